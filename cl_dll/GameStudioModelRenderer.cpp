@@ -77,6 +77,17 @@ void R_StudioInit( void )
 	g_StudioRenderer.Init();
 }
 
+/*
+====================
+R_StudioVidInit
+
+====================
+*/
+void R_StudioVidInit( void )
+{
+	g_StudioRenderer.StudioClearBoneCache();
+}
+
 // The simple drawing interface we'll pass back to the engine
 r_studio_interface_t studio =
 {
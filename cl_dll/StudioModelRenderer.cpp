@@ -55,6 +55,8 @@ void CStudioModelRenderer::Init( void )
 	m_pCvarHiModels			= IEngineStudio.GetCvar( "cl_himodels" );
 	m_pCvarDeveloper		= IEngineStudio.GetCvar( "developer" );
 	m_pCvarDrawEntities		= IEngineStudio.GetCvar( "r_drawentities" );
+	m_pCvarBoneCache		= CVAR_CREATE( "r_bonecache", "1", FCVAR_ARCHIVE );
+	m_pCvarBoneCacheSpeeds		= CVAR_CREATE( "r_bonecache_speeds", "0", 0 );
 
 	m_pChromeSprite			= IEngineStudio.GetChromeSprite();
 
@@ -81,6 +83,12 @@ CStudioModelRenderer::CStudioModelRenderer( void )
 	m_pCvarHiModels		= NULL;
 	m_pCvarDeveloper	= NULL;
 	m_pCvarDrawEntities	= NULL;
+	m_pCvarBoneCache	= NULL;
+	m_pCvarBoneCacheSpeeds	= NULL;
+	m_nBoneCacheFrame	= -1;
+	m_nBoneCacheHits	= 0;
+	m_nBoneCacheMisses	= 0;
+	m_nBonesComputed	= 0;
 	m_pChromeSprite		= NULL;
 	m_pStudioModelCount	= NULL;
 	m_pModelsDrawn		= NULL;
@@ -777,6 +785,116 @@ float CStudioModelRenderer::StudioEstimateFrame( mstudioseqdesc_t *pseqdesc )
 	return f;
 }
 
+/*
+====================
+StudioCanCacheBones
+
+====================
+*/
+bool CStudioModelRenderer::StudioCanCacheBones( void )
+{
+	if( !m_pCvarBoneCache || !m_pCvarBoneCache->value )
+		return false;
+
+	// Software renderer bakes the view into the bones
+	if( !IEngineStudio.IsHardware() )
+		return false;
+
+	// These effects jitter or scale the bones over time
+	switch( m_pCurrentEntity->curstate.renderfx )
+	{
+	case kRenderFxDistort:
+	case kRenderFxHologram:
+	case kRenderFxExplode:
+		return false;
+	default:
+		break;
+	}
+
+	// Blending from the last sequence depends on the time
+	if( m_fDoInterp && m_pCurrentEntity->latched.sequencetime &&
+		( m_pCurrentEntity->latched.sequencetime + 0.2 > m_clTime ) && 
+		( m_pCurrentEntity->latched.prevsequence < m_pStudioHeader->numseq ) )
+		return false;
+
+	return true;
+}
+
+/*
+====================
+StudioMakeBoneCacheKey
+
+====================
+*/
+void CStudioModelRenderer::StudioMakeBoneCacheKey( BoneCacheKey *key, double frame )
+{
+	// Compared as a whole, so padding must be zero too
+	memset( key, 0, sizeof( *key ) );
+
+	key->model = m_pRenderModel;
+	key->sequence = m_pCurrentEntity->curstate.sequence;
+	key->frame = frame;
+	key->dadt = StudioEstimateInterpolant();
+	memcpy( key->blending, m_pCurrentEntity->curstate.blending, sizeof( key->blending ) );
+	memcpy( key->prevblending, m_pCurrentEntity->latched.prevblending, sizeof( key->prevblending ) );
+	memcpy( key->controller, m_pCurrentEntity->curstate.controller, sizeof( key->controller ) );
+	memcpy( key->prevcontroller, m_pCurrentEntity->latched.prevcontroller, sizeof( key->prevcontroller ) );
+	key->mouthopen = m_pCurrentEntity->mouth.mouthopen;
+
+	if( m_pPlayerInfo && m_pPlayerInfo->gaitsequence != 0 )
+	{
+		key->gaitsequence = m_pPlayerInfo->gaitsequence;
+		key->gaitframe = m_pPlayerInfo->gaitframe;
+	}
+
+	memcpy( key->rotationmatrix, (*m_protationmatrix), sizeof( key->rotationmatrix ) );
+}
+
+/*
+====================
+StudioBoneCacheFrame
+
+====================
+*/
+void CStudioModelRenderer::StudioBoneCacheFrame( void )
+{
+	if( m_nBoneCacheFrame == m_nFrameCount )
+		return;
+
+	if( m_pCvarBoneCacheSpeeds && m_pCvarBoneCacheSpeeds->value )
+	{
+		gEngfuncs.Con_NPrintf( 17, "Bone setups: %d cached, %d computed", m_nBoneCacheHits, m_nBoneCacheMisses );
+		gEngfuncs.Con_NPrintf( 18, "Bones computed: %d", m_nBonesComputed );
+	}
+
+	// Entities that weren't drawn in the last frame are likely gone (temp entities, client-side entities),
+	// so the cache holds only what is being drawn
+	for( auto it = m_BoneCache.begin(); it != m_BoneCache.end(); )
+	{
+		if( it->second.lastframe != m_nBoneCacheFrame )
+			it = m_BoneCache.erase( it );
+		else
+			++it;
+	}
+
+	m_nBoneCacheFrame = m_nFrameCount;
+	m_nBoneCacheHits = 0;
+	m_nBoneCacheMisses = 0;
+	m_nBonesComputed = 0;
+}
+
+/*
+====================
+StudioClearBoneCache
+
+====================
+*/
+void CStudioModelRenderer::StudioClearBoneCache( void )
+{
+	m_BoneCache.clear();
+	m_nBoneCacheFrame = -1;
+}
+
 /*
 ====================
 StudioSetupBones
@@ -817,6 +935,31 @@ void CStudioModelRenderer::StudioSetupBones( void )
 		//Con_DPrintf( "%f %f\n", m_pCurrentEntity->prevframe, f );
 	}
 
+	StudioBoneCacheFrame();
+
+	BoneCacheEntry *pCacheEntry = NULL;
+	if( StudioCanCacheBones() )
+	{
+		BoneCacheKey key;
+		StudioMakeBoneCacheKey( &key, f );
+
+		pCacheEntry = &m_BoneCache[m_pCurrentEntity];
+		pCacheEntry->lastframe = m_nFrameCount;
+		if( pCacheEntry->valid && pCacheEntry->numbones == m_pStudioHeader->numbones &&
+			memcmp( &pCacheEntry->key, &key, sizeof( key ) ) == 0 )
+		{
+			memcpy( (*m_pbonetransform), pCacheEntry->bonetransform, sizeof( float[3][4] ) * pCacheEntry->numbones );
+			memcpy( (*m_plighttransform), pCacheEntry->lighttransform, sizeof( float[3][4] ) * pCacheEntry->numbones );
+			m_pCurrentEntity->latched.prevframe = f;
+			m_nBoneCacheHits++;
+			return;
+		}
+		pCacheEntry->key = key;
+		pCacheEntry->valid = false;
+	}
+	m_nBoneCacheMisses++;
+	m_nBonesComputed += m_pStudioHeader->numbones;
+
 	panim = StudioGetAnim( m_pRenderModel, pseqdesc );
 	StudioCalcRotations( pos, q, pseqdesc, panim, f );
 
@@ -961,6 +1104,14 @@ void CStudioModelRenderer::StudioSetupBones( void )
 			ConcatTransforms( (*m_plighttransform)[pbones[i].parent], bonematrix, (*m_plighttransform)[i] );
 		}
 	}
+
+	if( pCacheEntry )
+	{
+		pCacheEntry->numbones = m_pStudioHeader->numbones;
+		memcpy( pCacheEntry->bonetransform, (*m_pbonetransform), sizeof( float[3][4] ) * pCacheEntry->numbones );
+		memcpy( pCacheEntry->lighttransform, (*m_plighttransform), sizeof( float[3][4] ) * pCacheEntry->numbones );
+		pCacheEntry->valid = true;
+	}
 }
 
 /*
@@ -9,6 +9,35 @@
 #if !defined ( STUDIOMODELRENDERER_H )
 #define STUDIOMODELRENDERER_H
 
+#include <unordered_map>
+
+// Everything the bones computed by StudioSetupBones depend on
+struct BoneCacheKey
+{
+	model_t			*model;
+	int				sequence;
+	double			frame;
+	float			dadt;
+	byte			blending[2];
+	byte			prevblending[2];
+	byte			controller[4];
+	byte			prevcontroller[4];
+	byte			mouthopen;
+	int				gaitsequence;
+	float			gaitframe;
+	float			rotationmatrix[3][4];
+};
+
+struct BoneCacheEntry
+{
+	bool			valid;
+	int				lastframe;	// Entries not used in the last frame are evicted
+	BoneCacheKey	key;
+	int				numbones;
+	float			bonetransform[MAXSTUDIOBONES][3][4];
+	float			lighttransform[MAXSTUDIOBONES][3][4];
+};
+
 /*
 ====================
 CStudioModelRenderer
@@ -96,6 +125,20 @@ public:
 	// Process movement of player
 	virtual void StudioProcessGait( entity_state_t *pplayer );
 
+	// Bone cache
+	// Whether the bones of the current entity can be reused when nothing they depend on has changed
+	virtual bool StudioCanCacheBones( void );
+
+	// Collect everything the bones of the current entity depend on
+	virtual void StudioMakeBoneCacheKey( struct BoneCacheKey *key, double frame );
+
+	// Report r_bonecache_speeds counters and evict unused entries when a new frame starts
+	virtual void StudioBoneCacheFrame( void );
+
+public:
+	// Entities of the previous map are gone, called on VidInit
+	void StudioClearBoneCache( void );
+
 public:
 
 	// Client clock
@@ -159,6 +202,18 @@ public:
 	float			m_rgCachedBoneTransform[MAXSTUDIOBONES][3][4];
 	float			m_rgCachedLightTransform[MAXSTUDIOBONES][3][4];
 
+	// Bones set up for each entity, reused across render passes and by entities that don't animate
+	std::unordered_map<const cl_entity_t *, struct BoneCacheEntry> m_BoneCache;
+	// Use the bone cache?
+	cvar_t			*m_pCvarBoneCache;
+	// Print bone cache counters?
+	cvar_t			*m_pCvarBoneCacheSpeeds;
+	// Bone cache counters for the current frame
+	int				m_nBoneCacheFrame;
+	int				m_nBoneCacheHits;
+	int				m_nBoneCacheMisses;
+	int				m_nBonesComputed;
+
 	// Software renderer scale factors
 	float			m_fSoftwareXScale, m_fSoftwareYScale;
 
@@ -54,6 +54,7 @@ IParticleMan *g_pParticleMan = NULL;
 
 void CL_LoadParticleMan( void );
 void CL_UnloadParticleMan( void );
+void R_StudioVidInit( void );
 
 #if GOLDSOURCE_SUPPORT && (XASH_WIN32 || XASH_LINUX || XASH_APPLE) && XASH_X86
 #define USE_FAKE_VGUI	!USE_VGUI
@@ -356,6 +357,8 @@ so the HUD can reinitialize itself.
 int DLLEXPORT HUD_VidInit( void )
 {
 	gHUD.m_iHardwareMode = IEngineStudio.IsHardware();
+	PM_ClearGroundTextureCache();
+	R_StudioVidInit();
 	gHUD.VidInit();
 	LoadDefaultSprites();
 #if USE_FAKE_VGUI
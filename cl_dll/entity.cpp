@@ -676,6 +676,7 @@ void DLLEXPORT HUD_CreateEntities( void )
 	CL_UpdateLaserSpot();
 
 	gHUD.objectHintManager.Update();
+	gHUD.ropeManager.Update();
 
 #if USE_VGUI
 	GetClientVoiceMgr()->CreateEntities();
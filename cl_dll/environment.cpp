@@ -1,6 +1,7 @@
 #include <algorithm>
 
 #include "environment.h"
+#include "weather_particles.h"
 
 #include "parsemsg.h"
 
@@ -279,148 +280,6 @@ bool SnowData::SnowflakesAffectedByWind() const
 	return !(flags & SF_SNOW_NOT_AFFECTED_BY_WIND);
 }
 
-class CPartRainDrop : public CBaseParticle
-{
-public:
-	CPartRainDrop() = default;
-	void Think( float flTime ) override;
-	void Touch( Vector pos, Vector normal, int index ) override;
-
-	bool m_splashAllowed = true;
-	bool m_rippleAllowed = true;
-	ParticleParams m_splashParams;
-	ParticleParams m_rippleParams;
-	model_t* m_pRainSplash = nullptr;
-	model_t* m_pRipple = nullptr;
-
-private:
-	bool m_bTouched = false;
-};
-
-void CPartRainDrop::Think( float flTime )
-{
-	Vector vecViewAngles;
-	Vector vecForward, vecRight, vecUp;
-
-	gEngfuncs.GetViewAngles( vecViewAngles );
-
-	AngleVectors( vecViewAngles, vecForward, vecRight, vecUp );
-
-	m_vAngles.y = vecViewAngles.y;
-	m_vAngles.z = atan( DotProduct( m_vVelocity, vecRight ) / m_vVelocity.z ) * ( 180.0 / M_PI );
-
-	if( m_flBrightness < 155.0f )
-		m_flBrightness += 6.5f;
-
-	CBaseParticle::Think( flTime );
-}
-
-void CPartRainDrop::Touch( Vector pos, Vector normal, int index )
-{
-	if( m_bTouched )
-	{
-		return;
-	}
-
-	m_bTouched = true;
-
-	Vector vecStart = m_vOrigin;
-	vecStart.z += 32.0f;
-
-	pmtrace_t trace;
-
-	{
-		Vector vecEnd = m_vOrigin;
-		vecEnd.z -= 16.0f;
-
-		gEngfuncs.pEventAPI->EV_PlayerTrace( vecStart, vecEnd, PM_WORLD_ONLY, -1, &trace );
-	}
-
-	Vector vecNormal;
-
-	vecNormal.x = normal.x;
-	vecNormal.y = normal.y;
-	vecNormal.z = -normal.z;
-
-	Vector vecAngles;
-
-	VectorAngles( vecNormal, vecAngles );
-
-	if( gEngfuncs.PM_PointContents( trace.endpos, nullptr ) == gEngfuncs.PM_PointContents( vecStart, nullptr ) )
-	{
-		if (m_splashAllowed && m_pRainSplash)
-		{
-			CBaseParticle* pParticle = new CBaseParticle();
-
-			model_t* pRainSplash = m_pRainSplash;
-
-			pParticle->InitializeSprite( m_vOrigin + normal, Vector( 90.0f, 0.0f, 0.0f ), pRainSplash, m_splashParams.GetSize(), m_splashParams.brightness );
-
-			pParticle->m_iRendermode = m_splashParams.renderMode;
-
-			pParticle->m_flMass = 1.0f;
-			pParticle->m_flGravity = 0.1f;
-
-			pParticle->SetCullFlag( CULL_PVS );
-			pParticle->SetLightFlag( m_splashParams.lightFlag );
-
-			pParticle->m_vColor = m_splashParams.color;
-
-			pParticle->m_iNumFrames = pRainSplash->numframes - 1;
-			pParticle->m_iFramerate = Com_RandomLong( 30, 45 );
-			pParticle->m_flDieTime = gEngfuncs.GetClientTime() + 0.3f;
-			pParticle->SetCollisionFlags( TRI_ANIMATEDIE );
-			pParticle->SetRenderFlag( RENDER_FACEPLAYER );
-		}
-	}
-	else
-	{
-		if (m_rippleAllowed && m_pRipple)
-		{
-			Vector vecBegin = vecStart;
-			Vector vecEnd = trace.endpos;
-
-			Vector vecDist = vecEnd - vecBegin;
-
-			Vector vecHalf;
-
-			Vector vecNewBegin;
-
-			while( vecDist.Length() > 4.0 )
-			{
-				vecDist = vecDist * 0.5;
-
-				vecHalf = vecBegin + vecDist;
-
-				if( gEngfuncs.PM_PointContents( vecBegin, nullptr ) == gEngfuncs.PM_PointContents( vecHalf, nullptr ) )
-				{
-					vecBegin = vecHalf;
-					vecNewBegin = vecHalf;
-				}
-				else
-				{
-					vecEnd = vecHalf;
-					vecNewBegin = vecBegin;
-				}
-
-				vecDist = vecEnd - vecNewBegin;
-			}
-
-			CBaseParticle* pParticle = new CBaseParticle();
-
-			pParticle->InitializeSprite( vecBegin, vecAngles, m_pRipple, m_rippleParams.GetSize(), m_rippleParams.brightness );
-
-			pParticle->m_iRendermode = m_rippleParams.renderMode;
-			pParticle->m_flScaleSpeed = 1.0f;
-			pParticle->m_vColor = m_rippleParams.color;
-			pParticle->SetCullFlag( CULL_PVS );
-			pParticle->SetLightFlag( m_rippleParams.lightFlag );
-			pParticle->m_flFadeSpeed = 2.0f;
-			pParticle->m_flDieTime = gEngfuncs.GetClientTime() + 2.0f;
-		}
-	}
-}
-
 class CPartWind : public CBaseParticle
 {
 public:
@@ -455,89 +314,6 @@ void CPartWind::Think( float flTime )
 	CBaseParticle::Think( flTime );
 }
 
-class CPartSnowFlake : public CBaseParticle
-{
-public:
-	CPartSnowFlake() = default;
-	void Think( float flTime ) override;
-	void Touch( Vector pos, Vector normal, int index ) override;
-
-public:
-	bool m_bSpiral;
-	float m_flSpiralTime;
-	int m_targetBrightness;
-
-private:
-	bool m_bTouched = false;
-};
-
-void CPartSnowFlake::Think( float flTime )
-{
-	if( m_flBrightness < m_targetBrightness && !m_bTouched )
-		m_flBrightness += 4.5;
-
-	if (m_flBrightness > 255.0f)
-		m_flBrightness = 255.0f;
-
-	Fade( flTime );
-	Spin( flTime );
-
-	if( m_flSpiralTime <= gEngfuncs.GetClientTime() )
-	{
-		m_bSpiral = !m_bSpiral;
-
-		m_flSpiralTime = gEngfuncs.GetClientTime() + Com_RandomLong( 2, 4 );
-	}
-
-	if( m_bSpiral && !m_bTouched )
-	{
-		const float flDelta = flTime - g_Environment.GetOldTime();
-
-		const float flSpin = sin( flTime * 5.0 + reinterpret_cast<int>( this ) );
-
-		m_vOrigin = m_vOrigin + m_vVelocity * flDelta;
-
-		m_vOrigin.x += ( flSpin * flSpin ) * 0.3;
-	}
-	else
-	{
-		CalculateVelocity( flTime );
-	}
-
-	CheckCollision( flTime );
-}
-
-void CPartSnowFlake::Touch( Vector pos, Vector normal, int index )
-{
-	if( m_bTouched )
-	{
-		return;
-	}
-
-	m_bTouched = true;
-
-	SetRenderFlag( RENDER_FACEPLAYER );
-
-	m_flOriginalBrightness = m_flBrightness;
-
-	m_vVelocity = g_vecZero;
-
-	//m_iRendermode = kRenderTransAdd;
-
-	m_flFadeSpeed = 0;
-	m_flScaleSpeed = 0;
-	m_flDampingTime = 0;
-	m_iFrame = 0;
-	m_flMass = 1.0;
-	m_flGravity = 0;
-
-	//m_vColor.x = m_vColor.y = m_vColor.z = 128.0;
-
-	m_flDieTime = gEngfuncs.GetClientTime() + 0.5;
-
-	m_flTimeCreated = gEngfuncs.GetClientTime();
-}
-
 void CEnvironment::Initialize()
 {
 	Reset();
@@ -566,12 +342,14 @@ void CEnvironment::Reset()
 	m_vecDesiredWindDirection.z = 0;
 
 	m_flNextWindChangeTime = gEngfuncs.GetClientTime();
+	m_flOldTime = gEngfuncs.GetClientTime();
 }
 
 void CEnvironment::Clear()
 {
 	m_rains.clear();
 	m_snows.clear();
+	m_weatherParticles.clear();
 }
 
 void CEnvironment::Update()
@@ -605,6 +383,8 @@ void CEnvironment::Update()
 
 	const float clientTime = gEngfuncs.GetClientTime();
 
+	UpdateWeatherParticles(clientTime);
+
 	for (auto& rain : m_rains)
 	{
 		if (rain.updateTime <= clientTime)
@@ -705,6 +485,54 @@ void CEnvironment::UpdateWind()
 	m_vecWind = vecNewWind * m_flDesiredWindSpeed;
 }
 
+WeatherParticles& CEnvironment::GetRainParticles(const RainData& rainData)
+{
+	auto it = std::find_if(m_weatherParticles.begin(), m_weatherParticles.end(), [&](const std::unique_ptr<WeatherParticles>& particles) {
+		return particles->GetKind() == WeatherParticles::RAIN && particles->GetEntIndex() == rainData.entIndex;
+	});
+	if (it == m_weatherParticles.end())
+	{
+		m_weatherParticles.emplace_back(new WeatherParticles(WeatherParticles::RAIN, rainData.entIndex));
+		it = m_weatherParticles.end() - 1;
+	}
+	(*it)->SetRainData(rainData);
+	return **it;
+}
+
+WeatherParticles& CEnvironment::GetSnowParticles(const SnowData& snowData)
+{
+	auto it = std::find_if(m_weatherParticles.begin(), m_weatherParticles.end(), [&](const std::unique_ptr<WeatherParticles>& particles) {
+		return particles->GetKind() == WeatherParticles::SNOW && particles->GetEntIndex() == snowData.entIndex;
+	});
+	if (it == m_weatherParticles.end())
+	{
+		m_weatherParticles.emplace_back(new WeatherParticles(WeatherParticles::SNOW, snowData.entIndex));
+		it = m_weatherParticles.end() - 1;
+	}
+	(*it)->SetSnowData(snowData);
+	return **it;
+}
+
+void CEnvironment::UpdateWeatherParticles(float time)
+{
+	const float frametime = time - m_flOldTime;
+
+	for (size_t i = 0; i < m_weatherParticles.size();)
+	{
+		WeatherParticles& particles = *m_weatherParticles[i];
+		particles.Update(time, frametime);
+
+		if (particles.Count() == 0)
+		{
+			m_weatherParticles.erase(m_weatherParticles.begin() + i);
+			continue;
+		}
+
+		particles.Draw(time);
+		++i;
+	}
+}
+
 void CEnvironment::UpdateRain(const RainData& rainData)
 {
 	const float rainIntensity = rainData.intensity * m_flWeatherValue;
@@ -736,6 +564,8 @@ void CEnvironment::UpdateRain(const RainData& rainData)
 		if (!inPvs)
 			return;
 
+		WeatherParticles& raindrops = GetRainParticles(rainData);
+
 		for( size_t uiIndex = 0; static_cast<float>( uiIndex ) < rainIntensity; ++uiIndex )
 		{
 			Vector vecOrigin = rainData.GetRandomOrigin(weatherOrigin);
@@ -750,8 +580,7 @@ void CEnvironment::UpdateRain(const RainData& rainData)
 
 			if( allowIndoors || (pszTexture && strncmp( pszTexture, "sky", 3 ) == 0) )
 			{
-				CPartRainDrop* rainParticle = CreateRaindrop( vecOrigin, rainData );
-				if (rainParticle)
+				if (CreateRaindrop( raindrops, vecOrigin, rainData ))
 					rainDropCount++;
 
 				if (windParticlesEnabled)
@@ -820,6 +649,8 @@ void CEnvironment::UpdateSnow(const SnowData& snowData)
 		if (!inPvs)
 			return;
 
+		WeatherParticles& snowflakes = GetSnowParticles(snowData);
+
 		for( size_t uiIndex = 0; static_cast<float>( uiIndex ) < snowIntensity; ++uiIndex )
 		{
 			Vector vecOrigin = snowData.GetRandomOrigin(weatherOrigin);
@@ -834,59 +665,36 @@ void CEnvironment::UpdateSnow(const SnowData& snowData)
 
 			if( allowIndoors || (pszTexture && strncmp( pszTexture, "sky", 3 ) == 0) )
 			{
-				CreateSnowFlake( vecOrigin, snowData );
+				CreateSnowFlake( snowflakes, vecOrigin, snowData );
 			}
 		}
 	}
 }
 
-CPartRainDrop* CEnvironment::CreateRaindrop( const Vector& vecOrigin, const RainData& rainData )
+bool CEnvironment::CreateRaindrop( WeatherParticles& raindrops, const Vector& vecOrigin, const RainData& rainData )
 {
 	if( !rainData.rainSprite )
 	{
-		return nullptr;
+		return false;
 	}
 
-	CPartRainDrop* pParticle = new CPartRainDrop();
-	pParticle->m_splashAllowed = rainData.SplashesAllowed();
-	pParticle->m_rippleAllowed = rainData.RipplesAllowed();
-	pParticle->m_splashParams = rainData.splashParticleParams;
-	pParticle->m_rippleParams = rainData.rippleParticleParams;
-	pParticle->m_pRainSplash = rainData.splashSprite;
-	pParticle->m_pRipple = rainData.rippleSprite;
-
-	pParticle->InitializeSprite( vecOrigin, g_vecZero, rainData.rainSprite, rainData.raindropParticleParams.GetSize(), rainData.raindropParticleParams.brightness );
-
-	strcpy( pParticle->m_szClassname, "particle_rain" );
-
-	pParticle->m_flStretchY = rainData.raindropStretchY;
+	Vector vecVelocity;
 
 	if (rainData.RaindropsAffectedByWind())
 	{
-		pParticle->m_vVelocity.x = m_vecWind.x * Com_RandomFloat( 1.0f, 2.0f );
-		pParticle->m_vVelocity.y = m_vecWind.y * Com_RandomFloat( 1.0f, 2.0f );
+		vecVelocity.x = m_vecWind.x * Com_RandomFloat( 1.0f, 2.0f );
+		vecVelocity.y = m_vecWind.y * Com_RandomFloat( 1.0f, 2.0f );
 	}
 	else
 	{
-		pParticle->m_vVelocity.x = pParticle->m_vVelocity.y = 0.0f;
+		vecVelocity.x = vecVelocity.y = 0.0f;
 	}
 
-	pParticle->m_vVelocity.z = -rainData.GetRaindropFallingSpeed();
-
-	pParticle->SetCollisionFlags( TRI_COLLIDEWORLD | TRI_COLLIDEKILL | TRI_WATERTRACE );
-
-	pParticle->m_flGravity = 0;
-
-	pParticle->SetCullFlag( CULL_PVS );
-	pParticle->SetLightFlag( rainData.raindropParticleParams.lightFlag );
-
-	pParticle->m_iRendermode = rainData.raindropParticleParams.renderMode;
-
-	pParticle->m_vColor = rainData.raindropParticleParams.color;
+	vecVelocity.z = -rainData.GetRaindropFallingSpeed();
 
-	pParticle->m_flDieTime = gEngfuncs.GetClientTime() + rainData.raindropLife;
+	raindrops.AddRaindrop( vecOrigin, vecVelocity, gEngfuncs.GetClientTime() );
 
-	return pParticle;
+	return true;
 }
 
 CPartWind* CEnvironment::CreateWindParticle( const Vector& vecOrigin, const RainData& rainData )
@@ -952,38 +760,26 @@ CPartWind* CEnvironment::CreateWindParticle( const Vector& vecOrigin, const Rain
 	return pParticle;
 }
 
-void CEnvironment::CreateSnowFlake( const Vector& vecOrigin, const SnowData& snowData )
+void CEnvironment::CreateSnowFlake( WeatherParticles& snowflakes, const Vector& vecOrigin, const SnowData& snowData )
 {
 	if( !snowData.snowSprite )
 	{
 		return;
 	}
 
-	CPartSnowFlake* pParticle = new CPartSnowFlake();
-	pParticle->m_targetBrightness = snowData.snowflakeParticleParams.brightness;
-
-	pParticle->InitializeSprite(
-		vecOrigin, g_vecZero,
-		snowData.snowSprite,
-		snowData.snowflakeParticleParams.GetSize(), snowData.snowflakeInitialBrightness );
-
-	strcpy( pParticle->m_szClassname, "snow_particle" );
-
-	pParticle->m_iNumFrames = snowData.snowSprite->numframes;
+	Vector vecVelocity;
 
 	if (snowData.SnowflakesAffectedByWind())
 	{
-		pParticle->m_vVelocity.x = m_vecWind.x / Com_RandomFloat( 1.0, 2.0 );
-		pParticle->m_vVelocity.y = m_vecWind.y / Com_RandomFloat( 1.0, 2.0 );
+		vecVelocity.x = m_vecWind.x / Com_RandomFloat( 1.0, 2.0 );
+		vecVelocity.y = m_vecWind.y / Com_RandomFloat( 1.0, 2.0 );
 	}
 	else
 	{
-		pParticle->m_vVelocity.x = pParticle->m_vVelocity.y = 0.0f;
+		vecVelocity.x = vecVelocity.y = 0.0f;
 	}
 
-	pParticle->m_vVelocity.z = -snowData.GetSnowflakeFallingSpeed();
-
-	pParticle->SetCollisionFlags( TRI_COLLIDEWORLD );
+	vecVelocity.z = -snowData.GetSnowflakeFallingSpeed();
 
 	const float flFrac = Com_RandomFloat( 0.0, 1.0 );
 
@@ -991,40 +787,20 @@ void CEnvironment::CreateSnowFlake( const Vector& vecOrigin, const SnowData& sno
 	{
 		if( flFrac < 0.2 )
 		{
-			pParticle->m_vVelocity.z = -65.0;
+			vecVelocity.z = -65.0;
 		}
 		else if( flFrac < 0.3 )
 		{
-			pParticle->m_vVelocity.z = -75.0;
+			vecVelocity.z = -75.0;
 		}
 	}
 	else
 	{
-		pParticle->m_vVelocity.x *= 0.5;
-		pParticle->m_vVelocity.y *= 0.5;
+		vecVelocity.x *= 0.5;
+		vecVelocity.y *= 0.5;
 	}
 
-	pParticle->m_iRendermode = snowData.snowflakeParticleParams.renderMode;
-
-	pParticle->SetCullFlag( CULL_PVS );
-	pParticle->SetLightFlag( snowData.snowflakeParticleParams.lightFlag );
-	pParticle->SetRenderFlag( RENDER_FACEPLAYER );
-
-	pParticle->m_flScaleSpeed = 0;
-	pParticle->m_flDampingTime = 0;
-	pParticle->m_iFrame = 0;
-	pParticle->m_flMass = 1.0;
-
-	pParticle->m_flGravity = 0;
-	pParticle->m_flBounceFactor = 0;
-
-	pParticle->m_vColor = snowData.snowflakeParticleParams.color;
-
-	pParticle->m_flDieTime = gEngfuncs.GetClientTime() + snowData.snowflakeLife;
-
-	pParticle->m_bSpiral = Com_RandomLong( 0, 1 ) != 0;
-
-	pParticle->m_flSpiralTime = gEngfuncs.GetClientTime() + Com_RandomLong( 2, 4 );
+	snowflakes.AddSnowflake( vecOrigin, vecVelocity, Com_RandomLong( 0, 1 ) != 0, gEngfuncs.GetClientTime() );
 }
 
 static void ReadWeatherData(WeatherData& data)
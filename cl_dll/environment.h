@@ -6,10 +6,11 @@
 #include "cl_dll.h"
 #include "com_model.h"
 
+#include <memory>
 #include <vector>
 
-class CPartRainDrop;
 class CPartWind;
+class WeatherParticles;
 
 struct ParticleParams
 {
@@ -108,8 +109,6 @@ class CEnvironment
 public:
 	CEnvironment() = default;
 
-	float GetOldTime() const { return m_flOldTime; }
-
 	void Initialize();
 	void Reset();
 	void Clear();
@@ -129,9 +128,13 @@ private:
 	void UpdateRain(const RainData& rainData);
 	void UpdateSnow(const SnowData& snowData);
 
-	CPartRainDrop* CreateRaindrop(const Vector& vecOrigin, const RainData& rainData);
+	WeatherParticles& GetRainParticles(const RainData& rainData);
+	WeatherParticles& GetSnowParticles(const SnowData& snowData);
+	void UpdateWeatherParticles(float time);
+
+	bool CreateRaindrop(WeatherParticles& raindrops, const Vector& vecOrigin, const RainData& rainData);
 	CPartWind* CreateWindParticle(const Vector& vecOrigin, const RainData& rainData);
-	void CreateSnowFlake(const Vector& vecOrigin, const SnowData& snowData);
+	void CreateSnowFlake(WeatherParticles& snowflakes, const Vector& vecOrigin, const SnowData& snowData);
 
 	model_t* LoadSprite(const char* spriteName);
 private:
@@ -158,6 +161,9 @@ private:
 	std::vector<RainData> m_rains;
 	std::vector<SnowData> m_snows;
 
+	// Raindrops and snowflakes by weather entity. Stay until the last particle dies even if the entity is gone.
+	std::vector<std::unique_ptr<WeatherParticles> > m_weatherParticles;
+
 private:
 	CEnvironment( const CEnvironment& ) = delete;
 	CEnvironment& operator=( const CEnvironment& ) = delete;
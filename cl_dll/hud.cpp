@@ -385,6 +385,16 @@ int __MsgFunc_ObjectHint( const char *pszName, int iSize, void *pbuf )
 	return gHUD.MsgFunc_ObjectHint( pszName, iSize, pbuf );
 }
 
+int __MsgFunc_HintSprites( const char *pszName, int iSize, void *pbuf )
+{
+	return gHUD.MsgFunc_HintSprites( pszName, iSize, pbuf );
+}
+
+int __MsgFunc_Rope( const char *pszName, int iSize, void *pbuf )
+{
+	return gHUD.MsgFunc_Rope( pszName, iSize, pbuf );
+}
+
 // TFFree Command Menu
 void __CmdFunc_OpenCommandMenu( void )
 {
@@ -629,6 +639,8 @@ void CHud::Init( void )
 
 	HOOK_MESSAGE( PlayMP3 );
 	HOOK_MESSAGE( ObjectHint );
+	HOOK_MESSAGE( HintSprites );
+	HOOK_MESSAGE( Rope );
 
 	CVAR_CREATE( "hud_classautokill", "1", FCVAR_ARCHIVE | FCVAR_USERINFO );		// controls whether or not to suicide immediately on TF class switch
 	CVAR_CREATE( "hud_takesshots", "0", FCVAR_ARCHIVE );		// controls whether or not to automatically take screenshots at the end of a round
@@ -1254,6 +1266,7 @@ void CHud::VidInit( void )
 	m_iFontHeight = m_rgrcRects[m_HUD_number_0].bottom - m_rgrcRects[m_HUD_number_0].top;
 
 	objectHintManager.Clear();
+	ropeManager.Clear();
 
 	m_Ammo.VidInit();
 	m_Health.VidInit();
@@ -46,6 +46,7 @@
 #include "hud_renderer.h"
 #include "hud_inventory.h"
 #include "hud_objecthint.h"
+#include "hud_ropes.h"
 
 #include <vector>
 #include <string>
@@ -1068,6 +1069,8 @@ public:
 	int _cdecl MsgFunc_SetFog( const char *pszName, int iSize, void *pbuf );
 	int _cdecl MsgFunc_KeyedDLight( const char *pszName, int iSize, void *pbuf );
 	int _cdecl MsgFunc_ObjectHint( const char *pszName, int iSize, void *pbuf );
+	int _cdecl MsgFunc_HintSprites( const char *pszName, int iSize, void *pbuf );
+	int _cdecl MsgFunc_Rope( const char *pszName, int iSize, void *pbuf );
 
 	// Screen information
 	SCREENINFO	m_scrinfo;
@@ -1097,6 +1100,7 @@ public:
 
 	InventoryHudSpec inventorySpec;
 	ObjectHintManager objectHintManager;
+	RopeManager ropeManager;
 
 	HudSpriteRenderer hudRenderer;
 	bool hasHudScaleInEngine;
@@ -23,6 +23,7 @@
 #include "arraysize.h"
 #include "string_utils.h"
 #include "spritehint_flags.h"
+#include "rope_msg.h"
 
 #include "environment.h"
 
@@ -189,34 +190,81 @@ int CHud::MsgFunc_ObjectHint(const char *pszName, int iSize, void *pbuf)
 {
 	BEGIN_READ(pbuf, iSize);
 
-	ObjectHint objectHint;
+	ObjectHint objectHint = {};
 
-	int flags = READ_BYTE();
-	if (flags & OBJECTHINT_FLAG_CLOSEST)
-		objectHint.interactable = true;
-	else
-		objectHint.interactable = false;
+	const int flags = READ_BYTE();
+	objectHint.interactable = (flags & OBJECTHINT_FLAG_CLOSEST) != 0;
 	objectHint.entindex = READ_SHORT();
 
-	if (objectHint.entindex > 0)
+	if (flags & OBJECTHINT_FLAG_REMOVE)
 	{
+		if (objectHint.interactable || objectHint.entindex > 0)
+			objectHintManager.RemoveHint(objectHint.entindex, objectHint.interactable);
+		else
+			objectHintManager.RemoveAll();
+		return 1;
+	}
+
+	// Only the fields that changed are sent, cl_objecthint is applied when the hints are shown
+	const int fields = READ_BYTE();
+	if (fields & OBJECTHINT_FIELD_SPRITE)
+		objectHint.sprite = READ_BYTE();
+	if (fields & OBJECTHINT_FIELD_COLOR)
 		objectHint.color = READ_COLOR();
+	if (fields & OBJECTHINT_FIELD_SCALE)
 		objectHint.scaleFactor = READ_COORD();
+	if (fields & OBJECTHINT_FIELD_CENTER)
 		objectHint.center = READ_VECTOR();
+	if (fields & OBJECTHINT_FIELD_SIZE)
 		objectHint.size = READ_VECTOR();
-		const char* spriteName = READ_STRING();
-		strncpyEnsureTermination(objectHint.sprite, spriteName);
-
-		if (m_pCvarObjectHint->value)
-		{
-			const bool shouldSet = m_pCvarObjectHint->value == 2 ? objectHint.interactable : true;
-			if (shouldSet)
-				objectHintManager.SetHint(objectHint);
-		}
+	objectHintManager.SetHint(objectHint, fields);
+
+	return 1;
+}
+
+int CHud::MsgFunc_HintSprites(const char *pszName, int iSize, void *pbuf)
+{
+	BEGIN_READ(pbuf, iSize);
+
+	const int index = READ_BYTE();
+	objectHintManager.SetSprite(index, READ_STRING());
+
+	return 1;
+}
+
+int CHud::MsgFunc_Rope(const char *pszName, int iSize, void *pbuf)
+{
+	BEGIN_READ(pbuf, iSize);
+
+	const int type = READ_BYTE();
+	const int entindex = READ_SHORT();
+
+	switch (type) {
+	case ROPE_MSG_CREATE:
+	{
+		RopeDesc desc;
+		desc.entindex = entindex;
+		desc.numSegments = READ_BYTE();
+		desc.origin = READ_VECTOR();
+		desc.bodyModelIndex = READ_SHORT();
+		desc.endingModelIndex = READ_SHORT();
+		desc.bodyLength = READ_COORD();
+		desc.endingLength = READ_COORD();
+		ropeManager.CreateRope(desc);
 	}
-	else if (objectHint.interactable)
+		break;
+	case ROPE_MSG_REMOVE:
+		ropeManager.RemoveRope(entindex);
+		break;
+	case ROPE_MSG_ATTACH:
 	{
-		objectHintManager.RemoveInteractable();
+		const int attachedIndex = READ_SHORT();
+		const int segment = READ_BYTE();
+		ropeManager.SetAttachedObject(entindex, attachedIndex, segment);
+	}
+		break;
+	default:
+		break;
 	}
 
 	return 1;
@@ -2,8 +2,10 @@
 #include "hud.h"
 #include "event_api.h"
 #include "color_utils.h"
+#include "spritehint_flags.h"
 
 #include <cassert>
+#include <cstring>
 
 static void SetParentEntityIndex(TEMPENTITY* te, int entindex)
 {
@@ -29,11 +31,6 @@ static void SetExpirationTime(TEMPENTITY* te, float t)
 	te->die = t + 1.0f;
 }
 
-static float GetExpirationTime(TEMPENTITY* te)
-{
-	return te->entity.curstate.fuser1;
-}
-
 static void SetScaleFactor(TEMPENTITY* te, float scale)
 {
 	te->entity.curstate.fuser2 = scale;
@@ -87,90 +84,154 @@ static void UpdateObjectHintParams(TEMPENTITY* te, const ObjectHint &objectHint)
 		SetOffsetVector(te, Vector(0,0,0));
 }
 
-void ObjectHintManager::SetHint(const ObjectHint &objectHint)
+void ObjectHintManager::SetSprite(int index, const char* name)
 {
-	TEMPENTITY* existingHint = ExistingCurrentHint(objectHint.entindex);
-	if (existingHint)
+	if (index <= 0)
+		return;
+	if (index > (int)_spriteNames.size())
+		_spriteNames.resize(index);
+	_spriteNames[index - 1] = name;
+}
+
+void ObjectHintManager::SetHint(const ObjectHint &objectHint, int fields)
+{
+	HintState* state;
+	bool isNew = false;
+	if (objectHint.interactable)
 	{
-		if (strcmp(existingHint->entity.model->name, objectHint.sprite) == 0)
+		if (!_hasInteractableHint || _interactableHint.hint.entindex != objectHint.entindex)
 		{
-			existingHint->entity.origin = objectHint.center;
-			UpdateObjectHintParams(existingHint, objectHint);
-
-			SetExpirationTime(existingHint, gEngfuncs.GetClientTime() + 0.2f);
-			return;
+			KillTempEnt(_interactableHint);
+			_hasInteractableHint = true;
+			isNew = true;
 		}
-		else
+		state = &_interactableHint;
+	}
+	else
+	{
+		auto it = _independentHints.find(objectHint.entindex);
+		if (it == _independentHints.end())
 		{
-			existingHint->die = gEngfuncs.GetClientTime();
-			_independentHints.erase(objectHint.entindex);
+			it = _independentHints.insert(std::make_pair(objectHint.entindex, HintState())).first;
+			isNew = true;
 		}
+		state = &it->second;
 	}
 
-	if (!*objectHint.sprite)
-		return;
-
-	model_t* model = EnsureSpriteLoaded(objectHint.sprite);
-	if (!model)
-		return;
+	ObjectHint& hint = state->hint;
+	if (isNew)
+	{
+		memset(&hint, 0, sizeof(hint));
+		hint.entindex = objectHint.entindex;
+		hint.interactable = objectHint.interactable;
+		hint.scaleFactor = 1.0f;
+		state->te = nullptr;
+	}
+	if (fields & OBJECTHINT_FIELD_SPRITE)
+		hint.sprite = objectHint.sprite;
+	if (fields & OBJECTHINT_FIELD_COLOR)
+		hint.color = objectHint.color;
+	if (fields & OBJECTHINT_FIELD_SCALE)
+		hint.scaleFactor = objectHint.scaleFactor;
+	if (fields & OBJECTHINT_FIELD_CENTER)
+		hint.center = objectHint.center;
+	if (fields & OBJECTHINT_FIELD_SIZE)
+		hint.size = objectHint.size;
+	state->changed = true;
+}
 
-	Vector pos = objectHint.center;
-	TEMPENTITY* te = gEngfuncs.pEfxAPI->CL_TempEntAlloc(pos, model);
-	if (!te)
+void ObjectHintManager::RemoveHint(int entindex, bool interactable)
+{
+	if (interactable)
+	{
+		KillTempEnt(_interactableHint);
+		_hasInteractableHint = false;
 		return;
+	}
+	auto it = _independentHints.find(entindex);
+	if (it != _independentHints.end())
+	{
+		KillTempEnt(it->second);
+		_independentHints.erase(it);
+	}
+}
 
-	SetParentEntityIndex(te, objectHint.entindex);
-
-	te->entity.curstate.rendermode = kRenderGlow;
-	te->entity.curstate.renderfx = kRenderFxNoDissipation;
-	te->entity.curstate.renderamt = 255;
+void ObjectHintManager::RemoveAll()
+{
+	RemoveHint(0, true);
+	for (auto& p : _independentHints)
+	{
+		KillTempEnt(p.second);
+	}
+	_independentHints.clear();
+}
 
-	UpdateObjectHintParams(te, objectHint);
+void ObjectHintManager::KillTempEnt(HintState &state)
+{
+	if (state.te)
+	{
+		state.te->die = gEngfuncs.GetClientTime();
+		state.te = nullptr;
+	}
+}
 
-	SetExpirationTime(te, gEngfuncs.GetClientTime() + 0.2f);
+model_t* ObjectHintManager::SpriteModel(int sprite)
+{
+	if (sprite <= 0 || sprite > (int)_spriteNames.size() || _spriteNames[sprite - 1].empty())
+		return nullptr;
+	return EnsureSpriteLoaded(_spriteNames[sprite - 1].c_str());
+}
 
-	if (objectHint.interactable)
+void ObjectHintManager::UpdateState(HintState &state, bool show, float clientTime)
+{
+	model_t* model = show ? SpriteModel(state.hint.sprite) : nullptr;
+	if (!model)
 	{
-		RemoveInteractable();
-		_interactableHint = te;
+		KillTempEnt(state);
+		return;
 	}
-	else
+
+	if (state.te && state.te->entity.model != model)
+		KillTempEnt(state);
+
+	if (!state.te)
 	{
-		_independentHints[objectHint.entindex] = te;
+		TEMPENTITY* te = gEngfuncs.pEfxAPI->CL_TempEntAlloc(state.hint.center, model);
+		if (!te)
+			return;
+
+		SetParentEntityIndex(te, state.hint.entindex);
+
+		te->entity.curstate.rendermode = kRenderGlow;
+		te->entity.curstate.renderfx = kRenderFxNoDissipation;
+		te->entity.curstate.renderamt = 255;
+
+		state.te = te;
+		state.changed = true;
 	}
-}
 
-void ObjectHintManager::RemoveInteractable()
-{
-	if (_interactableHint)
+	if (state.changed)
 	{
-		_interactableHint->die = gEngfuncs.GetClientTime();
-		_interactableHint = nullptr;
+		state.te->entity.origin = state.hint.center;
+		UpdateObjectHintParams(state.te, state.hint);
+		state.changed = false;
 	}
+
+	// Hints stay until the server removes them
+	SetExpirationTime(state.te, clientTime + 0.2f);
+	UpdateHint(state.te);
 }
 
 void ObjectHintManager::Update()
 {
 	const float clientTime = gEngfuncs.GetClientTime();
-	if (_interactableHint)
+	const int mode = gHUD.m_pCvarObjectHint ? (int)gHUD.m_pCvarObjectHint->value : 1;
+
+	if (_hasInteractableHint)
+		UpdateState(_interactableHint, mode != 0, clientTime);
+	for (auto& p : _independentHints)
 	{
-		if (GetExpirationTime(_interactableHint) <= clientTime)
-			RemoveInteractable();
-		else
-			UpdateHint(_interactableHint);
-	}
-	for (auto it = _independentHints.begin(); it != _independentHints.end();)
-	{
-		if (GetExpirationTime(it->second) <= clientTime)
-		{
-			it->second->die = clientTime;
-			_independentHints.erase(it++);
-		}
-		else
-		{
-			UpdateHint(it->second);
-			++it;
-		}
+		UpdateState(p.second, mode != 0 && mode != 2, clientTime);
 	}
 }
 
@@ -203,21 +264,9 @@ model_t* ObjectHintManager::EnsureSpriteLoaded(const char* name)
 
 void ObjectHintManager::Clear()
 {
+	// Temp entities are gone along with the level. The sprite table is kept, it's only sent when the server resets the hints.
 	_loadedSprites.clear();
-	_interactableHint = nullptr;
+	_hasInteractableHint = false;
+	_interactableHint.te = nullptr;
 	_independentHints.clear();
 }
-
-TEMPENTITY* ObjectHintManager::ExistingCurrentHint(int entindex)
-{
-	if (_interactableHint && GetParentEntityIndex(_interactableHint) == entindex)
-	{
-		return _interactableHint;
-	}
-	auto it = _independentHints.find(entindex);
-	if (it != _independentHints.end())
-	{
-		return it->second;
-	}
-	return nullptr;
-}
@@ -8,34 +8,50 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 struct ObjectHint
 {
 	int entindex;
+	int sprite; // index in the sprite table sent by the server, 0 for none
 	color24 color;
 	float scaleFactor;
 	Vector center;
 	Vector size;
-	char sprite[64];
 	bool interactable;
 };
 
+// Keeps the hints as the server last described them. The server only sends the hints that were added, changed or removed.
 class ObjectHintManager
 {
 public:
-	void SetHint(const ObjectHint& objectHint);
-	void RemoveInteractable();
+	void SetSprite(int index, const char* name);
+	// Applies the fields (OBJECTHINT_FIELD_*) of the hint
+	void SetHint(const ObjectHint& objectHint, int fields);
+	void RemoveHint(int entindex, bool interactable);
+	void RemoveAll();
 	void Update();
 	model_t* EnsureSpriteLoaded(const char* name);
 	void Clear();
 
 private:
+	struct HintState
+	{
+		ObjectHint hint;
+		TEMPENTITY* te;
+		bool changed;
+	};
+
+	void UpdateState(HintState& state, bool show, float clientTime);
 	void UpdateHint(TEMPENTITY* te);
-	TEMPENTITY* ExistingCurrentHint(int entindex);
+	static void KillTempEnt(HintState& state);
+	model_t* SpriteModel(int sprite);
 
+	std::vector<std::string> _spriteNames;
 	std::map<std::string, model_t*> _loadedSprites;
-	TEMPENTITY* _interactableHint;
-	std::map<int, TEMPENTITY*> _independentHints;
+	HintState _interactableHint;
+	bool _hasInteractableHint = false;
+	std::map<int, HintState> _independentHints;
 };
 
 #endif
@@ -0,0 +1,216 @@
+#include "hud_ropes.h"
+#include "hud.h"
+#include "cl_util.h"
+#include "event_api.h"
+#include "triangleapi.h"
+#include "entity_types.h"
+#include "pmtrace.h"
+#include "pm_defs.h"
+#include "r_studioint.h"
+#include "hull_types.h"
+#include "min_and_max.h"
+#include "rope_msg.h"
+
+#include <cmath>
+
+extern engine_studio_api_t IEngineStudio;
+
+// Same as GetAlignmentAngles of the server ropes, the segment models hang along -z
+static void GetAlignmentAngles(const Vector& vecTop, const Vector& vecBottom, Vector& vecOut)
+{
+	Vector vecDist = vecBottom - vecTop;
+
+	Vector vecResult = vecDist.Normalize();
+
+	const float flRoll = acos(DotProduct(vecResult, Vector(0, 1, 0))) * (180.0 / M_PI);
+
+	vecOut.z = -flRoll;
+
+	vecDist.y = 0;
+
+	vecResult = vecDist.Normalize();
+
+	const float flPitch = acos(DotProduct(vecResult, Vector(0, 0, -1))) * (180.0 / M_PI);
+
+	vecOut.x = (vecResult.x >= 0.0) ? flPitch : -flPitch;
+	vecOut.y = 0;
+}
+
+static bool TraceWorld(Vector start, Vector end, pmtrace_t& trace)
+{
+	gEngfuncs.pEventAPI->EV_SetTraceHull(point_hull);
+	gEngfuncs.pEventAPI->EV_PlayerTrace(start, end, PM_WORLD_ONLY, -1, &trace);
+	return trace.fraction != 1.0f;
+}
+
+void RopeManager::CreateRope(const RopeDesc& desc)
+{
+	if (desc.numSegments <= 0 || desc.numSegments >= ROPE_MAX_SAMPLES)
+		return;
+
+	ClientRope& rope = _ropes[desc.entindex];
+
+	rope.numSegments = desc.numSegments;
+	rope.bodyModel = IEngineStudio.GetModelByIndex(desc.bodyModelIndex);
+	rope.endingModel = IEngineStudio.GetModelByIndex(desc.endingModelIndex);
+	rope.attachedIndex = 0;
+	rope.attachedSegment = 0;
+	rope.lastTime = 0.0f;
+
+	// Hang the rope straight from the anchor, like the server does when it creates the rope
+	const int numSamples = desc.numSegments + 1;
+	rope.sim.Init(numSamples, ROPE_GRAVITY_FORCE);
+
+	const Vector vecGravity = rope.sim.gravity.Normalize();
+	Vector vecOrigin = desc.origin;
+	for (int i = 0; i < numSamples; ++i)
+	{
+		rope.sim.position[i] = vecOrigin;
+		rope.sim.restLength[i] = i == desc.numSegments - 1 ? desc.endingLength : desc.bodyLength;
+		vecOrigin = vecOrigin + vecGravity * rope.sim.restLength[i];
+	}
+	rope.sim.restLength[numSamples - 1] = 0.0f;
+	rope.sim.massReciprocal[0] = 0.0f;
+	rope.sim.massReciprocal[numSamples - 1] = 0.2f;
+	rope.lastEndPos = rope.sim.position[numSamples - 1];
+
+	rope.segments.assign(desc.numSegments, cl_entity_t());
+	for (int i = 0; i < desc.numSegments; ++i)
+	{
+		cl_entity_t& ent = rope.segments[i];
+		ent.model = i == desc.numSegments - 1 ? rope.endingModel : rope.bodyModel;
+		ent.curstate.modelindex = i == desc.numSegments - 1 ? desc.endingModelIndex : desc.bodyModelIndex;
+		ent.curstate.rendermode = kRenderNormal;
+		ent.curstate.renderamt = 255;
+		ent.curstate.scale = 1.0f;
+		ent.origin = rope.sim.position[i];
+		ent.curstate.origin = ent.origin;
+	}
+}
+
+void RopeManager::RemoveRope(int entindex)
+{
+	if (entindex == 0)
+		_ropes.clear();
+	else
+		_ropes.erase(entindex);
+}
+
+void RopeManager::SetAttachedObject(int entindex, int attachedIndex, int segment)
+{
+	auto it = _ropes.find(entindex);
+	if (it == _ropes.end())
+		return;
+	if (segment < 0 || segment >= it->second.numSegments)
+		attachedIndex = 0;
+	it->second.attachedIndex = attachedIndex;
+	it->second.attachedSegment = segment;
+}
+
+void RopeManager::Update()
+{
+	const float clientTime = gEngfuncs.GetClientTime();
+	for (auto it = _ropes.begin(); it != _ropes.end(); ++it)
+	{
+		UpdateRope(it->second, clientTime);
+	}
+}
+
+void RopeManager::UpdateRope(ClientRope& rope, float clientTime)
+{
+	if (!rope.bodyModel || !rope.endingModel)
+		return;
+
+	RopeSolver& sim = rope.sim;
+
+	Vector mins = sim.position[0];
+	Vector maxs = sim.position[0];
+	for (int i = 1; i < sim.numSamples; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			mins[j] = Q_min(mins[j], sim.position[i][j]);
+			maxs[j] = Q_max(maxs[j], sim.position[i][j]);
+		}
+	}
+	if (!gEngfuncs.pTriAPI->BoxInPVS(mins, maxs))
+	{
+		// Not seen, don't catch up when it's back in view
+		rope.lastTime = 0.0f;
+		return;
+	}
+
+	float flDeltaTime = rope.lastTime > 0.0f ? clientTime - rope.lastTime : 0.0f;
+	rope.lastTime = clientTime;
+	// Time is reset on level changes and demo seeks
+	if (flDeltaTime < 0.0f)
+		flDeltaTime = 0.0f;
+
+	sim.Advance(flDeltaTime);
+
+	// The server simulates the rope the player hangs on, keep the attached sample where the server put the player
+	if (rope.attachedIndex > 0)
+	{
+		cl_entity_t* pAttached = gEngfuncs.GetEntityByIndex(rope.attachedIndex);
+		cl_entity_t* pLocal = gEngfuncs.GetLocalPlayer();
+		if (pAttached && pLocal && pAttached->curstate.messagenum >= pLocal->curstate.messagenum)
+		{
+			Vector vecAttachPos = pAttached->origin;
+			vecAttachPos.z += pAttached->curstate.usehull == 1 ? 12 : 24;
+			sim.position[rope.attachedSegment] = vecAttachPos;
+			sim.velocity[rope.attachedSegment] = Vector(0, 0, 0);
+		}
+	}
+
+	TraceSegments(rope);
+
+	for (int i = 0; i < rope.numSegments; ++i)
+	{
+		cl_entity_t& ent = rope.segments[i];
+		const Vector& vecBottom = i == rope.numSegments - 1 ? rope.lastEndPos : rope.segments[i + 1].origin;
+		GetAlignmentAngles(ent.origin, vecBottom, ent.angles);
+		ent.curstate.origin = ent.origin;
+		ent.curstate.angles = ent.angles;
+		gEngfuncs.CL_CreateVisibleEntity(ET_NORMAL, &ent);
+	}
+}
+
+// Client version of CRope::TraceModels for a rope nobody hangs on, only the world blocks the segments
+void RopeManager::TraceSegments(ClientRope& rope)
+{
+	RopeSolver& sim = rope.sim;
+	pmtrace_t trace;
+
+	rope.segments[0].origin = sim.position[0];
+
+	for (int i = 1; i < rope.numSegments; ++i)
+	{
+		cl_entity_t& ent = rope.segments[i];
+		if (rope.attachedIndex > 0 || !TraceWorld(ent.origin, sim.position[i], trace))
+		{
+			ent.origin = sim.position[i];
+		}
+		else
+		{
+			const Vector vecNormal = Vector(trace.plane.normal).Normalize();
+			ent.origin = Vector(trace.endpos) + vecNormal * 10.0f;
+			sim.SetExternalForce(i, vecNormal * 40000.0f);
+		}
+	}
+
+	const int iLastSample = sim.numSamples - 1;
+	if (!TraceWorld(rope.lastEndPos, sim.position[iLastSample], trace))
+	{
+		rope.lastEndPos = sim.position[iLastSample];
+	}
+	else
+	{
+		rope.lastEndPos = trace.endpos;
+		sim.SetExternalForce(iLastSample, Vector(trace.plane.normal).Normalize() * 40000.0f);
+	}
+}
+
+void RopeManager::Clear()
+{
+	_ropes.clear();
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef HUD_ROPES_H
+#define HUD_ROPES_H
+
+#include "cl_dll.h"
+#include "com_model.h"
+#include "cl_entity.h"
+#include "rope_solver.h"
+
+#include <map>
+#include <vector>
+
+struct RopeDesc
+{
+	int entindex;
+	int numSegments;
+	Vector origin;
+	int bodyModelIndex;
+	int endingModelIndex;
+	float bodyLength;
+	float endingLength;
+};
+
+// Simulates and draws the ropes the server runs in the client-side mode (sv_client_ropes).
+// The server only describes the rope and who hangs on which segment, the rest is up to the client.
+class RopeManager
+{
+public:
+	void CreateRope(const RopeDesc& desc);
+	void RemoveRope(int entindex);
+	void SetAttachedObject(int entindex, int attachedIndex, int segment);
+	// Advances the ropes and adds their segments to the visible entities, called once per frame
+	void Update();
+	void Clear();
+
+private:
+	struct ClientRope
+	{
+		int numSegments;
+		model_t* bodyModel;
+		model_t* endingModel;
+		int attachedIndex;
+		int attachedSegment;
+		float lastTime;
+		Vector lastEndPos;
+		RopeSolver sim;
+		std::vector<cl_entity_t> segments;
+	};
+
+	void UpdateRope(ClientRope& rope, float clientTime);
+	void TraceSegments(ClientRope& rope);
+
+	std::map<int, ClientRope> _ropes;
+};
+
+#endif
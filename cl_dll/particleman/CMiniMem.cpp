@@ -22,15 +22,111 @@
 
 CMiniMem* CMiniMem::_instance = nullptr;
 
+CMiniMem::~CMiniMem()
+{
+	ReleasePool();
+}
+
+CMiniMem::SlotHeader* CMiniMem::HeaderOf(void* memory)
+{
+	return reinterpret_cast<SlotHeader*>(reinterpret_cast<unsigned char*>(memory) - HeaderSize);
+}
+
+unsigned char* CMiniMem::TakeSlot(std::size_t sizeClass)
+{
+	auto& pool = _sizeClasses[sizeClass];
+
+	if (!pool.freeList)
+	{
+		const std::size_t slotSize = HeaderSize + (sizeClass + 1) * SizeGranularity;
+		auto block = reinterpret_cast<unsigned char*>(malloc(slotSize * SlotsPerBlock));
+
+		if (!block)
+		{
+			return nullptr;
+		}
+
+		pool.blocks.push_back(block);
+
+		//Chain the new slots in the address order.
+		for (std::size_t i = SlotsPerBlock; i-- > 0;)
+		{
+			auto slot = reinterpret_cast<FreeSlot*>(block + i * slotSize);
+			slot->next = pool.freeList;
+			pool.freeList = slot;
+		}
+	}
+
+	auto slot = pool.freeList;
+	pool.freeList = slot->next;
+
+	++pool.inUse;
+	pool.highWater = std::max(pool.highWater, pool.inUse);
+
+	return reinterpret_cast<unsigned char*>(slot);
+}
+
+void CMiniMem::ReleaseSlot(unsigned char* slot, std::size_t sizeClass)
+{
+	auto& pool = _sizeClasses[sizeClass];
+
+	auto freeSlot = reinterpret_cast<FreeSlot*>(slot);
+	freeSlot->next = pool.freeList;
+	pool.freeList = freeSlot;
+
+	--pool.inUse;
+}
+
+void CMiniMem::ReleasePool()
+{
+	for (auto& pool : _sizeClasses)
+	{
+		if (pool.inUse != 0)
+		{
+			continue;
+		}
+
+		for (auto block : pool.blocks)
+		{
+			free(block);
+		}
+
+		pool.blocks.clear();
+		pool.blocks.shrink_to_fit();
+		pool.freeList = nullptr;
+	}
+}
+
 void* CMiniMem::Allocate(std::size_t sizeInBytes)
 {
-	//auto particle = reinterpret_cast<CBaseParticle*>(_pool.allocate(sizeInBytes, alignment));
-	auto particle = reinterpret_cast<CBaseParticle*>(malloc(sizeInBytes));
+	const std::size_t sizeClass = sizeInBytes > 0 ? (sizeInBytes - 1) / SizeGranularity : 0;
+
+	unsigned char* slot;
 
-	if (nullptr != particle)
+	if (sizeClass < SizeClassCount)
 	{
-		_particles.push_back(particle);
+		slot = TakeSlot(sizeClass);
 	}
+	else
+	{
+		slot = reinterpret_cast<unsigned char*>(malloc(HeaderSize + sizeInBytes));
+		++_largeAllocations;
+	}
+
+	if (nullptr == slot)
+	{
+		return nullptr;
+	}
+
+	auto header = reinterpret_cast<SlotHeader*>(slot);
+	header->index = _particles.size();
+	header->sizeClass = sizeClass < SizeClassCount ? static_cast<int>(sizeClass) : -1;
+
+	auto particle = reinterpret_cast<CBaseParticle*>(slot + HeaderSize);
+
+	_particles.push_back(particle);
+	_particlesHighWater = std::max(_particlesHighWater, _particles.size());
+	++_allocations;
 
 	return particle;
 }
@@ -42,14 +138,29 @@ void CMiniMem::Deallocate(void* memory)
 		return;
 	}
 
-	auto it = std::find(_particles.begin(), _particles.end(), memory);
-	if (it != _particles.end())
-		_particles.erase(it);
+	auto header = HeaderOf(memory);
+
+	if (header->index < _particles.size() && _particles[header->index] == memory)
+	{
+		//Move the last particle into the freed spot.
+		auto last = _particles.back();
+		_particles[header->index] = last;
+		HeaderOf(last)->index = header->index;
+		_particles.pop_back();
+	}
 	else
 		gEngfuncs.Con_Printf("Couldn't find a particle in the particles array to erase!\n");
 
-	free(memory);
-	//_pool.deallocate(memory, sizeInBytes, alignment);
+	++_deallocations;
+
+	if (header->sizeClass >= 0)
+	{
+		ReleaseSlot(reinterpret_cast<unsigned char*>(header), header->sizeClass);
+	}
+	else
+	{
+		free(header);
+	}
 }
 
 void CMiniMem::Shutdown()
@@ -73,13 +184,10 @@ void CMiniMem::ProcessAll()
 	const float time = gEngfuncs.GetClientTime();
 
 	//Clear list of visible particles.
-	_visibleParticles = 0;
-
-	//Divide the particle list in two: the list of visible particles and the list of invisible particles.
-	//Remove any particles that have died.
-	std::size_t invisibleCount = 0;
+	_visible.clear();
 
-	for (std::size_t i = 0; i < (_particles.size() - invisibleCount);)
+	//Remove any particles that have died and collect the visible ones.
+	for (std::size_t i = 0; i < _particles.size();)
 	{
 		auto effect = _particles[i];
 
@@ -93,8 +201,7 @@ void CMiniMem::ProcessAll()
 			effect->Die();
 			delete effect;
 
-			//Don't do this! operator delete removes the effect from the list.
-			//_particles.erase(_particles.begin() + i);
+			//operator delete moved the last particle into this spot, process it next.
 			continue;
 		}
 
@@ -103,25 +210,15 @@ void CMiniMem::ProcessAll()
 			auto player = gEngfuncs.GetLocalPlayer();
 			effect->SetPlayerDistance((player->origin - effect->m_vOrigin).Length()*(player->origin - effect->m_vOrigin).Length());
 
-			++_visibleParticles;
-		}
-		else
-		{
-			if (i + invisibleCount < _particles.size())
-			{
-				//There is an effect we haven't checked yet.
-				//Put the invisible effect at the end of the list and check the other effect next.
-				std::swap(_particles[i], _particles[_particles.size() - 1 - invisibleCount]);
-				++invisibleCount;
-				continue;
-			}
-			//No more unchecked effects in the list.
+			_visible.push_back(effect);
 		}
 
 		++i;
 	}
 
-	std::sort(_particles.begin(), _particles.begin() + _visibleParticles, [](const CBaseParticle* lhs, const CBaseParticle* rhs)
+	_visibleParticles = _visible.size();
+
+	std::sort(_visible.begin(), _visible.end(), [](const CBaseParticle* lhs, const CBaseParticle* rhs)
 		{
 			//Particles are ordered farthest to nearest so they can be drawn in order.
 			const float lhsDistance = lhs->GetPlayerDistance();
@@ -130,9 +227,8 @@ void CMiniMem::ProcessAll()
 			return lhsDistance > rhsDistance;
 		});
 
-	for (std::size_t i = 0; i < _visibleParticles; ++i)
+	for (auto effect : _visible)
 	{
-		auto effect = _particles[i];
 		effect->Draw();
 	}
 
@@ -230,6 +326,30 @@ void CMiniMem::Reset()
 	}
 
 	//Wipe away previously allocated memory so maps with loads of particles don't eat up memory forever.
-	//_pool.release();
+	ReleasePool();
 	_particles.shrink_to_fit();
+	_visible.clear();
+	_visible.shrink_to_fit();
+}
+
+void CMiniMem::ReportPool()
+{
+	//Engine doesn't support printing size_t
+	gEngfuncs.Con_Printf("Particles: %d (high-water mark %d). Allocations: %d. Deallocations: %d. Not pooled: %d\n",
+		static_cast<int>(_particles.size()), static_cast<int>(_particlesHighWater),
+		static_cast<int>(_allocations), static_cast<int>(_deallocations), static_cast<int>(_largeAllocations));
+
+	for (std::size_t i = 0; i < SizeClassCount; ++i)
+	{
+		const auto& pool = _sizeClasses[i];
+
+		if (pool.highWater == 0 && pool.blocks.empty())
+		{
+			continue;
+		}
+
+		gEngfuncs.Con_Printf("  %4d bytes: %d in use, high-water mark %d, %d blocks\n",
+			static_cast<int>((i + 1) * SizeGranularity), static_cast<int>(pool.inUse),
+			static_cast<int>(pool.highWater), static_cast<int>(pool.blocks.size()));
+	}
 }
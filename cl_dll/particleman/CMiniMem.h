@@ -11,19 +11,57 @@ class CBaseParticle;
 
 /**
 *	@brief Simple allocator that uses a chunk-based pool to serve requests.
+*	Particles are rounded up to one of the fixed size classes, each class keeps a free list of slots.
+*	Every slot starts with a header holding the particle's index in the particle list, so removal is a swap with the last particle.
 */
 class CMiniMem
 {
 private:
+	static constexpr std::size_t HeaderSize = 16; //Keeps the particle 16 bytes aligned
+	static constexpr std::size_t SizeGranularity = 64;
+	static constexpr std::size_t SizeClassCount = 16; //Particles larger than SizeGranularity * SizeClassCount bytes are allocated with malloc
+	static constexpr std::size_t SlotsPerBlock = 256;
+
+	struct SlotHeader
+	{
+		std::size_t index; //Index in _particles
+		int sizeClass;	   //-1 if the particle was allocated with malloc
+	};
+
+	struct FreeSlot
+	{
+		FreeSlot* next;
+	};
+
+	struct SizeClass
+	{
+		std::vector<unsigned char*> blocks;
+		FreeSlot* freeList = nullptr;
+		std::size_t inUse = 0;
+		std::size_t highWater = 0;
+	};
+
 	static CMiniMem* _instance;
 
 	std::vector<CBaseParticle*> _particles;
+	std::vector<CBaseParticle*> _visible;
 	std::size_t _visibleParticles = 0;
 
+	SizeClass _sizeClasses[SizeClassCount];
+	std::size_t _allocations = 0;
+	std::size_t _deallocations = 0;
+	std::size_t _largeAllocations = 0;
+	std::size_t _particlesHighWater = 0;
+
+	static SlotHeader* HeaderOf(void* memory);
+	unsigned char* TakeSlot(std::size_t sizeClass);
+	void ReleaseSlot(unsigned char* slot, std::size_t sizeClass);
+	void ReleasePool();
+
 protected:
 	// private constructor and destructor.
 	CMiniMem() = default;
-	~CMiniMem() = default;
+	~CMiniMem();
 
 public:
 	void* Allocate(std::size_t sizeInBytes);
@@ -38,6 +76,8 @@ public:
 
 	int ApplyForce(Vector vOrigin, Vector vDirection, float flRadius, float flStrength);
 
+	void ReportPool();
+
 	static CMiniMem* Instance();
 
 	std::size_t GetTotalParticles() { return _particles.size(); }
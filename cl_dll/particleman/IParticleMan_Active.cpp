@@ -33,6 +33,11 @@ static cvar_t* cl_pmanstats = nullptr;
 
 static std::vector<ForceMember> g_pForceList;
 
+static void PoolStatsCmd()
+{
+	CMiniMem::Instance()->ReportPool();
+}
+
 IParticleMan_Active::IParticleMan_Active()
 {
 	g_pForceList.reserve(MaxForceElements);
@@ -67,6 +72,8 @@ void IParticleMan_Active::SetUp(cl_enginefunc_t* pEnginefuncs)
 	//std::memcpy(&gEngfuncs, pEnginefuncs, sizeof(gEngfuncs));
 
 	cl_pmanstats = gEngfuncs.pfnRegisterVariable("cl_pmanstats", "0", 0);
+
+	gEngfuncs.pfnAddCommand("pman_poolstats", &PoolStatsCmd);
 }
 
 CBaseParticle* IParticleMan_Active::CreateParticle(Vector org, Vector normal, model_s* sprite, float size, float brightness, const char* classname)
@@ -0,0 +1,634 @@
+#include <algorithm>
+#include <cmath>
+
+#include "weather_particles.h"
+
+#include "hud.h"
+#include "cl_util.h"
+#include "event_api.h"
+
+#include "particleman.h"
+#include "triangleapi.h"
+
+#include "pm_defs.h"
+#include "pmtrace.h"
+
+#include "pi_constant.h"
+
+extern const Vector g_vecZero;
+extern Vector v_origin;
+extern Vector v_angles;
+extern Vector g_vViewAngles;
+
+//Hull used by particle collision traces, same as in CBaseParticle::CheckCollision
+constexpr int WEATHER_TRACE_HULL = 2;
+constexpr float WEATHER_PVS_CHECK_PERIOD = 0.1f;
+
+constexpr float RAINDROP_MAX_BRIGHTNESS = 155.0f;
+constexpr float RAINDROP_BRIGHTNESS_STEP = 6.5f;
+
+constexpr float SNOWFLAKE_BRIGHTNESS_STEP = 4.5f;
+constexpr float SNOWFLAKE_MELT_TIME = 0.5f;
+
+WeatherParticles::WeatherParticles(Kind kind, int entIndex):
+	_kind(kind),
+	_entIndex(entIndex)
+{
+}
+
+void WeatherParticles::SetRainData(const RainData &rainData)
+{
+	_sprite = rainData.rainSprite;
+	_params = rainData.raindropParticleParams;
+	_initialBrightness = rainData.raindropParticleParams.brightness;
+	_stretchY = rainData.raindropStretchY;
+	_life = rainData.raindropLife;
+
+	_splashAllowed = rainData.SplashesAllowed();
+	_rippleAllowed = rainData.RipplesAllowed();
+	_splashParams = rainData.splashParticleParams;
+	_rippleParams = rainData.rippleParticleParams;
+	_splashSprite = rainData.splashSprite;
+	_rippleSprite = rainData.rippleSprite;
+}
+
+void WeatherParticles::SetSnowData(const SnowData &snowData)
+{
+	_sprite = snowData.snowSprite;
+	_params = snowData.snowflakeParticleParams;
+	_initialBrightness = snowData.snowflakeInitialBrightness;
+	_stretchY = 1.0f;
+	_life = snowData.snowflakeLife;
+}
+
+std::size_t WeatherParticles::Add(const Vector &vecOrigin, const Vector &vecVelocity, float size, float brightness, float dieTime, float time)
+{
+	_x.push_back(vecOrigin.x);
+	_y.push_back(vecOrigin.y);
+	_z.push_back(vecOrigin.z);
+	_prevX.push_back(vecOrigin.x);
+	_prevY.push_back(vecOrigin.y);
+	_prevZ.push_back(vecOrigin.z);
+	_velX.push_back(vecVelocity.x);
+	_velY.push_back(vecVelocity.y);
+	_velZ.push_back(vecVelocity.z);
+	_size.push_back(size);
+	_brightness.push_back(brightness);
+	_dieTime.push_back(dieTime);
+	_nextPVSCheck.push_back(time);
+	_flags.push_back(FL_IN_PVS);
+
+	_spiralTime.push_back(0.0f);
+	_phase.push_back(0.0f);
+	_touchTime.push_back(0.0f);
+	_touchBrightness.push_back(0.0f);
+
+	return _x.size() - 1;
+}
+
+void WeatherParticles::AddRaindrop(const Vector &vecOrigin, const Vector &vecVelocity, float time)
+{
+	Add(vecOrigin, vecVelocity, _params.GetSize(), _initialBrightness, time + _life, time);
+}
+
+void WeatherParticles::AddSnowflake(const Vector &vecOrigin, const Vector &vecVelocity, bool spiral, float time)
+{
+	const std::size_t i = Add(vecOrigin, vecVelocity, _params.GetSize(), _initialBrightness, time + _life, time);
+	if (spiral)
+		_flags[i] |= FL_SPIRAL;
+	_spiralTime[i] = time + Com_RandomLong( 2, 4 );
+	_phase[i] = Com_RandomFloat( 0.0f, M_PI * 2 );
+}
+
+void WeatherParticles::Remove(std::size_t i)
+{
+	//Move the last particle into the freed spot
+	const std::size_t last = _x.size() - 1;
+	if (i != last)
+	{
+		_x[i] = _x[last];
+		_y[i] = _y[last];
+		_z[i] = _z[last];
+		_prevX[i] = _prevX[last];
+		_prevY[i] = _prevY[last];
+		_prevZ[i] = _prevZ[last];
+		_velX[i] = _velX[last];
+		_velY[i] = _velY[last];
+		_velZ[i] = _velZ[last];
+		_size[i] = _size[last];
+		_brightness[i] = _brightness[last];
+		_dieTime[i] = _dieTime[last];
+		_nextPVSCheck[i] = _nextPVSCheck[last];
+		_flags[i] = _flags[last];
+		_spiralTime[i] = _spiralTime[last];
+		_phase[i] = _phase[last];
+		_touchTime[i] = _touchTime[last];
+		_touchBrightness[i] = _touchBrightness[last];
+	}
+
+	_x.pop_back();
+	_y.pop_back();
+	_z.pop_back();
+	_prevX.pop_back();
+	_prevY.pop_back();
+	_prevZ.pop_back();
+	_velX.pop_back();
+	_velY.pop_back();
+	_velZ.pop_back();
+	_size.pop_back();
+	_brightness.pop_back();
+	_dieTime.pop_back();
+	_nextPVSCheck.pop_back();
+	_flags.pop_back();
+	_spiralTime.pop_back();
+	_phase.pop_back();
+	_touchTime.pop_back();
+	_touchBrightness.pop_back();
+}
+
+void WeatherParticles::Clear()
+{
+	_x.clear();
+	_y.clear();
+	_z.clear();
+	_prevX.clear();
+	_prevY.clear();
+	_prevZ.clear();
+	_velX.clear();
+	_velY.clear();
+	_velZ.clear();
+	_size.clear();
+	_brightness.clear();
+	_dieTime.clear();
+	_nextPVSCheck.clear();
+	_flags.clear();
+	_spiralTime.clear();
+	_phase.clear();
+	_touchTime.clear();
+	_touchBrightness.clear();
+
+	_visible.clear();
+	_distance.clear();
+}
+
+void WeatherParticles::Update(float time, float frametime)
+{
+	if (frametime > 0.0f)
+	{
+		if (_kind == RAIN)
+			UpdateRain(time, frametime);
+		else
+			UpdateSnow(time, frametime);
+	}
+
+	for (std::size_t i = 0; i < Count();)
+	{
+		if (_dieTime[i] != 0.0f && time >= _dieTime[i])
+		{
+			Remove(i);
+			continue;
+		}
+		++i;
+	}
+}
+
+void WeatherParticles::Move(float frametime)
+{
+	const std::size_t count = Count();
+
+	float* x = _x.data();
+	float* y = _y.data();
+	float* z = _z.data();
+	float* prevX = _prevX.data();
+	float* prevY = _prevY.data();
+	float* prevZ = _prevZ.data();
+	const float* velX = _velX.data();
+	const float* velY = _velY.data();
+	const float* velZ = _velZ.data();
+
+	//No gravity for the weather particles, so the velocity stays the same until the collision
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		prevX[i] = x[i];
+		prevY[i] = y[i];
+		prevZ[i] = z[i];
+		x[i] += velX[i] * frametime;
+		y[i] += velY[i] * frametime;
+		z[i] += velZ[i] * frametime;
+	}
+}
+
+void WeatherParticles::UpdateRain(float time, float frametime)
+{
+	Move(frametime);
+
+	const std::size_t count = Count();
+	float* brightness = _brightness.data();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		brightness[i] = brightness[i] < RAINDROP_MAX_BRIGHTNESS ? brightness[i] + RAINDROP_BRIGHTNESS_STEP : brightness[i];
+	}
+
+	for (std::size_t i = 0; i < Count();)
+	{
+		if (_flags[i] & FL_TOUCHED)
+		{
+			++i;
+			continue;
+		}
+
+		Vector vecPrevOrigin(_prevX[i], _prevY[i], _prevZ[i]);
+		Vector vecOrigin(_x[i], _y[i], _z[i]);
+
+		pmtrace_t trace;
+		gEngfuncs.pEventAPI->EV_SetTraceHull( WEATHER_TRACE_HULL );
+		gEngfuncs.pEventAPI->EV_PlayerTrace( vecPrevOrigin, vecOrigin, PM_WORLD_ONLY | PM_STUDIO_BOX, -1, &trace );
+
+		if (trace.fraction != 1.0f)
+		{
+			Vector vecVelocity = Vector(_velX[i], _velY[i], _velZ[i]) * 0.6f;
+			if (vecVelocity.Length() < 10.0f)
+				vecVelocity = g_vecZero;
+
+			const Vector vecHit = vecPrevOrigin + vecVelocity * (trace.fraction * frametime);
+			_x[i] = vecHit.x;
+			_y[i] = vecHit.y;
+			_z[i] = vecHit.z;
+
+			if (trace.plane.normal.z <= 0.9f || vecVelocity.z != 0.0f)
+			{
+				TouchRaindrop(i, trace.plane.normal);
+				Remove(i);
+				continue;
+			}
+
+			//Stopped on a flat surface, stays there until its life ends
+			_velX[i] = _velY[i] = _velZ[i] = 0.0f;
+			_flags[i] |= FL_TOUCHED;
+			TouchRaindrop(i, trace.plane.normal);
+		}
+		else if (gEngfuncs.PM_PointContents( vecOrigin, nullptr ) == CONTENTS_WATER)
+		{
+			TouchRaindrop(i, Vector(0.0f, 0.0f, 1.0f));
+			Remove(i);
+			continue;
+		}
+		++i;
+	}
+}
+
+void WeatherParticles::TouchRaindrop(std::size_t i, const Vector &vecNormal)
+{
+	const Vector vecOrigin(_x[i], _y[i], _z[i]);
+
+	Vector vecStart = vecOrigin;
+	vecStart.z += 32.0f;
+
+	pmtrace_t trace;
+
+	{
+		Vector vecEnd = vecOrigin;
+		vecEnd.z -= 16.0f;
+
+		gEngfuncs.pEventAPI->EV_PlayerTrace( vecStart, vecEnd, PM_WORLD_ONLY, -1, &trace );
+	}
+
+	Vector vecSurfaceNormal;
+
+	vecSurfaceNormal.x = vecNormal.x;
+	vecSurfaceNormal.y = vecNormal.y;
+	vecSurfaceNormal.z = -vecNormal.z;
+
+	Vector vecAngles;
+
+	VectorAngles( vecSurfaceNormal, vecAngles );
+
+	if( gEngfuncs.PM_PointContents( trace.endpos, nullptr ) == gEngfuncs.PM_PointContents( vecStart, nullptr ) )
+	{
+		if (_splashAllowed && _splashSprite)
+		{
+			CBaseParticle* pParticle = new CBaseParticle();
+
+			pParticle->InitializeSprite( vecOrigin + vecNormal, Vector( 90.0f, 0.0f, 0.0f ), _splashSprite, _splashParams.GetSize(), _splashParams.brightness );
+
+			pParticle->m_iRendermode = _splashParams.renderMode;
+
+			pParticle->m_flMass = 1.0f;
+			pParticle->m_flGravity = 0.1f;
+
+			pParticle->SetCullFlag( CULL_PVS );
+			pParticle->SetLightFlag( _splashParams.lightFlag );
+
+			pParticle->m_vColor = _splashParams.color;
+
+			pParticle->m_iNumFrames = _splashSprite->numframes - 1;
+			pParticle->m_iFramerate = Com_RandomLong( 30, 45 );
+			pParticle->m_flDieTime = gEngfuncs.GetClientTime() + 0.3f;
+			pParticle->SetCollisionFlags( TRI_ANIMATEDIE );
+			pParticle->SetRenderFlag( RENDER_FACEPLAYER );
+		}
+	}
+	else
+	{
+		if (_rippleAllowed && _rippleSprite)
+		{
+			//Find the water surface between the start and the end of the trace
+			Vector vecBegin = vecStart;
+			Vector vecEnd = trace.endpos;
+
+			Vector vecDist = vecEnd - vecBegin;
+
+			Vector vecHalf;
+
+			Vector vecNewBegin;
+
+			while( vecDist.Length() > 4.0 )
+			{
+				vecDist = vecDist * 0.5;
+
+				vecHalf = vecBegin + vecDist;
+
+				if( gEngfuncs.PM_PointContents( vecBegin, nullptr ) == gEngfuncs.PM_PointContents( vecHalf, nullptr ) )
+				{
+					vecBegin = vecHalf;
+					vecNewBegin = vecHalf;
+				}
+				else
+				{
+					vecEnd = vecHalf;
+					vecNewBegin = vecBegin;
+				}
+
+				vecDist = vecEnd - vecNewBegin;
+			}
+
+			CBaseParticle* pParticle = new CBaseParticle();
+
+			pParticle->InitializeSprite( vecBegin, vecAngles, _rippleSprite, _rippleParams.GetSize(), _rippleParams.brightness );
+
+			pParticle->m_iRendermode = _rippleParams.renderMode;
+			pParticle->m_flScaleSpeed = 1.0f;
+			pParticle->m_vColor = _rippleParams.color;
+			pParticle->SetCullFlag( CULL_PVS );
+			pParticle->SetLightFlag( _rippleParams.lightFlag );
+			pParticle->m_flFadeSpeed = 2.0f;
+			pParticle->m_flDieTime = gEngfuncs.GetClientTime() + 2.0f;
+		}
+	}
+}
+
+void WeatherParticles::UpdateSnow(float time, float frametime)
+{
+	for (std::size_t i = 0; i < Count(); ++i)
+	{
+		if (_spiralTime[i] <= time)
+		{
+			_flags[i] ^= FL_SPIRAL;
+			_spiralTime[i] = time + Com_RandomLong( 2, 4 );
+		}
+	}
+
+	//Landed snowflakes have no velocity, so they stay in place
+	Move(frametime);
+
+	const std::size_t count = Count();
+	float* x = _x.data();
+	const float* phase = _phase.data();
+	const unsigned char* flags = _flags.data();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if ((flags[i] & (FL_SPIRAL | FL_TOUCHED)) == FL_SPIRAL)
+		{
+			const float flSpin = sinf( time * 5.0f + phase[i] );
+			x[i] += ( flSpin * flSpin ) * 0.3f;
+		}
+	}
+
+	//Snowflakes appear gradually and fade out after landing
+	const float targetBrightness = _params.brightness;
+	float* brightness = _brightness.data();
+	float* dieTime = _dieTime.data();
+	const float* touchTime = _touchTime.data();
+	const float* touchBrightness = _touchBrightness.data();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (flags[i] & FL_TOUCHED)
+		{
+			brightness[i] = ( 1.0f - ( time - touchTime[i] ) / ( dieTime[i] - touchTime[i] ) ) * touchBrightness[i];
+			if (brightness[i] < 1.0f)
+				dieTime[i] = time;
+		}
+		else
+		{
+			if (brightness[i] < targetBrightness)
+				brightness[i] += SNOWFLAKE_BRIGHTNESS_STEP;
+			if (brightness[i] > 255.0f)
+				brightness[i] = 255.0f;
+		}
+	}
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (_flags[i] & FL_TOUCHED)
+			continue;
+
+		Vector vecPrevOrigin(_prevX[i], _prevY[i], _prevZ[i]);
+		Vector vecOrigin(_x[i], _y[i], _z[i]);
+
+		pmtrace_t trace;
+		gEngfuncs.pEventAPI->EV_SetTraceHull( WEATHER_TRACE_HULL );
+		gEngfuncs.pEventAPI->EV_PlayerTrace( vecPrevOrigin, vecOrigin, PM_WORLD_ONLY | PM_STUDIO_BOX, -1, &trace );
+
+		if (trace.fraction != 1.0f)
+		{
+			Vector vecVelocity = Vector(_velX[i], _velY[i], _velZ[i]) * 0.6f;
+			if (vecVelocity.Length() < 10.0f)
+				vecVelocity = g_vecZero;
+
+			const Vector vecHit = vecPrevOrigin + vecVelocity * (trace.fraction * frametime);
+			_x[i] = vecHit.x;
+			_y[i] = vecHit.y;
+			_z[i] = vecHit.z;
+
+			//Snowflakes don't bounce, they lie on the ground and melt
+			_velX[i] = _velY[i] = _velZ[i] = 0.0f;
+			_flags[i] |= FL_TOUCHED;
+			_touchTime[i] = time;
+			_touchBrightness[i] = _brightness[i];
+			_dieTime[i] = time + SNOWFLAKE_MELT_TIME;
+		}
+	}
+}
+
+void WeatherParticles::CollectVisible(float time)
+{
+	_visible.clear();
+	_distance.clear();
+
+	Vector vecForward;
+	AngleVectors( v_angles, vecForward, nullptr, nullptr );
+	const float viewDist = DotProduct( v_origin, vecForward );
+	const float extent = Q_max( 1.0f, _stretchY );
+
+	const std::size_t count = Count();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const float radius = _size[i] / 5.0f;
+
+		if (time >= _nextPVSCheck[i])
+		{
+			const Vector vecRadius(radius, radius, radius);
+			const Vector vecOrigin(_x[i], _y[i], _z[i]);
+			Vector mins = vecOrigin - vecRadius;
+			Vector maxs = vecOrigin + vecRadius;
+
+			if (gEngfuncs.pTriAPI->BoxInPVS( mins, maxs ))
+				_flags[i] |= FL_IN_PVS;
+			else
+				_flags[i] &= ~FL_IN_PVS;
+
+			_nextPVSCheck[i] = time + WEATHER_PVS_CHECK_PERIOD;
+		}
+
+		if (!(_flags[i] & FL_IN_PVS))
+			continue;
+
+		//Particles completely behind the view can't be seen
+		if (_x[i] * vecForward.x + _y[i] * vecForward.y + _z[i] * vecForward.z - viewDist < -_size[i] * extent)
+			continue;
+
+		const float dx = _x[i] - v_origin.x;
+		const float dy = _y[i] - v_origin.y;
+		const float dz = _z[i] - v_origin.z;
+
+		_visible.push_back(i);
+		_distance.push_back(dx * dx + dy * dy + dz * dz);
+	}
+
+	//Farthest to nearest so they can be drawn in order
+	const std::vector<float>& distance = _distance;
+	std::vector<std::size_t> order(_visible.size());
+	for (std::size_t i = 0; i < order.size(); ++i)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&distance](std::size_t lhs, std::size_t rhs) {
+		return distance[lhs] > distance[rhs];
+	});
+	for (std::size_t i = 0; i < order.size(); ++i)
+		order[i] = _visible[order[i]];
+	_visible.swap(order);
+}
+
+#define clampValue( val, min, max ) ( ((val) > (max)) ? (max) : ( ((val) < (min)) ? (min) : (val) ) )
+
+void WeatherParticles::ParticleColor(std::size_t i, float color[3]) const
+{
+	Vector vecColor = g_vecZero;
+
+	if (_params.lightFlag & LIGHT_NONE)
+	{
+		vecColor = _params.color;
+	}
+	else
+	{
+		Vector vecLight;
+		gEngfuncs.pTriAPI->LightAtPoint( Vector(_x[i], _y[i], _z[i]), vecLight );
+
+		if (_params.lightFlag & LIGHT_COLOR)
+		{
+			vecColor.x = vecLight.x * _params.color.x / 255.0f;
+			vecColor.y = vecLight.y * _params.color.y / 255.0f;
+			vecColor.z = vecLight.z * _params.color.z / 255.0f;
+		}
+		else if (_params.lightFlag & LIGHT_INTENSITY)
+		{
+			const float intensity = ( vecLight.x + vecLight.y + vecLight.z ) / 3.0f;
+			vecColor = _params.color * ( intensity / 255.0f );
+		}
+	}
+
+	color[0] = clampValue( vecColor.x, 0.0f, 255.0f ) / 255.0f;
+	color[1] = clampValue( vecColor.y, 0.0f, 255.0f ) / 255.0f;
+	color[2] = clampValue( vecColor.z, 0.0f, 255.0f ) / 255.0f;
+}
+
+void WeatherParticles::Draw(float time)
+{
+	if (!_sprite || Count() == 0)
+		return;
+
+	CollectVisible(time);
+	if (_visible.empty())
+		return;
+
+	//Snowflakes face the player. Raindrops keep upright and lean along their velocity.
+	Vector vecSnowRight, vecSnowUp;
+	AngleVectors( g_vViewAngles, nullptr, vecSnowRight, vecSnowUp );
+
+	Vector vecViewAngles;
+	gEngfuncs.GetViewAngles( vecViewAngles );
+
+	Vector vecViewRight;
+	AngleVectors( vecViewAngles, nullptr, vecViewRight, nullptr );
+	const float sy = sinf( vecViewAngles.y * ( M_PI / 180.0 ) );
+	const float cy = cosf( vecViewAngles.y * ( M_PI / 180.0 ) );
+
+	gEngfuncs.pTriAPI->SpriteTexture( _sprite, 0 );
+	gEngfuncs.pTriAPI->RenderMode( _params.renderMode );
+	gEngfuncs.pTriAPI->CullFace( TRI_NONE );
+
+	gEngfuncs.pTriAPI->Begin( TRI_QUADS );
+
+	for (std::size_t n = 0; n < _visible.size(); ++n)
+	{
+		const std::size_t i = _visible[n];
+		const Vector vecOrigin(_x[i], _y[i], _z[i]);
+
+		Vector vecRight, vecUp;
+		if (_kind == RAIN)
+		{
+			//Same vectors AngleVectors gives for angles (0, view yaw, atan(slope)), without the trigonometry
+			const float slope = _velZ[i] != 0.0f ? ( _velX[i] * vecViewRight.x + _velY[i] * vecViewRight.y + _velZ[i] * vecViewRight.z ) / _velZ[i] : 0.0f;
+			const float cr = 1.0f / sqrtf( 1.0f + slope * slope );
+			const float sr = slope * cr;
+
+			vecRight = Vector( cr * sy, -cr * cy, -sr );
+			vecUp = Vector( sr * sy, -sr * cy, cr );
+		}
+		else
+		{
+			vecRight = vecSnowRight;
+			vecUp = vecSnowUp;
+		}
+
+		float color[3];
+		ParticleColor(i, color);
+
+		const float radius = _size[i];
+		const Vector width = vecRight * radius;
+		const Vector height = vecUp * radius * _stretchY;
+
+		const Vector lowLeft = vecOrigin - ( width * 0.5 ) - ( vecUp * radius * 0.5 );
+		const Vector lowRight = lowLeft + width;
+		const Vector topLeft = lowLeft + height;
+		const Vector topRight = lowRight + height;
+
+		gEngfuncs.pTriAPI->Color4f( color[0], color[1], color[2], _brightness[i] / 255.0f );
+
+		gEngfuncs.pTriAPI->TexCoord2f( 0, 0 );
+		gEngfuncs.pTriAPI->Vertex3fv( topLeft );
+
+		gEngfuncs.pTriAPI->TexCoord2f( 0, 1 );
+		gEngfuncs.pTriAPI->Vertex3fv( lowLeft );
+
+		gEngfuncs.pTriAPI->TexCoord2f( 1, 1 );
+		gEngfuncs.pTriAPI->Vertex3fv( lowRight );
+
+		gEngfuncs.pTriAPI->TexCoord2f( 1, 0 );
+		gEngfuncs.pTriAPI->Vertex3fv( topRight );
+	}
+
+	gEngfuncs.pTriAPI->End();
+
+	gEngfuncs.pTriAPI->RenderMode( kRenderNormal );
+	gEngfuncs.pTriAPI->CullFace( TRI_FRONT );
+}
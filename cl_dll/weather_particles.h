@@ -0,0 +1,99 @@
+#pragma once
+#ifndef WEATHER_PARTICLES_H
+#define WEATHER_PARTICLES_H
+
+#include "environment.h"
+
+#include <vector>
+
+/**
+*	@brief Raindrops or snowflakes spawned by one weather entity.
+*	Particles are stored as arrays of components instead of separate particle objects,
+*	so moving and fading them is a plain loop over the arrays.
+*	Visible particles are drawn with a single TriAPI batch.
+*/
+class WeatherParticles
+{
+public:
+	enum Kind
+	{
+		RAIN,
+		SNOW,
+	};
+
+	WeatherParticles(Kind kind, int entIndex);
+
+	Kind GetKind() const { return _kind; }
+	int GetEntIndex() const { return _entIndex; }
+	std::size_t Count() const { return _x.size(); }
+
+	//Parameters of the weather entity. Newly spawned and existing particles use the latest ones.
+	void SetRainData(const RainData& rainData);
+	void SetSnowData(const SnowData& snowData);
+
+	void AddRaindrop(const Vector& vecOrigin, const Vector& vecVelocity, float time);
+	void AddSnowflake(const Vector& vecOrigin, const Vector& vecVelocity, bool spiral, float time);
+
+	//Moves particles and removes the dead ones. Nothing moves if frametime is 0, e.g. when the game is paused.
+	void Update(float time, float frametime);
+	void Draw(float time);
+
+	void Clear();
+
+private:
+	enum
+	{
+		FL_IN_PVS = 1 << 0,
+		FL_SPIRAL = 1 << 1,
+		FL_TOUCHED = 1 << 2, //Hit the ground, doesn't collide anymore
+	};
+
+	std::size_t Add(const Vector& vecOrigin, const Vector& vecVelocity, float size, float brightness, float dieTime, float time);
+	void Remove(std::size_t i);
+
+	void Move(float frametime);
+	void UpdateRain(float time, float frametime);
+	void UpdateSnow(float time, float frametime);
+	void TouchRaindrop(std::size_t i, const Vector& vecNormal);
+
+	void CollectVisible(float time);
+	void ParticleColor(std::size_t i, float color[3]) const;
+
+	Kind _kind;
+	int _entIndex;
+
+	model_t* _sprite = nullptr;
+	ParticleParams _params = {};
+	float _initialBrightness = 0.0f;
+	float _stretchY = 1.0f;
+	float _life = 0.0f;
+
+	//Rain only
+	bool _splashAllowed = false;
+	bool _rippleAllowed = false;
+	ParticleParams _splashParams = {};
+	ParticleParams _rippleParams = {};
+	model_t* _splashSprite = nullptr;
+	model_t* _rippleSprite = nullptr;
+
+	std::vector<float> _x, _y, _z;
+	std::vector<float> _prevX, _prevY, _prevZ;
+	std::vector<float> _velX, _velY, _velZ;
+	std::vector<float> _size;
+	std::vector<float> _brightness;
+	std::vector<float> _dieTime;
+	std::vector<float> _nextPVSCheck;
+	std::vector<unsigned char> _flags;
+
+	//Snow only
+	std::vector<float> _spiralTime;
+	std::vector<float> _phase;
+	std::vector<float> _touchTime;
+	std::vector<float> _touchBrightness;
+
+	//Indices of visible particles and their squared distance to the player, rebuilt on every draw
+	std::vector<std::size_t> _visible;
+	std::vector<float> _distance;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+#include "monsters.h"
+#include "game.h"
+#include "ai_lod.h"
+
+#include <chrono>
+
+AILevelOfDetail g_AILevelOfDetail;
+
+#define AI_LOD_NEAR_DISTANCE 1536.0f
+
+static const float aiThinkInterval = 0.1f;
+static const float aiDormantThinkInterval = 0.3f;
+static const float aiSenseIntervals[AILevelOfDetail::TIER_COUNT] = { 0.0f, 0.2f, 0.3f, 0.3f };
+static const char* const aiTierNames[AILevelOfDetail::TIER_COUNT] = { "Full", "Near", "Far", "Dormant" };
+
+static float NearestPlayerDistance(CBaseMonster* pMonster)
+{
+	float nearest = 0.0f;
+	bool found = false;
+	for( int i = 1; i <= gpGlobals->maxClients; i++ )
+	{
+		CBaseEntity *pPlayer = UTIL_PlayerByIndex( i );
+		if( !pPlayer )
+			continue;
+		const float distance = ( pPlayer->pev->origin - pMonster->pev->origin ).Length();
+		if( !found || distance < nearest )
+		{
+			nearest = distance;
+			found = true;
+		}
+	}
+	return found ? nearest : 0.0f;
+}
+
+int AILevelOfDetail::ChooseTier(CBaseMonster *pMonster) const
+{
+	if( !sv_ai_lod.value )
+		return TIER_FULL;
+
+	const MONSTERSTATE state = pMonster->m_MonsterState;
+	if( state == MONSTERSTATE_SCRIPT || state == MONSTERSTATE_DEAD || pMonster->pev->deadflag != DEAD_NO || pMonster->m_pCine )
+		return TIER_FULL;
+
+	if( !FNullEnt( FIND_CLIENT_IN_PVS( pMonster->edict() ) ) )
+	{
+		if( state == MONSTERSTATE_COMBAT || NearestPlayerDistance( pMonster ) <= AI_LOD_NEAR_DISTANCE )
+			return TIER_FULL;
+		return TIER_NEAR;
+	}
+
+	if( state == MONSTERSTATE_COMBAT || FBitSet( pMonster->pev->spawnflags, SF_MONSTER_ACT_OUT_OF_PVS ) )
+	{
+		// Fights go on when the player leaves, keep the ones close by responsive
+		return NearestPlayerDistance( pMonster ) <= AI_LOD_NEAR_DISTANCE ? TIER_FULL : TIER_FAR;
+	}
+	return TIER_DORMANT;
+}
+
+float AILevelOfDetail::ThinkInterval(CBaseMonster *pMonster, int tier) const
+{
+	// Moving and flying monsters need small steps, StudioFrameAdvance takes care of the longer interval otherwise
+	if( tier == TIER_DORMANT && pMonster->pev->movetype == MOVETYPE_STEP && pMonster->MovementIsComplete() )
+		return aiDormantThinkInterval;
+	return aiThinkInterval;
+}
+
+void AILevelOfDetail::StartFrame()
+{
+	if( _frameTime != gpGlobals->time )
+	{
+		_frameTime = gpGlobals->time;
+		_frameSenseTime = 0.0;
+	}
+}
+
+bool AILevelOfDetail::ShouldSense(CBaseMonster *pMonster, int tier)
+{
+	if( tier == TIER_FULL )
+		return true;
+	if( pMonster->m_flNextAISense > gpGlobals->time )
+		return false;
+
+	StartFrame();
+	if( sv_ai_lod_budget.value > 0.0f && _frameSenseTime * 1000.0 >= sv_ai_lod_budget.value )
+	{
+		// Out of time for this frame, try again on the next think
+		_counters[tier].deferredSenses++;
+		return false;
+	}
+	return true;
+}
+
+void AILevelOfDetail::BeginSense()
+{
+	_senseStart = Clock();
+}
+
+void AILevelOfDetail::EndSense(CBaseMonster *pMonster, int tier)
+{
+	const double seconds = Clock() - _senseStart;
+	StartFrame();
+	_frameSenseTime += seconds;
+	pMonster->m_flNextAISense = gpGlobals->time + aiSenseIntervals[tier];
+
+	Counters& counters = _counters[tier];
+	counters.senses++;
+	counters.senseTime += seconds;
+}
+
+void AILevelOfDetail::CountThink(int tier, double seconds)
+{
+	Counters& counters = _counters[tier];
+	counters.thinks++;
+	counters.thinkTime += seconds;
+}
+
+double AILevelOfDetail::Clock()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void AILevelOfDetail::Report() const
+{
+	ALERT( at_console, "%-8s %8s %10s %8s %8s %10s\n", "Tier", "Thinks", "Think ms", "Senses", "Deferred", "Sense ms" );
+	for( int i = 0; i < TIER_COUNT; i++ )
+	{
+		const Counters& counters = _counters[i];
+		ALERT( at_console, "%-8s %8u %10.3f %8u %8u %10.3f\n", aiTierNames[i], counters.thinks, counters.thinkTime * 1000.0,
+			   counters.senses, counters.deferredSenses, counters.senseTime * 1000.0 );
+	}
+	if( !sv_ai_stats.value )
+		ALERT( at_console, "Set sv_ai_stats 1 to collect the timings\n" );
+}
+
+void AILevelOfDetail::ResetCounters()
+{
+	for( int i = 0; i < TIER_COUNT; i++ )
+		_counters[i] = Counters();
+}
+
+void ReportAIStats()
+{
+	g_AILevelOfDetail.Report();
+	if( CMD_ARGC() > 1 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+		g_AILevelOfDetail.ResetCounters();
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef AI_LOD_H
+#define AI_LOD_H
+
+class CBaseMonster;
+
+// Scales how often monsters think and gather sensory conditions by how relevant they are to the players.
+// Controlled by sv_ai_lod, sensing of the reduced tiers is limited to sv_ai_lod_budget milliseconds per frame.
+class AILevelOfDetail
+{
+public:
+	enum Tier
+	{
+		TIER_FULL = 0,	// Near a player, fighting in view or running a script: thinks and senses every 0.1 seconds
+		TIER_NEAR,		// In a player's PVS but far away: senses less often
+		TIER_FAR,		// Out of the players' PVS but still acting: senses less often
+		TIER_DORMANT,	// Out of the players' PVS and not acting: doesn't sense, thinks less often while standing still
+		TIER_COUNT
+	};
+
+	int ChooseTier(CBaseMonster* pMonster) const;
+	float ThinkInterval(CBaseMonster* pMonster, int tier) const;
+	// Whether the monster should Look and Listen on this think. Returns false to spread sensing over the next frames.
+	bool ShouldSense(CBaseMonster* pMonster, int tier);
+
+	void BeginSense();
+	void EndSense(CBaseMonster* pMonster, int tier);
+	void CountThink(int tier, double seconds);
+
+	static double Clock();
+	void Report() const;
+	void ResetCounters();
+
+private:
+	void StartFrame();
+
+	float _frameTime = -1.0f;
+	double _frameSenseTime = 0.0;
+	double _senseStart = 0.0;
+
+	struct Counters
+	{
+		unsigned int thinks = 0;
+		unsigned int senses = 0;
+		unsigned int deferredSenses = 0;
+		double thinkTime = 0.0;
+		double senseTime = 0.0;
+	};
+	Counters _counters[TIER_COUNT];
+};
+
+extern AILevelOfDetail g_AILevelOfDetail;
+
+void ReportAIStats();
+
+#endif
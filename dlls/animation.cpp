@@ -20,6 +20,9 @@
 #include "animation.h"
 #include "scriptevent.h"
 #include "studio.h"
+#include "studio_sequence_cache.h"
+
+#include <algorithm>
 #define VectorCopy(a,b) {(b)[0]=(a)[0];(b)[1]=(a)[1];(b)[2]=(a)[2];}
 
 #pragma warning( disable : 4244 )
@@ -49,58 +52,20 @@ int ExtractBbox( void *pmodel, int sequence, float *mins, float *maxs )
 
 int LookupActivity( void *pmodel, entvars_t *pev, int activity )
 {
-	studiohdr_t *pstudiohdr;
-
-	pstudiohdr = (studiohdr_t *)pmodel;
-	if( !pstudiohdr )
+	const StudioSequenceCache::ModelSequences *pSequences = g_StudioSequenceCache.GetModelSequences( pmodel );
+	if( !pSequences )
 		return 0;
 
-	mstudioseqdesc_t *pseqdesc;
-
-	pseqdesc = (mstudioseqdesc_t *)( (byte *)pstudiohdr + pstudiohdr->seqindex );
-
-	int weighttotal = 0;
-	int seq = ACTIVITY_NOT_AVAILABLE;
-	for( int i = 0; i < pstudiohdr->numseq; i++ )
-	{
-		if( pseqdesc[i].activity == activity )
-		{
-			weighttotal += pseqdesc[i].actweight;
-			if( !weighttotal || RANDOM_LONG( 0, weighttotal - 1 ) < pseqdesc[i].actweight )
-				seq = i;
-		}
-	}
-
-	return seq;
+	return pSequences->LookupActivity( activity );
 }
 
 int LookupActivityHeaviest( void *pmodel, entvars_t *pev, int activity )
 {
-	studiohdr_t *pstudiohdr;
-
-	pstudiohdr = (studiohdr_t *)pmodel;
-	if( !pstudiohdr )
+	const StudioSequenceCache::ModelSequences *pSequences = g_StudioSequenceCache.GetModelSequences( pmodel );
+	if( !pSequences )
 		return 0;
 
-	mstudioseqdesc_t *pseqdesc;
-
-	pseqdesc = (mstudioseqdesc_t *)( (byte *)pstudiohdr + pstudiohdr->seqindex );
-
-	int weight = 0;
-	int seq = ACTIVITY_NOT_AVAILABLE;
-	for( int i = 0; i < pstudiohdr->numseq; i++ )
-	{
-		if( pseqdesc[i].activity == activity )
-		{
-			if( pseqdesc[i].actweight > weight )
-			{
-				weight = pseqdesc[i].actweight;
-				seq = i;
-			}
-		}
-	}
-
-	return seq;
+	return pSequences->LookupActivityHeaviest( activity );
 }
 
 void GetEyePosition( void *pmodel, float *vecEyePosition )
@@ -120,23 +85,11 @@ void GetEyePosition( void *pmodel, float *vecEyePosition )
 
 int LookupSequence( void *pmodel, const char *label )
 {
-	studiohdr_t *pstudiohdr;
-
-	pstudiohdr = (studiohdr_t *)pmodel;
-	if( !pstudiohdr )
+	const StudioSequenceCache::ModelSequences *pSequences = g_StudioSequenceCache.GetModelSequences( pmodel );
+	if( !pSequences )
 		return 0;
 
-	mstudioseqdesc_t *pseqdesc;
-
-	pseqdesc = (mstudioseqdesc_t *)( (byte *)pstudiohdr + pstudiohdr->seqindex );
-
-	for( int i = 0; i < pstudiohdr->numseq; i++ )
-	{
-		if( stricmp( pseqdesc[i].label, label ) == 0 )
-			return i;
-	}
-
-	return -1;
+	return pSequences->LookupSequence( label );
 }
 
 int IsSoundEvent( int eventNumber )
@@ -244,7 +197,10 @@ int GetAnimationEvent( void *pmodel, entvars_t *pev, MonsterEvent_t *pMonsterEve
 	pseqdesc = (mstudioseqdesc_t *)( (byte *)pstudiohdr + pstudiohdr->seqindex ) + (int)pev->sequence;
 	pevent = (mstudioevent_t *)( (byte *)pstudiohdr + pseqdesc->eventindex );
 
-	if( pseqdesc->numevents == 0 || index > pseqdesc->numevents )
+	// index walks the server events of the sequence sorted by frame
+	const std::vector<StudioSequenceCache::ServerEvent>& events = g_StudioSequenceCache.GetModelSequences( pmodel )->SequenceServerEvents( pev->sequence );
+	const int numevents = (int)events.size();
+	if( numevents == 0 || index >= numevents )
 		return 0;
 
 	if( pseqdesc->numframes > 1 )
@@ -258,24 +214,32 @@ int GetAnimationEvent( void *pmodel, entvars_t *pev, MonsterEvent_t *pMonsterEve
 		flEnd = 1.0f;
 	}
 
-	for( ; index < pseqdesc->numevents; index++ )
+	// Events in the frame window, and the ones at the start of the sequence when a looping sequence wraps around
+	auto frameLess = []( const StudioSequenceCache::ServerEvent& serverEvent, float frame ) {
+		return serverEvent.frame < frame;
+	};
+	const float windowStart = Q_max( flStart, (float)minAnimEventFrame );
+	const int windowBegin = std::lower_bound( events.begin(), events.end(), windowStart, frameLess ) - events.begin();
+	const int windowEnd = std::lower_bound( events.begin(), events.end(), flEnd, frameLess ) - events.begin();
+	int wrapEnd = 0;
+	if( ( pseqdesc->flags & STUDIO_LOOPING ) && flEnd >= pseqdesc->numframes - 1 )
+		wrapEnd = std::lower_bound( events.begin(), events.end(), flEnd - pseqdesc->numframes + 1, frameLess ) - events.begin();
+
+	if( index >= wrapEnd )
 	{
-		// Don't send client-side events to the server AI
-		if( pevent[index].event >= EVENT_CLIENT )
-			continue;
+		if( index < windowBegin )
+			index = windowBegin;
+		if( index >= windowEnd )
+			return 0;
+	}
 
-		if( ( pevent[index].frame >= minAnimEventFrame && pevent[index].frame >= flStart && pevent[index].frame < flEnd ) ||
-			( ( pseqdesc->flags & STUDIO_LOOPING ) && flEnd >= pseqdesc->numframes - 1 && pevent[index].frame < flEnd - pseqdesc->numframes + 1 ) )
-		{
-			pMonsterEvent->event = pevent[index].event;
-			pMonsterEvent->options = pevent[index].options;
+	mstudioevent_t& animEvent = pevent[events[index].index];
+	pMonsterEvent->event = animEvent.event;
+	pMonsterEvent->options = animEvent.options;
 
-			if (pevent[index].frame > latestAnimEventFrame)
-				latestAnimEventFrame = pevent[index].frame;
-			return index + 1;
-		}
-	}
-	return 0;
+	if (animEvent.frame > latestAnimEventFrame)
+		latestAnimEventFrame = animEvent.frame;
+	return index + 1;
 }
 
 float SetController( void *pmodel, entvars_t *pev, int iController, float flValue )
@@ -419,24 +383,12 @@ int FindTransition( void *pmodel, int iEndingAnim, int iGoalAnim, int *piDir )
 	if( iInternNode == 0 )
 		return iGoalAnim;
 
-	int i;
-
 	// look for someone going
-	for( i = 0; i < pstudiohdr->numseq; i++ )
+	int iSequence, iDir;
+	if( g_StudioSequenceCache.GetModelSequences( pmodel )->FindTransition( iEndNode, iInternNode, iSequence, iDir ) )
 	{
-		if( pseqdesc[i].entrynode == iEndNode && pseqdesc[i].exitnode == iInternNode )
-		{
-			*piDir = 1;
-			return i;
-		}
-		if( pseqdesc[i].nodeflags )
-		{
-			if( pseqdesc[i].exitnode == iEndNode && pseqdesc[i].entrynode == iInternNode )
-			{
-				*piDir = -1;
-				return i;
-			}
-		}
+		*piDir = iDir;
+		return iSequence;
 	}
 
 	ALERT( at_console, "error in transition graph\n" );
@@ -120,6 +120,8 @@ public:
 	virtual int Save( CSave &save ); 
 	virtual int Restore( CRestore &restore );
 	static TYPEDESCRIPTION m_SaveData[];
+	static TYPEDESCRIPTION m_KeyValueData[];
+	static KeyValueTable m_KeyValueTable;
 
 	void KeyValue( KeyValueData *pkvd );
 	void Activate();
@@ -155,6 +157,8 @@ public:
 	virtual void MonsterThink( void );
 	void EXPORT CallMonsterThink( void ) { this->MonsterThink(); }
 	virtual int IRelationship( CBaseEntity *pTarget );
+	// Whether IRelationship can return something else than R_NO when the default relationship is R_NO
+	virtual bool IRelationshipMayOverrideNone() { return false; }
 	int IDefaultRelationship(CBaseEntity *pTarget );
 	int IDefaultRelationship( int classify );
 	
@@ -162,6 +166,8 @@ public:
 	
 	virtual void MonsterInit( void );
 	virtual void MonsterInitDead( void );	// Call after animation/pose is set up
+	virtual void ResetMonsterState( void );	// Forget the previous life of a dead monster that is going to be spawned again
+	virtual bool CanBePooled( void ) { return false; }	// ResetMonsterState brings back everything the monster changes during its life, and UpdateOnRemove doesn't remove anything made in Spawn
 	virtual void BecomeDead( void );
 	void EXPORT CorpseFallThink( void );
 
@@ -466,6 +472,9 @@ public:
 	short m_gibPolicy;
 	bool m_bForceConditionsGather;
 
+	int m_aiLodTier; // see ai_lod.h
+	float m_flNextAISense;
+
 	float m_flLastYawTime;
 
 	const char* taskFailReason;
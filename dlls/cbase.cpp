@@ -25,6 +25,7 @@
 #include	"ent_templates.h"
 #include	"studio.h"
 #include	"scriptevent.h"
+#include	"spatial_grid.h"
 
 bool g_fIsXash3D = false;
 
@@ -100,8 +101,12 @@ static DLL_FUNCTIONS gFunctionTable =
 void OnFreeEntPrivateData(edict_s* pEdict)
 {
 	entvars_t* pev = VARS(pEdict);
+	g_EntityNameIndex.Remove(pEdict);
+	g_SpatialGrid.Remove(pEdict);
 	if (pev && !FStringNull(pev->classname) && FStrEq(STRING(pev->classname), "worldspawn"))
 	{
+		g_EntityNameIndex.Clear();
+		g_SpatialGrid.Clear();
 		ClearStringPool();
 		ClearPrecachedModels();
 		ClearPrecachedSounds();
@@ -203,6 +208,8 @@ int DispatchSpawn( edict_t *pent )
 
 		if( pEntity )
 		{
+			g_EntityNameIndex.Update( pent );
+			g_SpatialGrid.Update( pent );
 			if( g_pGameRules && !g_pGameRules->IsAllowedToSpawn( pEntity ) )
 				return -1;	// return that this entity should be deleted
 			if( pEntity->pev->flags & FL_KILLME )
@@ -248,6 +255,8 @@ void DispatchKeyValue( edict_t *pentKeyvalue, KeyValueData *pkvd )
 		return;
 
 	EntvarsKeyvalue( VARS( pentKeyvalue ), pkvd );
+	if( pkvd->fHandled )
+		g_EntityNameIndex.Update( pentKeyvalue );
 
 	// If the key was an entity variable, or there's no class set yet, don't look for the object, it may
 	// not exist yet.
@@ -426,6 +435,11 @@ int DispatchRestore( edict_t *pent, SAVERESTOREDATA *pSaveData, int globalEntity
 
 		// Again, could be deleted, get the pointer again.
 		pEntity = (CBaseEntity *)GET_PRIVATE( pent );
+		if( pEntity )
+		{
+			g_EntityNameIndex.Update( pent );
+			g_SpatialGrid.Update( pent );
+		}
 #if 0
 		if( pEntity && pEntity->pev->globalname && globalEntity ) 
 		{
@@ -688,18 +702,18 @@ TYPEDESCRIPTION	CBaseEntity::m_SaveData[] =
 	DEFINE_FIELD( CBaseEntity, m_objectHint, FIELD_STRING ),
 };
 
+TYPEDESCRIPTION CBaseEntity::m_KeyValueData[] =
+{
+	DEFINE_KEYVALUE( CBaseEntity, m_soundList, FIELD_STRING, "soundlist" ),
+	DEFINE_KEYVALUE( CBaseEntity, m_entTemplate, FIELD_STRING, "ent_template" ),
+	DEFINE_KEYVALUE( CBaseEntity, m_objectHint, FIELD_STRING, "objecthint" ),
+};
+
+IMPLEMENT_KEYVALUES( CBaseEntity )
+
 void CBaseEntity::KeyValue(KeyValueData* pkvd)
 {
-	if (FStrEq(pkvd->szKeyName, "soundlist")) {
-		m_soundList = ALLOC_STRING(pkvd->szValue);
-		pkvd->fHandled = true;
-	} else if (FStrEq(pkvd->szKeyName, "ent_template")) {
-		m_entTemplate = ALLOC_STRING(pkvd->szValue);
-		pkvd->fHandled = true;
-	} else if (FStrEq(pkvd->szKeyName, "objecthint")) {
-		m_objectHint = ALLOC_STRING(pkvd->szValue);
-		pkvd->fHandled = true;
-	} else {
+	if (!m_KeyValueTable.Apply(this, pkvd)) {
 		pkvd->fHandled = false;
 	}
 }
@@ -820,6 +834,30 @@ const SoundScript* CBaseEntity::GetSoundScript(const char *name)
 	return g_SoundScriptSystem.GetSoundScript(name);
 }
 
+int CBaseEntity::GetSoundScriptSymbolForMyTemplate(int symbol)
+{
+	const EntTemplate* entTemplate = GetMyEntTemplate();
+	if (entTemplate)
+	{
+		const int symbolOverride = entTemplate->GetSoundScriptSymbolOverride(symbol);
+		if (symbolOverride != NameSymbolTable::INVALID_SYMBOL)
+			return symbolOverride;
+	}
+	entTemplate = GetOwnerEntTemplate();
+	if (entTemplate)
+	{
+		const int symbolOverride = entTemplate->GetSoundScriptSymbolOverride(symbol);
+		if (symbolOverride != NameSymbolTable::INVALID_SYMBOL)
+			return symbolOverride;
+	}
+	return symbol;
+}
+
+const SoundScript* CBaseEntity::GetSoundScript(const NamedSoundScript &soundScript)
+{
+	return g_SoundScriptSystem.GetSoundScript(GetSoundScriptSymbolForMyTemplate(soundScript.Symbol()));
+}
+
 bool CBaseEntity::EmitSoundScript(const SoundScript *soundScript, const SoundScriptParamOverride paramsOverride, int flags)
 {
 	if (soundScript)
@@ -840,6 +878,16 @@ bool CBaseEntity::EmitSoundScript(const char *name, const SoundScriptParamOverri
 	return false;
 }
 
+bool CBaseEntity::EmitSoundScript(const NamedSoundScript &namedSoundScript, const SoundScriptParamOverride paramsOverride, int flags)
+{
+	const SoundScript* soundScript = GetSoundScript(namedSoundScript);
+	if (soundScript)
+	{
+		return EmitSoundScript(soundScript, paramsOverride, flags);
+	}
+	return false;
+}
+
 bool CBaseEntity::EmitSoundScriptSelectedSample(const SoundScript* soundScript, int sampleIndex, const SoundScriptParamOverride paramsOverride, int flags)
 {
 	if (soundScript)
@@ -895,6 +943,15 @@ void CBaseEntity::StopSoundScript(const char *name)
 	}
 }
 
+void CBaseEntity::StopSoundScript(const NamedSoundScript &namedSoundScript)
+{
+	const SoundScript* soundScript = GetSoundScript(namedSoundScript);
+	if (soundScript)
+	{
+		return StopSoundScript(soundScript);
+	}
+}
+
 void CBaseEntity::StopSoundScriptSelectedSample(const SoundScript* soundScript, int sampleIndex)
 {
 	if (soundScript)
@@ -950,6 +1007,15 @@ void CBaseEntity::EmitSoundScriptAmbient(const Vector& vecOrigin, const char *na
 	}
 }
 
+void CBaseEntity::EmitSoundScriptAmbient(const Vector& vecOrigin, const NamedSoundScript &namedSoundScript, const SoundScriptParamOverride paramsOverride, int flags)
+{
+	const SoundScript* soundScript = GetSoundScript(namedSoundScript);
+	if (soundScript)
+	{
+		return EmitSoundScriptAmbient(vecOrigin, soundScript, paramsOverride, flags);
+	}
+}
+
 void CBaseEntity::PrecacheSoundScript(const SoundScript& soundScript)
 {
 	for (const auto& wave : soundScript.waves)
@@ -1033,6 +1099,30 @@ const Visual* CBaseEntity::GetVisual(const char *name)
 	return g_VisualSystem.GetVisual(name);
 }
 
+int CBaseEntity::GetVisualSymbolForMyTemplate(int symbol)
+{
+	const EntTemplate* entTemplate = GetMyEntTemplate();
+	if (entTemplate)
+	{
+		const int symbolOverride = entTemplate->GetVisualSymbolOverride(symbol);
+		if (symbolOverride != NameSymbolTable::INVALID_SYMBOL)
+			return symbolOverride;
+	}
+	entTemplate = GetOwnerEntTemplate();
+	if (entTemplate)
+	{
+		const int symbolOverride = entTemplate->GetVisualSymbolOverride(symbol);
+		if (symbolOverride != NameSymbolTable::INVALID_SYMBOL)
+			return symbolOverride;
+	}
+	return symbol;
+}
+
+const Visual* CBaseEntity::GetVisual(const NamedVisual &visual)
+{
+	return g_VisualSystem.GetVisual(GetVisualSymbolForMyTemplate(visual.Symbol()));
+}
+
 const Visual* CBaseEntity::RegisterVisual(const NamedVisual &defaultVisual, bool precache, string_t* usedTemplate)
 {
 	if (defaultVisual.mixin)
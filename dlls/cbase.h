@@ -22,6 +22,8 @@
 #include "visuals.h"
 #include "grapple_target.h"
 #include "classify.h"
+#include "ent_name_index.h"
+#include "keyvalue_table.h"
 #include <type_traits>
 /*
 
@@ -202,8 +204,11 @@ public:
 	virtual int Classify( void ) { return DefaultClassify(); }
 	virtual int DefaultClassify() { return CLASS_NONE; }
 	virtual void DeathNotice( entvars_t *pevChild ) {}// monster maker children use this to tell the monster maker that they have died.
+	virtual bool RecycleChild( CBaseEntity *pChild ) { return false; }// dead monster maker children are offered back to the maker instead of being removed.
 
 	static TYPEDESCRIPTION m_SaveData[];
+	static TYPEDESCRIPTION m_KeyValueData[];
+	static KeyValueTable m_KeyValueTable;
 
 	virtual void TraceAttack( entvars_t *pevInflictor, entvars_t *pevAttacker, float flDamage, Vector vecDir, TraceResult *ptr, int bitsDamageType);
 	void ApplyTraceAttack( entvars_t *pevInflictor, entvars_t *pevAttacker, float flDamage, Vector vecDir, TraceResult *ptr, int bitsDamageType );
@@ -280,20 +285,25 @@ public:
 	static const char* GetSoundScriptNameForTemplate(const char* name, const EntTemplate* entTemplate);
 	const char* GetSoundScriptNameForMyTemplate(const char* name, string_t* usedTemplate = nullptr);
 	const SoundScript* GetSoundScript(const char* name);
+	int GetSoundScriptSymbolForMyTemplate(int symbol);
+	const SoundScript* GetSoundScript(const NamedSoundScript& soundScript);
 	bool EmitSoundScript(const SoundScript* soundScript, const SoundScriptParamOverride paramsOverride = SoundScriptParamOverride(), int flags = 0);
 	bool EmitSoundScript(const char* name, const SoundScriptParamOverride paramsOverride = SoundScriptParamOverride(), int flags = 0);
+	bool EmitSoundScript(const NamedSoundScript& soundScript, const SoundScriptParamOverride paramsOverride = SoundScriptParamOverride(), int flags = 0);
 	bool EmitSoundScriptSelectedSample(const SoundScript* soundScript, int sampleIndex, const SoundScriptParamOverride paramsOverride = SoundScriptParamOverride(), int flags = 0);
 	bool EmitSoundScriptSelectedSample(const SoundScript* soundScript, const char* sample, const SoundScriptParamOverride paramsOverride = SoundScriptParamOverride(), int flags = 0);
 	bool EmitSoundScriptSelectedSample(const char* name, int sampleIndex, const SoundScriptParamOverride paramsOverride = SoundScriptParamOverride(), int flags = 0);
 	bool EmitSoundScriptSelectedSample(const char* name, const char* sample, const SoundScriptParamOverride paramsOverride = SoundScriptParamOverride(), int flags = 0);
 	void StopSoundScript(const SoundScript* soundScript);
 	void StopSoundScript(const char* name);
+	void StopSoundScript(const NamedSoundScript& soundScript);
 	void StopSoundScriptSelectedSample(const SoundScript* soundScript, int sampleIndex);
 	void StopSoundScriptSelectedSample(const SoundScript* soundScript, const char* sample);
 	void StopSoundScriptSelectedSample(const char* name, int sampleIndex);
 	void StopSoundScriptSelectedSample(const char* name, const char* sample);
 	void EmitSoundScriptAmbient(const Vector& vecOrigin, const SoundScript* soundScript, const SoundScriptParamOverride paramsOverride = SoundScriptParamOverride(), int flags = 0);
 	void EmitSoundScriptAmbient(const Vector& vecOrigin, const char* name, const SoundScriptParamOverride paramsOverride = SoundScriptParamOverride(), int flags = 0);
+	void EmitSoundScriptAmbient(const Vector& vecOrigin, const NamedSoundScript& soundScript, const SoundScriptParamOverride paramsOverride = SoundScriptParamOverride(), int flags = 0);
 	void PrecacheSoundScript(const SoundScript& soundScript);
 	void RegisterAndPrecacheSoundScriptByName(const char* name, const SoundScript& defaultSoundScript);
 	void RegisterAndPrecacheSoundScript(const NamedSoundScript& defaultSoundScript);
@@ -303,6 +313,8 @@ public:
 	static const char* GetVisualNameForTemplate(const char* name, const EntTemplate* entTemplate);
 	const char* GetVisualNameForMyTemplate(const char* name, string_t* usedTemplate = nullptr);
 	const Visual* GetVisual(const char* name);
+	int GetVisualSymbolForMyTemplate(int symbol);
+	const Visual* GetVisual(const NamedVisual& visual);
 	const Visual* RegisterVisual(const NamedVisual& defaultVisual, bool precache = true, string_t* usedTemplate = nullptr);
 	void AssignEntityOverrides(EntityOverrides entityOverrides);
 	EntityOverrides GetProjectileOverrides();
@@ -531,6 +543,8 @@ public:
 	virtual int Save( CSave &save );
 	virtual int Restore( CRestore &restore );
 	static TYPEDESCRIPTION m_SaveData[];
+	static TYPEDESCRIPTION m_KeyValueData[];
+	static KeyValueTable m_KeyValueTable;
 	// common member functions
 	void SUB_UseTargets( CBaseEntity *pActivator, USE_TYPE useType = USE_TOGGLE, float value = 0.0f );
 	static void DelayedUse(float delay, CBaseEntity *pActivator, CBaseEntity *pCaller, USE_TYPE useType, string_t target, string_t killTarget = iStringNull, float value = 0.0f );
@@ -607,6 +621,8 @@ public:
 	virtual int		Restore( CRestore &restore );
 
 	static	TYPEDESCRIPTION m_SaveData[];
+	static TYPEDESCRIPTION m_KeyValueData[];
+	static KeyValueTable m_KeyValueTable;
 
 	CBaseToggle *MyTogglePointer( void ) { return this; }
 	virtual int		GetToggleState( void ) { return m_toggle_state; }
@@ -753,6 +769,9 @@ template <class T> T * GetClassPtr( T *a )
 		// allocate private data 
 		a = new( pev ) T;
 		a->pev = pev;
+#if !CLIENT_DLL
+		g_EntityNameIndex.MarkPending( ENT( pev ) );
+#endif
 	}
 	return a;
 }
@@ -914,5 +933,7 @@ struct FieldDefiner<T, FIELD_CHARACTER, typename std::enable_if<
 #define DEFINE_ARRAY(type,name,fieldtype,count)		_FIELD_SAFE(type, name, fieldtype, count, 0)
 #define DEFINE_ENTITY_GLOBAL_FIELD(name,fieldtype)	_FIELD_SAFE(entvars_t, name, fieldtype, 1, FTYPEDESC_GLOBAL )
 #define DEFINE_GLOBAL_FIELD(type,name,fieldtype)		_FIELD_SAFE(type, name, fieldtype, 1, FTYPEDESC_GLOBAL )
+// A field set by the keyvalue with the given key name, see KeyValueTable
+#define DEFINE_KEYVALUE(type,name,fieldtype,key)		FieldDefiner<decltype(type::name), fieldtype>::D(key, offsetof(type, name), 1, FTYPEDESC_KEY)
 
 #endif
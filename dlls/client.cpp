@@ -31,6 +31,10 @@
 #include "spectator.h"
 #include "client.h"
 #include "soundent.h"
+#include "spatial_grid.h"
+#include "visibility_cache.h"
+#include "fullpack_cache.h"
+#include "skill.h"
 #include "gamerules.h"
 #include "game.h"
 #include "customentity.h"
@@ -941,8 +945,17 @@ void StartFrame( void )
 {
 	//ALERT( at_console, "SV_Physics( %g, frametime %g )\n", gpGlobals->time, gpGlobals->frametime );
 
+	g_EntityNameIndex.UpdateAll();
+	g_SpatialGrid.UpdateAll();
+	g_VisibilityCache.NewFrame();
+
 	if( g_pGameRules )
+	{
+		// Pick up edited skill values without waiting for the next map
+		if( g_SkillCvars.CheckForChanges() )
+			g_pGameRules->RefreshSkillData();
 		g_pGameRules->Think();
+	}
 
 	if( g_fGameOver )
 		return;
@@ -1232,6 +1245,7 @@ void SetupVisibility( edict_t *pViewEntity, edict_t *pClient, unsigned char **pv
 
 	const int clientIndex = ENTINDEX(pClient) - 1;
 	g_PlayerFullyInitialized[clientIndex] = true;
+	g_FullPackCache.BeginClient(clientIndex);
 
 	if( pClient->v.flags & FL_PROXY )
 	{
@@ -1279,32 +1293,53 @@ we could also use the pas/ pvs that we set in SetupVisibility, if we wanted to.
 int AddToFullPack( struct entity_state_s *state, int e, edict_t *ent, edict_t *host, int hostflags, int player, unsigned char *pSet )
 {
 	int i;
-	CBaseEntity *Entity;
-
-	// don't send if flagged for NODRAW and it's not the host getting the message
-	if( ( ent->v.effects & EF_NODRAW ) && ( ent != host ) )
-		return 0;
-
-	// Ignore ents without valid / visible models
-	if( !ent->v.modelindex || !STRING( ent->v.model ) )
-		return 0;
+	const bool useCache = sv_fullpack_cache.value != 0;
 
-	// Don't send spectators to other players
-	if( ( ent->v.flags & FL_SPECTATOR ) && ( ent != host ) )
+	if( useCache )
 	{
-		return 0;
+		switch( g_FullPackCache.GetNetworkClass( e, ent ) )
+		{
+		case FullPackCache::NETWORK_NEVER:
+			return 0;
+		case FullPackCache::NETWORK_HOST_ONLY:
+			if( ent != host )
+				return 0;
+			break;
+		case FullPackCache::NETWORK_PVS:
+			if( ent != host && !ENGINE_CHECK_VISIBILITY( (const struct edict_s *)ent, pSet ) )
+				return 0;
+			break;
+		default:
+			break;
+		}
 	}
-
-	// Ignore if not the host and not touching a PVS/PAS leaf
-	// If pSet is NULL, then the test will always succeed and the entity will be added to the update
-	if( ent != host )
+	else
 	{
-		if( !ENGINE_CHECK_VISIBILITY( (const struct edict_s *)ent, pSet ) )
+		// don't send if flagged for NODRAW and it's not the host getting the message
+		if( ( ent->v.effects & EF_NODRAW ) && ( ent != host ) )
+			return 0;
+
+		// Ignore ents without valid / visible models
+		if( !ent->v.modelindex || !STRING( ent->v.model ) )
+			return 0;
+
+		// Don't send spectators to other players
+		if( ( ent->v.flags & FL_SPECTATOR ) && ( ent != host ) )
 		{
-			// env_sky is visible always
-			if( !FClassnameIs( ent, "env_sky" ) )
+			return 0;
+		}
+
+		// Ignore if not the host and not touching a PVS/PAS leaf
+		// If pSet is NULL, then the test will always succeed and the entity will be added to the update
+		if( ent != host )
+		{
+			if( !ENGINE_CHECK_VISIBILITY( (const struct edict_s *)ent, pSet ) )
 			{
-				return 0;
+				// env_sky is visible always
+				if( !FClassnameIs( ent, "env_sky" ) )
+				{
+					return 0;
+				}
 			}
 		}
 	}
@@ -1341,6 +1376,20 @@ int AddToFullPack( struct entity_state_s *state, int e, edict_t *ent, edict_t *h
 		UTIL_UnsetGroupTrace();
 	}
 
+	// The parts of the state that take more than copying the fields are the same for all clients
+	FullPackCache::EntityState uncachedState;
+	const FullPackCache::EntityState* entityState = &uncachedState;
+	if( useCache )
+	{
+		entityState = &g_FullPackCache.GetEntityState( e, ent, player );
+	}
+	else
+	{
+		FullPackCache::ComputeEntityState( uncachedState, ent );
+		if( player )
+			uncachedState.weaponmodel = MODEL_INDEX( STRING( ent->v.weaponmodel ) );
+	}
+
 	memset( state, 0, sizeof(*state) );
 
 	// Assign index so we can track this entity from frame to frame and
@@ -1392,13 +1441,8 @@ int AddToFullPack( struct entity_state_s *state, int e, edict_t *ent, edict_t *h
 		state->eflags |= EFLAG_SLERP;
 	}
 #else
-	if(ent->v.flags & FL_FLY )
-		state->eflags |= EFLAG_SLERP;
-	else state->eflags &= ~EFLAG_SLERP;
-
-	CBaseEntity* pEntity = (CBaseEntity*)GET_PRIVATE(ent);
-	if (pEntity)
-		state->eflags |= pEntity->m_EFlags;
+	// Slerp for FL_FLY, entity flags and flesh sound
+	state->eflags = entityState->eflags;
 #endif
 
 	state->scale		= ent->v.scale;
@@ -1427,29 +1471,9 @@ int AddToFullPack( struct entity_state_s *state, int e, edict_t *ent, edict_t *h
 	state->rendercolor.g	= (byte)ent->v.rendercolor.y;
 	state->rendercolor.b	= (byte)ent->v.rendercolor.z;
 
-	state->aiment = 0;
-	if( ent->v.aiment )
-	{
-		state->aiment = ENTINDEX( ent->v.aiment );
-	}
-
-	state->owner = 0;
-	if( ent->v.owner )
-	{
-		int owner = ENTINDEX( ent->v.owner );
-
-		// Only care if owned by a player
-		if( owner >= 1 && owner <= gpGlobals->maxClients )
-		{
-			state->owner = owner;
-		}
-	}
-
-	state->onground = 0;
-	if( ent->v.groundentity )
-	{
-		state->onground = ENTINDEX( ent->v.groundentity );
-	}
+	state->aiment = entityState->aiment;
+	state->owner = entityState->owner;
+	state->onground = entityState->onground;
 
 	// HACK:  Somewhat...
 	// Class is overridden for non-players to signify a breakable glass object ( sort of a class? )
@@ -1463,7 +1487,7 @@ int AddToFullPack( struct entity_state_s *state, int e, edict_t *ent, edict_t *h
 	{
 		memcpy( state->basevelocity, ent->v.basevelocity, 3 * sizeof(float) );
 
-		state->weaponmodel	= MODEL_INDEX( STRING( ent->v.weaponmodel ) );
+		state->weaponmodel	= entityState->weaponmodel;
 		state->gaitsequence	= ent->v.gaitsequence;
 		state->spectator	= ent->v.flags & FL_SPECTATOR;
 		state->friction		= ent->v.friction;
@@ -1475,12 +1499,6 @@ int AddToFullPack( struct entity_state_s *state, int e, edict_t *ent, edict_t *h
 		state->health		= (int)ent->v.health;
 	}
 
-	if( ( Entity = CBaseEntity::Instance( ent ))
-		&& Entity->HasFlesh() )
-	{
-		SetBits( state->eflags, EFLAG_FLESH_SOUND );
-	}
-
 	return 1;
 }
 
@@ -38,6 +38,7 @@
 #include "common_soundscripts.h"
 #include "visuals_utils.h"
 #include "ent_templates.h"
+#include "visibility_cache.h"
 
 extern DLL_GLOBAL Vector		g_vecAttackDir;
 extern DLL_GLOBAL int			g_iSkillLevel;
@@ -1393,16 +1394,20 @@ bool CBaseEntity::FVisible( CBaseEntity *pEntity )
 	vecLookerOrigin = pev->origin + pev->view_ofs;//look through the caller's 'eyes'
 	vecTargetOrigin = pEntity->EyePosition();
 
+	const bool fUseCache = sv_visibility_cache.value != 0;
+	bool fVisible;
+	if( fUseCache && g_VisibilityCache.Lookup( edict(), pEntity->edict(), vecLookerOrigin, vecTargetOrigin, fVisible ) )
+		return fVisible;
+
 	UTIL_TraceLine( vecLookerOrigin, vecTargetOrigin, ignore_monsters, ignore_glass, ENT( pev )/*pentIgnore*/, &tr );
 
-	if( tr.flFraction != 1.0f )
-	{
-		return false;// Line of sight is not established
-	}
-	else
-	{
-		return true;// line of sight is valid.
-	}
+	// Line of sight is valid only if the trace wasn't interrupted
+	fVisible = tr.flFraction == 1.0f;
+
+	if( fUseCache )
+		g_VisibilityCache.Store( edict(), pEntity->edict(), vecLookerOrigin, vecTargetOrigin, fVisible );
+
+	return fVisible;
 }
 
 //=========================================================
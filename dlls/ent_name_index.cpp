@@ -0,0 +1,216 @@
+#include "extdll.h"
+#include "util.h"
+#include "ent_name_index.h"
+
+#include <algorithm>
+
+EntityNameIndex g_EntityNameIndex;
+
+unsigned int EntityNameIndex::HashName(const char* str)
+{
+	// FNV-1a. Comparison is case-sensitive like the one in the engine.
+	unsigned int hash = 2166136261u;
+	while (*str)
+	{
+		hash ^= (unsigned char)*str++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+string_t EntityNameIndex::EdictName(const edict_t *pent, int key)
+{
+	if (pent->free)
+		return iStringNull;
+	return key == KEY_TARGETNAME ? pent->v.targetname : pent->v.classname;
+}
+
+EntityNameIndex::EdictState* EntityNameIndex::GetState(edict_t *pent)
+{
+	const int index = ENTINDEX(pent);
+	// The world is never returned by the engine search functions, so don't index it either
+	if (index <= 0)
+		return nullptr;
+	if ((size_t)index >= _states.size())
+		_states.resize(std::max(index + 1, gpGlobals->maxEntities));
+	return &_states[index];
+}
+
+void EntityNameIndex::Unregister(edict_t *pent, IndexedName &name, int key)
+{
+	if (name.registered)
+	{
+		Buckets::iterator it = _buckets[key].find(name.hash);
+		if (it != _buckets[key].end())
+		{
+			std::vector<edict_t*>& edicts = it->second;
+			std::vector<edict_t*>::iterator found = std::lower_bound(edicts.begin(), edicts.end(), pent);
+			if (found != edicts.end() && *found == pent)
+				edicts.erase(found);
+			if (edicts.empty())
+				_buckets[key].erase(it);
+		}
+		name.registered = false;
+	}
+	name.value = iStringNull;
+	name.hash = 0;
+}
+
+void EntityNameIndex::UpdateName(edict_t *pent, EdictState &state, int key)
+{
+	IndexedName& name = state.names[key];
+	const string_t value = EdictName(pent, key);
+	if (value == name.value)
+		return;
+
+	if (FStringNull(value) || *STRING(value) == '\0')
+	{
+		Unregister(pent, name, key);
+		return;
+	}
+
+	const unsigned int hash = HashName(STRING(value));
+	if (name.registered && name.hash == hash)
+	{
+		// Same text, different string_t
+		name.value = value;
+		return;
+	}
+
+	Unregister(pent, name, key);
+
+	std::vector<edict_t*>& edicts = _buckets[key][hash];
+	edicts.insert(std::lower_bound(edicts.begin(), edicts.end(), pent), pent);
+	name.value = value;
+	name.hash = hash;
+	name.registered = true;
+}
+
+void EntityNameIndex::MarkPending(edict_t *pent)
+{
+	EdictState* state = GetState(pent);
+	if (state && !state->pending)
+	{
+		state->pending = true;
+		_pending.push_back(pent);
+	}
+}
+
+void EntityNameIndex::Update(edict_t *pent)
+{
+	if (!pent)
+		return;
+	EdictState* state = GetState(pent);
+	if (state)
+	{
+		for (int key = 0; key < KEY_COUNT; ++key)
+			UpdateName(pent, *state, key);
+		state->pending = false;
+	}
+}
+
+void EntityNameIndex::Remove(edict_t *pent)
+{
+	if (!pent)
+		return;
+	EdictState* state = GetState(pent);
+	if (state)
+	{
+		for (int key = 0; key < KEY_COUNT; ++key)
+			Unregister(pent, state->names[key], key);
+	}
+}
+
+void EntityNameIndex::FlushPending()
+{
+	// Entities created without DispatchSpawn may get their names assigned any time after the creation.
+	// Keep them pending until they're updated explicitly or until the next full update.
+	size_t count = 0;
+	for (size_t i = 0; i < _pending.size(); ++i)
+	{
+		edict_t* pent = _pending[i];
+		EdictState* state = GetState(pent);
+		if (!state->pending)
+			continue;
+		for (int key = 0; key < KEY_COUNT; ++key)
+			UpdateName(pent, *state, key);
+		_pending[count++] = pent;
+	}
+	_pending.resize(count);
+}
+
+void EntityNameIndex::UpdateAll()
+{
+	edict_t* pWorld = INDEXENT(0);
+	if (!pWorld)
+		return;
+
+	for (int i = 1; i < gpGlobals->maxEntities; ++i)
+	{
+		edict_t* pent = pWorld + i;
+		EdictState* state = i < (int)_states.size() ? &_states[i] : nullptr;
+		if (!state)
+		{
+			if (pent->free || (FStringNull(pent->v.targetname) && FStringNull(pent->v.classname)))
+				continue;
+			state = GetState(pent);
+		}
+		for (int key = 0; key < KEY_COUNT; ++key)
+			UpdateName(pent, *state, key);
+		state->pending = false;
+	}
+	_pending.clear();
+}
+
+void EntityNameIndex::Clear()
+{
+	for (int key = 0; key < KEY_COUNT; ++key)
+		_buckets[key].clear();
+	_states.clear();
+	_pending.clear();
+}
+
+edict_t* EntityNameIndex::Find(edict_t *pentStart, int key, const char *value)
+{
+	if (!value)
+		return nullptr;
+
+	_lookups++;
+	FlushPending();
+
+	Buckets::const_iterator it = _buckets[key].find(HashName(value));
+	if (it == _buckets[key].end())
+		return nullptr;
+
+	const std::vector<edict_t*>& edicts = it->second;
+	std::vector<edict_t*>::const_iterator candidate = pentStart ? std::upper_bound(edicts.begin(), edicts.end(), pentStart) : edicts.begin();
+	for (; candidate != edicts.end(); ++candidate)
+	{
+		_candidatesTested++;
+		edict_t* pent = *candidate;
+		// The name might have been changed directly since the last update
+		const string_t name = EdictName(pent, key);
+		if (!FStringNull(name) && strcmp(STRING(name), value) == 0)
+			return pent;
+	}
+	return nullptr;
+}
+
+void EntityNameIndex::Report()
+{
+	size_t indexed[KEY_COUNT] = {0, 0};
+	for (int key = 0; key < KEY_COUNT; ++key)
+	{
+		for (Buckets::const_iterator it = _buckets[key].begin(); it != _buckets[key].end(); ++it)
+			indexed[key] += it->second.size();
+	}
+	ALERT(at_console, "Indexed targetnames: %u (%u buckets)\n", (unsigned)indexed[KEY_TARGETNAME], (unsigned)_buckets[KEY_TARGETNAME].size());
+	ALERT(at_console, "Indexed classnames: %u (%u buckets)\n", (unsigned)indexed[KEY_CLASSNAME], (unsigned)_buckets[KEY_CLASSNAME].size());
+	ALERT(at_console, "Pending: %u\n", (unsigned)_pending.size());
+	ALERT(at_console, "Lookups: %u. Candidates tested: %u\n", _lookups, _candidatesTested);
+}
+
+void ReportEntityNameIndex()
+{
+	g_EntityNameIndex.Report();
+}
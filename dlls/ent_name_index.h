@@ -0,0 +1,72 @@
+#pragma once
+#ifndef ENT_NAME_INDEX_H
+#define ENT_NAME_INDEX_H
+
+#include "extdll.h"
+
+#include <unordered_map>
+#include <vector>
+
+// Game-side index of edicts by targetname and classname.
+// It's a replacement for linear FIND_ENTITY_BY_STRING scans over the whole edict list.
+// Lookups return edicts in the increasing edict index order, just like the engine does.
+class EntityNameIndex
+{
+public:
+	enum {
+		KEY_TARGETNAME,
+		KEY_CLASSNAME,
+		KEY_COUNT
+	};
+
+	// Entity was just created and its names are not known yet
+	void MarkPending(edict_t* pent);
+	// Re-read targetname and classname of the edict
+	void Update(edict_t* pent);
+	void Remove(edict_t* pent);
+	// Resynchronize all edicts. Catches the names assigned directly to pev bypassing the index
+	void UpdateAll();
+	void Clear();
+
+	edict_t* Find(edict_t* pentStart, int key, const char* value);
+
+	void Report();
+private:
+	struct IndexedName
+	{
+		IndexedName(): value(0), hash(0), registered(false) {}
+		string_t value;
+		unsigned int hash;
+		bool registered;
+	};
+
+	struct EdictState
+	{
+		EdictState(): pending(false) {}
+		IndexedName names[KEY_COUNT];
+		bool pending;
+	};
+
+	typedef std::unordered_map<unsigned int, std::vector<edict_t*> > Buckets;
+
+	static unsigned int HashName(const char* str);
+	static string_t EdictName(const edict_t* pent, int key);
+
+	EdictState* GetState(edict_t* pent);
+	void UpdateName(edict_t* pent, EdictState& state, int key);
+	void Unregister(edict_t* pent, IndexedName& name, int key);
+	void FlushPending();
+
+	Buckets _buckets[KEY_COUNT];
+	std::vector<EdictState> _states;
+	std::vector<edict_t*> _pending;
+
+	unsigned int _lookups = 0;
+	unsigned int _candidatesTested = 0;
+};
+
+extern EntityNameIndex g_EntityNameIndex;
+
+void ReportEntityNameIndex();
+
+#endif
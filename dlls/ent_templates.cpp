@@ -104,8 +104,6 @@ const char* entTemplatesSchema = R"(
 }
 )";
 
-static std::string g_tempString;
-
 const char* EntTemplate::OwnVisualName() const
 {
 	return _ownVisual.empty() ? nullptr : _ownVisual.c_str();
@@ -116,32 +114,64 @@ const char* EntTemplate::GibVisualName() const
 	return _gibVisual.empty() ? nullptr : _gibVisual.c_str();
 }
 
-const char* EntTemplate::GetSoundScriptNameOverride(const char *name) const
+const char* EntTemplate::FindNameOverride(const std::unordered_map<int, NameOverride>& overrides, const char *name)
 {
-	g_tempString = name;
-	auto it = _soundScripts.find(g_tempString);
-	if (it != _soundScripts.end())
-		return it->second.c_str();
+	if (overrides.empty())
+		return nullptr;
+	auto it = overrides.find(g_NameSymbols.Find(name));
+	if (it != overrides.end())
+		return it->second.name.c_str();
 	return nullptr;
 }
 
+int EntTemplate::FindSymbolOverride(const std::unordered_map<int, NameOverride>& overrides, int symbol)
+{
+	if (overrides.empty())
+		return NameSymbolTable::INVALID_SYMBOL;
+	auto it = overrides.find(symbol);
+	if (it != overrides.end())
+		return it->second.symbol;
+	return NameSymbolTable::INVALID_SYMBOL;
+}
+
+void EntTemplate::SetNameOverride(std::unordered_map<int, NameOverride>& overrides, const char *name, const std::string& replacement)
+{
+	const int symbol = g_NameSymbols.Intern(name);
+	if (symbol == NameSymbolTable::INVALID_SYMBOL)
+		return;
+	NameOverride& nameOverride = overrides[symbol];
+	nameOverride.symbol = g_NameSymbols.Intern(replacement.c_str());
+	nameOverride.name = replacement;
+}
+
+const char* EntTemplate::GetSoundScriptNameOverride(const char *name) const
+{
+	return FindNameOverride(_soundScripts, name);
+}
+
+int EntTemplate::GetSoundScriptSymbolOverride(int symbol) const
+{
+	return FindSymbolOverride(_soundScripts, symbol);
+}
+
 const char* EntTemplate::GetVisualNameOverride(const char *name) const
 {
-	g_tempString = name;
-	auto it = _visuals.find(g_tempString);
-	if (it != _visuals.end())
-		return it->second.c_str();
-	return nullptr;
+	return FindNameOverride(_visuals, name);
+}
+
+int EntTemplate::GetVisualSymbolOverride(int symbol) const
+{
+	return FindSymbolOverride(_visuals, symbol);
 }
 
 void EntTemplate::SetSoundScriptReplacement(const char *soundScript, const std::string& replacement)
 {
-	_soundScripts[soundScript] = replacement;
+	SetNameOverride(_soundScripts, soundScript, replacement);
 }
 
 void EntTemplate::SetVisualReplacement(const char *visual, const std::string& replacement)
 {
-	_visuals[visual] = replacement;
+	SetNameOverride(_visuals, visual, replacement);
 }
 
 const char* EntTemplate::GetSoundReplacement(const char *originalSample) const
@@ -497,21 +527,23 @@ bool EntTemplateSystem::ReadFromDocument(rapidjson::Document& document, const ch
 			}
 		}
 
-		_entTemplates[templateName] = entTemplate;
+		EntTemplate& entry = _entTemplates[templateName];
+		entry = entTemplate;
+		const int symbol = g_NameSymbols.Intern(templateName.c_str());
+		if (symbol != NameSymbolTable::INVALID_SYMBOL)
+		{
+			if (symbol >= (int)_entTemplatesBySymbol.size())
+				_entTemplatesBySymbol.resize(symbol + 1, nullptr);
+			_entTemplatesBySymbol[symbol] = &entry;
+		}
 	}
 
 	return true;
 }
 
-const EntTemplate* EntTemplateSystem::GetTemplate(const char *name)
+const EntTemplate* EntTemplateSystem::GetTemplate(const char *name) const
 {
-	if (!name || *name == '\0')
-		return nullptr;
-	_temp = name;
-	auto it = _entTemplates.find(_temp);
-	if (it != _entTemplates.end())
-		return &it->second;
-	return nullptr;
+	return GetTemplate(g_NameSymbols.Find(name));
 }
 
 void EntTemplateSystem::EnsureVisualReplacementForTemplate(const char* templateName, const char* visualName)
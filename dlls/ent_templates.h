@@ -9,6 +9,7 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -26,9 +27,13 @@ public:
 	}
 
 	const char* GetSoundScriptNameOverride(const char* name) const;
+	// Symbol of the replacement sound script or NameSymbolTable::INVALID_SYMBOL
+	int GetSoundScriptSymbolOverride(int symbol) const;
 	void SetSoundScriptReplacement(const char* soundScript, const std::string& replacement);
 
 	const char* GetVisualNameOverride(const char* name) const;
+	// Symbol of the replacement visual or NameSymbolTable::INVALID_SYMBOL
+	int GetVisualSymbolOverride(int symbol) const;
 	void SetVisualReplacement(const char* visual, const std::string& replacement);
 
 	const char* GetSoundReplacement(const char* originalSample) const;
@@ -140,8 +145,18 @@ public:
 		_speechPrefix = speechPrefix;
 	}
 private:
-	std::map<std::string, std::string> _soundScripts;
-	std::map<std::string, std::string> _visuals;
+	struct NameOverride
+	{
+		int symbol;
+		std::string name;
+	};
+	static const char* FindNameOverride(const std::unordered_map<int, NameOverride>& overrides, const char* name);
+	static int FindSymbolOverride(const std::unordered_map<int, NameOverride>& overrides, int symbol);
+	static void SetNameOverride(std::unordered_map<int, NameOverride>& overrides, const char* name, const std::string& replacement);
+
+	// By the symbol of the replaced name
+	std::unordered_map<int, NameOverride> _soundScripts;
+	std::unordered_map<int, NameOverride> _visuals;
 	std::string _ownVisual;
 	std::string _gibVisual;
 
@@ -182,7 +197,10 @@ public:
 	void SetVisualSystem(VisualSystem* visualSystem) {
 		_visualSystem = visualSystem;
 	}
-	const EntTemplate* GetTemplate(const char* name);
+	const EntTemplate* GetTemplate(const char* name) const;
+	const EntTemplate* GetTemplate(int symbol) const {
+		return symbol >= 0 && symbol < (int)_entTemplatesBySymbol.size() ? _entTemplatesBySymbol[symbol] : nullptr;
+	}
 	void EnsureVisualReplacementForTemplate(const char* templateName, const char* visualName);
 	void EnsureSoundScriptReplacementForTemplate(const char* templateName, const char* soundScriptName);
 protected:
@@ -190,6 +208,7 @@ protected:
 	bool ReadFromDocument(rapidjson::Document& document, const char* fileName);
 private:
 	std::map<std::string, EntTemplate, CaseInsensitiveCompare> _entTemplates;
+	std::vector<EntTemplate*> _entTemplatesBySymbol; // map nodes never move
 	std::string _temp;
 
 	SoundScriptSystem* _soundScriptSystem;
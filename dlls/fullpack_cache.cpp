@@ -0,0 +1,108 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+#include "fullpack_cache.h"
+
+FullPackCache g_FullPackCache;
+
+void FullPackCache::BeginClient(int clientIndex)
+{
+	// Clients are set up in the order of their indices, with nothing changing the entities in between
+	if( _frameTime != gpGlobals->time || clientIndex <= _lastClient )
+	{
+		_frameTime = gpGlobals->time;
+		_frame++;
+	}
+	_lastClient = clientIndex;
+}
+
+FullPackCache::Entry& FullPackCache::GetEntry(int e)
+{
+	if( e >= (int)_entries.size() )
+		_entries.resize( Q_max( e + 1, gpGlobals->maxEntities ) );
+	return _entries[e];
+}
+
+int FullPackCache::GetNetworkClass(int e, edict_t *ent)
+{
+	Entry& entry = GetEntry(e);
+	if( entry.classFrame == _frame )
+		return entry.networkClass;
+	entry.classFrame = _frame;
+
+	if( !ent->v.modelindex || !STRING( ent->v.model ) )
+	{
+		entry.networkClass = NETWORK_NEVER;
+	}
+	else if( ( ent->v.effects & EF_NODRAW ) || ( ent->v.flags & FL_SPECTATOR ) )
+	{
+		entry.networkClass = NETWORK_HOST_ONLY;
+	}
+	else
+	{
+		// Only compare the class name when the entity gets a new one
+		if( entry.classname != ent->v.classname )
+		{
+			entry.classname = ent->v.classname;
+			entry.sky = FClassnameIs( ent, "env_sky" );
+		}
+		entry.networkClass = entry.sky ? NETWORK_ALWAYS : NETWORK_PVS;
+	}
+	return entry.networkClass;
+}
+
+void FullPackCache::ComputeEntityState(EntityState &state, edict_t *ent)
+{
+	state.eflags = ( ent->v.flags & FL_FLY ) ? EFLAG_SLERP : 0;
+	CBaseEntity* pEntity = (CBaseEntity*)GET_PRIVATE( ent );
+	if( pEntity )
+	{
+		state.eflags |= pEntity->m_EFlags;
+		if( pEntity->HasFlesh() )
+			state.eflags |= EFLAG_FLESH_SOUND;
+	}
+
+	state.aiment = ent->v.aiment ? ENTINDEX( ent->v.aiment ) : 0;
+
+	state.owner = 0;
+	if( ent->v.owner )
+	{
+		const int owner = ENTINDEX( ent->v.owner );
+
+		// Only care if owned by a player
+		if( owner >= 1 && owner <= gpGlobals->maxClients )
+			state.owner = owner;
+	}
+
+	state.onground = ent->v.groundentity ? ENTINDEX( ent->v.groundentity ) : 0;
+	state.weaponmodel = 0;
+}
+
+const FullPackCache::EntityState& FullPackCache::GetEntityState(int e, edict_t *ent, int player)
+{
+	Entry& entry = GetEntry(e);
+	EntityState& state = entry.state;
+	if( entry.stateFrame == _frame )
+		return state;
+	entry.stateFrame = _frame;
+
+	ComputeEntityState( state, ent );
+	if( player )
+	{
+		// Looking up a model index goes through the model names, only do it when the weapon changes
+		if( entry.weaponmodel != ent->v.weaponmodel || !entry.weaponmodel )
+		{
+			entry.weaponmodel = ent->v.weaponmodel;
+			entry.weaponmodelIndex = MODEL_INDEX( STRING( ent->v.weaponmodel ) );
+		}
+		state.weaponmodel = entry.weaponmodelIndex;
+	}
+	return state;
+}
+
+void FullPackCache::Clear()
+{
+	_entries.clear();
+	_frameTime = -1.0f;
+	_lastClient = -1;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef FULLPACK_CACHE_H
+#define FULLPACK_CACHE_H
+
+#include "extdll.h"
+
+#include <vector>
+
+// Per-entity data used by AddToFullPack that doesn't depend on the client receiving the update.
+// It's computed for the first client the entity is sent to in a frame and reused for the rest of the clients.
+// Controlled by sv_fullpack_cache.
+class FullPackCache
+{
+public:
+	enum NetworkClass
+	{
+		NETWORK_NEVER = 0,	// No model, not sent to anyone
+		NETWORK_HOST_ONLY,	// NODRAW or spectator, only sent to the client itself
+		NETWORK_PVS,		// Sent when it touches the client's PVS
+		NETWORK_ALWAYS,		// env_sky, sent even when out of PVS
+	};
+
+	struct EntityState
+	{
+		int eflags;
+		int aiment;
+		int owner;
+		int onground;
+		int weaponmodel;
+	};
+
+	// Called from SetupVisibility: a new frame starts when time moves or the clients start over
+	void BeginClient(int clientIndex);
+
+	int GetNetworkClass(int e, edict_t* ent);
+	const EntityState& GetEntityState(int e, edict_t* ent, int player);
+	void Clear();
+
+	// Fills everything but the weapon model, which is only looked up for players
+	static void ComputeEntityState(EntityState& state, edict_t* ent);
+
+private:
+	struct Entry
+	{
+		unsigned int classFrame = 0;
+		unsigned int stateFrame = 0;
+		int networkClass = NETWORK_NEVER;
+		string_t classname = 0;
+		bool sky = false;
+		string_t weaponmodel = 0;
+		int weaponmodelIndex = 0;
+		EntityState state;
+	};
+
+	Entry& GetEntry(int e);
+
+	std::vector<Entry> _entries;
+	unsigned int _frame = 1;
+	float _frameTime = -1.0f;
+	int _lastClient = -1;
+};
+
+extern FullPackCache g_FullPackCache;
+
+#endif
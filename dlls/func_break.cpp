@@ -27,6 +27,7 @@
 #include "decals.h"
 #include "explode.h"
 #include "game.h"
+#include "localmove_cache.h"
 
 extern DLL_GLOBAL Vector	g_vecAttackDir;
 
@@ -852,10 +853,12 @@ void CBreakable::DieToActivator( CBaseEntity* pActivator )
 
 	// Don't fire something that could fire myself
 	pev->targetname = 0;
+	g_EntityNameIndex.Update( edict() );
 	pev->effects |= EF_NODRAW;
 	pev->takedamage = DAMAGE_NO;
 
 	pev->solid = SOLID_NOT;
+	g_LocalMoveCache.Invalidate();
 
 	// Fire targets on break
 	CBaseEntity* pTargetActivator = 0;
@@ -1175,6 +1178,12 @@ void CPushable::Move( CBaseEntity *pOther, int push )
 		}
 	}
 
+	if( length > 0 )
+	{
+		// Local move results around the pushable are stale now
+		g_LocalMoveCache.Invalidate();
+	}
+
 	if( playerTouch )
 	{
 		if( push || pushablemode.value != 0 )
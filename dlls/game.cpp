@@ -32,6 +32,15 @@
 #include "objecthint_spec.h"
 #include "vcs_info.h"
 #include "tex_materials.h"
+#include "ent_name_index.h"
+#include "spatial_grid.h"
+#include "visibility_cache.h"
+#include "node_search.h"
+#include "saverestore_index.h"
+#include "ai_lod.h"
+#include "localmove_cache.h"
+#include "skill.h"
+#include "relationships.h"
 
 ModFeatures g_modFeatures;
 
@@ -795,6 +804,17 @@ cvar_t grenade_jump = { "grenade_jump","1", FCVAR_SERVER };
 
 cvar_t findnearestnodefix = { "findnearestnodefix", "1", FCVAR_SERVER };
 
+cvar_t sv_spatial_grid = { "sv_spatial_grid", "1", FCVAR_SERVER };
+cvar_t sv_visibility_cache = { "sv_visibility_cache", "1", FCVAR_SERVER };
+cvar_t sv_nearest_node_cache = { "sv_nearest_node_cache", "1", FCVAR_SERVER };
+cvar_t sv_saverestore_stats = { "sv_saverestore_stats", "0", FCVAR_SERVER };
+cvar_t sv_ai_lod = { "sv_ai_lod", "1", FCVAR_SERVER };
+cvar_t sv_ai_lod_budget = { "sv_ai_lod_budget", "2", FCVAR_SERVER };
+cvar_t sv_ai_stats = { "sv_ai_stats", "0", FCVAR_SERVER };
+cvar_t sv_localmove_cache = { "sv_localmove_cache", "1", FCVAR_SERVER };
+cvar_t sv_fullpack_cache = { "sv_fullpack_cache", "1", FCVAR_SERVER };
+cvar_t sv_client_ropes = { "sv_client_ropes", "0", FCVAR_SERVER };
+
 cvar_t keepinventory	= { "mp_keepinventory","0", FCVAR_SERVER }; // keep inventory across level transitions in multiplayer coop
 
 // Engine Cvars
@@ -820,7 +840,8 @@ cvar_t name ## 3 = { #name "3", defaultValue3, 0, 0, 0 };
 #define REGISTER_SKILL_CVARS(name) \
 CVAR_REGISTER( &name ## 1 ); \
 CVAR_REGISTER( &name ## 2 ); \
-CVAR_REGISTER( &name ## 3 );
+CVAR_REGISTER( &name ## 3 ); \
+g_SkillCvars.Register( #name, &name ## 1, &name ## 2, &name ## 3 );
 
 //CVARS FOR SKILL LEVEL SETTINGS
 // Agrunt
@@ -1514,6 +1535,8 @@ void GameDLLInit( void )
 	ReadSaveTitles();
 	g_objectHintCatalog.ReadFromFile("templates/objecthint.json");
 	g_MaterialRegistry.ReadFromFile("features/materials.json");
+	g_RelationshipMatrix.ReadFromFile("features/relationships.json");
+	g_RelationshipMatrix.Compile();
 
 	// Register cvars here:
 
@@ -1612,6 +1635,16 @@ void GameDLLInit( void )
 #endif
 
 	CVAR_REGISTER( &findnearestnodefix );
+	CVAR_REGISTER( &sv_spatial_grid );
+	CVAR_REGISTER( &sv_visibility_cache );
+	CVAR_REGISTER( &sv_nearest_node_cache );
+	CVAR_REGISTER( &sv_saverestore_stats );
+	CVAR_REGISTER( &sv_ai_lod );
+	CVAR_REGISTER( &sv_ai_lod_budget );
+	CVAR_REGISTER( &sv_ai_stats );
+	CVAR_REGISTER( &sv_localmove_cache );
+	CVAR_REGISTER( &sv_fullpack_cache );
+	CVAR_REGISTER( &sv_client_ropes );
 
 	CVAR_REGISTER( &keepinventory );
 
@@ -2146,6 +2179,13 @@ void GameDLLInit( void )
 	g_engfuncs.pfnAddServerCommand("dump_soundscripts", ReportSoundScripts);
 	g_engfuncs.pfnAddServerCommand("dump_visuals", ReportVisuals);
 	g_engfuncs.pfnAddServerCommand("dump_materials", ReportMaterials);
+	g_engfuncs.pfnAddServerCommand("dump_entity_name_index", ReportEntityNameIndex);
+	g_engfuncs.pfnAddServerCommand("dump_spatial_grid", ReportSpatialGrid);
+	g_engfuncs.pfnAddServerCommand("dump_visibility_cache", ReportVisibilityCache);
+	g_engfuncs.pfnAddServerCommand("dump_node_search", ReportNodeSearch);
+	g_engfuncs.pfnAddServerCommand("dump_saverestore_stats", ReportSaveRestoreStats);
+	g_engfuncs.pfnAddServerCommand("dump_ai_stats", ReportAIStats);
+	g_engfuncs.pfnAddServerCommand("dump_localmove_cache", ReportLocalMoveCache);
 }
 
 bool ItemsPickableByTouch()
@@ -199,6 +199,17 @@ extern cvar_t sv_busters;
 
 extern cvar_t keepinventory;
 
+extern cvar_t sv_spatial_grid;
+extern cvar_t sv_visibility_cache;
+extern cvar_t sv_nearest_node_cache;
+extern cvar_t sv_saverestore_stats;
+extern cvar_t sv_ai_lod;
+extern cvar_t sv_ai_lod_budget;
+extern cvar_t sv_ai_stats;
+extern cvar_t sv_localmove_cache;
+extern cvar_t sv_fullpack_cache;
+extern cvar_t sv_client_ropes;
+
 // Engine Cvars
 extern cvar_t *g_psv_gravity;
 extern cvar_t *g_psv_maxspeed;
@@ -124,6 +124,8 @@ void CGameRules::RefreshSkillData ( void )
 
 	ALERT( at_console, "\nGAME SKILL LEVEL:%d\n",iSkill );
 
+	g_SkillCvars.BeginRefresh();
+
 	//Agrunt		
 	gSkillData.agruntHealth = GetSkillCvar( "sk_agrunt_health" );
 	gSkillData.agruntDmgPunch = GetSkillCvar( "sk_agrunt_dmg_punch" );
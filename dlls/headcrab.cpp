@@ -107,6 +107,7 @@ public:
 
 	virtual int DefaultSizeForGrapple() { return GRAPPLE_SMALL; }
 	bool IsDisplaceable() { return true; }
+	bool CanBePooled() { return true; }
 	Vector DefaultMinHullSize() { return Vector( -12.0f, -12.0f, 0.0f ); }
 	Vector DefaultMaxHullSize() { return Vector( 12.0f, 12.0f, 24.0f ); }
 
@@ -700,6 +701,7 @@ public:
 	bool ShouldFadeOnDeath() override;
 	int TakeDamage( entvars_t *pevInflictor, entvars_t *pevAttacker, float flDamage, int bitsDamageType );
 	void OnDying();
+	bool CanBePooled() { return false; } // Dies of age since m_flBirthTime
 
 	Vector DefaultMinHullSize() { return Vector( -12.0f, -12.0f, 0.0f ); }
 	Vector DefaultMaxHullSize() { return Vector( 12.0f, 12.0f, 4.0f ); }
@@ -41,6 +41,7 @@ public:
 	int DefaultClassify( void );
 	int Classify( void );
 	int IRelationship( CBaseEntity *pTarget );
+	bool IRelationshipMayOverrideNone() { return true; }
 	virtual int Save( CSave &save );
 	virtual int Restore( CRestore &restore );
 	static TYPEDESCRIPTION m_SaveData[];
@@ -105,6 +105,8 @@ class CHoundeye : public CSquadMonster
 public:
 	void Spawn( void );
 	void Precache( void );
+	void ResetMonsterState( void );
+	bool CanBePooled( void ) { return true; }
 	int DefaultClassify( void );
 	const char* DefaultDisplayName() { return "Houndeye"; }
 	void HandleAnimEvent( MonsterEvent_t *pEvent );
@@ -455,6 +457,14 @@ void CHoundeye::Spawn()
 	MonsterInit();
 }
 
+void CHoundeye::ResetMonsterState()
+{
+	m_iAsleep = HOUNDEYE_AWAKE;
+	m_iBlink = HOUNDEYE_BLINK;
+	m_vecPackCenter = g_vecZero;
+	CSquadMonster::ResetMonsterState();
+}
+
 //=========================================================
 // Precache - precaches all resources this monster needs
 //=========================================================
@@ -82,6 +82,7 @@ void CWorldItem::Spawn( void )
 	{
 		pEntity->pev->target = pev->target;
 		pEntity->pev->targetname = pev->targetname;
+		g_EntityNameIndex.Update( pEntity->edict() );
 		pEntity->pev->spawnflags = pev->spawnflags;
 	}
 
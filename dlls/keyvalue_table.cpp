@@ -0,0 +1,181 @@
+#include "extdll.h"
+#include "util.h"
+#include "keyvalue_table.h"
+
+#include <algorithm>
+#include <cctype>
+
+// Every bucket holds two keys on average and a table is at most half full,
+// so the displacement search for a bucket ends after a few tries
+#define KEYVALUE_KEYS_PER_BUCKET 2
+#define KEYVALUE_MAX_SEED 100000
+
+static unsigned int PowerOfTwoAtLeast(unsigned int n)
+{
+	unsigned int result = 1;
+	while (result < n)
+		result <<= 1;
+	return result;
+}
+
+KeyValueTable::KeyValueTable(const TYPEDESCRIPTION *fields, int count, bool caseSensitive):
+	_fields(fields), _count(count), _caseSensitive(caseSensitive),
+	_compiled(false), _bucketMask(0), _slotMask(0)
+{
+}
+
+unsigned int KeyValueTable::Hash(const char *key, unsigned int seed) const
+{
+	// FNV-1a, the seed picks one of the hash functions of the family
+	unsigned int hash = 2166136261u ^ (seed * 0x9E3779B9u);
+	for (const unsigned char* p = (const unsigned char*)key; *p; ++p)
+	{
+		hash ^= _caseSensitive ? *p : (unsigned char)tolower(*p);
+		hash *= 16777619u;
+	}
+	hash ^= hash >> 15;
+	hash *= 0x2C1B3C6Du;
+	hash ^= hash >> 12;
+	return hash;
+}
+
+bool KeyValueTable::KeysEqual(const char *key1, const char *key2) const
+{
+	return _caseSensitive ? strcmp(key1, key2) == 0 : stricmp(key1, key2) == 0;
+}
+
+void KeyValueTable::Compile() const
+{
+	_compiled = true;
+
+	const unsigned int bucketCount = PowerOfTwoAtLeast(_count / KEYVALUE_KEYS_PER_BUCKET + 1);
+	const unsigned int slotCount = PowerOfTwoAtLeast(_count * 2 + 1);
+	_bucketMask = bucketCount - 1;
+	_slotMask = slotCount - 1;
+	_seeds.assign(bucketCount, 0);
+	_slots.assign(slotCount, 0);
+
+	std::vector<std::vector<int> > buckets(bucketCount);
+	for (int i = 0; i < _count; ++i)
+	{
+		// Equal keys go to the same bucket, the first one wins like in the if-else chains
+		std::vector<int>& bucket = buckets[Hash(_fields[i].fieldName, 0) & _bucketMask];
+		bool duplicate = false;
+		for (int fieldIndex : bucket)
+		{
+			if (KeysEqual(_fields[fieldIndex].fieldName, _fields[i].fieldName))
+				duplicate = true;
+		}
+		if (!duplicate)
+			bucket.push_back(i);
+	}
+
+	// Place the largest buckets first while most of the slots are free
+	std::vector<unsigned int> order(bucketCount);
+	for (unsigned int i = 0; i < bucketCount; ++i)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&buckets](unsigned int a, unsigned int b) {
+		return buckets[a].size() > buckets[b].size();
+	});
+
+	std::vector<unsigned int> bucketSlots;
+	for (unsigned int bucketIndex : order)
+	{
+		const std::vector<int>& bucket = buckets[bucketIndex];
+		if (bucket.empty())
+			break;
+
+		unsigned int seed;
+		for (seed = 1; seed < KEYVALUE_MAX_SEED; ++seed)
+		{
+			bucketSlots.clear();
+			bool fits = true;
+			for (int fieldIndex : bucket)
+			{
+				const unsigned int slot = Hash(_fields[fieldIndex].fieldName, seed) & _slotMask;
+				if (_slots[slot] != 0 || std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+				{
+					fits = false;
+					break;
+				}
+				bucketSlots.push_back(slot);
+			}
+			if (fits)
+				break;
+		}
+
+		if (seed == KEYVALUE_MAX_SEED)
+		{
+			ALERT(at_error, "Couldn't compile the keyvalue table of '%s'\n", _fields[bucket[0]].fieldName);
+			continue;
+		}
+
+		_seeds[bucketIndex] = seed;
+		for (size_t i = 0; i < bucket.size(); ++i)
+			_slots[bucketSlots[i]] = (unsigned short)(bucket[i] + 1);
+	}
+}
+
+const TYPEDESCRIPTION* KeyValueTable::Find(const char *key) const
+{
+	if (!_compiled)
+		Compile();
+
+	const unsigned int seed = _seeds[Hash(key, 0) & _bucketMask];
+	if (seed == 0)
+		return NULL;
+
+	const unsigned short fieldIndex = _slots[Hash(key, seed) & _slotMask];
+	if (fieldIndex == 0)
+		return NULL;
+
+	const TYPEDESCRIPTION* field = &_fields[fieldIndex - 1];
+	return KeysEqual(field->fieldName, key) ? field : NULL;
+}
+
+bool KeyValueTable::Apply(void *base, KeyValueData *pkvd) const
+{
+	const TYPEDESCRIPTION* field = Find(pkvd->szKeyName);
+	if (!field)
+		return false;
+
+	SetField(base, field, pkvd->szValue);
+	pkvd->fHandled = true;
+	return true;
+}
+
+void KeyValueTable::SetField(void *base, const TYPEDESCRIPTION *field, const char *value)
+{
+	void* pOutput = (char *)base + field->fieldOffset;
+	switch( field->fieldType )
+	{
+	case FIELD_MODELNAME:
+	case FIELD_SOUNDNAME:
+	case FIELD_STRING:
+		*(string_t *)pOutput = ALLOC_STRING( value );
+		break;
+	case FIELD_TIME:
+	case FIELD_FLOAT:
+		*(float *)pOutput = atof( value );
+		break;
+	case FIELD_INTEGER:
+		*(int *)pOutput = atoi( value );
+		break;
+	case FIELD_SHORT:
+		*(short *)pOutput = (short)atoi( value );
+		break;
+	case FIELD_CHARACTER:
+		*(char *)pOutput = (char)atoi( value );
+		break;
+	case FIELD_BOOLEAN:
+		*(bool *)pOutput = atoi( value ) != 0;
+		break;
+	case FIELD_POSITION_VECTOR:
+	case FIELD_VECTOR:
+		UTIL_StringToVector( (float *)pOutput, value );
+		break;
+	default:
+		ALERT( at_error, "Bad field in entity!!\n" );
+		break;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef KEYVALUE_TABLE_H
+#define KEYVALUE_TABLE_H
+
+#include <vector>
+#include "arraysize.h"
+
+// Finds the keyvalue fields of a class by key name, declared with DEFINE_KEYVALUE like the save-restore fields.
+// The keys are compiled on first use into a perfect hash (hash and displace),
+// so a lookup is two hashes of the key and at most one string comparison, whatever the number of keys.
+// Keys that aren't in the table are left for the KeyValue of the base class.
+class KeyValueTable
+{
+public:
+	KeyValueTable(const TYPEDESCRIPTION* fields, int count, bool caseSensitive = true);
+
+	const TYPEDESCRIPTION* Find(const char* key) const;
+
+	// Sets the field for the key of the keyvalue and marks it handled. Returns false if the key isn't in the table.
+	bool Apply(void* base, KeyValueData* pkvd) const;
+
+	// Parses the value the way KeyValue functions do for the field type
+	static void SetField(void* base, const TYPEDESCRIPTION* field, const char* value);
+
+private:
+	void Compile() const;
+	unsigned int Hash(const char* key, unsigned int seed) const;
+	bool KeysEqual(const char* key1, const char* key2) const;
+
+	const TYPEDESCRIPTION* _fields;
+	int _count;
+	bool _caseSensitive;
+
+	mutable bool _compiled;
+	mutable unsigned int _bucketMask;
+	mutable unsigned int _slotMask;
+	mutable std::vector<unsigned int> _seeds;
+	// Index of the field + 1, 0 for free slots
+	mutable std::vector<unsigned short> _slots;
+};
+
+#define IMPLEMENT_KEYVALUES(derivedClass) \
+	KeyValueTable derivedClass::m_KeyValueTable( derivedClass::m_KeyValueData, ARRAYSIZE( derivedClass::m_KeyValueData ) );
+
+#endif
@@ -108,6 +108,7 @@ public:
 	int DefaultClassify( void ) { return CLASS_INSECT; }
 	const char* DefaultDisplayName() { return "Leech"; }
 	int IRelationship( CBaseEntity *pTarget );
+	bool IRelationshipMayOverrideNone() { return true; }
 
 	virtual int Save( CSave &save );
 	virtual int Restore( CRestore &restore );
@@ -0,0 +1,121 @@
+#include "extdll.h"
+#include "util.h"
+#include "localmove_cache.h"
+
+#include <cmath>
+#include <cstring>
+
+LocalMoveCache g_LocalMoveCache;
+
+// Monsters blocking the way don't invalidate the cache, so results are only trusted for a moment
+#define LOCALMOVE_CACHE_LIFETIME 0.5f
+
+static int Quantize(float value, int units)
+{
+	return (int)floorf(value / units);
+}
+
+void LocalMoveCache::MakeQuery(Query &query, const Vector &vecStart, const Vector &vecEnd, const Vector &vecMins, const Vector &vecMaxs, int flags, int target)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		query.start[i] = Quantize(vecStart[i], QUANTIZE_UNITS);
+		query.end[i] = Quantize(vecEnd[i], QUANTIZE_UNITS);
+		query.mins[i] = Quantize(vecMins[i], 1);
+		query.maxs[i] = Quantize(vecMaxs[i], 1);
+	}
+	query.flags = flags;
+	query.target = target;
+}
+
+unsigned int LocalMoveCache::HashQuery(const Query &query)
+{
+	// FNV-1a over the query fields
+	const int* values = (const int*)&query;
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < sizeof(Query) / sizeof(int); ++i)
+	{
+		hash = (hash ^ (unsigned int)values[i]) * 16777619u;
+	}
+	return hash;
+}
+
+void LocalMoveCache::CountFrame()
+{
+	if (_lastFrameTime != gpGlobals->time)
+	{
+		_lastFrameTime = gpGlobals->time;
+		_frames++;
+	}
+}
+
+bool LocalMoveCache::Lookup(const Query &query, int &result, float &dist)
+{
+	CountFrame();
+	_checks++;
+
+	const Entry& entry = _entries[HashQuery(query) & (CACHE_ENTRIES - 1)];
+	if (!entry.used || entry.generation != _generation || memcmp(&entry.query, &query, sizeof(Query)) != 0)
+		return false;
+	// Time goes back on level change and restore
+	if (entry.time > gpGlobals->time || gpGlobals->time - entry.time > LOCALMOVE_CACHE_LIFETIME)
+		return false;
+
+	result = entry.result;
+	dist = entry.dist;
+	_hits++;
+	return true;
+}
+
+void LocalMoveCache::Store(const Query &query, int result, float dist)
+{
+	Entry& entry = _entries[HashQuery(query) & (CACHE_ENTRIES - 1)];
+	entry.query = query;
+	entry.result = result;
+	entry.dist = dist;
+	entry.time = gpGlobals->time;
+	entry.generation = _generation;
+	entry.used = true;
+}
+
+void LocalMoveCache::Invalidate()
+{
+	_generation++;
+	_invalidations++;
+}
+
+void LocalMoveCache::CountSteps(int steps)
+{
+	_steps += steps;
+}
+
+void LocalMoveCache::CountCoarseRejection()
+{
+	_coarseRejections++;
+}
+
+void LocalMoveCache::Report()
+{
+	const float frames = _frames ? (float)_frames : 1.0f;
+	ALERT(at_console, "Local move checks: %u in %u frames (%.2f per frame)\n", _checks, _frames, _checks / frames);
+	ALERT(at_console, "Cache hits: %u (%.1f%%), coarse rejections: %u\n", _hits, _checks ? _hits * 100.0f / _checks : 0.0f, _coarseRejections);
+	ALERT(at_console, "Walk steps: %u (%.2f per frame)\n", _steps, _steps / frames);
+	ALERT(at_console, "Invalidations: %u\n", _invalidations);
+}
+
+void LocalMoveCache::ResetCounters()
+{
+	_frames = 0;
+	_checks = 0;
+	_hits = 0;
+	_coarseRejections = 0;
+	_steps = 0;
+	_invalidations = 0;
+}
+
+void ReportLocalMoveCache()
+{
+	g_LocalMoveCache.Report();
+	if (CMD_ARGC() > 1 && FStrEq(CMD_ARGV(1), "reset"))
+		g_LocalMoveCache.ResetCounters();
+}
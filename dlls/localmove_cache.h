@@ -0,0 +1,69 @@
+#pragma once
+#ifndef LOCALMOVE_CACHE_H
+#define LOCALMOVE_CACHE_H
+
+#include "vector.h"
+
+// Remembers recent CheckLocalMove results by quantized start, end and hull, controlled by sv_localmove_cache.
+// Entries expire after a short time, since monsters blocking the way move around,
+// and are all dropped whenever a brush entity starts or stops moving or is toggled.
+// Moves blocked by monsters or clients aren't remembered, the result depends on the asking monster.
+class LocalMoveCache
+{
+public:
+	enum {
+		CACHE_ENTRIES = 4096,
+		QUANTIZE_UNITS = 8,
+	};
+
+	struct Query
+	{
+		int start[3];
+		int end[3];
+		int mins[3];
+		int maxs[3];
+		int flags;
+		int target;
+	};
+
+	static void MakeQuery(Query& query, const Vector& vecStart, const Vector& vecEnd, const Vector& vecMins, const Vector& vecMaxs, int flags, int target);
+	bool Lookup(const Query& query, int& result, float& dist);
+	void Store(const Query& query, int result, float dist);
+	void Invalidate();
+
+	void CountSteps(int steps);
+	void CountCoarseRejection();
+	void Report();
+	void ResetCounters();
+
+private:
+	struct Entry
+	{
+		Query query;
+		int result;
+		float dist;
+		float time;
+		unsigned int generation;
+		bool used;
+	};
+
+	static unsigned int HashQuery(const Query& query);
+	void CountFrame();
+
+	Entry _entries[CACHE_ENTRIES] = {};
+	unsigned int _generation = 1;
+
+	float _lastFrameTime = -1.0f;
+	unsigned int _frames = 0;
+	unsigned int _checks = 0;
+	unsigned int _hits = 0;
+	unsigned int _coarseRejections = 0;
+	unsigned int _steps = 0;
+	unsigned int _invalidations = 0;
+};
+
+extern LocalMoveCache g_LocalMoveCache;
+
+void ReportLocalMoveCache();
+
+#endif
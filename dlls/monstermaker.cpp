@@ -66,6 +66,7 @@ typedef enum
 } MONSTERMAKER_TARGET_ACTIVATOR;
 
 #define MAX_CHILD_KEYS 16
+#define MAX_MONSTERMAKER_POOL 32
 
 //=========================================================
 // MonsterMaker - this ent creates monsters during the game.
@@ -88,6 +89,12 @@ public:
 	void GetRealHullSizes(Vector& minHullSize, Vector& maxHullSize);
 	int CalculateSpot(const Vector& testMinHullSize, const Vector& testMaxHullSize, Vector& placePosition, Vector& placeAngles, edict_t*& warpballSoundEnt, float spawnDelay);
 	CBaseEntity* SpawnMonster(const Vector& placePosition, const Vector& placeAngles);
+	CBaseEntity* CreateMonster(const Vector& placePosition, const Vector& placeAngles);
+	CBaseEntity* RespawnPooledMonster(const Vector& placePosition, const Vector& placeAngles);
+	void CapturePrototype(CBaseEntity* pEntity);
+	bool RecycleChild( CBaseEntity *pChild );
+	void ClearPool();
+	void UpdateOnRemove();
 	void StartWarpballEffect(const Vector& vecPosition, edict_t* warpballSoundEnt);
 	string_t WarpballName() {
 		return pev->message;
@@ -97,6 +104,8 @@ public:
 	virtual int Restore( CRestore &restore );
 
 	static TYPEDESCRIPTION m_SaveData[];
+	static TYPEDESCRIPTION m_KeyValueData[];
+	static KeyValueTable m_KeyValueTable;
 
 	string_t m_iszMonsterClassname;// classname of the monster(s) that will be created.
 
@@ -138,6 +147,26 @@ public:
 	int m_childKeyCount;
 
 	bool m_childIsValid;
+
+	void ResolveChildKeys();
+	// Entvars fields of the child keys, resolved once instead of on every spawn. Not saved.
+	const TYPEDESCRIPTION* m_childKeyFields[MAX_CHILD_KEYS];
+	bool m_childKeysResolved;
+
+	// Dead children kept to be spawned again instead of creating new entities
+	int m_poolSize;
+	EHANDLE m_pool[MAX_MONSTERMAKER_POOL];
+	int m_pooledCount;
+
+	// State of a freshly spawned child. Pooled children are reset to it. Not saved, captured again on the next new child.
+	bool m_prototypeValid;
+	string_t m_prototypeClassname;
+	entvars_t m_prototypeVars;
+	float m_prototypeTime;
+	BASEPTR m_prototypeThink;
+	ENTITYFUNCPTR m_prototypeTouch;
+	USEPTR m_prototypeUse;
+	ENTITYFUNCPTR m_prototypeBlocked;
 };
 
 LINK_ENTITY_TO_CLASS( monstermaker, CMonsterMaker )
@@ -176,127 +205,49 @@ TYPEDESCRIPTION	CMonsterMaker::m_SaveData[] =
 	DEFINE_ARRAY( CMonsterMaker, m_childKeys, FIELD_STRING, MAX_CHILD_KEYS ),
 	DEFINE_ARRAY( CMonsterMaker, m_childValues, FIELD_STRING, MAX_CHILD_KEYS ),
 	DEFINE_FIELD( CMonsterMaker, m_childKeyCount, FIELD_INTEGER ),
+	DEFINE_FIELD( CMonsterMaker, m_poolSize, FIELD_INTEGER ),
+	DEFINE_ARRAY( CMonsterMaker, m_pool, FIELD_EHANDLE, MAX_MONSTERMAKER_POOL ),
+	DEFINE_FIELD( CMonsterMaker, m_pooledCount, FIELD_INTEGER ),
 };
 
 IMPLEMENT_SAVERESTORE( CMonsterMaker, CBaseMonster )
 
+TYPEDESCRIPTION CMonsterMaker::m_KeyValueData[] =
+{
+	DEFINE_KEYVALUE( CMonsterMaker, m_cNumMonsters, FIELD_INTEGER, "monstercount" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iMaxLiveChildren, FIELD_INTEGER, "m_imaxlivechildren" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iszMonsterClassname, FIELD_STRING, "monstertype" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_customModel, FIELD_STRING, "new_model" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iPose, FIELD_INTEGER, "pose" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_notSolid, FIELD_BOOLEAN, "notsolid" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_gag, FIELD_BOOLEAN, "gag" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iHead, FIELD_INTEGER, "head" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iszTriggerTarget, FIELD_STRING, "trigger_target" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iTriggerCondition, FIELD_SHORT, "trigger_condition" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iTriggerAltCondition, FIELD_SHORT, "trigger_alt_condition" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_reverseRelationship, FIELD_BOOLEAN, "respawn_as_playerally" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_targetActivator, FIELD_SHORT, "target_activator" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iszPlacePosition, FIELD_STRING, "spawnorigin" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iMaxYawDeviation, FIELD_SHORT, "yawdeviation" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_followFailPolicy, FIELD_SHORT, "followfailpolicy" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iszUse, FIELD_STRING, "UseSentence" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iszUnUse, FIELD_STRING, "UnUseSentence" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_iszDecline, FIELD_STRING, "RefusalSentence" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_followagePolicy, FIELD_SHORT, "followage_policy" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_spawnDelay, FIELD_FLOAT, "spawndelay" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_delayAfterBlocked, FIELD_FLOAT, "delay_after_blocked" ),
+	DEFINE_KEYVALUE( CMonsterMaker, m_poolSize, FIELD_INTEGER, "poolsize" ),
+};
+
+IMPLEMENT_KEYVALUES( CMonsterMaker )
+
 void CMonsterMaker::KeyValue( KeyValueData *pkvd )
 {
-	if( FStrEq( pkvd->szKeyName, "monstercount" ) )
-	{
-		m_cNumMonsters = atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "m_imaxlivechildren" ) )
-	{
-		m_iMaxLiveChildren = atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "monstertype" ) )
-	{
-		m_iszMonsterClassname = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "warpball" ) || FStrEq( pkvd->szKeyName, "xenmaker" ) )
+	if ( FStrEq( pkvd->szKeyName, "warpball" ) || FStrEq( pkvd->szKeyName, "xenmaker" ) )
 	{
 		pev->message = ALLOC_STRING( pkvd->szValue );
 		pkvd->fHandled = true;
 	}
-	else if ( FStrEq( pkvd->szKeyName, "new_model" ) )
-	{
-		m_customModel = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "pose" ) )
-	{
-		m_iPose = atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "notsolid" ) )
-	{
-		m_notSolid = atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "gag" ) )
-	{
-		m_gag = atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "head" ) )
-	{
-		m_iHead = atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "trigger_target" ) )
-	{
-		m_iszTriggerTarget = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "trigger_condition" ) )
-	{
-		m_iTriggerCondition = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "trigger_alt_condition" ) )
-	{
-		m_iTriggerAltCondition = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "respawn_as_playerally" ) )
-	{
-		m_reverseRelationship = atoi( pkvd->szValue ) != 0;
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "target_activator" ) )
-	{
-		m_targetActivator = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "spawnorigin" ) )
-	{
-		m_iszPlacePosition = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "yawdeviation" ) )
-	{
-		m_iMaxYawDeviation = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "followfailpolicy" ) )
-	{
-		m_followFailPolicy = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "UseSentence" ) )
-	{
-		m_iszUse = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "UnUseSentence" ) )
-	{
-		m_iszUnUse = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if (FStrEq( pkvd->szKeyName, "RefusalSentence" ))
-	{
-		m_iszDecline = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "followage_policy" ) )
-	{
-		m_followagePolicy = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "spawndelay" ) )
-	{
-		m_spawnDelay = atof( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "delay_after_blocked" ) )
-	{
-		m_delayAfterBlocked = atof( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
 	else if ( pkvd->szKeyName[0] == '#' )
 	{
 		if (m_childKeyCount < MAX_CHILD_KEYS)
@@ -310,7 +261,7 @@ void CMonsterMaker::KeyValue( KeyValueData *pkvd )
 			ALERT(at_warning, "%s: Too many child keys", STRING(pev->classname));
 		}
 	}
-	else
+	else if ( !m_KeyValueTable.Apply( this, pkvd ) )
 		CBaseMonster::KeyValue( pkvd );
 }
 
@@ -326,6 +277,11 @@ void CMonsterMaker::Spawn()
 	}
 
 	m_cLiveChildren = 0;
+	if (m_poolSize > MAX_MONSTERMAKER_POOL)
+	{
+		ALERT(at_warning, "%s: pool size %d is too big, using %d\n", STRING(pev->classname), m_poolSize, MAX_MONSTERMAKER_POOL);
+		m_poolSize = MAX_MONSTERMAKER_POOL;
+	}
 	Precache();
 	if( !FStringNull( pev->targetname ) )
 	{
@@ -650,7 +606,16 @@ int CMonsterMaker::CalculateSpot(const Vector &testMinHullSize, const Vector &te
 	return 0;
 }
 
-CBaseEntity* CMonsterMaker::SpawnMonster(const Vector &placePosition, const Vector &placeAngles)
+void CMonsterMaker::ResolveChildKeys()
+{
+	for (int i=0; i<m_childKeyCount; ++i)
+	{
+		m_childKeyFields[i] = FindEntvarsKeyvalueField(STRING(m_childKeys[i]));
+	}
+	m_childKeysResolved = true;
+}
+
+CBaseEntity* CMonsterMaker::CreateMonster(const Vector &placePosition, const Vector &placeAngles)
 {
 	if (!CheckMonsterClassname())
 		return 0;
@@ -668,6 +633,12 @@ CBaseEntity* CMonsterMaker::SpawnMonster(const Vector &placePosition, const Vect
 
 	if (m_childKeyCount > 0)
 	{
+		if (!m_childKeysResolved)
+			ResolveChildKeys();
+
+		CBaseEntity *pChild = (CBaseEntity *)GET_PRIVATE( pent );
+		bool entvarsChanged = false;
+
 		const char* classname = STRING(pevCreate->classname);
 		KeyValueData kvd;
 		kvd.szClassName = classname;
@@ -683,8 +654,24 @@ CBaseEntity* CMonsterMaker::SpawnMonster(const Vector &placePosition, const Vect
 				continue;
 			}
 
+			const TYPEDESCRIPTION* pField = m_childKeyFields[i];
+			if (pField && pChild)
+			{
+				// Same order as in DispatchKeyValue, but without looking up the entvars field again
+				pChild->PreEntvarsKeyvalue(&kvd);
+				if (!kvd.fHandled)
+				{
+					KeyValueTable::SetField(pevCreate, pField, kvd.szValue);
+					entvarsChanged = true;
+				}
+				continue;
+			}
+
 			DispatchKeyValue(pent, &kvd);
 		}
+
+		if (entvarsChanged)
+			g_EntityNameIndex.Update( pent );
 	}
 
 	pevCreate->body = pev->body;
@@ -809,7 +796,161 @@ CBaseEntity* CMonsterMaker::SpawnMonster(const Vector &placePosition, const Vect
 	{
 		// if I have a netname (overloaded), give the child monster that name as a targetname
 		pevCreate->targetname = pev->netname;
+		g_EntityNameIndex.Update( ENT( pevCreate ) );
+	}
+
+	CBaseEntity* pCreated = CBaseEntity::Instance(pevCreate);
+	if (m_poolSize > 0 && pCreated)
+		CapturePrototype(pCreated);
+
+	return pCreated;
+}
+
+void CMonsterMaker::CapturePrototype(CBaseEntity *pEntity)
+{
+	CBaseMonster* pMonster = pEntity->MyMonsterPointer();
+	m_prototypeValid = pMonster != NULL && pMonster->CanBePooled() && !FBitSet(pEntity->pev->flags, FL_KILLME);
+	m_prototypeClassname = m_iszMonsterClassname;
+	m_prototypeVars = *pEntity->pev;
+	m_prototypeTime = gpGlobals->time;
+	m_prototypeThink = pEntity->m_pfnThink;
+	m_prototypeTouch = pEntity->m_pfnTouch;
+	m_prototypeUse = pEntity->m_pfnUse;
+	m_prototypeBlocked = pEntity->m_pfnBlocked;
+}
+
+CBaseEntity* CMonsterMaker::RespawnPooledMonster(const Vector &placePosition, const Vector &placeAngles)
+{
+	if (!m_prototypeValid || !FStrEq(STRING(m_prototypeClassname), STRING(m_iszMonsterClassname)))
+		return NULL;
+
+	while (m_pooledCount > 0)
+	{
+		m_pooledCount--;
+		CBaseEntity* pEntity = m_pool[m_pooledCount];
+		m_pool[m_pooledCount] = NULL;
+
+		// Could have been removed while waiting in the pool
+		if (!pEntity)
+			continue;
+		if (!FStrEq(STRING(pEntity->pev->classname), STRING(m_prototypeVars.classname)))
+		{
+			UTIL_Remove(pEntity);
+			continue;
+		}
+
+		// Reset the entity to the state it had right after spawning instead of spawning it again
+		edict_t* pent = pEntity->edict();
+		entvars_t* pevCreate = pEntity->pev;
+		*pevCreate = m_prototypeVars;
+		pevCreate->pContainingEntity = pent;
+		pevCreate->owner = edict();
+		pevCreate->groundentity = NULL;
+		pevCreate->chain = NULL;
+		pevCreate->enemy = NULL;
+		pevCreate->dmg_inflictor = NULL;
+		pevCreate->angles = placeAngles;
+		pevCreate->ideal_yaw = placeAngles.y;
+		pevCreate->animtime = gpGlobals->time;
+		if (m_prototypeVars.nextthink > 0)
+			pevCreate->nextthink = gpGlobals->time + (m_prototypeVars.nextthink - m_prototypeTime);
+
+		pEntity->m_pfnThink = m_prototypeThink;
+		pEntity->m_pfnTouch = m_prototypeTouch;
+		pEntity->m_pfnUse = m_prototypeUse;
+		pEntity->m_pfnBlocked = m_prototypeBlocked;
+
+		CBaseMonster* pMonster = pEntity->MyMonsterPointer();
+		if (pMonster)
+			pMonster->ResetMonsterState();
+
+		UTIL_SetOrigin(pevCreate, placePosition);
+		g_EntityNameIndex.Update(pent);
+		return pEntity;
 	}
+	return NULL;
+}
+
+bool CMonsterMaker::RecycleChild(CBaseEntity *pChild)
+{
+	if (m_poolSize <= 0 || m_cNumMonsters == 0 || !m_prototypeValid)
+		return false;
+
+	CBaseMonster* pMonster = pChild->MyMonsterPointer();
+	if (!pMonster || !pMonster->CanBePooled() || !pMonster->HasMemory(bits_MEMORY_KILLED))
+		return false;
+	if (!FStrEq(STRING(pChild->pev->classname), STRING(m_prototypeVars.classname)))
+		return false;
+
+	// Forget the children that were removed while waiting
+	int count = 0;
+	for (int i=0; i<m_pooledCount; ++i)
+	{
+		if (m_pool[i] != 0)
+			m_pool[count++] = m_pool[i];
+	}
+	for (int i=count; i<m_pooledCount; ++i)
+		m_pool[i] = NULL;
+	m_pooledCount = count;
+
+	if (m_pooledCount >= m_poolSize)
+		return false;
+
+	// Clean up like on removal, but keep the entity hidden until the next spawn
+	pChild->UpdateOnRemove();
+	pChild->ResetThink();
+	pChild->ResetTouch();
+	pChild->ResetUse();
+	pChild->ResetBlocked();
+
+	entvars_t* pevChild = pChild->pev;
+	pevChild->nextthink = 0;
+	pevChild->health = 0;
+	pevChild->takedamage = DAMAGE_NO;
+	pevChild->solid = SOLID_NOT;
+	pevChild->movetype = MOVETYPE_NONE;
+	pevChild->velocity = g_vecZero;
+	pevChild->avelocity = g_vecZero;
+	pevChild->effects |= EF_NODRAW;
+	ClearBits(pevChild->flags, FL_MONSTER);
+	pevChild->targetname = iStringNull;
+	g_EntityNameIndex.Update(pChild->edict());
+	UTIL_SetOrigin(pevChild, pevChild->origin);
+
+	// Invalidate the handles other entities keep to the dead monster, like the engine does when freeing an edict
+	pChild->edict()->serialnumber++;
+
+	m_pool[m_pooledCount++] = pChild;
+	return true;
+}
+
+void CMonsterMaker::ClearPool()
+{
+	for (int i=0; i<m_pooledCount; ++i)
+	{
+		CBaseEntity* pEntity = m_pool[i];
+		if (pEntity)
+			UTIL_Remove(pEntity);
+		m_pool[i] = NULL;
+	}
+	m_pooledCount = 0;
+}
+
+void CMonsterMaker::UpdateOnRemove()
+{
+	ClearPool();
+	CBaseMonster::UpdateOnRemove();
+}
+
+CBaseEntity* CMonsterMaker::SpawnMonster(const Vector &placePosition, const Vector &placeAngles)
+{
+	CBaseEntity* pEntity = m_poolSize > 0 ? RespawnPooledMonster(placePosition, placeAngles) : NULL;
+	if (!pEntity)
+		pEntity = CreateMonster(placePosition, placeAngles);
+	if (!pEntity)
+		return 0;
+
+	CBaseMonster* createdMonster = pEntity->MyMonsterPointer();
 
 	m_cLiveChildren++;// count this monster
 	if (m_cNumMonsters > 0)
@@ -820,6 +961,7 @@ CBaseEntity* CMonsterMaker::SpawnMonster(const Vector &placePosition, const Vect
 		// Disable this forever.  Don't kill it because it still gets death notices
 		SetThink( NULL );
 		SetUse( NULL );
+		ClearPool();
 	}
 
 	// If I have a target, fire!
@@ -849,7 +991,7 @@ CBaseEntity* CMonsterMaker::SpawnMonster(const Vector &placePosition, const Vect
 		FireTargets( STRING( pev->target ), pActivator, this );
 	}
 
-	return CBaseEntity::Instance(pevCreate);
+	return pEntity;
 }
 
 void CMonsterMaker::StartWarpballEffect(const Vector &vecPosition, edict_t* warpballSoundEnt)
@@ -40,6 +40,9 @@
 #include "visuals_utils.h"
 #include "classify.h"
 #include "studio.h"
+#include "ai_lod.h"
+#include "localmove_cache.h"
+#include "relationships.h"
 
 #define MONSTER_CUT_CORNER_DIST		8 // 8 means the monster's bounding box is contained without the box of the node in WC
 
@@ -247,21 +250,28 @@ void CBaseMonster::Listen( void )
 		iMySounds &= m_pSchedule->iSoundMask;
 	}
 
-	iSound = CSoundEnt::ActiveList();
-
 	// UNDONE: Clear these here?
 	ClearConditions( bits_COND_HEAR_SOUND | bits_COND_SMELL_FOOD | bits_COND_SMELL );
 	hearingSensitivity = HearingSensitivity();
 
-	while( iSound != SOUNDLIST_EMPTY )
+	if( !iMySounds )
+		return;
+
+	const Vector vecEar = EarPosition();
+	int sounds[MAX_WORLD_SOUNDS_LIMIT];
+	const int soundCount = CSoundEnt::SoundsInRange( iMySounds, vecEar, hearingSensitivity, sounds, ARRAYSIZE( sounds ) );
+
+	for( int i = 0; i < soundCount; i++ )
 	{
+		iSound = sounds[i];
 		pCurrentSound = CSoundEnt::SoundPointerForIndex( iSound );
+		if( !pCurrentSound )
+			continue;
 
-		if( pCurrentSound &&
-			( pCurrentSound->m_iType & iMySounds )	&&
-			( pCurrentSound->m_vecOrigin - EarPosition() ).Length() <= pCurrentSound->m_iVolume * hearingSensitivity )
-
-		//if( ( g_pSoundEnt->m_SoundPool[iSound].m_iType & iMySounds ) && ( g_pSoundEnt->m_SoundPool[iSound].m_vecOrigin - EarPosition()).Length () <= g_pSoundEnt->m_SoundPool[iSound].m_iVolume * hearingSensitivity )
+		const float flHearingDistance = pCurrentSound->m_iVolume * hearingSensitivity;
+		const Vector vecToSound = pCurrentSound->m_vecOrigin - vecEar;
+		if( flHearingDistance >= 0 &&
+			DotProduct( vecToSound, vecToSound ) <= flHearingDistance * flHearingDistance )
 		{
  			// the monster cares about this sound, and it's close enough to hear.
 			//g_pSoundEnt->m_SoundPool[iSound].m_iNextAudible = m_iAudibleList;
@@ -294,10 +304,6 @@ void CBaseMonster::Listen( void )
 
 			m_iAudibleList = iSound;
 		}
-
-		//iSound = g_pSoundEnt->m_SoundPool[iSound].m_iNext;
-		if( pCurrentSound )
-			iSound = pCurrentSound->m_iNext;
 	}
 }
 
@@ -353,16 +359,26 @@ void CBaseMonster::Look( int iDistance )
 
 		// Find only monsters/clients in box, NOT limited to PVS
 		int count = UTIL_EntitiesInBox( pList, 100, pev->origin - delta, pev->origin + delta, FL_CLIENT | FL_MONSTER );
+
+		// Classify can change at any time (templates, trigger_change_class, owners), so it's resolved once per Look.
+		// Candidates we have no relationship with are rejected by the row before any virtual call or trace.
+		const int myClassify = Classify();
+		const signed char* relationshipRow = IRelationshipMayOverrideNone() ? NULL : g_RelationshipMatrix.Row( myClassify );
+
 		for( int i = 0; i < count; i++ )
 		{
 			pSightEnt = pList[i];
+			if( pSightEnt == this || pSightEnt->pev->health <= 0 )
+				continue;
+
+			const int sightClassify = pSightEnt->Classify();
+			if( relationshipRow && ( sightClassify < 0 || sightClassify >= CLASS_NUMBER_OF_CLASSES || relationshipRow[sightClassify] == R_NO ) )
+				continue;
+
 			// !!!temporarily only considering other monsters and clients, don't see prisoners
-			if( pSightEnt != this && 
-				 !FBitSet( pSightEnt->pev->spawnflags, SF_MONSTER_PRISONER ) && 
-				 (!m_prisonerTo || m_prisonerTo != pSightEnt->Classify()) &&
-				 pSightEnt->pev->health > 0 )
+			if( !FBitSet( pSightEnt->pev->spawnflags, SF_MONSTER_PRISONER ) && 
+				 (!m_prisonerTo || m_prisonerTo != sightClassify) )
 			{
-				const int myClassify = Classify();
 				CBaseMonster* pSightMonster = pSightEnt->MyMonsterPointer();
 				if (pSightMonster)
 				{
@@ -577,7 +593,9 @@ CSound *CBaseMonster::PBestScent( void )
 //=========================================================
 void CBaseMonster::MonsterThink( void )
 {
-	pev->nextthink = gpGlobals->time + 0.1f;// keep monster thinking.
+	const double thinkStart = sv_ai_stats.value ? AILevelOfDetail::Clock() : 0.0;
+	m_aiLodTier = g_AILevelOfDetail.ChooseTier( this );
+	pev->nextthink = gpGlobals->time + g_AILevelOfDetail.ThinkInterval( this, m_aiLodTier );// keep monster thinking.
 
 	RunAI();
 	GlowShellUpdate();
@@ -623,6 +641,9 @@ void CBaseMonster::MonsterThink( void )
 			ALERT( at_error, "Schedule stalled!!\n" );
 	}
 #endif
+
+	if( sv_ai_stats.value )
+		g_AILevelOfDetail.CountThink( m_aiLodTier, AILevelOfDetail::Clock() - thinkStart );
 }
 
 //=========================================================
@@ -1460,6 +1481,7 @@ void CBaseMonster::SetSequenceByName( const char *szSequence )
 // DON"T USE SETORIGIN! 
 //=========================================================
 #define	LOCAL_STEP_SIZE	16
+#define LOCAL_COARSE_CHECK_DIST 128
 int CBaseMonster::CheckLocalMove( const Vector &vecStart, const Vector &vecEnd, CBaseEntity *pTarget, float *pflDist )
 {
 	Vector vecStartPos;// record monster's position before trying the move
@@ -1468,11 +1490,32 @@ int CBaseMonster::CheckLocalMove( const Vector &vecStart, const Vector &vecEnd,
 	float flStep, stepSize;
 	int iReturn;
 
+	// Recent results for about the same segment are reused, see localmove_cache.h
+	LocalMoveCache::Query query;
+	const bool useCache = sv_localmove_cache.value != 0;
+	if( useCache )
+	{
+		int queryFlags = pev->flags & ( FL_FLY | FL_SWIM | FL_MONSTERCLIP );
+		if( pTarget && ( pTarget->pev->flags & FL_ONGROUND ) )
+			queryFlags |= FL_ONGROUND;
+		LocalMoveCache::MakeQuery( query, vecStart, vecEnd, pev->mins, pev->maxs, queryFlags, pTarget ? pTarget->entindex() : 0 );
+
+		float flCachedDist;
+		if( g_LocalMoveCache.Lookup( query, iReturn, flCachedDist ) )
+		{
+			if( pflDist != NULL && flCachedDist >= 0.0f )
+				*pflDist = flCachedDist;
+			return iReturn;
+		}
+	}
+
 	vecStartPos = pev->origin;
 
 	flYaw = UTIL_VecToYaw( vecEnd - vecStart );// build a yaw that points to the goal.
 	flDist = ( vecEnd - vecStart ).Length2D();// get the distance.
 	iReturn = LOCALMOVE_VALID;// assume everything will be ok.
+	float flFailDist = -1.0f;
+	edict_t *pentBlocker = NULL;// what stopped the move, if anything
 
 	// move the monster to the start of the local move that's to be checked.
 	UTIL_SetOrigin( pev, vecStart );// !!!BUGBUG - won't this fire triggers? - nope, SetOrigin doesn't fire
@@ -1482,6 +1525,31 @@ int CBaseMonster::CheckLocalMove( const Vector &vecStart, const Vector &vecEnd,
 		DROP_TO_FLOOR( ENT( pev ) );//make sure monster is on the floor!
 	}
 
+	flStep = 0;
+	if( useCache && !( pev->flags & ( FL_FLY | FL_SWIM ) ) && flDist > LOCAL_COARSE_CHECK_DIST && fabs( vecEnd.z - pev->origin.z ) <= LOCAL_STEP_SIZE )
+	{
+		// Coarse check before stepping: a wall that blocks the hull both at the floor and a step higher,
+		// at the same distance, can't be climbed or stepped over, so the walk would fail there.
+		const Vector vecStepUp = Vector( 0, 0, CVAR_GET_FLOAT( "sv_stepsize" ) );
+		const Vector vecFlatEnd = Vector( vecEnd.x, vecEnd.y, pev->origin.z );
+		TraceResult trLow, trHigh;
+		TRACE_MONSTER_HULL( edict(), pev->origin, vecFlatEnd, dont_ignore_monsters, edict(), &trLow );
+		if( !trLow.fStartSolid && trLow.flFraction < 1.0f && trLow.vecPlaneNormal.z < 0.7f && ( !pTarget || trLow.pHit != pTarget->edict() ) )
+		{
+			TRACE_MONSTER_HULL( edict(), pev->origin + vecStepUp, vecFlatEnd + vecStepUp, dont_ignore_monsters, edict(), &trHigh );
+			if( !trHigh.fStartSolid && trHigh.flFraction < 1.0f && trHigh.vecPlaneNormal.z < 0.7f && trHigh.pHit == trLow.pHit &&
+				fabs( trHigh.flFraction - trLow.flFraction ) * flDist < 1.0f )
+			{
+				g_LocalMoveCache.CountCoarseRejection();
+				pentBlocker = trLow.pHit;
+				// The fine check would have stopped at the last whole step before the wall
+				flFailDist = (int)( trLow.flFraction * flDist / LOCAL_STEP_SIZE ) * LOCAL_STEP_SIZE;
+				iReturn = LOCALMOVE_INVALID;
+				flStep = flDist;
+			}
+		}
+	}
+
 	//pev->origin.z = vecStartPos.z;//!!!HACKHACK
 
 	//pev->origin = vecStart;
@@ -1499,7 +1567,8 @@ int CBaseMonster::CheckLocalMove( const Vector &vecStart, const Vector &vecEnd,
 	}
 */
 	// this loop takes single steps to the goal.
-	for( flStep = 0; flStep < flDist; flStep += LOCAL_STEP_SIZE )
+	int iSteps = 0;
+	for( ; flStep < flDist; flStep += LOCAL_STEP_SIZE )
 	{
 		stepSize = LOCAL_STEP_SIZE;
 
@@ -1508,13 +1577,12 @@ int CBaseMonster::CheckLocalMove( const Vector &vecStart, const Vector &vecEnd,
 
 		//UTIL_ParticleEffect( pev->origin, g_vecZero, 255, 25 );
 
+		iSteps++;
 		if( !WALK_MOVE( ENT( pev ), flYaw, stepSize, WALKMOVE_CHECKONLY ) )
 		{
 			// can't take the next step, fail!
-			if( pflDist != NULL )
-			{
-				*pflDist = flStep;
-			}
+			flFailDist = flStep;
+			pentBlocker = gpGlobals->trace_ent;
 			if( pTarget && pTarget->edict() == gpGlobals->trace_ent )
 			{
 				// if this step hits target ent, the move is legal.
@@ -1558,6 +1626,19 @@ int CBaseMonster::CheckLocalMove( const Vector &vecStart, const Vector &vecEnd,
 	// since we've actually moved the monster during the check, undo the move.
 	UTIL_SetOrigin( pev, vecStartPos );
 
+	if( pflDist != NULL && flFailDist >= 0.0f )
+	{
+		*pflDist = flFailDist;
+	}
+	if( useCache )
+	{
+		g_LocalMoveCache.CountSteps( iSteps );
+
+		// Being blocked by a monster or a client depends on who asks, e.g. the blocker itself would pass
+		if( !pentBlocker || !FBitSet( pentBlocker->v.flags, FL_MONSTER | FL_CLIENT ) )
+			g_LocalMoveCache.Store( query, iReturn, flFailDist );
+	}
+
 	return iReturn;
 }
 
@@ -2461,6 +2542,40 @@ void CBaseMonster::MonsterInitThink( void )
 	StartMonster();
 }
 
+//=========================================================
+// ResetMonsterState - clears what the monster remembers
+// from its previous life. Used by the monstermaker pool,
+// entity variables are restored by the monstermaker.
+//=========================================================
+void CBaseMonster::ResetMonsterState( void )
+{
+	m_MonsterState = MONSTERSTATE_NONE;
+	m_IdealMonsterState = MONSTERSTATE_IDLE;
+	m_Activity = ACT_RESET;
+	m_IdealActivity = ACT_IDLE;
+	m_failSchedule = SCHED_NONE;
+
+	ClearSchedule();
+	RouteClear();
+	InitBoneControllers();
+
+	m_iHintNode = NO_NODE;
+	m_afConditions = 0;
+	m_afMemory = MEMORY_CLEAR;
+	m_bitsDamageType = 0;
+
+	m_hEnemy = NULL;
+	m_hTargetEnt = NULL;
+	m_hMoveGoalEnt = NULL;
+	m_pGoalEnt = NULL;
+	m_pCine = NULL;
+	for( int i = 0; i < MAX_OLD_ENEMIES; i++ )
+	{
+		m_hOldEnemy[i] = NULL;
+		m_vecOldEnemy[i] = g_vecZero;
+	}
+}
+
 Schedule_t* CBaseMonster::StartPatrol(CBaseEntity *path)
 {
 	if (path)
@@ -2641,56 +2756,9 @@ int CBaseMonster::IDefaultRelationship(int classify)
 	return IDefaultRelationship(Classify(), classify);
 }
 
-#define R_OA (R_AL-1)
-#define R_XA (R_AL-2)
-#define R_PA (R_AL-3)
-#define R_XG (R_AL-4)
-#define R_AX (R_AL-5)
-
 int CBaseMonster::IDefaultRelationship(int classify1, int classify2)
 {
-	static short iEnemy[CLASS_NUMBER_OF_CLASSES][CLASS_NUMBER_OF_CLASSES] =
-	{			 //   NONE	 MACH	 PLYR	 HPASS	 HMIL	 AMIL	 APASS	 AMONST	APREY	 APRED	 INSECT	PLRALY	PBWPN	ABWPN	XPRED	XSHOCK	ALMIL	BLOPS	SNARK	GARG
-	/*NONE*/		{ R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO},
-	/*MACHINE*/		{ R_NO	,R_NO	,R_DL	,R_DL	,R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL},
-	/*PLAYER*/		{ R_NO	,R_DL	,R_NO	,R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_NO,	R_DL,	R_DL,	R_DL,	R_DL,	R_NO,	R_DL,	R_DL,	R_DL},
-	/*HUMANPASSIVE*/{ R_NO	,R_NO	,R_AL	,R_AL	,R_HT	,R_HT	,R_NO	,R_HT	,R_DL	,R_HT	,R_NO	,R_AL,	R_NO,	R_NO,	R_HT,	R_HT,	R_OA,	R_HT,	R_DL,	R_HT},
-	/*HUMANMILITAR*/{ R_NO	,R_NO	,R_HT	,R_DL	,R_NO	,R_HT	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_HT,	R_NO,	R_NO,	R_HT,	R_HT,	R_DL,	R_DL,	R_HT,	R_HT},
-	/*ALIENMILITAR*/{ R_NO	,R_DL	,R_HT	,R_DL	,R_HT	,R_AL	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_DL,	R_NO,	R_NO,	R_PA,	R_XA,	R_HT,	R_HT,	R_NO,	R_AL},
-	/*ALIENPASSIVE*/{ R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO},
-	/*ALIENMONSTER*/{ R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_DL,	R_NO,	R_NO,	R_AX,	R_AX,	R_DL,	R_DL,	R_NO,	R_NO},
-	/*ALIENPREY   */{ R_NO	,R_NO	,R_DL	,R_DL	,R_DL	,R_NO	,R_NO	,R_NO	,R_NO	,R_FR	,R_NO	,R_DL,	R_NO,	R_NO,	R_FR,	R_FR,	R_DL,	R_DL,	R_NO,	R_NO},
-	/*ALIENPREDATO*/{ R_NO	,R_NO	,R_DL	,R_DL	,R_DL	,R_NO	,R_NO	,R_NO	,R_HT	,R_DL	,R_NO	,R_DL,	R_NO,	R_NO,	R_DL,	R_AX,	R_DL,	R_DL,	R_NO,	R_NO},
-	/*INSECT*/		{ R_FR	,R_FR	,R_FR	,R_FR	,R_FR	,R_NO	,R_FR	,R_FR	,R_FR	,R_FR	,R_NO	,R_FR,	R_NO,	R_NO,	R_NO,	R_NO,	R_FR,	R_FR,	R_NO,	R_FR},
-	/*PLAYERALLY*/	{ R_NO	,R_DL	,R_AL	,R_AL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_AL,	R_NO,	R_NO,	R_DL,	R_DL,	R_OA,	R_DL,	R_HT,	R_DL},
-	/*PBIOWEAPON*/	{ R_NO	,R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_DL,	R_NO,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL},
-	/*ABIOWEAPON*/	{ R_NO	,R_NO	,R_DL	,R_DL	,R_DL	,R_AL	,R_NO	,R_DL	,R_DL	,R_NO	,R_NO	,R_DL,	R_DL,	R_NO,	R_DL,	R_DL,	R_DL,	R_DL,	R_NO,	R_AL},
-	/*XPREDATOR*/	{ R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_PA	,R_NO	,R_AX	,R_DL	,R_DL	,R_NO	,R_DL,	R_NO,	R_NO,	R_AL,	R_AL,	R_DL,	R_DL,	R_NO,	R_XG},
-	/*XSHOCK*/		{ R_NO	,R_DL	,R_HT	,R_DL	,R_HT	,R_XA	,R_NO	,R_AX	,R_AX	,R_AX	,R_NO	,R_DL,	R_NO,	R_NO,	R_AL,	R_AL,	R_HT,	R_HT,	R_NO,	R_XG},
-	/*PLRALLYMIL*/	{ R_NO	,R_DL	,R_AL	,R_OA	,R_DL	,R_HT	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_OA,	R_NO,	R_NO,	R_DL,	R_HT,	R_AL,	R_DL,	R_HT,	R_HT},
-	/*BLACKOPS*/	{ R_NO	,R_DL	,R_HT	,R_DL	,R_DL	,R_HT	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_HT,	R_NO,	R_NO,	R_HT,	R_HT,	R_DL,	R_AL,	R_HT,	R_HT},
-	/*SNARK*/		{ R_NO	,R_NO	,R_HT	,R_DL	,R_HT	,R_NO	,R_NO	,R_DL	,R_DL	,R_NO	,R_NO	,R_DL,	R_NO,	R_NO,	R_DL,	R_DL,	R_HT,	R_HT,	R_NO,	R_DL},
-	/*GARGANTUA*/	{ R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_AL	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_DL,	R_NO,	R_NO,	R_XG,	R_XG,	R_DL,	R_DL,	R_NO,	R_AL},
-	};
-	if (classify1 >= CLASS_NUMBER_OF_CLASSES || classify1 < 0 || classify2 >= CLASS_NUMBER_OF_CLASSES || classify2 < 0 )
-	{
-		ALERT(at_aiconsole, "Unknown classify for monster relationship %d,%d\n", classify1, classify2);
-		return R_NO;
-	}
-	const int rel = iEnemy[classify1][classify2];
-	switch (rel) {
-	case R_OA:
-		return g_modFeatures.opfor_grunts_dislike_civilians ? R_DL : R_AL;
-	case R_XA:
-	case R_PA:
-		return g_modFeatures.racex_dislike_alien_military ? R_HT : R_NO;
-	case R_XG:
-		return g_modFeatures.racex_dislike_gargs ? R_HT : R_NO;
-	case R_AX:
-		return g_modFeatures.racex_dislike_alien_monsters ? R_DL : R_NO;
-	default:
-		return rel;
-	}
+	return g_RelationshipMatrix.Relationship(classify1, classify2);
 }
 
 //=========================================================
@@ -3579,6 +3647,29 @@ void CBaseMonster::ReportAIState( ALERT_TYPE level )
 	}
 }
 
+TYPEDESCRIPTION CBaseMonster::m_KeyValueData[] =
+{
+	DEFINE_KEYVALUE( CBaseMonster, m_iszTriggerTarget, FIELD_STRING, "TriggerTarget" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_iTriggerCondition, FIELD_SHORT, "TriggerCondition" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_iTriggerAltCondition, FIELD_SHORT, "TriggerAltCondition" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_iClass, FIELD_INTEGER, "classify" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_gibModel, FIELD_STRING, "gibmodel" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_gibModel, FIELD_STRING, "m_iszGibModel" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_reverseRelationship, FIELD_BOOLEAN, "is_player_ally" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_displayName, FIELD_STRING, "displayname" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_minHullSize, FIELD_VECTOR, "minhullsize" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_maxHullSize, FIELD_VECTOR, "maxhullsize" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_customSoundMask, FIELD_INTEGER, "soundmask" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_prisonerTo, FIELD_SHORT, "prisonerto" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_ignoredBy, FIELD_SHORT, "ignoredby" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_freeRoam, FIELD_SHORT, "freeroam" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_activeAfterCombat, FIELD_SHORT, "active_alert" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_sizeForGrapple, FIELD_SHORT, "size_for_grapple" ),
+	DEFINE_KEYVALUE( CBaseMonster, m_gibPolicy, FIELD_SHORT, "gib_policy" ),
+};
+
+IMPLEMENT_KEYVALUES( CBaseMonster )
+
 //=========================================================
 // KeyValue
 //
@@ -3586,22 +3677,7 @@ void CBaseMonster::ReportAIState( ALERT_TYPE level )
 //=========================================================
 void CBaseMonster::KeyValue( KeyValueData *pkvd )
 {
-	if( FStrEq( pkvd->szKeyName, "TriggerTarget" ) )
-	{
-		m_iszTriggerTarget = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "TriggerCondition" ) )
-	{
-		m_iTriggerCondition = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "TriggerAltCondition" ) )
-	{
-		m_iTriggerAltCondition = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "bloodcolor" ) )
+	if ( FStrEq( pkvd->szKeyName, "bloodcolor" ) )
 	{
 		m_bloodColor = atoi( pkvd->szValue );
 		// Check for values 1 and 2 for Sven Co-op compatibility
@@ -3620,72 +3696,7 @@ void CBaseMonster::KeyValue( KeyValueData *pkvd )
 		}
 		pkvd->fHandled = true;
 	}
-	else if ( FStrEq( pkvd->szKeyName, "classify" ) )
-	{
-		m_iClass = atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName , "gibmodel" ) || FStrEq( pkvd->szKeyName, "m_iszGibModel" ) )
-	{
-		m_gibModel = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "is_player_ally" ) )
-	{
-		m_reverseRelationship = atoi( pkvd->szValue ) != 0;
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "displayname" ) )
-	{
-		m_displayName = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "minhullsize" ) )
-	{
-		UTIL_StringToVector((float*)m_minHullSize, pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "maxhullsize" ) )
-	{
-		UTIL_StringToVector((float*)m_maxHullSize, pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "soundmask" ) )
-	{
-		m_customSoundMask = atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "prisonerto" ) )
-	{
-		m_prisonerTo = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "ignoredby" ) )
-	{
-		m_ignoredBy = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "freeroam" ) )
-	{
-		m_freeRoam = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "active_alert" ) )
-	{
-		m_activeAfterCombat = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "size_for_grapple" ) )
-	{
-		m_sizeForGrapple = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if ( FStrEq( pkvd->szKeyName, "gib_policy" ) )
-	{
-		m_gibPolicy = (short)atoi( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else
+	else if ( !m_KeyValueTable.Apply( this, pkvd ) )
 	{
 		CBaseToggle::KeyValue( pkvd );
 	}
@@ -25,6 +25,7 @@
 #include "saverestore.h"
 #include "soundent.h"
 #include "followingmonster.h"
+#include "ai_lod.h"
 
 //=========================================================
 // SetState
@@ -101,10 +102,14 @@ void CBaseMonster::RunAI( void )
 		// things will happen before the player gets there!
 		// UPDATE: We now let COMBAT state monsters think and act fully outside of player PVS. This allows the player to leave 
 		// an area where monsters are fighting, and the fight will continue.
-		if( bForcedGather || FBitSet(pev->spawnflags, SF_MONSTER_ACT_OUT_OF_PVS) || ( m_MonsterState == MONSTERSTATE_COMBAT ) || !FNullEnt( FIND_CLIENT_IN_PVS( edict() ) ) )
+		// Monsters far from the players sense less often, see ai_lod.h
+		if( bForcedGather || ( ( FBitSet(pev->spawnflags, SF_MONSTER_ACT_OUT_OF_PVS) || ( m_MonsterState == MONSTERSTATE_COMBAT ) || !FNullEnt( FIND_CLIENT_IN_PVS( edict() ) ) ) &&
+			g_AILevelOfDetail.ShouldSense( this, m_aiLodTier ) ) )
 		{
+			g_AILevelOfDetail.BeginSense();
 			Look( m_flDistLook );
 			Listen();// check for audible sounds. 
+			g_AILevelOfDetail.EndSense( this, m_aiLodTier );
 
 			// now filter conditions.
 			ClearConditions( IgnoreConditions() );
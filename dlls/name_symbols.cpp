@@ -0,0 +1,84 @@
+#include "name_symbols.h"
+
+#include <cstring>
+
+NameSymbolTable g_NameSymbols;
+
+unsigned int NameSymbolTable::HashName(const char *name)
+{
+	// FNV-1a of the lower case name
+	unsigned int hash = 2166136261u;
+	for (const unsigned char* p = (const unsigned char*)name; *p; ++p)
+	{
+		unsigned char c = *p;
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		hash = (hash ^ c) * 16777619u;
+	}
+	return hash;
+}
+
+int NameSymbolTable::FindHashed(const char *name, unsigned int hash) const
+{
+	if (_slots.empty())
+		return INVALID_SYMBOL;
+	unsigned int slot = hash & _mask;
+	while (_slots[slot] != INVALID_SYMBOL)
+	{
+		const int symbol = _slots[slot];
+		if (stricmp(_names[symbol].c_str(), name) == 0)
+			return symbol;
+		slot = (slot + 1) & _mask;
+	}
+	return INVALID_SYMBOL;
+}
+
+void NameSymbolTable::Grow()
+{
+	const unsigned int slotCount = _slots.empty() ? 256 : (unsigned int)_slots.size() * 2;
+	_mask = slotCount - 1;
+	_slots.assign(slotCount, INVALID_SYMBOL);
+	for (int symbol = 0; symbol < Count(); ++symbol)
+	{
+		unsigned int slot = HashName(_names[symbol].c_str()) & _mask;
+		while (_slots[slot] != INVALID_SYMBOL)
+			slot = (slot + 1) & _mask;
+		_slots[slot] = symbol;
+	}
+}
+
+int NameSymbolTable::Intern(const char *name)
+{
+	if (!name || *name == '\0')
+		return INVALID_SYMBOL;
+	const unsigned int hash = HashName(name);
+	int symbol = FindHashed(name, hash);
+	if (symbol != INVALID_SYMBOL)
+		return symbol;
+
+	// Keep the load factor under a half
+	if ((_names.size() + 1) * 2 > _slots.size())
+		Grow();
+
+	symbol = Count();
+	_names.push_back(name);
+	unsigned int slot = hash & _mask;
+	while (_slots[slot] != INVALID_SYMBOL)
+		slot = (slot + 1) & _mask;
+	_slots[slot] = symbol;
+	return symbol;
+}
+
+int NameSymbolTable::Find(const char *name) const
+{
+	if (!name || *name == '\0')
+		return INVALID_SYMBOL;
+	return FindHashed(name, HashName(name));
+}
+
+const char* NameSymbolTable::Name(int symbol) const
+{
+	if (symbol < 0 || symbol >= Count())
+		return nullptr;
+	return _names[symbol].c_str();
+}
@@ -0,0 +1,41 @@
+#pragma once
+#ifndef NAME_SYMBOLS_H
+#define NAME_SYMBOLS_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+// Interns names of sound scripts, visuals, templates and skill cvars into small integer symbols.
+// Names are compared case insensitively, like the keys of the configs they come from.
+// Symbols are dense and never released, so systems can index plain arrays by them.
+class NameSymbolTable
+{
+public:
+	enum {
+		INVALID_SYMBOL = -1
+	};
+
+	// Symbol of the name, added if the name is new. INVALID_SYMBOL for null or empty names.
+	int Intern(const char* name);
+	// Symbol of the name or INVALID_SYMBOL if the name was never interned
+	int Find(const char* name) const;
+	// Spelling of the name as it was first interned
+	const char* Name(int symbol) const;
+	int Count() const {
+		return (int)_names.size();
+	}
+
+	static unsigned int HashName(const char* name);
+private:
+	int FindHashed(const char* name, unsigned int hash) const;
+	void Grow();
+
+	std::deque<std::string> _names; // deque keeps the c_str() pointers stable
+	std::vector<int> _slots;
+	unsigned int _mask = 0;
+};
+
+extern NameSymbolTable g_NameSymbols;
+
+#endif
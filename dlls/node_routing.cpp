@@ -0,0 +1,401 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+#include "monsters.h"
+#include "nodes.h"
+#include "node_routing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+NodeRoutingBuilder g_NodeRoutingBuilder;
+
+static double RoutingClock()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int HullLinkMask(int iHull)
+{
+	switch (iHull)
+	{
+	case NODE_SMALL_HULL:
+		return bits_LINK_SMALL_HULL;
+	case NODE_HUMAN_HULL:
+		return bits_LINK_HUMAN_HULL;
+	case NODE_LARGE_HULL:
+		return bits_LINK_LARGE_HULL;
+	case NODE_FLY_HULL:
+		return bits_LINK_FLY_HULL;
+	default:
+		return 0;
+	}
+}
+
+static int CapMaskForIndex(int iCap)
+{
+	return iCap == 1 ? (bits_CAP_OPEN_DOORS | bits_CAP_AUTO_DOORS | bits_CAP_USE) : 0;
+}
+
+static bool EncodeNodeOffset(signed char*& p, int iLastNode, int iFrom, int cNodes)
+{
+	int a = iLastNode - iFrom;
+	int b = iLastNode - iFrom + cNodes;
+	int c = iLastNode - iFrom - cNodes;
+	if( -128 <= a && a <= 127 )
+	{
+		*p++ = a;
+	}
+	else if( -128 <= b && b <= 127 )
+	{
+		*p++ = b;
+	}
+	else if( -128 <= c && c <= 127 )
+	{
+		*p++ = c;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+// Compress one node's routing table, see CGraph::NextNodeInRoute for decoding.
+// pRoute must have room for cNodes * 2 entries. Returns the compressed size.
+static int CompressRoute(const unsigned short *BestNextNodes, int cNodes, int iFrom, signed char *pRoute, int &unsortedCount)
+{
+	int iLastNode = 9999999; // just really big.
+	int cSequence = 0;
+	int cRepeats = 0;
+	signed char *p = pRoute;
+	for( int i = 0; i < cNodes; i++ )
+	{
+		bool CanRepeat = ( ( BestNextNodes[i] == iLastNode ) && cRepeats < 127 );
+		bool CanSequence = ( BestNextNodes[i] == i && cSequence < 128 );
+
+		if( cRepeats )
+		{
+			if( CanRepeat )
+			{
+				cRepeats++;
+			}
+			else
+			{
+				// Emit the repeat phrase.
+				//
+				*p++ = cRepeats - 1;
+				if( !EncodeNodeOffset( p, iLastNode, iFrom, cNodes ) )
+					unsortedCount++;
+				cRepeats = 0;
+
+				if( CanSequence )
+				{
+					// Start a sequence.
+					//
+					cSequence++;
+				}
+				else
+				{
+					// Start another repeat.
+					//
+					cRepeats++;
+				}
+			}
+		}
+		else if( cSequence )
+		{
+			if( CanSequence )
+			{
+				cSequence++;
+			}
+			else
+			{
+				// It may be advantageous to combine
+				// a single-entry sequence phrase with the
+				// next repeat phrase.
+				//
+				if( cSequence == 1 && CanRepeat )
+				{
+					// Combine with repeat phrase.
+					//
+					cRepeats = 2;
+					cSequence = 0;
+				}
+				else
+				{
+					// Emit the sequence phrase.
+					//
+					*p++ = -cSequence;
+					cSequence = 0;
+
+					// Start a repeat sequence.
+					//
+					cRepeats++;
+				}
+			}
+		}
+		else
+		{
+			if( CanSequence )
+			{
+				// Start a sequence phrase.
+				//
+				cSequence++;
+			}
+			else
+			{
+				// Start a repeat sequence.
+				//
+				cRepeats++;
+			}
+		}
+		iLastNode = BestNextNodes[i];
+	}
+	if( cRepeats )
+	{
+		// Emit the repeat phrase.
+		//
+		*p++ = cRepeats - 1;
+		if( !EncodeNodeOffset( p, iLastNode, iFrom, cNodes ) )
+			unsortedCount++;
+	}
+	if( cSequence )
+	{
+		// Emit the Sequence phrase.
+		//
+		*p++ = -cSequence;
+	}
+	return p - pRoute;
+}
+
+NodeRoutingBuilder::~NodeRoutingBuilder()
+{
+	Cancel();
+}
+
+void NodeRoutingBuilder::Start(CGraph &graph)
+{
+	Cancel();
+
+	_startTime = RoutingClock();
+	_cNodes = graph.m_cNodes;
+
+	// Link entities can only be queried from the main thread, so resolve them for both capability sets now
+	_firstLink.resize(_cNodes + 1);
+	_links.clear();
+	for (int iNode = 0; iNode < _cNodes; ++iNode)
+	{
+		_firstLink[iNode] = (int)_links.size();
+		const CNode& node = graph.m_pNodes[iNode];
+		for (int i = 0; i < node.m_cNumLinks; ++i)
+		{
+			const CLink& link = graph.m_pLinkPool[node.m_iFirstLink + i];
+			RouteLink routeLink;
+			routeLink.destNode = link.m_iDestNode;
+			routeLink.linkInfo = link.m_afLinkInfo;
+			routeLink.weight = link.m_flWeight;
+			routeLink.allowedCaps = 0;
+			for (int iCap = 0; iCap < 2; ++iCap)
+			{
+				if (link.m_pLinkEnt == NULL || graph.HandleLinkEnt(iNode, link.m_pLinkEnt, CapMaskForIndex(iCap), CGraph::NODEGRAPH_STATIC))
+					routeLink.allowedCaps |= 1 << iCap;
+			}
+			_links.push_back(routeLink);
+		}
+	}
+	_firstLink[_cNodes] = (int)_links.size();
+
+	// Keep the order of hulls and caps the routing tables were always written in
+	_jobs.resize(MAX_NODE_HULLS * 2);
+	for (size_t i = 0; i < _jobs.size(); ++i)
+	{
+		Job& job = _jobs[i];
+		job.hull = (int)i / 2;
+		job.cap = (int)i % 2;
+		job.routes.clear();
+		job.routeOffsets.assign(_cNodes + 1, 0);
+		job.unsortedCount = 0;
+	}
+
+	_nextJob = 0;
+	_finishedJobs = 0;
+	_cancel = false;
+	_running = true;
+
+#if !__DOS__
+	// Leave a core for the server itself
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	threadCount = threadCount > 1 ? threadCount - 1 : 1;
+	if (threadCount > _jobs.size())
+		threadCount = (unsigned int)_jobs.size();
+
+	for (unsigned int i = 0; i < threadCount; ++i)
+		_workers.push_back(std::thread(&NodeRoutingBuilder::RunJobs, this));
+	ALERT(at_aiconsole, "Computing routes for %d nodes on %u threads\n", _cNodes, threadCount);
+#else
+	RunJobs();
+#endif
+}
+
+bool NodeRoutingBuilder::IsDone() const
+{
+	return _running && _finishedJobs == (int)_jobs.size();
+}
+
+void NodeRoutingBuilder::RunJobs()
+{
+	int i;
+	while (!_cancel && (i = _nextJob++) < (int)_jobs.size())
+	{
+		RunJob(_jobs[i]);
+		_finishedJobs++;
+	}
+}
+
+void NodeRoutingBuilder::RunJob(Job &job)
+{
+	typedef std::pair<float, int> QueueEntry;
+
+	const int hullMask = HullLinkMask(job.hull);
+	const int capBit = 1 << job.cap;
+
+	std::vector<float> closestSoFar(_cNodes);
+	std::vector<int> firstHop(_cNodes);
+	std::vector<unsigned short> bestNextNodes(_cNodes);
+	std::vector<signed char> compressed(_cNodes * 2 + 2);
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+
+	for (int iFrom = 0; iFrom < _cNodes; ++iFrom)
+	{
+		if (_cancel)
+			return;
+
+		// Full search from iFrom. Instead of walking back the previous nodes for every destination
+		// remember the first step each node was reached with.
+		std::fill(closestSoFar.begin(), closestSoFar.end(), -1.0f);
+		closestSoFar[iFrom] = 0.0f;
+		firstHop[iFrom] = iFrom;
+		queue.push(QueueEntry(0.0f, iFrom));
+
+		while (!queue.empty())
+		{
+			const QueueEntry entry = queue.top();
+			queue.pop();
+			const int iCurrentNode = entry.second;
+			const float flCurrentDistance = entry.first;
+			if (flCurrentDistance > closestSoFar[iCurrentNode])
+				continue;
+
+			for (int iLink = _firstLink[iCurrentNode]; iLink < _firstLink[iCurrentNode + 1]; ++iLink)
+			{
+				const RouteLink& link = _links[iLink];
+				if ((link.linkInfo & hullMask) != hullMask)
+					continue;
+				if (!(link.allowedCaps & capBit))
+					continue;
+
+				const int iVisitNode = link.destNode;
+				const float flOurDistance = flCurrentDistance + link.weight;
+				if (closestSoFar[iVisitNode] < -0.5f || flOurDistance < closestSoFar[iVisitNode] - 0.001f)
+				{
+					closestSoFar[iVisitNode] = flOurDistance;
+					firstHop[iVisitNode] = iCurrentNode == iFrom ? iVisitNode : firstHop[iCurrentNode];
+					queue.push(QueueEntry(flOurDistance, iVisitNode));
+				}
+			}
+		}
+
+		// Unreachable nodes route to the node itself
+		for (int iTo = 0; iTo < _cNodes; ++iTo)
+		{
+			bestNextNodes[iTo] = closestSoFar[iTo] < -0.5f ? iFrom : firstHop[iTo];
+		}
+
+		const int nRoute = CompressRoute(&bestNextNodes[0], _cNodes, iFrom, &compressed[0], job.unsortedCount);
+		job.routeOffsets[iFrom] = (int)job.routes.size();
+		job.routes.insert(job.routes.end(), compressed.begin(), compressed.begin() + nRoute);
+	}
+	job.routeOffsets[_cNodes] = (int)job.routes.size();
+}
+
+void NodeRoutingBuilder::StopWorkers()
+{
+#if !__DOS__
+	for (size_t i = 0; i < _workers.size(); ++i)
+		_workers[i].join();
+	_workers.clear();
+#endif
+}
+
+void NodeRoutingBuilder::Finish(CGraph &graph)
+{
+	if (!_running)
+		return;
+
+	StopWorkers();
+
+	// Nodes with identical routes share the same data
+	std::vector<signed char> routeInfo;
+	std::unordered_map<std::string, int> routeOffsets;
+	int unsortedCount = 0;
+
+	for (size_t i = 0; i < _jobs.size(); ++i)
+	{
+		const Job& job = _jobs[i];
+		unsortedCount += job.unsortedCount;
+		for (int iFrom = 0; iFrom < _cNodes; ++iFrom)
+		{
+			const signed char* pRoute = &job.routes[0] + job.routeOffsets[iFrom];
+			const int nRoute = job.routeOffsets[iFrom + 1] - job.routeOffsets[iFrom];
+			const std::string key((const char*)pRoute, nRoute);
+
+			std::unordered_map<std::string, int>::const_iterator it = routeOffsets.find(key);
+			if (it != routeOffsets.end())
+			{
+				graph.m_pNodes[iFrom].m_pNextBestNode[job.hull][job.cap] = it->second;
+			}
+			else
+			{
+				const int offset = (int)routeInfo.size();
+				routeInfo.insert(routeInfo.end(), pRoute, pRoute + nRoute);
+				routeOffsets[key] = offset;
+				graph.m_pNodes[iFrom].m_pNextBestNode[job.hull][job.cap] = offset;
+			}
+		}
+	}
+
+	if (graph.m_pRouteInfo)
+		free(graph.m_pRouteInfo);
+	graph.m_nRouteInfo = (int)routeInfo.size();
+	graph.m_pRouteInfo = (signed char *)calloc(sizeof(signed char), routeInfo.size() + 1);
+	if (!routeInfo.empty())
+		memcpy(graph.m_pRouteInfo, &routeInfo[0], routeInfo.size());
+
+	if (unsortedCount)
+		ALERT(at_aiconsole, "Nodes need sorting (%d routes)!\n", unsortedCount);
+	ALERT(at_aiconsole, "Size of Routes = %d\n", graph.m_nRouteInfo);
+	ALERT(at_aiconsole, "Routing tables computed in %.2f seconds\n", RoutingClock() - _startTime);
+
+	graph.m_fRoutingComplete = 1;
+
+	_jobs.clear();
+	_links.clear();
+	_firstLink.clear();
+	_running = false;
+}
+
+void NodeRoutingBuilder::Cancel()
+{
+	_cancel = true;
+	StopWorkers();
+	_jobs.clear();
+	_links.clear();
+	_firstLink.clear();
+	_running = false;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#ifndef NODE_ROUTING_H
+#define NODE_ROUTING_H
+
+#include <atomic>
+#include <vector>
+#if !__DOS__
+#include <thread>
+#endif
+
+class CGraph;
+
+// Computes the static routing tables of the node graph.
+// Each hull and capability combination is a separate job that runs a shortest path search from every node.
+// Jobs work on a snapshot of the links and are run by worker threads, so the server keeps running frames meanwhile.
+// Results are merged into CGraph::m_pRouteInfo on Finish, in the same compressed format the graph always used.
+class NodeRoutingBuilder
+{
+public:
+	NodeRoutingBuilder(): _cNodes(0), _nextJob(0), _finishedJobs(0), _cancel(false), _running(false), _startTime(0.0) {}
+	~NodeRoutingBuilder();
+
+	// Take a snapshot of the graph links and start computing routes
+	void Start(CGraph& graph);
+	bool IsRunning() const { return _running; }
+	bool IsDone() const;
+	// Wait for the remaining jobs and write routes to the graph
+	void Finish(CGraph& graph);
+	// Drop the running build, e.g. when the level changes
+	void Cancel();
+
+private:
+	struct RouteLink
+	{
+		int destNode;
+		int linkInfo;
+		float weight;
+		int allowedCaps; // bit per capability index: whether the link entity lets the monster pass
+	};
+
+	struct Job
+	{
+		int hull;
+		int cap;
+		std::vector<signed char> routes; // compressed routes of all nodes, back to back
+		std::vector<int> routeOffsets; // m_cNodes + 1 entries
+		int unsortedCount;
+	};
+
+	void RunJobs();
+	void RunJob(Job& job);
+	void StopWorkers();
+
+	int _cNodes;
+	std::vector<int> _firstLink; // m_cNodes + 1 entries
+	std::vector<RouteLink> _links;
+	std::vector<Job> _jobs;
+
+	std::atomic<int> _nextJob;
+	std::atomic<int> _finishedJobs;
+	std::atomic<bool> _cancel;
+#if !__DOS__
+	std::vector<std::thread> _workers;
+#endif
+	bool _running;
+	double _startTime;
+};
+
+extern NodeRoutingBuilder g_NodeRoutingBuilder;
+
+#endif
@@ -0,0 +1,257 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+#include "nodes.h"
+#include "node_search.h"
+
+#include <algorithm>
+#include <cmath>
+
+NodeSearchTree g_NodeSearchTree;
+
+// How long the cached results stay valid, in seconds
+static const float NODE_CACHE_LIFETIME = 0.5f;
+
+namespace
+{
+struct AxisLess
+{
+	AxisLess(const std::vector<Vector>& positions, int axis): positions(positions), axis(axis) {}
+	bool operator()(int a, int b) const {
+		return positions[a][axis] < positions[b][axis];
+	}
+	const std::vector<Vector>& positions;
+	int axis;
+};
+}
+
+void NodeSearchTree::Prepare(const CGraph &graph)
+{
+	if (_graph == &graph && _nodeCount == graph.m_cNodes && !_tree.empty())
+		return;
+
+	Clear();
+	_graph = &graph;
+	_nodeCount = graph.m_cNodes;
+	if (_nodeCount <= 0)
+		return;
+
+	_positions.resize(_nodeCount);
+	_nodeTypes.resize(_nodeCount);
+	_order.resize(_nodeCount);
+	for (int i = 0; i < _nodeCount; ++i)
+	{
+		_positions[i] = graph.m_pNodes[i].m_vecOriginPeek;
+		_nodeTypes[i] = graph.m_pNodes[i].m_afNodeInfo;
+		_order[i] = i;
+	}
+	_tree.reserve(2 * _nodeCount / LEAF_SIZE + 1);
+	BuildSubtree(0, _nodeCount);
+}
+
+void NodeSearchTree::Clear()
+{
+	_graph = nullptr;
+	_nodeCount = 0;
+	_tree.clear();
+	_order.clear();
+	_positions.clear();
+	_nodeTypes.clear();
+	while (!_queue.empty())
+		_queue.pop();
+	for (int i = 0; i < RESULT_CACHE_SIZE; ++i)
+		_cache[i] = CacheEntry();
+}
+
+int NodeSearchTree::BuildSubtree(int first, int count)
+{
+	const int index = (int)_tree.size();
+	_tree.push_back(TreeNode());
+
+	TreeNode treeNode;
+	treeNode.first = first;
+	treeNode.count = count;
+	treeNode.children[0] = treeNode.children[1] = -1;
+	treeNode.nodeTypes = 0;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		treeNode.mins[axis] = treeNode.maxs[axis] = _positions[_order[first]][axis];
+	}
+	for (int i = first; i < first + count; ++i)
+	{
+		const Vector& position = _positions[_order[i]];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			treeNode.mins[axis] = Q_min(treeNode.mins[axis], position[axis]);
+			treeNode.maxs[axis] = Q_max(treeNode.maxs[axis], position[axis]);
+		}
+		treeNode.nodeTypes |= _nodeTypes[_order[i]];
+	}
+
+	if (count > LEAF_SIZE)
+	{
+		// Split by the median along the longest side
+		int splitAxis = 0;
+		for (int axis = 1; axis < 3; ++axis)
+		{
+			if (treeNode.maxs[axis] - treeNode.mins[axis] > treeNode.maxs[splitAxis] - treeNode.mins[splitAxis])
+				splitAxis = axis;
+		}
+		const int half = count / 2;
+		std::nth_element(_order.begin() + first, _order.begin() + first + half, _order.begin() + first + count, AxisLess(_positions, splitAxis));
+
+		treeNode.children[0] = BuildSubtree(first, half);
+		treeNode.children[1] = BuildSubtree(first + half, count - half);
+	}
+
+	_tree[index] = treeNode;
+	return index;
+}
+
+float NodeSearchTree::BoxDistanceSquared(const TreeNode &treeNode) const
+{
+	float distSquared = 0.0f;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float delta = 0.0f;
+		if (_searchOrigin[axis] < treeNode.mins[axis])
+			delta = treeNode.mins[axis] - _searchOrigin[axis];
+		else if (_searchOrigin[axis] > treeNode.maxs[axis])
+			delta = _searchOrigin[axis] - treeNode.maxs[axis];
+		distSquared += delta * delta;
+	}
+	return distSquared;
+}
+
+void NodeSearchTree::PushTreeNode(int index)
+{
+	const TreeNode& treeNode = _tree[index];
+	if (!(treeNode.nodeTypes & _searchTypes))
+		return;
+
+	SearchEntry entry;
+	entry.distSquared = BoxDistanceSquared(treeNode);
+	entry.index = index;
+	entry.isTreeNode = true;
+	_queue.push(entry);
+}
+
+void NodeSearchTree::BeginSearch(const CGraph &graph, const Vector &vecOrigin, int afNodeTypes)
+{
+	Prepare(graph);
+
+	while (!_queue.empty())
+		_queue.pop();
+	_searchOrigin = vecOrigin;
+	_searchTypes = afNodeTypes;
+
+	if (!_tree.empty())
+		PushTreeNode(0);
+}
+
+int NodeSearchTree::NextNode(float &flDist)
+{
+	while (!_queue.empty())
+	{
+		const SearchEntry entry = _queue.top();
+		_queue.pop();
+
+		if (!entry.isTreeNode)
+		{
+			flDist = sqrtf(entry.distSquared);
+			return entry.index;
+		}
+
+		const TreeNode& treeNode = _tree[entry.index];
+		if (treeNode.children[0] >= 0)
+		{
+			PushTreeNode(treeNode.children[0]);
+			PushTreeNode(treeNode.children[1]);
+		}
+		else
+		{
+			for (int i = treeNode.first; i < treeNode.first + treeNode.count; ++i)
+			{
+				const int iNode = _order[i];
+				if (!(_nodeTypes[iNode] & _searchTypes))
+					continue;
+
+				SearchEntry nodeEntry;
+				const Vector delta = _positions[iNode] - _searchOrigin;
+				nodeEntry.distSquared = DotProduct(delta, delta);
+				nodeEntry.index = iNode;
+				nodeEntry.isTreeNode = false;
+				_queue.push(nodeEntry);
+			}
+		}
+	}
+	return -1;
+}
+
+void NodeSearchTree::QuantizeOrigin(const Vector &vecOrigin, int key[])
+{
+	for (int axis = 0; axis < 3; ++axis)
+		key[axis] = (int)floorf(vecOrigin[axis] / RESULT_CACHE_QUANTUM);
+}
+
+unsigned int NodeSearchTree::CacheIndex(const int key[], int afNodeTypes)
+{
+	return ((unsigned int)key[0] * 73856093u ^ (unsigned int)key[1] * 19349663u ^ (unsigned int)key[2] * 83492791u ^ (unsigned int)afNodeTypes) & (RESULT_CACHE_SIZE - 1);
+}
+
+bool NodeSearchTree::LookupCache(const Vector &vecOrigin, int afNodeTypes, int &iNode)
+{
+	int key[3];
+	QuantizeOrigin(vecOrigin, key);
+	const CacheEntry& entry = _cache[CacheIndex(key, afNodeTypes)];
+	if (entry.time < 0.0f || gpGlobals->time - entry.time > NODE_CACHE_LIFETIME || entry.time > gpGlobals->time)
+		return false;
+	if (entry.nodeTypes != afNodeTypes || entry.key[0] != key[0] || entry.key[1] != key[1] || entry.key[2] != key[2])
+		return false;
+
+	_queries++;
+	_cacheHits++;
+	iNode = entry.node;
+	return true;
+}
+
+void NodeSearchTree::StoreCache(const Vector &vecOrigin, int afNodeTypes, int iNode)
+{
+	int key[3];
+	QuantizeOrigin(vecOrigin, key);
+	CacheEntry& entry = _cache[CacheIndex(key, afNodeTypes)];
+	entry.key[0] = key[0];
+	entry.key[1] = key[1];
+	entry.key[2] = key[2];
+	entry.nodeTypes = afNodeTypes;
+	entry.node = iNode;
+	entry.time = gpGlobals->time;
+}
+
+void NodeSearchTree::CountQuery(int tracesDone, bool found)
+{
+	_queries++;
+	_traces += tracesDone;
+	if (!found)
+		_notFound++;
+}
+
+void NodeSearchTree::Report()
+{
+	ALERT(at_console, "Nodes in tree: %d (%u tree nodes)\n", _nodeCount, (unsigned)_tree.size());
+	ALERT(at_console, "Queries: %u. Cache hits: %u\n", _queries, _cacheHits);
+	const unsigned int searches = _queries - _cacheHits;
+	ALERT(at_console, "Traces: %u (%.2f per search). Not found: %u\n", _traces, searches ? (double)_traces / searches : 0.0, _notFound);
+}
+
+void NodeSearchTree::ResetCounters()
+{
+	_queries = _cacheHits = _traces = _notFound = 0;
+}
+
+void ReportNodeSearch()
+{
+	g_NodeSearchTree.Report();
+	if (CMD_ARGC() > 1 && FStrEq(CMD_ARGV(1), "reset"))
+		g_NodeSearchTree.ResetCounters();
+}
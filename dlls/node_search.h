@@ -0,0 +1,103 @@
+#pragma once
+#ifndef NODE_SEARCH_H
+#define NODE_SEARCH_H
+
+#include "extdll.h"
+
+#include <queue>
+#include <vector>
+
+class CGraph;
+
+// KD-tree over the node positions used by CGraph::FindNearestNode.
+// Nodes are enumerated in the increasing distance order, so the search can stop at the first visible node.
+// Results are remembered for a short time by the quantized origin, so monsters moving around
+// the same spot don't repeat the traces.
+class NodeSearchTree
+{
+public:
+	enum {
+		LEAF_SIZE = 8,
+		RESULT_CACHE_SIZE = 512,
+		RESULT_CACHE_QUANTUM = 16, // units
+	};
+
+	// Build the tree if the graph changed since the last query
+	void Prepare(const CGraph& graph);
+	void Clear();
+
+	// Start enumerating nodes of afNodeTypes closest to vecOrigin
+	void BeginSearch(const CGraph& graph, const Vector& vecOrigin, int afNodeTypes);
+	// Returns the next closest node or -1 if there are no more nodes
+	int NextNode(float& flDist);
+
+	bool LookupCache(const Vector& vecOrigin, int afNodeTypes, int& iNode);
+	void StoreCache(const Vector& vecOrigin, int afNodeTypes, int iNode);
+
+	void CountQuery(int tracesDone, bool found);
+	void Report();
+	void ResetCounters();
+
+private:
+	struct TreeNode
+	{
+		float mins[3];
+		float maxs[3];
+		int first; // in _order
+		int count;
+		int children[2]; // -1 for leaves
+		int nodeTypes; // all types of the nodes in this subtree
+	};
+
+	struct SearchEntry
+	{
+		float distSquared;
+		int index; // tree node or graph node
+		bool isTreeNode;
+		bool operator<(const SearchEntry& other) const {
+			// Closest first in std::priority_queue. Graph nodes go before the tree nodes at the same distance
+			if (distSquared != other.distSquared)
+				return distSquared > other.distSquared;
+			return isTreeNode && !other.isTreeNode;
+		}
+	};
+
+	struct CacheEntry
+	{
+		CacheEntry(): nodeTypes(0), node(-1), time(-1.0f) {}
+		int key[3];
+		int nodeTypes;
+		int node;
+		float time;
+	};
+
+	int BuildSubtree(int first, int count);
+	float BoxDistanceSquared(const TreeNode& treeNode) const;
+	void PushTreeNode(int index);
+	static void QuantizeOrigin(const Vector& vecOrigin, int key[3]);
+	static unsigned int CacheIndex(const int key[3], int afNodeTypes);
+
+	const CGraph* _graph = nullptr;
+	int _nodeCount = 0;
+	std::vector<TreeNode> _tree;
+	std::vector<int> _order;
+	std::vector<Vector> _positions;
+	std::vector<int> _nodeTypes;
+
+	std::priority_queue<SearchEntry> _queue;
+	Vector _searchOrigin;
+	int _searchTypes = 0;
+
+	CacheEntry _cache[RESULT_CACHE_SIZE];
+
+	unsigned int _queries = 0;
+	unsigned int _cacheHits = 0;
+	unsigned int _traces = 0;
+	unsigned int _notFound = 0;
+};
+
+extern NodeSearchTree g_NodeSearchTree;
+
+void ReportNodeSearch();
+
+#endif
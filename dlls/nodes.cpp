@@ -25,6 +25,10 @@
 #include	"animation.h"
 #include	"doors.h"
 #include	"game.h"
+#include	"node_routing.h"
+#include	"node_search.h"
+
+#include <vector>
 
 #define	HULL_STEP_SIZE 16// how far the test hull moves on each step
 #define	NODE_HEIGHT	8	// how high to lift nodes off the ground after we drop them all (make stair/ramp mapping easier)
@@ -34,12 +38,43 @@
 #define	MAX_NODE_INITIAL_LINKS	128
 #define	MAX_NODES               1024
 
+// how many traces and hull steps the test hull may take in one think while building the graph
+#define	NODE_BUILD_TRACES_PER_FRAME	1024
+
 extern DLL_GLOBAL edict_t *g_pBodyQueueHead;
 
 Vector VecBModelOrigin( entvars_t *pevBModel );
 
 CGraph WorldGraph;
 
+// The test hull builds the graph over many thinks, this is where it
+// keeps its place in between.
+struct nodebuild_t
+{
+	FILE	*file;		// text node report
+	CLink	*pTempPool;	// temporary link pool
+	int	cPoolLinks;	// number of links in the pool
+	int	iNode;		// node to continue from
+	int	iLink;		// link of iNode to continue from
+};
+
+static nodebuild_t gNodeBuild;
+
+static void FreeNodeBuild( void )
+{
+	if( gNodeBuild.pTempPool )
+	{
+		free( gNodeBuild.pTempPool );
+	}
+
+	if( gNodeBuild.file )
+	{
+		fclose( gNodeBuild.file );
+	}
+
+	memset( &gNodeBuild, 0, sizeof(gNodeBuild) );
+}
+
 LINK_ENTITY_TO_CLASS( info_node, CNodeEnt )
 LINK_ENTITY_TO_CLASS( info_node_air, CNodeEnt )
 
@@ -59,12 +94,31 @@ LINK_ENTITY_TO_CLASS( info_node_air, CNodeEnt )
 //=========================================================
 void CGraph::InitGraph( void )
 {
+	// Routes computed for the previous graph are of no use anymore
+	//
+	g_NodeRoutingBuilder.Cancel();
+	g_NodeSearchTree.Clear();
+	FreeNodeBuild();
+
 	// Make the graph unavailable
 	//
 	m_fGraphPresent = 0;
 	m_fGraphPointersSet = 0;
 	m_fRoutingComplete = 0;
 
+	// The graph was loaded in place, arrays point into the file
+	//
+	if( m_pGraphData )
+	{
+		FREE_FILE( m_pGraphData );
+		m_pGraphData = NULL;
+		m_pLinkPool = NULL;
+		m_pNodes = NULL;
+		m_di = NULL;
+		m_pRouteInfo = NULL;
+		m_pHashLinks = NULL;
+	}
+
 	// Free the link pool
 	//
 	if( m_pLinkPool )
@@ -739,29 +793,6 @@ int CGraph::FindShortestPath(int *piPath, int pathSize, int iStart, int iDest, i
 	return iNumPathNodes;
 }
 
-inline ULONG Hash( void *p, int len )
-{
-	CRC32_t ulCrc;
-	CRC32_INIT( &ulCrc );
-	CRC32_PROCESS_BUFFER( &ulCrc, p, len );
-	return CRC32_FINAL( ulCrc );
-}
-
-void inline CalcBounds( int &Lower, int &Upper, int Goal, int Best )
-{
-	int Temp = 2 * Goal - Best;
-	if( Best > Goal )
-	{
-		Lower = Q_max( 0, Temp );
-		Upper = Best;
-	}
-	else
-	{
-		Upper = Q_min( 255, Temp );
-		Lower = Best;
-	}
-}
-
 // Convert from [-8192,8192] to [0, 255]
 //
 inline int CALC_RANGE( int x, int lower, int upper )
@@ -769,62 +800,6 @@ inline int CALC_RANGE( int x, int lower, int upper )
 	return NUM_RANGES * ( x - lower ) / ( ( upper - lower + 1 ) );
 }
 
-void inline UpdateRange( int &minValue, int &maxValue, int Goal, int Best )
-{
-	int Lower, Upper;
-	CalcBounds( Lower, Upper, Goal, Best );
-	if( Upper < maxValue )
-		maxValue = Upper;
-	if( minValue < Lower )
-		minValue = Lower;
-}
-
-void CGraph::CheckNode( Vector vecOrigin, int iNode )
-{
-	extern cvar_t findnearestnodefix;
-
-	// Have we already seen this point before?.
-	//
-	if( m_di[iNode].m_CheckedEvent == m_CheckedCounter )
-		return;
-
-	m_di[iNode].m_CheckedEvent = m_CheckedCounter;
-
-	float flDist = ( vecOrigin - m_pNodes[iNode].m_vecOriginPeek ).Length();
-
-	if( flDist < m_flShortest )
-	{
-		TraceResult tr;
-
-		Vector vecStart = vecOrigin;
-		if (findnearestnodefix.value)
-			vecStart.z += NODE_HEIGHT;
-
-		// make sure that vecOrigin can trace to this node!
-		UTIL_TraceLine( vecStart, m_pNodes[iNode].m_vecOriginPeek, ignore_monsters, 0, &tr );
-
-		if( tr.flFraction == 1.0f )
-		{
-			m_iNearest = iNode;
-			m_flShortest = flDist;
-
-			UpdateRange( m_minX, m_maxX, CALC_RANGE( vecOrigin.x, m_RegionMin[0], m_RegionMax[0] ), m_pNodes[iNode].m_Region[0] );
-			UpdateRange( m_minY, m_maxY, CALC_RANGE( vecOrigin.y, m_RegionMin[1], m_RegionMax[1] ), m_pNodes[iNode].m_Region[1] );
-			UpdateRange( m_minZ, m_maxZ, CALC_RANGE( vecOrigin.z, m_RegionMin[2], m_RegionMax[2] ), m_pNodes[iNode].m_Region[2] );
-
-			// From maxCircle, calculate maximum bounds box. All points must be
-			// simultaneously inside all bounds of the box.
-			//
-			m_minBoxX = CALC_RANGE( vecOrigin.x - flDist, m_RegionMin[0], m_RegionMax[0] );
-			m_maxBoxX = CALC_RANGE( vecOrigin.x + flDist, m_RegionMin[0], m_RegionMax[0] );
-			m_minBoxY = CALC_RANGE( vecOrigin.y - flDist, m_RegionMin[1], m_RegionMax[1] );
-			m_maxBoxY = CALC_RANGE( vecOrigin.y + flDist, m_RegionMin[1], m_RegionMax[1] );
-			m_minBoxZ = CALC_RANGE( vecOrigin.z - flDist, m_RegionMin[2], m_RegionMax[2] );
-			m_maxBoxZ = CALC_RANGE( vecOrigin.z + flDist, m_RegionMin[2], m_RegionMax[2] );
-		}
-	}
-}
-
 //=========================================================
 // CGraph - FindNearestNode - returns the index of the node nearest
 // the given vector -1 is failure (couldn't find a valid
@@ -837,8 +812,7 @@ int CGraph::FindNearestNode( const Vector &vecOrigin,  CBaseEntity *pEntity )
 
 int CGraph::FindNearestNode( const Vector &vecOrigin, int afNodeTypes )
 {
-	int i;
-	TraceResult tr;
+	extern cvar_t findnearestnodefix;
 
 	if( !m_fGraphPresent || !m_fGraphPointersSet )
 	{
@@ -849,241 +823,39 @@ int CGraph::FindNearestNode( const Vector &vecOrigin, int afNodeTypes )
 
 	// Check with the cache
 	//
-	ULONG iHash = ( CACHE_SIZE - 1 ) & Hash( (void *)(const float *)vecOrigin, sizeof(vecOrigin) );
-	if( m_Cache[iHash].v == vecOrigin )
-	{
-		//ALERT( at_aiconsole, "Cache Hit.\n" );
-		return m_Cache[iHash].n;
-	}
-/*	else
-	{
-		//ALERT( at_aiconsole, "Cache Miss.\n" );
-	}
-*/
-	// Mark all points as unchecked.
-	//
-	m_CheckedCounter++;
-	if( m_CheckedCounter == 0 )
-	{
-		for( i = 0; i < m_cNodes; i++ )
-		{
-			m_di[i].m_CheckedEvent = 0;
-		}
-		m_CheckedCounter++;
-	}
+	int iNearest;
+	if( sv_nearest_node_cache.value && g_NodeSearchTree.LookupCache( vecOrigin, afNodeTypes, iNearest ) )
+		return iNearest;
 
-	m_iNearest = -1;
-	m_flShortest = 999999.0f; // just a big number.
+	Vector vecStart = vecOrigin;
+	if( findnearestnodefix.value )
+		vecStart.z += NODE_HEIGHT;
 
-	// If we can find a visible point, then let CalcBounds set the limits, but if
-	// we have no visible point at all to start with, then don't restrict the limits.
+	// Nodes come closest first, so the first node we can trace to is the nearest one
 	//
-#if 1
-	m_minX = 0; m_maxX = 255;
-	m_minY = 0; m_maxY = 255;
-	m_minZ = 0; m_maxZ = 255;
-	m_minBoxX = 0; m_maxBoxX = 255;
-	m_minBoxY = 0; m_maxBoxY = 255;
-	m_minBoxZ = 0; m_maxBoxZ = 255;
-#else
-	m_minBoxX = CALC_RANGE( vecOrigin.x - flDist, m_RegionMin[0], m_RegionMax[0] );
-	m_maxBoxX = CALC_RANGE( vecOrigin.x + flDist, m_RegionMin[0], m_RegionMax[0] );
-	m_minBoxY = CALC_RANGE( vecOrigin.y - flDist, m_RegionMin[1], m_RegionMax[1] );
-	m_maxBoxY = CALC_RANGE( vecOrigin.y + flDist, m_RegionMin[1], m_RegionMax[1] );
-	m_minBoxZ = CALC_RANGE( vecOrigin.z - flDist, m_RegionMin[2], m_RegionMax[2] );
-	m_maxBoxZ = CALC_RANGE( vecOrigin.z + flDist, m_RegionMin[2], m_RegionMax[2] );
-	CalcBounds( m_minX, m_maxX, CALC_RANGE( vecOrigin.x, m_RegionMin[0], m_RegionMax[0] ), m_pNodes[m_iNearest].m_Region[0] );
-	CalcBounds( m_minY, m_maxY, CALC_RANGE( vecOrigin.y, m_RegionMin[1], m_RegionMax[1] ), m_pNodes[m_iNearest].m_Region[1] );
-	CalcBounds( m_minZ, m_maxZ, CALC_RANGE( vecOrigin.z, m_RegionMin[2], m_RegionMax[2] ), m_pNodes[m_iNearest].m_Region[2] );
-#endif
-	int halfX = ( m_minX + m_maxX ) / 2;
-	int halfY = ( m_minY + m_maxY ) / 2;
-	int halfZ = ( m_minZ + m_maxZ ) / 2;
-
-	int j;
-
-	for( i = halfX; i >= m_minX; i-- )
-	{
-		for( j = m_RangeStart[0][i]; j <= m_RangeEnd[0][i]; j++ )
-		{
-			if( !( m_pNodes[m_di[j].m_SortedBy[0]].m_afNodeInfo & afNodeTypes ) )
-				continue;
-
-			int rgY = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[1];
-			if( rgY > m_maxBoxY )
-				break;
-
-			if( rgY < m_minBoxY )
-				continue;
-
-			int rgZ = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[2];
-			if( rgZ < m_minBoxZ )
-				continue;
-
-			if( rgZ > m_maxBoxZ )
-				continue;
-
-			CheckNode( vecOrigin, m_di[j].m_SortedBy[0] );
-		}
-	}
-
-	for( i = Q_max( m_minY, halfY + 1 ); i <= m_maxY; i++ )
-	{
-		for( j = m_RangeStart[1][i]; j <= m_RangeEnd[1][i]; j++ )
-		{
-			if( !( m_pNodes[m_di[j].m_SortedBy[1]].m_afNodeInfo & afNodeTypes ) )
-				continue;
-
-			int rgZ = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[2];
-			if( rgZ > m_maxBoxZ )
-				break;
-
-			if( rgZ < m_minBoxZ )
-				continue;
-
-			int rgX = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[0];
-			if( rgX < m_minBoxX )
-				continue;
-
-			if( rgX > m_maxBoxX )
-				continue;
-
-			CheckNode( vecOrigin, m_di[j].m_SortedBy[1] );
-		}
-	}
-
-	for( i = Q_min( m_maxZ, halfZ ); i >= m_minZ; i-- )
-	{
-		for( j = m_RangeStart[2][i]; j <= m_RangeEnd[2][i]; j++ )
-		{
-			if( !( m_pNodes[m_di[j].m_SortedBy[2]].m_afNodeInfo & afNodeTypes ) )
-				continue;
-
-			int rgX = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[0];
-			if( rgX > m_maxBoxX )
-				break;
-
-			if( rgX < m_minBoxX )
-				continue;
-
-			int rgY = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[1];
-			if( rgY < m_minBoxY )
-				continue;
-
-			if( rgY > m_maxBoxY )
-				continue;
-
-			CheckNode( vecOrigin, m_di[j].m_SortedBy[2] );
-		}
-	}
-
-	for( i = Q_max( m_minX, halfX + 1 ); i <= m_maxX; i++ )
-	{
-		for( j = m_RangeStart[0][i]; j <= m_RangeEnd[0][i]; j++ )
-		{
-			if( !( m_pNodes[m_di[j].m_SortedBy[0]].m_afNodeInfo & afNodeTypes ) )
-				continue;
-
-			int rgY = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[1];
-			if( rgY > m_maxBoxY )
-				break;
-			if( rgY < m_minBoxY )
-				continue;
-
-			int rgZ = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[2];
-			if( rgZ < m_minBoxZ )
-				continue;
-			if( rgZ > m_maxBoxZ )
-				continue;
-			CheckNode( vecOrigin, m_di[j].m_SortedBy[0] );
-		}
-	}
-
-	for( i = Q_min( m_maxY, halfY ); i >= m_minY; i-- )
-	{
-		for( j = m_RangeStart[1][i]; j <= m_RangeEnd[1][i]; j++ )
-		{
-			if( !( m_pNodes[m_di[j].m_SortedBy[1]].m_afNodeInfo & afNodeTypes ) )
-				continue;
-
-			int rgZ = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[2];
-			if( rgZ > m_maxBoxZ )
-				break;
-			if( rgZ < m_minBoxZ )
-				continue;
-			int rgX = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[0];
-			if( rgX < m_minBoxX )
-				continue;
-			if( rgX > m_maxBoxX )
-				continue;
-			CheckNode( vecOrigin, m_di[j].m_SortedBy[1] );
-		}
-	}
-
-	for( i = Q_max( m_minZ, halfZ + 1 ); i <= m_maxZ; i++ )
+	iNearest = -1;
+	int cTraces = 0;
+	int iNode;
+	float flDist;
+	g_NodeSearchTree.BeginSearch( *this, vecOrigin, afNodeTypes );
+	while( ( iNode = g_NodeSearchTree.NextNode( flDist ) ) != -1 )
 	{
-		for( j = m_RangeStart[2][i]; j <= m_RangeEnd[2][i]; j++ )
-		{
-			if( !( m_pNodes[m_di[j].m_SortedBy[2]].m_afNodeInfo & afNodeTypes ) )
-				continue;
-
-			int rgX = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[0];
-			if( rgX > m_maxBoxX )
-				break;
-			if( rgX < m_minBoxX )
-				continue;
-			int rgY = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[1];
-			if( rgY < m_minBoxY )
-				continue;
-			if( rgY > m_maxBoxY )
-				continue;
-			CheckNode(vecOrigin, m_di[j].m_SortedBy[2]);
-		}
-	}
-
-#if 0
-	// Verify our answers.
-	//
-	int iNearestCheck = -1;
-	m_flShortest = 8192;// find nodes within this radius
+		TraceResult tr;
 
-	for( i = 0; i < m_cNodes; i++ )
-	{
-		float flDist = ( vecOrigin - m_pNodes[i].m_vecOriginPeek ).Length();
+		// make sure that vecOrigin can trace to this node!
+		UTIL_TraceLine( vecStart, m_pNodes[iNode].m_vecOriginPeek, ignore_monsters, 0, &tr );
+		cTraces++;
 
-		if( flDist < m_flShortest )
+		if( tr.flFraction == 1.0f )
 		{
-			// make sure that vecOrigin can trace to this node!
-			UTIL_TraceLine( vecOrigin, m_pNodes[i].m_vecOriginPeek, ignore_monsters, 0, &tr );
-
-			if( tr.flFraction == 1.0 )
-			{
-				iNearestCheck = i;
-				m_flShortest = flDist;
-			}
+			iNearest = iNode;
+			break;
 		}
 	}
 
-	if( iNearestCheck != m_iNearest )
-	{
-		ALERT( at_aiconsole, "NOT closest %d(%f,%f,%f) %d(%f,%f,%f).\n",
-			iNearestCheck,
-			m_pNodes[iNearestCheck].m_vecOriginPeek.x,
-			m_pNodes[iNearestCheck].m_vecOriginPeek.y,
-			m_pNodes[iNearestCheck].m_vecOriginPeek.z,
-			m_iNearest,
-			( m_iNearest == -1?0.0:m_pNodes[m_iNearest].m_vecOriginPeek.x ),
-			( m_iNearest == -1?0.0:m_pNodes[m_iNearest].m_vecOriginPeek.y ),
-			( m_iNearest == -1?0.0:m_pNodes[m_iNearest].m_vecOriginPeek.z ) );
-	}
-	if( m_iNearest == -1 )
-	{
-		ALERT( at_aiconsole, "All that work for nothing.\n" );
-	}
-#endif
-	m_Cache[iHash].v = vecOrigin;
-	m_Cache[iHash].n = m_iNearest;
-	return m_iNearest;
+	g_NodeSearchTree.CountQuery( cTraces, iNearest != -1 );
+	g_NodeSearchTree.StoreCache( vecOrigin, afNodeTypes, iNearest );
+	return iNearest;
 }
 
 //=========================================================
@@ -1154,50 +926,59 @@ static void ResetMonsterclip()
 // function of node graph creation, this connects every
 // node to every other node that it can see. Expects a 
 // pointer to an empty connection pool and a file pointer 
-// to write progress to. Returns the total number of initial
-// links.
+// to write progress to.
+//
+// Links the nodes from *piNode on until cMaxTraces traces
+// were made, then stores the node to continue from in
+// *piNode. All nodes are linked once *piNode reaches
+// m_cNodes. Returns the number of initial links made so
+// far, or -1 on failure.
 //
 // If there's a problem with this process, the index
 // of the offending node will be written to piBadNode
 //=========================================================
-int CGraph::LinkVisibleNodes( CLink *pLinkPool, FILE *file, int *piBadNode )
+int CGraph::LinkVisibleNodes( CLink *pLinkPool, FILE *file, int *piBadNode, int *piNode, int cMaxTraces )
 {
 	int i, j, z;
 	edict_t *pTraceEnt;
 	int cTotalLinks, cLinksThisNode, cMaxInitialLinks;
+	int cTraces;
 	TraceResult tr;
 
-	// !!!BUGBUG - this function returns 0 if there is a problem in the middle of connecting the graph
-	// it also returns 0 if none of the nodes in a level can see each other. piBadNode is ALWAYS read
-	// by BuildNodeGraph() if this function returns a 0, so make sure that it doesn't get some random
-	// number back.
+	// piBadNode is ALWAYS read by the test hull if this function fails, so make sure
+	// that it doesn't get some random number back.
 	*piBadNode = 0;
 
 	if( m_cNodes <= 0 )
 	{
 		ALERT( at_aiconsole, "No Nodes!\n" );
-		return 0;
+		return -1;
 	}
 
-	// if the file pointer is bad, don't blow up, just don't write the
-	// file.
-	if( !file )
+	if( *piNode == 0 )
 	{
-		ALERT( at_aiconsole, "**LinkVisibleNodes:\ncan't write to file." );
+		// if the file pointer is bad, don't blow up, just don't write the
+		// file.
+		if( !file )
+		{
+			ALERT( at_aiconsole, "**LinkVisibleNodes:\ncan't write to file." );
+		}
+		else
+		{
+			fprintf( file, "----------------------------------------------------------------------------\n" );
+			fprintf( file, "LinkVisibleNodes - Initial Connections\n" );
+			fprintf( file, "----------------------------------------------------------------------------\n" );
+		}
+
+		cTotalLinks = 0;// start with no connections
 	}
 	else
 	{
-		fprintf( file, "----------------------------------------------------------------------------\n" );
-		fprintf( file, "LinkVisibleNodes - Initial Connections\n" );
-		fprintf( file, "----------------------------------------------------------------------------\n" );
+		// the links of the nodes done so far are packed at the start of the pool
+		cTotalLinks = m_pNodes[*piNode - 1].m_iFirstLink + m_pNodes[*piNode - 1].m_cNumLinks;
 	}
 
-	cTotalLinks = 0;// start with no connections
-
-	// to keep track of the maximum number of initial links any node had so far.
-	// this lets us keep an eye on MAX_NODE_INITIAL_LINKS to ensure that we are
-	// being generous enough.
-	cMaxInitialLinks = 0;
+	cTraces = 0;
 
 	CBaseEntity* pMonsterclip = NULL;
 	while ( (pMonsterclip = UTIL_FindEntityByClassname(pMonsterclip, "func_monsterclip")) != 0 ) {
@@ -1205,7 +986,7 @@ int CGraph::LinkVisibleNodes( CLink *pLinkPool, FILE *file, int *piBadNode )
 		SetBits(pMonsterclip->pev->flags, FL_WORLDBRUSH);
 	}
 
-	for( i = 0; i < m_cNodes; i++ )
+	for( i = *piNode; i < m_cNodes && cTraces < cMaxTraces; i++ )
 	{
 		cLinksThisNode = 0;// reset this count for each node.
 
@@ -1247,6 +1028,7 @@ int CGraph::LinkVisibleNodes( CLink *pLinkPool, FILE *file, int *piBadNode )
 #endif
 			tr.pHit = NULL;// clear every time so we don't get stuck with last trace's hit ent
 			pTraceEnt = 0;
+			cTraces++;
 
 			UTIL_TraceLine( m_pNodes[i].m_vecOrigin,
 							m_pNodes[j].m_vecOrigin,
@@ -1261,6 +1043,7 @@ int CGraph::LinkVisibleNodes( CLink *pLinkPool, FILE *file, int *piBadNode )
 			{
 				// trace hit a brush ent, trace backwards to make sure that this ent is the only thing in the way.
 				pTraceEnt = tr.pHit;// store the ent that the trace hit, for comparison
+				cTraces++;
 
 				UTIL_TraceLine( m_pNodes[j].m_vecOrigin,
 								m_pNodes[i].m_vecOrigin,
@@ -1322,7 +1105,7 @@ int CGraph::LinkVisibleNodes( CLink *pLinkPool, FILE *file, int *piBadNode )
 				*piBadNode = i;
 
 				ResetMonsterclip();
-				return 0;
+				return -1;
 			}
 			else if( cTotalLinks > MAX_NODE_INITIAL_LINKS * m_cNodes )
 			{
@@ -1331,7 +1114,7 @@ int CGraph::LinkVisibleNodes( CLink *pLinkPool, FILE *file, int *piBadNode )
 				*piBadNode = i;
 
 				ResetMonsterclip();
-				return 0;
+				return -1;
 			}
 
 			if( cLinksThisNode == 0 )
@@ -1341,13 +1124,6 @@ int CGraph::LinkVisibleNodes( CLink *pLinkPool, FILE *file, int *piBadNode )
 
 			// record the connection info in the link pool
 			WorldGraph.m_pNodes[i].m_cNumLinks = cLinksThisNode;
-
-			// keep track of the most initial links ANY node had, so we can figure out
-			// if we have a large enough default link pool
-			if( cLinksThisNode > cMaxInitialLinks )
-			{
-				cMaxInitialLinks = cLinksThisNode;
-			}
 		}
 
 		if( file )
@@ -1358,6 +1134,26 @@ int CGraph::LinkVisibleNodes( CLink *pLinkPool, FILE *file, int *piBadNode )
 
 	ResetMonsterclip();
 
+	*piNode = i;
+
+	if( i < m_cNodes )
+	{
+		// out of traces, the caller continues from here later
+		return cTotalLinks;
+	}
+
+	// keep track of the most initial links ANY node had, so we can figure out
+	// if we have a large enough default link pool
+	cMaxInitialLinks = 0;
+
+	for( i = 0; i < m_cNodes; i++ )
+	{
+		if( m_pNodes[i].m_cNumLinks > cMaxInitialLinks )
+		{
+			cMaxInitialLinks = m_pNodes[i].m_cNumLinks;
+		}
+	}
+
 	fprintf( file, "\n%4d Total Initial Connections - %4d Maximum connections for a single node.\n", cTotalLinks, cMaxInitialLinks );
 	fprintf( file, "----------------------------------------------------------------------------\n\n\n" );
 
@@ -1471,9 +1267,16 @@ public:
 	virtual int ObjectCaps( void ) { return CBaseMonster :: ObjectCaps() & ~FCAP_ACROSS_TRANSITION; }
 	void EXPORT CallBuildNodeGraph ( void );
 	void BuildNodeGraph( void );
+	void EXPORT ConnectVisibleNodes( void );
+	void EXPORT CallWalkNodeLinks( void );
+	void WalkNodeLinks( void );
+	void FinishNodeGraph( void );
+	void BeginWalk( void );
+	void EndWalk( void );
 	void EXPORT ShowBadNode( void );
 	void EXPORT DropDelay( void );
 	void EXPORT PathFind( void );
+	void EXPORT WaitForRouting( void );
 
 	Vector vecBadNodeOrigin;
 };
@@ -1488,7 +1291,7 @@ void CTestHull::Spawn( entvars_t *pevMasterNode )
 	SET_MODEL( ENT( pev ), "models/player.mdl" );
 	UTIL_SetSize( pev, VEC_HUMAN_HULL_MIN, VEC_HUMAN_HULL_MAX );
 
-	pev->solid = SOLID_SLIDEBOX;
+	pev->solid = SOLID_NOT;// only solid while WalkNodeLinks walks it, so it doesn't block anyone between frames
 	pev->movetype = MOVETYPE_STEP;
 	pev->effects = 0;
 	pev->health = 50;
@@ -1633,57 +1436,88 @@ static void ResetWallToggle()
 	}
 }
 
+// Clients and monsters made passable while the hull walks, with their solid type
+struct passable_t
+{
+	edict_t	*pent;
+	int	solid;
+};
+
+static std::vector<passable_t> gPassableEnts;
+
+//=========================================================
+// BeginWalk - makes the hull solid and lets it walk through
+// clients and monsters, so only the world geometry decides
+// which links are rejected.
+//=========================================================
+void CTestHull::BeginWalk( void )
+{
+	CBaseEntity* pWallToggle = NULL;
+	while ( (pWallToggle = UTIL_FindEntityByClassname(pWallToggle, "func_wall_toggle")) != 0 ) {
+		ClearBits(pWallToggle->pev->flags, FL_WORLDBRUSH);
+	}
+
+	gPassableEnts.clear();
+
+	edict_t *pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
+	for( int i = 1; i < gpGlobals->maxEntities; i++, pEdict++ )
+	{
+		if( pEdict->free || pEdict == edict() )
+			continue;
+
+		if( !FBitSet( pEdict->v.flags, FL_CLIENT | FL_MONSTER ) || pEdict->v.solid == SOLID_NOT )
+			continue;
+
+		passable_t passable = { pEdict, pEdict->v.solid };
+		gPassableEnts.push_back( passable );
+		pEdict->v.solid = SOLID_NOT;
+	}
+
+	pev->solid = SOLID_SLIDEBOX;
+}
+
+//=========================================================
+// EndWalk - undoes BeginWalk, the hull stays out of
+// everyone's way until the next walk.
+//=========================================================
+void CTestHull::EndWalk( void )
+{
+	ResetWallToggle();
+
+	for( size_t i = 0; i < gPassableEnts.size(); i++ )
+	{
+		gPassableEnts[i].pent->v.solid = gPassableEnts[i].solid;
+	}
+	gPassableEnts.clear();
+
+	pev->solid = SOLID_NOT;
+	UTIL_SetOrigin( pev, pev->origin );// relink as not solid
+}
+
 //=========================================================
 // BuildNodeGraph - think function called by the empty walk
 // hull that is spawned by the first node to spawn. This
-// function links all nodes that can see each other, then
-// eliminates all inline links, then uses a monster-sized 
-// hull that walks between each node and each of its links
-// to ensure that a monster can actually fit through the space
+// starts the graph build, which links all nodes that can see
+// each other, then uses a monster-sized hull that walks
+// between each node and each of its links to ensure that a
+// monster can actually fit through the space, then eliminates
+// all inline links. The linking and walking are spread
+// across frames, see ConnectVisibleNodes and WalkNodeLinks.
 //=========================================================
 void CTestHull::BuildNodeGraph( void )
 {
-	//TraceResult tr;
 	FILE *file;
 
 	char szNrpFilename [MAX_PATH];// text node report filename
 
 	CLink *pTempPool; // temporary link pool 
 
-	CNode *pSrcNode;// node we're currently working with
-	CNode *pDestNode;// the other node in comparison operations
+	int i;
 
-	bool fSkipRemainingHulls;//if smallest hull can't fit, don't check any others
-	bool fPairsValid;// are all links in the graph evenly paired?
+	SetThink( &CBaseEntity::SUB_Remove );// no matter what happens, the hull gets rid of itself.
+	pev->nextthink = gpGlobals->time;
 
-	int i, j, hull;
-
-	int iBadNode;// this is the node that caused graph generation to fail
-
-	//int cMaxInitialLinks = 0;
-	//int cMaxValidLinks = 0;
-
-	//int iPoolIndex = 0;
-	int cPoolLinks;// number of links in the pool.
-
-	Vector vecDirToCheckNode;
-	Vector vecDirToTestNode;
-	Vector vecStepCheckDir;
-	Vector vecTraceSpot;
-	Vector vecSpot;
-
-	Vector2D vec2DirToCheckNode;
-	Vector2D vec2DirToTestNode;
-	Vector2D vec2StepCheckDir;
-	Vector2D vec2TraceSpot;
-	Vector2D vec2Spot;
-
-	float flYaw;// use this stuff to walk the hull between nodes
-	float flDist;
-	int step;
-
-	SetThink( &CBaseEntity::SUB_Remove );// no matter what happens, the hull gets rid of itself.
-	pev->nextthink = gpGlobals->time;
+	FreeNodeBuild();
 
 	//malloc a swollen temporary connection pool that we trim down after we know exactly how many connections there are.
 	pTempPool = (CLink *)calloc( sizeof(CLink), ( WorldGraph.m_cNodes * MAX_NODE_INITIAL_LINKS ) );
@@ -1788,9 +1622,40 @@ void CTestHull::BuildNodeGraph( void )
 		}
 	}
 
-	cPoolLinks = WorldGraph.LinkVisibleNodes( pTempPool, file, &iBadNode );
+	gNodeBuild.file = file;
+	gNodeBuild.pTempPool = pTempPool;
+
+	SetThink( &CTestHull::ConnectVisibleNodes );
+}
+
+//=========================================================
+// ConnectVisibleNodes - think function of the test hull
+// while it links the nodes that can see each other. Links
+// as many nodes as the trace budget allows each frame.
+//=========================================================
+void CTestHull::ConnectVisibleNodes( void )
+{
+	int iBadNode;// this is the node that caused graph generation to fail
+
+	SetThink( &CBaseEntity::SUB_Remove );// no matter what happens, the hull gets rid of itself.
+	pev->nextthink = gpGlobals->time;
 
-	if( !cPoolLinks )
+	if( !gNodeBuild.pTempPool )
+	{
+		// build was cancelled (e.g. the game was restored)
+		return;
+	}
+
+	gNodeBuild.cPoolLinks = WorldGraph.LinkVisibleNodes( gNodeBuild.pTempPool, gNodeBuild.file, &iBadNode, &gNodeBuild.iNode, NODE_BUILD_TRACES_PER_FRAME );
+
+	if( gNodeBuild.cPoolLinks >= 0 && gNodeBuild.iNode < WorldGraph.m_cNodes )
+	{
+		// link the rest of the nodes on the next frames
+		SetThink( &CTestHull::ConnectVisibleNodes );
+		return;
+	}
+
+	if( gNodeBuild.cPoolLinks <= 0 )
 	{
 		ALERT( at_aiconsole, "**ConnectVisibleNodes FAILED!\n" );
 
@@ -1798,39 +1663,91 @@ void CTestHull::BuildNodeGraph( void )
 		//pev->solid = SOLID_NOT;
 		pev->origin = WorldGraph.m_pNodes[iBadNode].m_vecOrigin;
 
-		if( pTempPool )
-		{
-			free( pTempPool );
-		}
-
-		if( file )
-		{
-			// close the file
-			fclose( file );
-		}
-
+		FreeNodeBuild();
 		return;
 	}
 
 	// send the walkhull to all of this node's connections now. We'll do this here since
 	// so much of it relies on being able to control the test hull.
-	fprintf( file, "----------------------------------------------------------------------------\n" );
-	fprintf( file, "Walk Rejection:\n");	
+	fprintf( gNodeBuild.file, "----------------------------------------------------------------------------\n" );
+	fprintf( gNodeBuild.file, "Walk Rejection:\n");	
 
-	CBaseEntity* pWallToggle = NULL;
-	while ( (pWallToggle = UTIL_FindEntityByClassname(pWallToggle, "func_wall_toggle")) != 0 ) {
-		ClearBits(pWallToggle->pev->flags, FL_WORLDBRUSH);
+	gNodeBuild.iNode = 0;
+	gNodeBuild.iLink = 0;
+
+	SetThink( &CTestHull::CallWalkNodeLinks );
+}
+
+void CTestHull::CallWalkNodeLinks( void )
+{
+	// TOUCH HACK -- Don't allow this entity to call anyone's "touch" function
+	gTouchDisabled = true;
+	WalkNodeLinks();
+	gTouchDisabled = false;
+	// Undo TOUCH HACK
+}
+
+//=========================================================
+// WalkNodeLinks - walks the hull along the links made by
+// ConnectVisibleNodes, as many steps as the trace budget
+// allows each frame, and rejects the links no hull fits
+// through. Finishes the graph once all links are walked.
+//=========================================================
+void CTestHull::WalkNodeLinks( void )
+{
+	FILE *file = gNodeBuild.file;
+
+	CLink *pTempPool = gNodeBuild.pTempPool; // temporary link pool 
+
+	CNode *pSrcNode;// node we're currently working with
+	CNode *pDestNode;// the other node in comparison operations
+
+	bool fSkipRemainingHulls;//if smallest hull can't fit, don't check any others
+
+	int i, j, hull;
+
+	int cTraces = 0;// traces and hull steps taken this frame
+
+	Vector vecSpot;
+
+	float flYaw;// use this stuff to walk the hull between nodes
+	float flDist;
+	int step;
+
+	SetThink( &CBaseEntity::SUB_Remove );// no matter what happens, the hull gets rid of itself.
+	pev->nextthink = gpGlobals->time;
+
+	if( !pTempPool )
+	{
+		// build was cancelled (e.g. the game was restored)
+		return;
 	}
 
-	for( i = 0; i < WorldGraph.m_cNodes; i++ )
+	BeginWalk();
+
+	for( i = gNodeBuild.iNode; i < WorldGraph.m_cNodes; i++ )
 	{
 		pSrcNode = &WorldGraph.m_pNodes[i];
 
-		fprintf( file, "-------------------------------------------------------------------------------\n" );
-		fprintf( file, "Node %4d:\n\n", i );
+		if( gNodeBuild.iLink == 0 )
+		{
+			fprintf( file, "-------------------------------------------------------------------------------\n" );
+			fprintf( file, "Node %4d:\n\n", i );
+		}
 
-		for( j = 0; j < pSrcNode->m_cNumLinks; j++ )
+		for( j = gNodeBuild.iLink; j < pSrcNode->m_cNumLinks; j++ )
 		{
+			if( cTraces >= NODE_BUILD_TRACES_PER_FRAME )
+			{
+				// walk the rest of the links on the next frames
+				gNodeBuild.iNode = i;
+				gNodeBuild.iLink = j;
+
+				EndWalk();
+				SetThink( &CTestHull::CallWalkNodeLinks );
+				return;
+			}
+
 			// assume that all hulls can walk this link, then eliminate the ones that can't.
 			pTempPool[pSrcNode->m_iFirstLink + j].m_afLinkInfo = bits_LINK_SMALL_HULL | bits_LINK_HUMAN_HULL | bits_LINK_LARGE_HULL | bits_LINK_FLY_HULL;
 
@@ -1872,18 +1789,8 @@ void CTestHull::BuildNodeGraph( void )
 				if( j < 0 )
 				{
 					ALERT( at_aiconsole, "**** j = %d ****\n", j );
-					if( pTempPool )
-					{
-						free( pTempPool );
-					}
-
-					if( file )
-					{
-						// close the file
-						fclose( file );
-					}
-
-					ResetWallToggle();
+					FreeNodeBuild();
+					EndWalk();
 					return;
 				}
 				
@@ -1917,6 +1824,8 @@ void CTestHull::BuildNodeGraph( void )
 						if( ( step + stepSize ) >= ( flDist - 1 ) )
 							stepSize = ( flDist - step ) - 1;
 
+						cTraces++;
+
 						if( !WALK_MOVE( ENT( pev ), flYaw, stepSize, MoveMode ) )
 						{
 							// can't take the next step
@@ -1961,6 +1870,8 @@ void CTestHull::BuildNodeGraph( void )
 				{
 					TraceResult tr;
 
+					cTraces++;
+
 					UTIL_TraceHull( pSrcNode->m_vecOrigin + Vector( 0, 0, 32 ), pDestNode->m_vecOriginPeek + Vector( 0, 0, 32 ), ignore_monsters, large_hull, ENT( pev ), &tr );
 					if( tr.fStartSolid || tr.flFraction < 1.0f )
 					{
@@ -1976,15 +1887,37 @@ void CTestHull::BuildNodeGraph( void )
 				fprintf( file, "Any Hull\n" );
 
 				pSrcNode->m_cNumLinks--;
-				cPoolLinks--;// we just removed a link, so decrement the total number of links in the pool.
+				gNodeBuild.cPoolLinks--;// we just removed a link, so decrement the total number of links in the pool.
 				j--;
 			}
 
 		}
+
+		gNodeBuild.iLink = 0;
 	}
 	fprintf( file, "-------------------------------------------------------------------------------\n\n\n" );
 
-	ResetWallToggle();
+	EndWalk();
+
+	FinishNodeGraph();
+}
+
+//=========================================================
+// FinishNodeGraph - eliminates the inline links, packs the
+// links into the graph's pool and builds the lookup tables
+// once every link is walked, then starts the routing.
+//=========================================================
+void CTestHull::FinishNodeGraph( void )
+{
+	FILE *file = gNodeBuild.file;
+
+	CLink *pTempPool = gNodeBuild.pTempPool; // temporary link pool 
+
+	bool fPairsValid;// are all links in the graph evenly paired?
+
+	int i, j;
+
+	int cPoolLinks = gNodeBuild.cPoolLinks;// number of links in the pool.
 
 	cPoolLinks -= WorldGraph.RejectInlineLinks( pTempPool, file );
 
@@ -1995,16 +1928,7 @@ void CTestHull::BuildNodeGraph( void )
 	{
 		// couldn't make the link pool!
 		ALERT( at_aiconsole, "Couldn't malloc LinkPool!\n" );
-		if( pTempPool )
-		{
-			free( pTempPool );
-		}
-		if( file )
-		{
-			// close the file
-			fclose( file );
-		}
-
+		FreeNodeBuild();
 		return;
 	}
 	WorldGraph.m_cLinks = cPoolLinks;
@@ -2090,16 +2014,8 @@ void CTestHull::BuildNodeGraph( void )
 		}
 	}
 
-	if( pTempPool )
-	{
-		// free the temp pool
-		free( pTempPool );
-	}
-
-	if( file )
-	{
-		fclose( file );
-	}
+	// free the temp pool and close the report
+	FreeNodeBuild();
 
 	// We now have some graphing capabilities.
 	//
@@ -2107,13 +2023,43 @@ void CTestHull::BuildNodeGraph( void )
 	WorldGraph.m_fGraphPointersSet = 1;// since the graph was generated, the pointers are ready
 	WorldGraph.m_fRoutingComplete = 0; // Optimal routes aren't computed, yet.
 
-	// Compute and compress the routing information.
+	// Compute and compress the routing information. This runs in the background,
+	// monsters use dynamic pathfinding until routes are ready.
 	//
-	WorldGraph.ComputeStaticRoutingTables();
+	g_NodeRoutingBuilder.Start( WorldGraph );
+	SetThink( &CTestHull::WaitForRouting );
+	pev->nextthink = gpGlobals->time;
+}
+
+//=========================================================
+// WaitForRouting - think function of the test hull after
+// the graph is built. Saves the node graph once the routing
+// tables are computed.
+//=========================================================
+void CTestHull::WaitForRouting( void )
+{
+	if( !g_NodeRoutingBuilder.IsRunning() )
+	{
+		// build was cancelled (e.g. the game was restored)
+		SetThink( &CBaseEntity::SUB_Remove );
+		pev->nextthink = gpGlobals->time;
+		return;
+	}
+
+	if( !g_NodeRoutingBuilder.IsDone() )
+	{
+		pev->nextthink = gpGlobals->time + 0.1f;
+		return;
+	}
+
+	g_NodeRoutingBuilder.Finish( WorldGraph );
 
 	// save the node graph for this level	
 	WorldGraph.FSaveGraph( STRING( gpGlobals->mapname ) );
 	ALERT( at_console, "Done.\n" );
+
+	SetThink( &CBaseEntity::SUB_Remove );
+	pev->nextthink = gpGlobals->time;
 }
 
 //=========================================================
@@ -2367,6 +2313,124 @@ void CQueuePriority::Heap_SiftUp( void )
 // will be loaded. If file cannot be loaded, the node tree
 // will be created and saved to disk.
 //=========================================================
+// Part of CGraph written to the graph files of the older formats
+#define GRAPH_LEGACY_CLASS_SIZE offsetof( CGraph, m_pGraphData )
+
+// Members of CGraph stored in the TABLES section of the graph file
+#define GRAPH_TABLES_SIZE (int)( offsetof( CGraph, m_pHashLinks ) - offsetof( CGraph, m_RangeStart ) )
+
+// Alignment of the sections in the graph file
+#define GRAPH_SECTION_ALIGN 16
+
+// The graph file read by CheckNODFile is handed over to FLoadGraph, so it's read only once
+static byte *g_pCheckedGraphFile = NULL;
+static int g_iCheckedGraphFileLength = 0;
+static char g_szCheckedGraphFile[MAX_PATH];
+
+static void FreeCheckedGraphFile( void )
+{
+	if( g_pCheckedGraphFile )
+	{
+		FREE_FILE( g_pCheckedGraphFile );
+		g_pCheckedGraphFile = NULL;
+	}
+	g_iCheckedGraphFileLength = 0;
+}
+
+static byte *LoadGraphFile( const char *szFilename, int *pLength )
+{
+	if( g_pCheckedGraphFile && strcmp( g_szCheckedGraphFile, szFilename ) == 0 )
+	{
+		byte *pData = g_pCheckedGraphFile;
+		*pLength = g_iCheckedGraphFileLength;
+		g_pCheckedGraphFile = NULL;
+		g_iCheckedGraphFileLength = 0;
+		return pData;
+	}
+
+	FreeCheckedGraphFile();
+	return LOAD_FILE_FOR_ME( szFilename, pLength );
+}
+
+static bool GraphBspChecksum( const char *szMapName, CRC32_t &checksum, int &size )
+{
+	char szBspFilename[MAX_PATH];
+	_snprintf( szBspFilename, sizeof(szBspFilename), "maps/%s.bsp", szMapName );
+
+	byte *pData = LOAD_FILE_FOR_ME( szBspFilename, &size );
+	if( !pData )
+		return false;
+
+	CRC32_INIT( &checksum );
+	CRC32_PROCESS_BUFFER( &checksum, pData, size );
+	checksum = CRC32_FINAL( checksum );
+	FREE_FILE( pData );
+	return true;
+}
+
+static bool GraphSectionValid( int offset, int count, int elementSize, int length )
+{
+	return offset >= (int)sizeof(GraphFileHeader) && count >= 0 && offset <= length && count <= ( length - offset ) / elementSize;
+}
+
+//=========================================================
+// CGraph - FSetGraphData - points the graph arrays into
+// the graph file of the current format. The graph takes
+// ownership of pData on success.
+//=========================================================
+bool CGraph::FSetGraphData( byte *pData, int length )
+{
+	if( length < (int)sizeof(GraphFileHeader) )
+		return false;
+
+	const GraphFileHeader *pHeader = (const GraphFileHeader *)pData;
+	if( pHeader->iHeaderSize != (int)sizeof(GraphFileHeader) || pHeader->iNodeSize != (int)sizeof(CNode)
+		|| pHeader->iLinkSize != (int)sizeof(CLink) || pHeader->iTablesSize != GRAPH_TABLES_SIZE )
+	{
+		ALERT( at_aiconsole, "**ERROR** Graph file layout doesn't match this build\n" );
+		return false;
+	}
+
+	if( pHeader->iFileSize != length
+		|| !GraphSectionValid( pHeader->iTablesOffset, 1, GRAPH_TABLES_SIZE, length )
+		|| !GraphSectionValid( pHeader->iNodesOffset, pHeader->cNodes, sizeof(CNode), length )
+		|| !GraphSectionValid( pHeader->iLinksOffset, pHeader->cLinks, sizeof(CLink), length )
+		|| !GraphSectionValid( pHeader->iDistInfoOffset, pHeader->cNodes, sizeof(DIST_INFO), length )
+		|| !GraphSectionValid( pHeader->iRouteInfoOffset, pHeader->nRouteInfo, sizeof(signed char), length )
+		|| !GraphSectionValid( pHeader->iHashLinksOffset, pHeader->nHashLinks, sizeof(short), length ) )
+	{
+		ALERT( at_aiconsole, "**ERROR** Graph file is corrupted\n" );
+		return false;
+	}
+
+	memcpy( (void *)m_RangeStart, pData + pHeader->iTablesOffset, GRAPH_TABLES_SIZE );
+
+	m_cNodes = pHeader->cNodes;
+	m_cLinks = pHeader->cLinks;
+	m_nRouteInfo = pHeader->nRouteInfo;
+	m_nHashLinks = pHeader->nHashLinks;
+
+	m_pNodes = (CNode *)( pData + pHeader->iNodesOffset );
+	m_pLinkPool = (CLink *)( pData + pHeader->iLinksOffset );
+	m_di = (DIST_INFO *)( pData + pHeader->iDistInfoOffset );
+	m_pRouteInfo = (signed char *)( pData + pHeader->iRouteInfoOffset );
+	m_pHashLinks = (short *)( pData + pHeader->iHashLinksOffset );
+	m_pGraphData = pData;
+
+	m_CheckedCounter = 0;
+	for( int i = 0; i < m_cNodes; i++ )
+	{
+		m_di[i].m_CheckedEvent = 0;
+	}
+
+	// Set the graph present flag, clear the pointers set flag
+	//
+	m_fRoutingComplete = 1;
+	m_fGraphPresent = 1;
+	m_fGraphPointersSet = 0;
+	return true;
+}
+
 bool CGraph::FLoadGraph( const char *szMapName )
 {
 	char szFilename[MAX_PATH];
@@ -2387,7 +2451,7 @@ bool CGraph::FLoadGraph( const char *szMapName )
 	strcat( szFilename, szMapName );
 	strcat( szFilename, ".nod" );
 
-	pMemFile = aMemFile = LOAD_FILE_FOR_ME( szFilename, &length );
+	pMemFile = aMemFile = LoadGraphFile( szFilename, &length );
 
 	if( !aMemFile )
 		return false;
@@ -2400,17 +2464,27 @@ bool CGraph::FLoadGraph( const char *szMapName )
 	iVersion = *(int *) pMemFile;
 	pMemFile += sizeof(int);
 
-	if( iVersion == GRAPH_VERSION || iVersion == GRAPH_VERSION_RETAIL )
+	if( iVersion == GRAPH_FILE_VERSION )
+	{
+		// The graph keeps the file
+		//
+		if( !FSetGraphData( aMemFile, length + sizeof(int) ) )
+			goto ShortFile;
+
+		ALERT( at_aiconsole, "Built graph successfully\n" );
+		return true;
+	}
+	else if( iVersion == GRAPH_VERSION || iVersion == GRAPH_VERSION_RETAIL )
 	{
 		// Read the graph class
 		//
 		if ( iVersion == GRAPH_VERSION )
 		{
-			length -= sizeof(CGraph);
+			length -= GRAPH_LEGACY_CLASS_SIZE;
 			if( length < 0 )
 				goto ShortFile;
-			memcpy( this, pMemFile, sizeof(CGraph) );
-			pMemFile += sizeof(CGraph);
+			memcpy( this, pMemFile, GRAPH_LEGACY_CLASS_SIZE );
+			pMemFile += GRAPH_LEGACY_CLASS_SIZE;
 
 			// Set the pointers to zero, just in case we run out of memory.
 			//
@@ -2573,9 +2647,16 @@ NoMemory:
 // CGraph - FSaveGraph - It's not rocket science.
 // this WILL overwrite existing files.
 //=========================================================
+struct GraphSection
+{
+	int *pOffset;
+	const void *pData;
+	int size;
+};
+
 bool CGraph::FSaveGraph( const char *szMapName )
 {
-	int iVersion = GRAPH_VERSION;
+	int iVersion = GRAPH_FILE_VERSION;
 	char szFilename[MAX_PATH];
 	FILE *file;
 
@@ -2609,31 +2690,55 @@ bool CGraph::FSaveGraph( const char *szMapName )
 	}
 	else
 	{
-		// write the version
-		fwrite( &iVersion, sizeof(int), 1, file );
+		GraphFileHeader header;
+		memset( &header, 0, sizeof(header) );
+		header.iVersion = iVersion;
+		header.iHeaderSize = sizeof(GraphFileHeader);
+		header.iNodeSize = sizeof(CNode);
+		header.iLinkSize = sizeof(CLink);
+		header.iTablesSize = GRAPH_TABLES_SIZE;
+		header.cNodes = m_cNodes;
+		header.cLinks = m_cLinks;
+		header.nRouteInfo = m_pRouteInfo ? m_nRouteInfo : 0;
+		header.nHashLinks = m_pHashLinks ? m_nHashLinks : 0;
 
-		// write the CGraph class
-		fwrite( this, sizeof(CGraph), 1, file );
-
-		// write the nodes
-		fwrite( m_pNodes, sizeof(CNode), m_cNodes, file );
-
-		// write the links
-		fwrite( m_pLinkPool, sizeof(CLink), m_cLinks, file );
+		if( !GraphBspChecksum( szMapName, header.bspChecksum, header.bspSize ) )
+		{
+			// the graph will be rebuilt on the next load
+			ALERT( at_aiconsole, "Couldn't compute the BSP checksum for %s\n", szFilename );
+			header.bspSize = -1;
+		}
 
-		fwrite( m_di, sizeof(DIST_INFO), m_cNodes, file );
+		const GraphSection sections[] = {
+			{ &header.iTablesOffset, m_RangeStart, GRAPH_TABLES_SIZE },
+			{ &header.iNodesOffset, m_pNodes, (int)sizeof(CNode) * m_cNodes },
+			{ &header.iLinksOffset, m_pLinkPool, (int)sizeof(CLink) * m_cLinks },
+			{ &header.iDistInfoOffset, m_di, (int)sizeof(DIST_INFO) * m_cNodes },
+			{ &header.iRouteInfoOffset, m_pRouteInfo, (int)sizeof(signed char) * header.nRouteInfo },
+			{ &header.iHashLinksOffset, m_pHashLinks, (int)sizeof(short) * header.nHashLinks },
+		};
 
-		// Write the route info.
-		//
-		if( m_pRouteInfo && m_nRouteInfo )
+		int offset = sizeof(GraphFileHeader);
+		for( size_t i = 0; i < ARRAYSIZE( sections ); i++ )
 		{
-			fwrite( m_pRouteInfo, sizeof(signed char), m_nRouteInfo, file );
+			offset = ( offset + GRAPH_SECTION_ALIGN - 1 ) & ~( GRAPH_SECTION_ALIGN - 1 );
+			*sections[i].pOffset = offset;
+			offset += sections[i].size;
 		}
+		header.iFileSize = offset;
+
+		fwrite( &header, sizeof(header), 1, file );
 
-		if( m_pHashLinks && m_nHashLinks )
+		offset = sizeof(GraphFileHeader);
+		for( size_t i = 0; i < ARRAYSIZE( sections ); i++ )
 		{
-			fwrite( m_pHashLinks, sizeof(short), m_nHashLinks, file );
+			static const byte padding[GRAPH_SECTION_ALIGN] = {};
+			fwrite( padding, 1, *sections[i].pOffset - offset, file );
+			if( sections[i].size )
+				fwrite( sections[i].pData, 1, sections[i].size, file );
+			offset = *sections[i].pOffset + sections[i].size;
 		}
+
 		fclose( file );
 		return true;
 	}
@@ -2722,6 +2827,38 @@ bool CGraph::CheckNODFile( const char *szMapName )
 
 	retValue = true;
 
+	// Graph files of the current format know which BSP they were built for,
+	// so they stay valid no matter what the file times are
+	//
+	FreeCheckedGraphFile();
+	g_pCheckedGraphFile = LOAD_FILE_FOR_ME( szGraphFilename, &g_iCheckedGraphFileLength );
+	strncpy( g_szCheckedGraphFile, szGraphFilename, sizeof(g_szCheckedGraphFile) - 1 );
+	g_szCheckedGraphFile[sizeof(g_szCheckedGraphFile) - 1] = '\0';
+
+	if( g_pCheckedGraphFile && g_iCheckedGraphFileLength >= (int)sizeof(GraphFileHeader)
+		&& ( (const GraphFileHeader *)g_pCheckedGraphFile )->iVersion == GRAPH_FILE_VERSION )
+	{
+		const GraphFileHeader *pHeader = (const GraphFileHeader *)g_pCheckedGraphFile;
+
+		// Cheap tests first, the BSP is only read again if it's newer than the graph
+		int bspSize = g_engfuncs.pfnGetFileSize ? g_engfuncs.pfnGetFileSize( szBspFilename ) : -1;
+		if( bspSize < 0 || bspSize == pHeader->bspSize )
+		{
+			int iCompare;
+			if( COMPARE_FILE_TIME( szBspFilename, szGraphFilename, &iCompare ) && iCompare <= 0 )
+				return true;
+
+			// BSP file is newer, but it may just have been copied over
+			CRC32_t bspChecksum;
+			if( GraphBspChecksum( szMapName, bspChecksum, bspSize ) && bspSize == pHeader->bspSize && bspChecksum == pHeader->bspChecksum )
+				return true;
+		}
+
+		ALERT( at_aiconsole, ".NOD File was built for a different BSP and will be updated\n\n" );
+		FreeCheckedGraphFile();
+		return false;
+	}
+
 	int iCompare;
 	if( COMPARE_FILE_TIME( szBspFilename, szGraphFilename, &iCompare ) )
 	{
@@ -2737,6 +2874,11 @@ bool CGraph::CheckNODFile( const char *szMapName )
 		retValue = false;
 	}
 
+	if( !retValue )
+	{
+		FreeCheckedGraphFile();
+	}
+
 	return retValue;
 }
 
@@ -3131,311 +3273,16 @@ void CGraph::BuildRegionTables( void )
 	// Initialize the cache.
 	//
 	memset( m_Cache, 0, sizeof(m_Cache) );
+	g_NodeSearchTree.Clear();
 }
 
 void CGraph::ComputeStaticRoutingTables( void )
 {
-	int iFrom;
-	int nRoutes = m_cNodes * m_cNodes;
-#define FROM_TO(x,y) ( ( x ) * m_cNodes + ( y ) )
-	short *Routes = new short[nRoutes];
-
-	int *pMyPath = new int[m_cNodes];
-	unsigned short *BestNextNodes = new unsigned short[m_cNodes];
-	signed char *pRoute = new signed char[m_cNodes*2];
-
-	if( Routes && pMyPath && BestNextNodes && pRoute )
-	{
-		int nTotalCompressedSize = 0;
-		for( int iHull = 0; iHull < MAX_NODE_HULLS; iHull++ )
-		{
-			for( int iCap = 0; iCap < 2; iCap++ )
-			{
-				int iCapMask;
-				switch( iCap )
-				{
-				case 0:
-					iCapMask = 0;
-					break;
-				case 1:
-					iCapMask = bits_CAP_OPEN_DOORS | bits_CAP_AUTO_DOORS | bits_CAP_USE;
-					break;
-				}
-
-				// Initialize Routing table to uncalculated.
-				//
-				for( iFrom = 0; iFrom < m_cNodes; iFrom++ )
-				{
-					for( int iTo = 0; iTo < m_cNodes; iTo++ )
-					{
-						Routes[FROM_TO( iFrom, iTo )] = -1;
-					}
-				}
-
-				for( iFrom = 0; iFrom < m_cNodes; iFrom++ )
-				{
-					for( int iTo = m_cNodes - 1; iTo >= 0; iTo-- )
-					{
-						if( Routes[FROM_TO( iFrom, iTo )] != -1 )
-							continue;
-
-						int cPathSize = FindShortestPath( pMyPath, m_cNodes, iFrom, iTo, iHull, iCapMask );
-
-						// Use the computed path to update the routing table.
-						//
-						if( cPathSize > 1 )
-						{
-							for( int iNode = 0; iNode < cPathSize - 1; iNode++ )
-							{
-								int iStart = pMyPath[iNode];
-								int iNext  = pMyPath[iNode + 1];
-								for( int iNode1 = iNode + 1; iNode1 < cPathSize; iNode1++ )
-								{
-									int iEnd = pMyPath[iNode1];
-									Routes[FROM_TO(iStart, iEnd)] = iNext;
-								}
-							}
-#if 0
-							// Well, at first glance, this should work, but actually it's safer
-							// to be told explictly that you can take a series of node in a
-							// particular direction. Some links don't appear to have links in
-							// the opposite direction.
-							//
-							for( iNode = cPathSize-1; iNode >= 1; iNode-- )
-							{
-								int iStart = pMyPath[iNode];
-								int iNext = pMyPath[iNode - 1];
-								for( int iNode1 = iNode-1; iNode1 >= 0; iNode1-- )
-								{
-									int iEnd = pMyPath[iNode1];
-									Routes[FROM_TO( iStart, iEnd )] = iNext;
-								}
-							}
-#endif
-						}
-						else
-						{
-							Routes[FROM_TO( iFrom, iTo )] = iFrom;
-							Routes[FROM_TO( iTo, iFrom )] = iTo;
-						}
-					}
-				}
-
-				for( iFrom = 0; iFrom < m_cNodes; iFrom++ )
-				{
-					for( int iTo = 0; iTo < m_cNodes; iTo++ )
-					{
-						BestNextNodes[iTo] = Routes[FROM_TO( iFrom, iTo )];
-					}
-
-					// Compress this node's routing table.
-					//
-					int iLastNode = 9999999; // just really big.
-					int cSequence = 0;
-					int cRepeats = 0;
-					int CompressedSize = 0;
-					signed char *p = pRoute;
-					for( int i = 0; i < m_cNodes; i++ )
-					{
-						bool CanRepeat = ( ( BestNextNodes[i] == iLastNode ) && cRepeats < 127 );
-						bool CanSequence = ( BestNextNodes[i] == i && cSequence < 128 );
-
-						if( cRepeats )
-						{
-							if( CanRepeat )
-							{
-								cRepeats++;
-							}
-							else
-							{
-								// Emit the repeat phrase.
-								//
-								CompressedSize += 2; // (count-1, iLastNode-i)
-								*p++ = cRepeats - 1;
-								int a = iLastNode - iFrom;
-								int b = iLastNode - iFrom + m_cNodes;
-								int c = iLastNode - iFrom - m_cNodes;
-								if( -128 <= a && a <= 127 )
-								{
-									*p++ = a;
-								}
-								else if( -128 <= b && b <= 127 )
-								{
-									*p++ = b;
-								}
-								else if( -128 <= c && c <= 127 )
-								{
-									*p++ = c;
-								}
-								else
-								{
-									ALERT( at_aiconsole, "Nodes need sorting (%d,%d)!\n", iLastNode, iFrom );
-								}
-								cRepeats = 0;
-
-								if( CanSequence )
-								{
-									// Start a sequence.
-									//
-									cSequence++;
-								}
-								else
-								{
-									// Start another repeat.
-									//
-									cRepeats++;
-								}
-							}
-						}
-						else if( cSequence )
-						{
-							if( CanSequence )
-							{
-								cSequence++;
-							}
-							else
-							{
-								// It may be advantageous to combine
-								// a single-entry sequence phrase with the
-								// next repeat phrase.
-								//
-								if( cSequence == 1 && CanRepeat )
-								{
-									// Combine with repeat phrase.
-									//
-									cRepeats = 2;
-									cSequence = 0;
-								}
-								else
-								{
-									// Emit the sequence phrase.
-									//
-									CompressedSize += 1; // (-count)
-									*p++ = -cSequence;
-									cSequence = 0;
-
-									// Start a repeat sequence.
-									//
-									cRepeats++;
-								}
-							}
-						}
-						else
-						{
-							if( CanSequence )
-							{
-								// Start a sequence phrase.
-								//
-								cSequence++;
-							}
-							else
-							{
-								// Start a repeat sequence.
-								//
-								cRepeats++;
-							}
-						}
-						iLastNode = BestNextNodes[i];
-					}
-					if( cRepeats )
-					{
-						// Emit the repeat phrase.
-						//
-						CompressedSize += 2;
-						*p++ = cRepeats - 1;
-#if 0
-						iLastNode = iFrom + *pRoute;
-						if( iLastNode >= m_cNodes )
-							iLastNode -= m_cNodes;
-						else if( iLastNode < 0 )
-							iLastNode += m_cNodes;
-#endif
-						int a = iLastNode - iFrom;
-						int b = iLastNode - iFrom + m_cNodes;
-						int c = iLastNode - iFrom - m_cNodes;
-						if( -128 <= a && a <= 127 )
-						{
-							*p++ = a;
-						}
-						else if( -128 <= b && b <= 127 )
-						{
-							*p++ = b;
-						}
-						else if( -128 <= c && c <= 127 )
-						{
-							*p++ = c;
-						}
-						else
-						{
-							ALERT( at_aiconsole, "Nodes need sorting (%d,%d)!\n", iLastNode, iFrom );
-						}
-					}
-					if( cSequence )
-					{
-						// Emit the Sequence phrase.
-						//
-						CompressedSize += 1;
-						*p++ = -cSequence;
-					}
-
-					// Go find a place to store this thing and point to it.
-					//
-					int nRoute = p - pRoute;
-					if( m_pRouteInfo )
-					{
-						int i;
-						for( i = 0; i < m_nRouteInfo - nRoute; i++ )
-						{
-							if( memcmp( m_pRouteInfo + i, pRoute, nRoute ) == 0 )
-							{
-								break;
-							}
-						}
-						if( i < m_nRouteInfo - nRoute )
-						{
-							m_pNodes[iFrom].m_pNextBestNode[iHull][iCap] = i;
-						}
-						else
-						{
-							signed char *Tmp = (signed char *)calloc( sizeof(signed char), ( m_nRouteInfo + nRoute ) );
-							memcpy( Tmp, m_pRouteInfo, m_nRouteInfo );
-							free( m_pRouteInfo );
-							m_pRouteInfo = Tmp;
-							memcpy( m_pRouteInfo + m_nRouteInfo, pRoute, nRoute );
-							m_pNodes[iFrom].m_pNextBestNode[iHull][iCap] = m_nRouteInfo;
-							m_nRouteInfo += nRoute;
-							nTotalCompressedSize += CompressedSize;
-						}
-					}
-					else
-					{
-						m_nRouteInfo = nRoute;
-						m_pRouteInfo = (signed char *)calloc( sizeof(signed char), nRoute );
-						memcpy( m_pRouteInfo, pRoute, nRoute );
-						m_pNodes[iFrom].m_pNextBestNode[iHull][iCap] = 0;
-						nTotalCompressedSize += CompressedSize;
-					}
-				}
-			}
-		}
-		ALERT( at_aiconsole, "Size of Routes = %d\n", nTotalCompressedSize );
-	}
-	if( Routes )
-		delete[] Routes;
-	if( BestNextNodes )
-		delete[] BestNextNodes;
-	if( pRoute )
-		delete[] pRoute;
-	if( pMyPath )
-		delete[] pMyPath;
-	Routes = 0;
-	BestNextNodes = 0;
-	pRoute = 0;
-	pMyPath = 0;
+	g_NodeRoutingBuilder.Start( *this );
+	g_NodeRoutingBuilder.Finish( *this );
 #if 0
 	TestRoutingTables();
 #endif
-	m_fRoutingComplete = 1;
 }
 
 // Test those routing tables. Doesn't really work, yet.
@@ -117,6 +117,39 @@ typedef struct
 #define GRAPH_VERSION (int)_GRAPH_VERSION
 #define GRAPH_VERSION_RETAIL (int)_GRAPH_VERSION_RETAIL
 
+// Graph files written by this version are a single block laid out as described by GraphFileHeader.
+// Arrays are located by offsets, so the file is used in place after loading.
+#define GRAPH_FILE_VERSION 200
+
+typedef struct
+{
+	int iVersion; // GRAPH_FILE_VERSION. Must be first, older files start with the version too
+	int iHeaderSize;
+	int iFileSize;
+
+	// The file can only be used in place if the layout of the structures matches
+	int iNodeSize;
+	int iLinkSize;
+	int iTablesSize;
+
+	// BSP the graph was built for
+	CRC32_t bspChecksum;
+	int bspSize;
+
+	int cNodes;
+	int cLinks;
+	int nRouteInfo;
+	int nHashLinks;
+
+	// Offsets from the start of the file
+	int iTablesOffset; // CGraph members from m_RangeStart up to m_pHashLinks
+	int iNodesOffset;
+	int iLinksOffset;
+	int iDistInfoOffset;
+	int iRouteInfoOffset;
+	int iHashLinksOffset;
+} GraphFileHeader;
+
 class CGraph
 {
 public:
@@ -170,8 +203,12 @@ public:
 	// another such system used to track the search for cover nodes, helps greatly with two monsters trying to get to the same node.
 	int		m_iLastCoverSearch;
 
+	// Contents of the graph file the arrays point into, if the graph was loaded from the current file format.
+	// Members above this one are what older graph files store.
+	byte	*m_pGraphData;
+
 	// functions to create the graph
-	int		LinkVisibleNodes ( CLink *pLinkPool, FILE *file, int *piBadNode );
+	int		LinkVisibleNodes ( CLink *pLinkPool, FILE *file, int *piBadNode, int *piNode, int cMaxTraces );
 	int		RejectInlineLinks ( CLink *pLinkPool, FILE *file );
 	int		FindShortestPath ( int *piPath, int pathSize, int iStart, int iDest, int iHull, int afCapMask, bool dynamic = false );
 	int		FindNearestNode ( const Vector &vecOrigin, CBaseEntity *pEntity );
@@ -191,9 +228,9 @@ public:
 	
 	bool	CheckNODFile(const char *szMapName);
 	bool	FLoadGraph(const char *szMapName);
+	bool	FSetGraphData(byte *pData, int length);
 	bool	FSaveGraph(const char *szMapName);
 	bool	FSetGraphPointers(void);
-	void	CheckNode(Vector vecOrigin, int iNode);
 
 	void    BuildRegionTables(void);
 	void    ComputeStaticRoutingTables(void);
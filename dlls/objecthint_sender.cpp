@@ -0,0 +1,200 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+#include "player.h"
+#include "objecthint_spec.h"
+#include "objecthint_sender.h"
+
+ObjectHintSender g_ObjectHintSender;
+
+extern int gmsgObjectHint;
+extern int gmsgHintSprites;
+
+// Coordinates are sent in 1/8 units, smaller changes don't make it to the client
+static bool SameCoord(float a, float b)
+{
+	return (int)( a * 8.0f ) == (int)( b * 8.0f );
+}
+
+static bool SameVector(const Vector& a, const Vector& b)
+{
+	return SameCoord(a.x, b.x) && SameCoord(a.y, b.y) && SameCoord(a.z, b.z);
+}
+
+void ObjectHintSender::Reset(CBasePlayer *pPlayer)
+{
+	const int clientIndex = pPlayer->entindex() - 1;
+	if (clientIndex < 0 || clientIndex >= (int)ARRAYSIZE(_clients))
+		return;
+
+	ClientHints& clientHints = _clients[clientIndex];
+	clientHints.hints.clear();
+	clientHints.hasInteractable = false;
+
+	if (!g_objectHintCatalog.HasAnyTemplates())
+		return;
+
+	MESSAGE_BEGIN(MSG_ONE, gmsgObjectHint, nullptr, pPlayer->pev);
+		WRITE_BYTE(OBJECTHINT_FLAG_REMOVE);
+		WRITE_SHORT(0);
+	MESSAGE_END();
+	MESSAGE_BEGIN(MSG_ONE, gmsgObjectHint, nullptr, pPlayer->pev);
+		WRITE_BYTE(OBJECTHINT_FLAG_REMOVE | OBJECTHINT_FLAG_CLOSEST);
+		WRITE_SHORT(0);
+	MESSAGE_END();
+
+	const std::vector<std::string>& spriteNames = g_objectHintCatalog.SpriteNames();
+	for (size_t i = 0; i < spriteNames.size(); ++i)
+	{
+		MESSAGE_BEGIN(MSG_ONE, gmsgHintSprites, nullptr, pPlayer->pev);
+			WRITE_BYTE(i + 1);
+			WRITE_STRING(spriteNames[i].c_str());
+		MESSAGE_END();
+	}
+}
+
+void ObjectHintSender::BeginUpdate(CBasePlayer *pPlayer)
+{
+	const int clientIndex = pPlayer->entindex() - 1;
+	if (clientIndex < 0 || clientIndex >= (int)ARRAYSIZE(_clients))
+	{
+		_player = nullptr;
+		_current = nullptr;
+		return;
+	}
+
+	_player = pPlayer;
+	_current = &_clients[clientIndex];
+	for (SentHint& sent : _current->hints)
+	{
+		sent.seen = false;
+	}
+	_current->interactable.seen = false;
+}
+
+int ObjectHintSender::ChangedFields(const SentHint &sent, const SentHint &hint)
+{
+	int fields = 0;
+	if (sent.sprite != hint.sprite)
+		fields |= OBJECTHINT_FIELD_SPRITE;
+	if (sent.color.r != hint.color.r || sent.color.g != hint.color.g || sent.color.b != hint.color.b)
+		fields |= OBJECTHINT_FIELD_COLOR;
+	if (!SameCoord(sent.scale, hint.scale))
+		fields |= OBJECTHINT_FIELD_SCALE;
+	if (!SameVector(sent.center, hint.center))
+		fields |= OBJECTHINT_FIELD_CENTER;
+	if (!SameVector(sent.size, hint.size))
+		fields |= OBJECTHINT_FIELD_SIZE;
+	return fields;
+}
+
+void ObjectHintSender::SetHint(int entindex, bool interactable, const ObjectHintVisual *visual, const Vector &center, const Vector &size)
+{
+	if (!_current)
+		return;
+
+	SentHint hint;
+	hint.entindex = entindex;
+	hint.sprite = visual->spriteIndex;
+	hint.color = visual->color;
+	hint.scale = visual->scale;
+	hint.center = center;
+	hint.size = size;
+	hint.seen = true;
+
+	SentHint* sent = nullptr;
+	if (interactable)
+	{
+		if (_current->hasInteractable && _current->interactable.entindex == entindex)
+			sent = &_current->interactable;
+	}
+	else
+	{
+		for (SentHint& candidate : _current->hints)
+		{
+			if (candidate.entindex == entindex)
+			{
+				sent = &candidate;
+				break;
+			}
+		}
+	}
+
+	if (!sent)
+	{
+		SendHint(hint, interactable, OBJECTHINT_FIELD_ALL);
+		if (interactable)
+		{
+			_current->interactable = hint;
+			_current->hasInteractable = true;
+		}
+		else
+		{
+			_current->hints.push_back(hint);
+		}
+		return;
+	}
+
+	const int fields = ChangedFields(*sent, hint);
+	if (fields)
+	{
+		SendHint(hint, interactable, fields);
+		*sent = hint;
+	}
+	sent->seen = true;
+}
+
+void ObjectHintSender::EndUpdate()
+{
+	if (!_current)
+		return;
+
+	if (_current->hasInteractable && !_current->interactable.seen)
+	{
+		SendRemove(_current->interactable.entindex, true);
+		_current->hasInteractable = false;
+	}
+
+	std::vector<SentHint>& hints = _current->hints;
+	for (size_t i = 0; i < hints.size();)
+	{
+		if (hints[i].seen)
+		{
+			++i;
+			continue;
+		}
+		SendRemove(hints[i].entindex, false);
+		hints[i] = hints.back();
+		hints.pop_back();
+	}
+
+	_player = nullptr;
+	_current = nullptr;
+}
+
+void ObjectHintSender::SendHint(const SentHint &hint, bool interactable, int fields)
+{
+	MESSAGE_BEGIN(MSG_ONE, gmsgObjectHint, nullptr, _player->pev);
+		WRITE_BYTE(interactable ? OBJECTHINT_FLAG_CLOSEST : 0);
+		WRITE_SHORT(hint.entindex);
+		WRITE_BYTE(fields);
+		if (fields & OBJECTHINT_FIELD_SPRITE)
+			WRITE_BYTE(hint.sprite);
+		if (fields & OBJECTHINT_FIELD_COLOR)
+			WRITE_COLOR(hint.color);
+		if (fields & OBJECTHINT_FIELD_SCALE)
+			WRITE_COORD(hint.scale);
+		if (fields & OBJECTHINT_FIELD_CENTER)
+			WRITE_VECTOR(hint.center);
+		if (fields & OBJECTHINT_FIELD_SIZE)
+			WRITE_VECTOR(hint.size);
+	MESSAGE_END();
+}
+
+void ObjectHintSender::SendRemove(int entindex, bool interactable)
+{
+	MESSAGE_BEGIN(MSG_ONE, gmsgObjectHint, nullptr, _player->pev);
+		WRITE_BYTE(OBJECTHINT_FLAG_REMOVE | (interactable ? OBJECTHINT_FLAG_CLOSEST : 0));
+		WRITE_SHORT(entindex);
+	MESSAGE_END();
+}
@@ -0,0 +1,57 @@
+#pragma once
+#ifndef OBJECTHINT_SENDER_H
+#define OBJECTHINT_SENDER_H
+
+#include <vector>
+
+#include "vector.h"
+#include "com_model.h"
+#include "template_property_types.h"
+
+class CBasePlayer;
+struct ObjectHintVisual;
+
+// Remembers the object hints each client was told about, so that only the added, changed and removed hints are sent.
+// Sprites are referred to by their index in the table sent on Reset.
+class ObjectHintSender
+{
+public:
+	// The client forgot its hints, e.g. on connect, level change or respawn
+	void Reset(CBasePlayer* pPlayer);
+
+	void BeginUpdate(CBasePlayer* pPlayer);
+	void SetHint(int entindex, bool interactable, const ObjectHintVisual* visual, const Vector& center, const Vector& size);
+	// Removes the hints that weren't set since BeginUpdate
+	void EndUpdate();
+
+private:
+	struct SentHint
+	{
+		int entindex;
+		int sprite;
+		Color color;
+		float scale;
+		Vector center;
+		Vector size;
+		bool seen;
+	};
+
+	struct ClientHints
+	{
+		std::vector<SentHint> hints;
+		SentHint interactable;
+		bool hasInteractable = false;
+	};
+
+	static int ChangedFields(const SentHint& sent, const SentHint& hint);
+	void SendHint(const SentHint& hint, bool interactable, int fields);
+	void SendRemove(int entindex, bool interactable);
+
+	ClientHints _clients[MAX_CLIENTS];
+	CBasePlayer* _player = nullptr;
+	ClientHints* _current = nullptr;
+};
+
+extern ObjectHintSender g_ObjectHintSender;
+
+#endif
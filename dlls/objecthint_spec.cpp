@@ -145,6 +145,24 @@ static void ReportUndefinedTemplate(const char* fileName, const char* subject, c
 	g_errorCollector.AddFormattedError("%s: %s refers to the template '%s' which is not defined", fileName, subject, templateName);
 }
 
+int ObjectHintCatalog::RegisterSprite(const std::string &sprite, const char* fileName)
+{
+	if (sprite.empty())
+		return 0;
+	for (size_t i = 0; i < _spriteNames.size(); ++i)
+	{
+		if (_spriteNames[i] == sprite)
+			return (int)i + 1;
+	}
+	if (_spriteNames.size() >= OBJECTHINT_MAX_SPRITES)
+	{
+		g_errorCollector.AddFormattedError("%s: too many different object hint sprites, '%s' is not going to be shown", fileName, sprite.c_str());
+		return 0;
+	}
+	_spriteNames.push_back(sprite);
+	return (int)_spriteNames.size();
+}
+
 const char* ObjectHintCatalog::Schema() const
 {
 	return objectHintCatalogSchema;
@@ -165,6 +183,7 @@ bool ObjectHintCatalog::ReadFromDocument(rapidjson::Document& document, const ch
 				UpdatePropertyFromJson(visual.sprite, value, "sprite");
 				UpdatePropertyFromJson(visual.color, value, "color");
 				UpdatePropertyFromJson(visual.scale, value, "scale");
+				visual.spriteIndex = RegisterSprite(visual.sprite, fileName);
 				_visuals[visualIt->name.GetString()] = visual;
 			}
 		}
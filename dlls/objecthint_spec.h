@@ -4,6 +4,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "json_config.h"
 #include "spritehint_flags.h"
@@ -12,6 +13,7 @@
 struct ObjectHintVisual
 {
 	std::string sprite;
+	int spriteIndex = 0; // index in the catalog sprite table, 0 for none
 	Color color;
 	float scale;
 };
@@ -42,14 +44,20 @@ struct ObjectHintCatalog : public JSONConfig
 	const ObjectHintSpec* GetSpecByPickupName(const char* name);
 	float GetMaxDistance() const;
 	bool HasAnyTemplates() const;
+	// Sprites of all the visuals, sent to clients once so hints can refer to them by index
+	const std::vector<std::string>& SpriteNames() const {
+		return _spriteNames;
+	}
 
 protected:
 	const char* Schema() const;
 	bool ReadFromDocument(rapidjson::Document& document, const char* fileName);
 private:
 	const ObjectHintSpec* GetSpec(const std::string& name);
+	int RegisterSprite(const std::string& sprite, const char* fileName);
 
 	std::map<std::string, ObjectHintVisual> _visuals;
+	std::vector<std::string> _spriteNames;
 	std::map<std::string, ObjectHintSpec> _templates;
 	std::map<std::string, std::string> _entityMapping;
 	std::map<std::string, std::string> _pickupMapping;
@@ -26,6 +26,7 @@
 #include "trains.h"
 #include "saverestore.h"
 #include "soundradius.h"
+#include "localmove_cache.h"
 
 float SoundAttenuation(short soundRadius)
 {
@@ -1104,6 +1105,7 @@ void CFuncTrackTrain::Use( CBaseEntity *pActivator, CBaseEntity *pCaller, USE_TY
 			pev->avelocity = g_vecZero;
 			StopSound();
 			SetThink( NULL );
+			g_LocalMoveCache.Invalidate();
 		}
 	}
 	else
@@ -1242,6 +1244,9 @@ void CFuncTrackTrain::Next( void )
 
 	UpdateSound();
 
+	// Local move results around the train are stale now
+	g_LocalMoveCache.Invalidate();
+
 	Vector nextPos = pev->origin;
 
 	nextPos.z -= m_height;
@@ -1390,6 +1395,7 @@ void CFuncTrackTrain::DeadEnd( void )
 
 	pev->velocity = g_vecZero;
 	pev->avelocity = g_vecZero;
+	g_LocalMoveCache.Invalidate();
 	if( pTrack )
 	{
 		ALERT( at_aiconsole, "at %s\n", STRING( pTrack->pev->targetname ) );
@@ -44,6 +44,7 @@
 #include "common_soundscripts.h"
 #include "error_collector.h"
 #include "spritehint_flags.h"
+#include "objecthint_sender.h"
 
 #if FEATURE_ROPE
 #include "ropes.h"
@@ -248,6 +249,8 @@ int gmsgCaption = 0;
 
 int gmsgInventory = 0;
 int gmsgObjectHint = 0;
+int gmsgHintSprites = 0;
+int gmsgRope = 0;
 
 int gmsgRain = 0;
 int gmsgSnow = 0;
@@ -349,6 +352,8 @@ void LinkUserMessages( void )
 
 	gmsgInventory = REG_USER_MSG("Inventory", -1);
 	gmsgObjectHint = REG_USER_MSG("ObjectHint", -1);
+	gmsgHintSprites = REG_USER_MSG("HintSprites", -1);
+	gmsgRope = REG_USER_MSG("Rope", -1);
 
 	gmsgRain = REG_USER_MSG("Rain", -1);
 	gmsgSnow = REG_USER_MSG("Snow", -1);
@@ -5100,6 +5105,8 @@ void CBasePlayer::UpdateClientData( void )
 			WRITE_BYTE( 0 );
 		MESSAGE_END();
 
+		g_ObjectHintSender.Reset( this );
+
 		if( !m_fGameHUDInitialized )
 		{
 			MESSAGE_BEGIN( MSG_ONE, gmsgInitHUD, NULL, pev );
@@ -5494,19 +5501,14 @@ void CBasePlayer::GatherAndSendObjectHints()
 		return visualSet.defaultVisual;
 	};
 
-	auto sendObjectHint = [this](const ObjectHintSpec* spec, const ObjectHintVisual* hintVisual, CBaseEntity* pEntity, int flags)
+	auto sendObjectHint = [this](const ObjectHintSpec* spec, const ObjectHintVisual* hintVisual, CBaseEntity* pEntity, bool interactable)
 	{
-		MESSAGE_BEGIN(MSG_ONE, gmsgObjectHint, nullptr, pev);
-			WRITE_BYTE(flags);
-			WRITE_SHORT(pEntity->entindex());
-			WRITE_COLOR(hintVisual->color);
-			WRITE_COORD(hintVisual->scale);
-			WRITE_VECTOR(CalcHintOrigin(pEntity, this) + Vector(0,0,spec->verticalOffset));
-			WRITE_VECTOR(pEntity->pev->size);
-			WRITE_STRING(hintVisual->sprite.c_str());
-		MESSAGE_END();
+		g_ObjectHintSender.SetHint(pEntity->entindex(), interactable, hintVisual,
+								   CalcHintOrigin(pEntity, this) + Vector(0,0,spec->verticalOffset), pEntity->pev->size);
 	};
 
+	g_ObjectHintSender.BeginUpdate(this);
+
 	std::vector<std::pair<CBaseEntity*, const ObjectHintSpec*>> hintedEntities;
 	auto interaction = GetInteractiveEntity(&hintedEntities);
 	CBaseEntity* pClosest = interaction.first;
@@ -5520,16 +5522,9 @@ void CBasePlayer::GatherAndSendObjectHints()
 
 	if (pClosest && closestHintVisual)
 	{
-		sendObjectHint(closestHintSpec, closestHintVisual, pClosest, OBJECTHINT_FLAG_CLOSEST);
+		sendObjectHint(closestHintSpec, closestHintVisual, pClosest, true);
 		shownInteraction = true;
 	}
-	else
-	{
-		MESSAGE_BEGIN(MSG_ONE, gmsgObjectHint, nullptr, pev);
-			WRITE_BYTE(OBJECTHINT_FLAG_CLOSEST);
-			WRITE_SHORT(0);
-		MESSAGE_END();
-	}
 
 	for (auto p : hintedEntities)
 	{
@@ -5541,9 +5536,12 @@ void CBasePlayer::GatherAndSendObjectHints()
 		const ObjectHintVisual* hintVisual = chooseHintVisual(pEntity, spec->scanVisualSet);
 		if (hintVisual)
 		{
-			sendObjectHint(spec, hintVisual, pEntity, 0);
+			sendObjectHint(spec, hintVisual, pEntity, false);
 		}
 	}
+
+	// Hints that weren't set this time are removed on the client
+	g_ObjectHintSender.EndUpdate();
 }
 
 //=========================================================
@@ -0,0 +1,186 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+#include "monsters.h"
+#include "game.h"
+#include "logger.h"
+#include "relationships.h"
+
+using namespace rapidjson;
+
+RelationshipMatrix g_RelationshipMatrix;
+
+// Placeholders resolved by the server features when the matrix is compiled
+#define R_OA (R_AL-1)
+#define R_XA (R_AL-2)
+#define R_PA (R_AL-3)
+#define R_XG (R_AL-4)
+#define R_AX (R_AL-5)
+
+static const signed char defaultRelationships[CLASS_NUMBER_OF_CLASSES][CLASS_NUMBER_OF_CLASSES] =
+{			 //   NONE	 MACH	 PLYR	 HPASS	 HMIL	 AMIL	 APASS	 AMONST	APREY	 APRED	 INSECT	PLRALY	PBWPN	ABWPN	XPRED	XSHOCK	ALMIL	BLOPS	SNARK	GARG
+/*NONE*/		{ R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO},
+/*MACHINE*/		{ R_NO	,R_NO	,R_DL	,R_DL	,R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL},
+/*PLAYER*/		{ R_NO	,R_DL	,R_NO	,R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_NO,	R_DL,	R_DL,	R_DL,	R_DL,	R_NO,	R_DL,	R_DL,	R_DL},
+/*HUMANPASSIVE*/{ R_NO	,R_NO	,R_AL	,R_AL	,R_HT	,R_HT	,R_NO	,R_HT	,R_DL	,R_HT	,R_NO	,R_AL,	R_NO,	R_NO,	R_HT,	R_HT,	R_OA,	R_HT,	R_DL,	R_HT},
+/*HUMANMILITAR*/{ R_NO	,R_NO	,R_HT	,R_DL	,R_NO	,R_HT	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_HT,	R_NO,	R_NO,	R_HT,	R_HT,	R_DL,	R_DL,	R_HT,	R_HT},
+/*ALIENMILITAR*/{ R_NO	,R_DL	,R_HT	,R_DL	,R_HT	,R_AL	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_DL,	R_NO,	R_NO,	R_PA,	R_XA,	R_HT,	R_HT,	R_NO,	R_AL},
+/*ALIENPASSIVE*/{ R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO,	R_NO},
+/*ALIENMONSTER*/{ R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_DL,	R_NO,	R_NO,	R_AX,	R_AX,	R_DL,	R_DL,	R_NO,	R_NO},
+/*ALIENPREY   */{ R_NO	,R_NO	,R_DL	,R_DL	,R_DL	,R_NO	,R_NO	,R_NO	,R_NO	,R_FR	,R_NO	,R_DL,	R_NO,	R_NO,	R_FR,	R_FR,	R_DL,	R_DL,	R_NO,	R_NO},
+/*ALIENPREDATO*/{ R_NO	,R_NO	,R_DL	,R_DL	,R_DL	,R_NO	,R_NO	,R_NO	,R_HT	,R_DL	,R_NO	,R_DL,	R_NO,	R_NO,	R_DL,	R_AX,	R_DL,	R_DL,	R_NO,	R_NO},
+/*INSECT*/		{ R_FR	,R_FR	,R_FR	,R_FR	,R_FR	,R_NO	,R_FR	,R_FR	,R_FR	,R_FR	,R_NO	,R_FR,	R_NO,	R_NO,	R_NO,	R_NO,	R_FR,	R_FR,	R_NO,	R_FR},
+/*PLAYERALLY*/	{ R_NO	,R_DL	,R_AL	,R_AL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_AL,	R_NO,	R_NO,	R_DL,	R_DL,	R_OA,	R_DL,	R_HT,	R_DL},
+/*PBIOWEAPON*/	{ R_NO	,R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_DL,	R_NO,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL,	R_DL},
+/*ABIOWEAPON*/	{ R_NO	,R_NO	,R_DL	,R_DL	,R_DL	,R_AL	,R_NO	,R_DL	,R_DL	,R_NO	,R_NO	,R_DL,	R_DL,	R_NO,	R_DL,	R_DL,	R_DL,	R_DL,	R_NO,	R_AL},
+/*XPREDATOR*/	{ R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_PA	,R_NO	,R_AX	,R_DL	,R_DL	,R_NO	,R_DL,	R_NO,	R_NO,	R_AL,	R_AL,	R_DL,	R_DL,	R_NO,	R_XG},
+/*XSHOCK*/		{ R_NO	,R_DL	,R_HT	,R_DL	,R_HT	,R_XA	,R_NO	,R_AX	,R_AX	,R_AX	,R_NO	,R_DL,	R_NO,	R_NO,	R_AL,	R_AL,	R_HT,	R_HT,	R_NO,	R_XG},
+/*PLRALLYMIL*/	{ R_NO	,R_DL	,R_AL	,R_OA	,R_DL	,R_HT	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_OA,	R_NO,	R_NO,	R_DL,	R_HT,	R_AL,	R_DL,	R_HT,	R_HT},
+/*BLACKOPS*/	{ R_NO	,R_DL	,R_HT	,R_DL	,R_DL	,R_HT	,R_DL	,R_DL	,R_DL	,R_DL	,R_NO	,R_HT,	R_NO,	R_NO,	R_HT,	R_HT,	R_DL,	R_AL,	R_HT,	R_HT},
+/*SNARK*/		{ R_NO	,R_NO	,R_HT	,R_DL	,R_HT	,R_NO	,R_NO	,R_DL	,R_DL	,R_NO	,R_NO	,R_DL,	R_NO,	R_NO,	R_DL,	R_DL,	R_HT,	R_HT,	R_NO,	R_DL},
+/*GARGANTUA*/	{ R_NO	,R_DL	,R_DL	,R_DL	,R_DL	,R_AL	,R_NO	,R_NO	,R_NO	,R_NO	,R_NO	,R_DL,	R_NO,	R_NO,	R_XG,	R_XG,	R_DL,	R_DL,	R_NO,	R_AL},
+};
+
+struct RelationshipAndName
+{
+	int relationship;
+	const char* name;
+};
+
+static const RelationshipAndName relationshipNames[] = {
+	{ R_AL, "ally" },
+	{ R_FR, "fear" },
+	{ R_NO, "none" },
+	{ R_DL, "dislike" },
+	{ R_HT, "hate" },
+	{ R_NM, "nemesis" },
+};
+
+const char relationshipsSchema[] = R"(
+{
+	"type": "object",
+	"properties": {
+		"relationships": {
+			"type": "array",
+			"items": {
+				"type": "object",
+				"properties": {
+					"classify": {
+						"type": "string"
+					},
+					"target": {
+						"type": "string"
+					},
+					"relationship": {
+						"type": "string",
+						"enum": ["ally", "fear", "none", "dislike", "hate", "nemesis"]
+					},
+					"mutual": {
+						"type": "boolean"
+					}
+				},
+				"required": ["classify", "target", "relationship"],
+				"additionalProperties": false
+			}
+		}
+	},
+	"additionalProperties": false
+}
+)";
+
+const char* RelationshipMatrix::Schema() const
+{
+	return relationshipsSchema;
+}
+
+bool RelationshipMatrix::ReadFromDocument(rapidjson::Document& document, const char* fileName)
+{
+	auto relationshipsIt = document.FindMember("relationships");
+	if (relationshipsIt == document.MemberEnd())
+		return true;
+
+	Value& a = relationshipsIt->value;
+	for (auto it = a.Begin(); it != a.End(); ++it)
+	{
+		const char* classifyName = (*it)["classify"].GetString();
+		const char* targetName = (*it)["target"].GetString();
+		const char* relationshipName = (*it)["relationship"].GetString();
+
+		Override relationshipOverride;
+		relationshipOverride.classify = ClassifyFromName(classifyName);
+		relationshipOverride.target = ClassifyFromName(targetName);
+		relationshipOverride.relationship = R_NO;
+		for (const RelationshipAndName& p : relationshipNames)
+		{
+			if (strcmp(relationshipName, p.name) == 0)
+				relationshipOverride.relationship = p.relationship;
+		}
+
+		if (relationshipOverride.classify < 0 || relationshipOverride.target < 0)
+		{
+			LOG_WARNING("%s: unknown classification in relationship '%s' to '%s'\n", fileName, classifyName, targetName);
+			continue;
+		}
+		_overrides.push_back(relationshipOverride);
+
+		auto mutualIt = it->FindMember("mutual");
+		if (mutualIt != it->MemberEnd() && mutualIt->value.GetBool() && relationshipOverride.classify != relationshipOverride.target)
+		{
+			Override mutualOverride = relationshipOverride;
+			mutualOverride.classify = relationshipOverride.target;
+			mutualOverride.target = relationshipOverride.classify;
+			_overrides.push_back(mutualOverride);
+		}
+	}
+	return true;
+}
+
+static int ResolveDefaultRelationship(int rel)
+{
+	switch (rel) {
+	case R_OA:
+		return g_modFeatures.opfor_grunts_dislike_civilians ? R_DL : R_AL;
+	case R_XA:
+	case R_PA:
+		return g_modFeatures.racex_dislike_alien_military ? R_HT : R_NO;
+	case R_XG:
+		return g_modFeatures.racex_dislike_gargs ? R_HT : R_NO;
+	case R_AX:
+		return g_modFeatures.racex_dislike_alien_monsters ? R_DL : R_NO;
+	default:
+		return rel;
+	}
+}
+
+void RelationshipMatrix::Compile()
+{
+	for (int i = 0; i < CLASS_NUMBER_OF_CLASSES; ++i)
+	{
+		for (int j = 0; j < CLASS_NUMBER_OF_CLASSES; ++j)
+		{
+			_matrix[i][j] = (signed char)ResolveDefaultRelationship(defaultRelationships[i][j]);
+		}
+	}
+	// Later overrides win
+	for (const Override& relationshipOverride : _overrides)
+	{
+		_matrix[relationshipOverride.classify][relationshipOverride.target] = (signed char)relationshipOverride.relationship;
+	}
+}
+
+int RelationshipMatrix::Relationship(int classify1, int classify2) const
+{
+	if (classify1 >= CLASS_NUMBER_OF_CLASSES || classify1 < 0 || classify2 >= CLASS_NUMBER_OF_CLASSES || classify2 < 0 )
+	{
+		ALERT(at_aiconsole, "Unknown classify for monster relationship %d,%d\n", classify1, classify2);
+		return R_NO;
+	}
+	return _matrix[classify1][classify2];
+}
+
+const signed char* RelationshipMatrix::Row(int classify) const
+{
+	if (classify >= CLASS_NUMBER_OF_CLASSES || classify < 0)
+		return NULL;
+	return _matrix[classify];
+}
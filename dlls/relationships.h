@@ -0,0 +1,38 @@
+#pragma once
+#ifndef RELATIONSHIPS_H
+#define RELATIONSHIPS_H
+
+#include <vector>
+#include "json_config.h"
+#include "classify.h"
+
+// Monster to monster relationships by classify, compiled once from the built-in table,
+// the relationship flags of the server features and the overrides from features/relationships.json.
+// Looking up a relationship is a single byte load, rows can be kept by monsters for the duration of a Look.
+class RelationshipMatrix : public JSONConfig
+{
+public:
+	void Compile();
+
+	int Relationship(int classify1, int classify2) const;
+	// The relationships of the given classify to every other classify, NULL if the classify is out of the table
+	const signed char* Row(int classify) const;
+
+protected:
+	const char* Schema() const;
+	bool ReadFromDocument(rapidjson::Document& document, const char* fileName);
+
+private:
+	struct Override
+	{
+		int classify;
+		int target;
+		int relationship;
+	};
+	std::vector<Override> _overrides;
+	signed char _matrix[CLASS_NUMBER_OF_CLASSES][CLASS_NUMBER_OF_CLASSES] = {};
+};
+
+extern RelationshipMatrix g_RelationshipMatrix;
+
+#endif
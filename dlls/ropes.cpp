@@ -23,93 +23,23 @@
 #include "effects.h"
 #include "saverestore.h"
 #include "mod_features.h"
+#include "game.h"
 
 #if FEATURE_ROPE
 #include "ropes.h"
+#include "rope_msg.h"
+
+extern int gmsgRope;
 
 #define SF_ROPE_NO_TRANSITION 2
 
-#define HOOK_CONSTANT	2500.0f
-#define SPRING_DAMPING	0.1f
 #define ROPE_IGNORE_SAMPLES	4		// integrator may be hanging if less than
 
 const float RopeFrameRate = 100.f;
+// Rate of the server copy of a client-side rope while nothing is attached to it
+const float RopeClientSideFrameRate = 10.f;
 const float RopeForceMultiplier = 50.f;
 
-/**
-*	Data for a single rope joint.
-*/
-struct RopeSampleData
-{
-	Vector mPosition;
-	Vector mVelocity;
-	Vector mForce;
-	Vector mExternalForce;
-
-	bool mApplyExternalForce;
-	float mMassReciprocal;
-	float restLength;
-};
-
-#define MAX_LIST_SEGMENTS	5
-RopeSampleData g_pTempList[MAX_LIST_SEGMENTS][MAX_SEGMENTS];
-
-/**
-*	Represents a single joint in a rope. There are numSegments + 1 samples in a rope.
-*/
-class CRopeSample : public CBaseEntity
-{
-public:
-
-	void Spawn();
-	virtual int		Save( CSave &save );
-	virtual int		Restore( CRestore &restore );
-	static	TYPEDESCRIPTION m_SaveData[];
-
-	int ObjectCaps() {
-		if (FBitSet(pev->spawnflags, SF_ROPE_NO_TRANSITION))
-			return CBaseEntity::ObjectCaps() & ~FCAP_ACROSS_TRANSITION;
-		else
-			return CBaseEntity::ObjectCaps();
-	}
-
-	static CRopeSample* CreateSample();
-
-	RopeSampleData& GetData()
-	{
-		return data;
-	}
-
-	RopeSampleData& GetSourceData() {
-		if (swapped)
-			return data2;
-		else
-			return data;
-	}
-	RopeSampleData& GetTargetData() {
-		if (swapped)
-			return data;
-		else
-			return data2;
-	}
-
-	void Swap()
-	{
-		swapped = !swapped;
-	}
-
-	void ResetSwap()
-	{
-		swapped = false;
-	}
-
-private:
-	RopeSampleData data;
-	RopeSampleData data2;
-	bool swapped;
-};
-
-
 class CRopeSegment : public CBaseAnimating
 {
 public:
@@ -132,9 +62,10 @@ public:
 		pev->origin = pos;
 	}
 
-	static CRopeSegment* CreateSegment(CRopeSample* pSample, string_t iszModelName , CRope *rope);
+	static CRopeSegment* CreateSegment(int iSample, string_t iszModelName , CRope *rope);
 
-	CRopeSample* GetSample() { return m_Sample; }
+	int GetSample() const { return m_iSample; }
+	void SetSample( int iSample ) { m_iSample = iSample; }
 
 	void ApplyExternalForce( const Vector& vecForce );
 
@@ -146,6 +77,9 @@ public:
 		mMasterRope = pRope;
 		if (FBitSet(mMasterRope->pev->spawnflags, SF_ROPE_NO_TRANSITION))
 			pev->spawnflags |= SF_ROPE_NO_TRANSITION;
+		// Clients draw the rope themselves, the segment is only touched on the server
+		if (mMasterRope->IsClientSide())
+			pev->effects |= EF_NODRAW;
 	}
 
 	virtual int		Save( CSave &save );
@@ -154,9 +88,8 @@ public:
 
 
 private:
-	CRopeSample* m_Sample;
+	int m_iSample;
 	string_t mModelName;
-	float mDefaultMass;
 	bool mCauseDamage;
 	bool mCanBeGrabbed;
 	CRope* mMasterRope;
@@ -176,28 +109,62 @@ const NamedSoundScript CRope::creakSoundScript = {
 
 TYPEDESCRIPTION	CRope::m_SaveData[] =
 {	DEFINE_FIELD( CRope, m_iSegments, FIELD_INTEGER ),
-	DEFINE_FIELD( CRope, m_bToggle, FIELD_BOOLEAN ),
 	DEFINE_FIELD( CRope, m_InitialDeltaTime, FIELD_BOOLEAN ),
 	DEFINE_FIELD( CRope, mLastTime, FIELD_TIME ),
 	DEFINE_FIELD( CRope, m_LastEndPos, FIELD_POSITION_VECTOR ),
-	DEFINE_FIELD( CRope, m_Gravity, FIELD_VECTOR ),
 	DEFINE_FIELD( CRope, m_NumSamples, FIELD_INTEGER ),
+	DEFINE_FIELD( CRope, m_Sim.numSamples, FIELD_INTEGER ),
+	DEFINE_FIELD( CRope, m_Sim.gravity, FIELD_VECTOR ),
+	DEFINE_FIELD( CRope, m_Sim.accumulatedTime, FIELD_FLOAT ),
+	DEFINE_ARRAY( CRope, m_Sim.position, FIELD_POSITION_VECTOR, MAX_SAMPLES ),
+	DEFINE_ARRAY( CRope, m_Sim.velocity, FIELD_VECTOR, MAX_SAMPLES ),
+	DEFINE_ARRAY( CRope, m_Sim.externalForce, FIELD_VECTOR, MAX_SAMPLES ),
+	DEFINE_ARRAY( CRope, m_Sim.massReciprocal, FIELD_FLOAT, MAX_SAMPLES ),
+	DEFINE_ARRAY( CRope, m_Sim.restLength, FIELD_FLOAT, MAX_SAMPLES ),
+	DEFINE_ARRAY( CRope, m_Sim.applyExternalForce, FIELD_BOOLEAN, MAX_SAMPLES ),
 	DEFINE_FIELD( CRope, mObjectAttached, FIELD_BOOLEAN ),
 	DEFINE_FIELD( CRope, mAttachedObjectsSegment, FIELD_INTEGER ),
 	DEFINE_FIELD( CRope, detachTime, FIELD_TIME ),
 	DEFINE_FIELD( CRope, detachDelay, FIELD_FLOAT ),
 	DEFINE_ARRAY( CRope, seg, FIELD_CLASSPTR, MAX_SEGMENTS ),
-	DEFINE_ARRAY( CRope, altseg, FIELD_CLASSPTR, MAX_SEGMENTS ),
-	DEFINE_ARRAY( CRope, m_Samples, FIELD_CLASSPTR, MAX_SAMPLES ),
 	DEFINE_FIELD( CRope, mDisallowPlayerAttachment, FIELD_INTEGER ),
 	DEFINE_FIELD( CRope, mBodyModel, FIELD_STRING ),
 	DEFINE_FIELD( CRope, mEndingModel, FIELD_STRING ),
 	DEFINE_FIELD( CRope, mAttachedObjectsOffset, FIELD_FLOAT ),
 	DEFINE_FIELD( CRope, m_bMakeSound, FIELD_BOOLEAN ),
 	DEFINE_FIELD( CRope, m_activated, FIELD_BOOLEAN ),
+	DEFINE_FIELD( CRope, m_bClientSide, FIELD_BOOLEAN ),
+	DEFINE_FIELD( CRope, m_hAttachedObject, FIELD_EHANDLE ),
 };
 
-IMPLEMENT_SAVERESTORE( CRope, CBaseDelay )
+int CRope::Save( CSave &save )
+{
+	if( !CBaseDelay::Save( save ) )
+		return 0;
+	return save.WriteFields( "CRope", this, m_SaveData, ARRAYSIZE( m_SaveData ) );
+}
+
+int CRope::Restore( CRestore &restore )
+{
+	if( !CBaseDelay::Restore( restore ) )
+		return 0;
+	int status = restore.ReadFields( "CRope", this, m_SaveData, ARRAYSIZE( m_SaveData ) );
+
+	if( status && m_Sim.numSamples == 0 )
+	{
+		// Saved when the samples were rope_sample entities, none of their state was restored.
+		m_Sim.Init( m_NumSamples, ROPE_GRAVITY_FORCE );
+
+		if( m_activated )
+		{
+			// The segments may not be restored yet, rebuild the simulation from them on the next think
+			SetThink( &CRope::RestoreRopeThink );
+			pev->nextthink = gpGlobals->time;
+		}
+	}
+
+	return status;
+}
 
 LINK_ENTITY_TO_CLASS( env_rope, CRope )
 
@@ -239,6 +206,7 @@ CRope::CRope()
 	mBodyModel = MAKE_STRING( "models/rope16.mdl" );
 	mEndingModel = MAKE_STRING( "models/rope16.mdl" );
 
+	m_iSentAttachedSegment = -1;
 }
 
 void CRope::Precache()
@@ -246,7 +214,6 @@ void CRope::Precache()
 	CBaseDelay::Precache();
 
 	UTIL_PrecacheOther( "rope_segment" );
-	UTIL_PrecacheOther( "rope_sample" );
 
 	PRECACHE_MODEL(STRING(GetBodyModel()));
 	PRECACHE_MODEL(STRING(GetEndingModel()));
@@ -263,12 +230,10 @@ void CRope::Spawn()
 
 	Precache();
 
-	m_Gravity.x = m_Gravity.y = 0;
-	m_Gravity.z = -50;
-
 	mObjectAttached = false;
 
 	m_NumSamples = m_iSegments + 1;
+	m_Sim.Init( m_NumSamples, ROPE_GRAVITY_FORCE );
 
 	m_activated = false;
 }
@@ -294,22 +259,10 @@ void CRope::InitRope()
 {
 	pev->flags |= FL_ALWAYSTHINK;
 
-	for( int uiSample = 0; uiSample < m_NumSamples; ++uiSample )
-	{
-		m_Samples[ uiSample ] = CRopeSample::CreateSample();
-		UTIL_SetOrigin(m_Samples[ uiSample ]->pev, pev->origin);
-		if (FBitSet(pev->spawnflags, SF_ROPE_NO_TRANSITION))
-			m_Samples[ uiSample ]->pev->spawnflags |= SF_ROPE_NO_TRANSITION;
-	}
-
-	memset( m_Samples + m_NumSamples, 0, sizeof( CRopeSample* ) * ( MAX_SAMPLES - m_NumSamples ) );
+	m_bClientSide = sv_client_ropes.value != 0;
 
 	{
-		CRopeSegment* pSegment = seg[ 0 ] = CRopeSegment::CreateSegment( m_Samples[ 0 ], GetBodyModel(), this );
-
-		pSegment->SetAbsOrigin( pev->origin );
-
-		pSegment = altseg[ 0 ] = CRopeSegment::CreateSegment( m_Samples[ 0 ], GetBodyModel(), this );
+		CRopeSegment* pSegment = seg[ 0 ] = CRopeSegment::CreateSegment( 0, GetBodyModel(), this );
 
 		pSegment->SetAbsOrigin( pev->origin );
 	}
@@ -317,18 +270,13 @@ void CRope::InitRope()
 	Vector origin;
 	Vector angles;
 
-	const Vector vecGravity = m_Gravity.Normalize();
+	const Vector vecGravity = m_Sim.gravity.Normalize();
 
 	if( m_iSegments > 2 )
 	{
-		CRopeSample** ppCurrentSys = m_Samples;
-
 		for( int uiSeg = 1; uiSeg < m_iSegments - 1; ++uiSeg )
 		{
-			CRopeSample* pSegSample = m_Samples[ uiSeg ];
-			seg[ uiSeg ] = CRopeSegment::CreateSegment( pSegSample, GetBodyModel(), this );
-
-			altseg[ uiSeg ] = CRopeSegment::CreateSegment( pSegSample, GetBodyModel(), this );
+			seg[ uiSeg ] = CRopeSegment::CreateSegment( uiSeg, GetBodyModel(), this );
 
 			CRopeSegment* pCurrent = seg[ uiSeg - 1 ];
 
@@ -341,14 +289,10 @@ void CRope::InitRope()
 			origin = flLength * vecGravity + pCurrent->pev->origin;
 
 			seg[ uiSeg ]->SetAbsOrigin( origin );
-			altseg[ uiSeg ]->SetAbsOrigin( origin );
 		}
 	}
 
-	CRopeSample* pSegSample = m_Samples[ m_iSegments - 1 ];
-	seg[ m_iSegments - 1 ] = CRopeSegment::CreateSegment( pSegSample, GetEndingModel(), this );
-
-	altseg[ m_iSegments - 1 ] = CRopeSegment::CreateSegment( pSegSample, GetEndingModel(), this );
+	seg[ m_iSegments - 1 ] = CRopeSegment::CreateSegment( m_iSegments - 1, GetEndingModel(), this );
 
 	CRopeSegment* pCurrent = seg[ m_iSegments - 2 ];
 
@@ -361,330 +305,241 @@ void CRope::InitRope()
 	origin = flLength * vecGravity + pCurrent->pev->origin;
 
 	seg[ m_iSegments - 1 ]->SetAbsOrigin( origin );
-	altseg[ m_iSegments - 1 ]->SetAbsOrigin( origin );
 
 	memset( seg + m_iSegments, 0, sizeof( CRopeSegment* ) * ( MAX_SEGMENTS - m_iSegments ) );
-	memset( altseg + m_iSegments, 0, sizeof( CRopeSegment* ) * ( MAX_SEGMENTS - m_iSegments ) );
 
 	m_InitialDeltaTime = true;
 
 	InitializeRopeSim();
 
+	SendRope( NULL );
+
 	SetThink(&CRope::RopeThink);
 	pev->nextthink = gpGlobals->time + 0.01;
 }
 
 void CRope::RopeThink()
 {
-	m_bToggle = !m_bToggle;
-
 	RunSimOnSamples();
 
-	CRopeSegment** ppPrimarySegs;
-	CRopeSegment** ppHiddenSegs;
-
-	if( m_bToggle )
-	{
-		ppPrimarySegs = altseg;
-		ppHiddenSegs = seg;
-	}
-	else
-	{
-		ppPrimarySegs = seg;
-		ppHiddenSegs = altseg;
-	}
-
-	SetRopeSegments( m_iSegments, ppPrimarySegs, ppHiddenSegs );
+	if( m_iSegments > 0 )
+		TraceModels();
 
 	if( ShouldCreak() )
 	{
 		Creak();
 	}
 
-	pev->nextthink = gpGlobals->time + (1 / RopeFrameRate);
-}
-
-void CRope::InitializeRopeSim()
-{
-	int uiIndex;
-
-	for( int uiSeg = 0; uiSeg < m_iSegments; ++uiSeg )
+	if( m_bClientSide && mObjectAttached && mAttachedObjectsSegment != m_iSentAttachedSegment )
 	{
-		CRopeSegment* pSegment = seg[ uiSeg ];
-		CRopeSample* pSample = pSegment->GetSample();
-
-		RopeSampleData& data = pSample->GetData();
-
-		data.mPosition = pSegment->pev->origin;
-
-		data.mVelocity				= g_vecZero;
-		data.mForce					= g_vecZero;
-		data.mMassReciprocal		= 1;
-		data.mApplyExternalForce	= false;
-		data.mExternalForce			= g_vecZero;
-
-		Vector vecOrigin, vecAngles;
-		pSegment->GetAttachment( 0, vecOrigin, vecAngles );
-		data.restLength = ( pSegment->pev->origin - vecOrigin ).Length();
+		SendAttachedObject( NULL );
 	}
 
+	if( m_bClientSide && !mObjectAttached )
 	{
-		//Zero out the anchored segment's mass so it stays in place.
-		CRopeSample *pSample = m_Samples[ 0 ];
-
-		pSample->GetData().mMassReciprocal = 0;
+		// Nobody sees the server copy, it only has to be close enough for grabbing the rope
+		pev->flags &= ~FL_ALWAYSTHINK;
+		pev->nextthink = gpGlobals->time + (1 / RopeClientSideFrameRate);
 	}
-
-	CRopeSegment* pSegment = seg[ m_iSegments - 1 ];
-
-	Vector vecOrigin, vecAngles;
-
-	pSegment->GetAttachment( 0, vecOrigin, vecAngles );
-
-	Vector vecDistance = vecOrigin - pSegment->pev->origin;
-
-	const float flLength = vecDistance.Length();
-
-	const Vector vecGravity = m_Gravity.Normalize();
-
-	vecOrigin = vecGravity * flLength + pSegment->pev->origin;
-
-	CRopeSample* pSample = m_Samples[ m_NumSamples - 1 ];
-
-	RopeSampleData& data = pSample->GetData();
-
-	data.mPosition = vecOrigin;
-
-	m_LastEndPos = vecOrigin;
-
-	data.mVelocity = g_vecZero;
-
-	data.mForce = g_vecZero;
-
-	data.mMassReciprocal = 0.2;
-
-	data.mApplyExternalForce = false;
-
-	int uiNumSegs = ROPE_IGNORE_SAMPLES;
-
-	if( m_iSegments <= ROPE_IGNORE_SAMPLES )
-		uiNumSegs = m_iSegments;
-
-	for( uiIndex = 0; uiIndex < uiNumSegs; ++uiIndex )
+	else
 	{
-		seg[ uiIndex ]->SetCanBeGrabbed( false );
-		altseg[ uiIndex ]->SetCanBeGrabbed( false );
+		pev->flags |= FL_ALWAYSTHINK;
+		pev->nextthink = gpGlobals->time + (1 / RopeFrameRate);
 	}
 }
 
-void CRope::RunSimOnSamples()
+//=========================================================
+// RestoreRopeThink - rebuilds the simulation of a rope
+// restored from a save made when the samples were entities.
+// The hidden set of segments the rope used to swap with the
+// visible one is removed.
+//=========================================================
+void CRope::RestoreRopeThink()
 {
-	float flDeltaTime = 0.025;
-
-	if( m_InitialDeltaTime )
-	{
-		m_InitialDeltaTime = false;
-		mLastTime = gpGlobals->time;
-		flDeltaTime = 0;
-	}
-
-	int uiIndex = 0;
+	int uiSeg;
 
-	bool swapped = false;
-	while( true )
+	CBaseEntity* pEntity = NULL;
+	while( ( pEntity = UTIL_FindEntityByClassname( pEntity, "rope_segment" ) ) != NULL )
 	{
-		++uiIndex;
+		CRopeSegment* pSegment = (CRopeSegment*)pEntity;
 
-		ComputeForces( m_Samples );
-		RK4Integrate( flDeltaTime );
+		if( pSegment->GetMasterRope() != this )
+			continue;
 
-		mLastTime += 0.007;
-
-		if( gpGlobals->time <= mLastTime )
+		for( uiSeg = 0; uiSeg < m_iSegments; ++uiSeg )
 		{
-			if( ( uiIndex % 2 ) != 0 )
+			if( seg[ uiSeg ] == pSegment )
 				break;
 		}
 
-		for (int i=0; i<m_NumSamples; ++i)
-		{
-			m_Samples[i]->Swap();
-		}
-		swapped = !swapped;
+		if( uiSeg == m_iSegments )
+			UTIL_Remove( pSegment );
 	}
 
-	if (swapped)
+	bool bSegmentsValid = m_iSegments >= 2;
+
+	for( uiSeg = 0; uiSeg < m_iSegments && bSegmentsValid; ++uiSeg )
 	{
-		for (int i=0; i<m_NumSamples; ++i)
-		{
-			m_Samples[i]->ResetSwap();
-		}
+		if( !seg[ uiSeg ] )
+			bSegmentsValid = false;
 	}
 
-	mLastTime = gpGlobals->time;
-}
+	m_bClientSide = sv_client_ropes.value != 0;
 
-void CRope::ComputeForces( RopeSampleData* pSystem )
-{
-	int uiIndex;
-	for( uiIndex = 0; uiIndex < m_NumSamples; ++uiIndex )
+	if( !bSegmentsValid )
 	{
-		ComputeSampleForce( pSystem[ uiIndex ] );
-	}
+		// Nothing to rebuild from, start over
+		for( uiSeg = 0; uiSeg < MAX_SEGMENTS; ++uiSeg )
+		{
+			if( seg[ uiSeg ] )
+				UTIL_Remove( seg[ uiSeg ] );
+		}
 
-	for( uiIndex = 0; uiIndex < m_iSegments; ++uiIndex )
-	{
-		ComputeSpringForce( pSystem[ uiIndex ], pSystem[ uiIndex+1 ] );
+		InitRope();
+		return;
 	}
-}
 
-void CRope::ComputeForces( CRopeSample** ppSystem )
-{
-	int uiIndex;
-	for( uiIndex = 0; uiIndex < m_NumSamples; ++uiIndex )
+	for( uiSeg = 0; uiSeg < m_iSegments; ++uiSeg )
 	{
-		ComputeSampleForce( ppSystem[ uiIndex ]->GetSourceData() );
+		// The saved set may be the one that was hidden at the time
+		CRopeSegment* pSegment = seg[ uiSeg ];
+		pSegment->SetSample( uiSeg );
+		pSegment->pev->solid = SOLID_TRIGGER;
+		pSegment->pev->effects = 0;
+		pSegment->SetMasterRope( this );
+		UTIL_SetOrigin( pSegment->pev, pSegment->pev->origin );
 	}
 
-	for( uiIndex = 0; uiIndex < m_iSegments; ++uiIndex )
-	{
-		ComputeSpringForce( ppSystem[ uiIndex ]->GetSourceData(), ppSystem[ uiIndex+1 ]->GetSourceData() );
-	}
+	m_InitialDeltaTime = true;
+
+	InitializeRopeSim();
+
+	SendRope( NULL );
+
+	SetThink( &CRope::RopeThink );
+	pev->nextthink = gpGlobals->time + 0.01;
 }
 
-void CRope::ComputeSampleForce( RopeSampleData& data )
+void CRope::SendMessages( CBaseEntity* pClient )
 {
-	data.mForce = g_vecZero;
+	if( !m_activated )
+		return;
 
-	if( data.mMassReciprocal != 0.0 )
-	{
-		data.mForce = data.mForce + ( m_Gravity / data.mMassReciprocal );
-	}
+	SendRope( pClient );
+	if( mObjectAttached )
+		SendAttachedObject( pClient );
+}
 
-	if( data.mApplyExternalForce )
+void CRope::UpdateOnRemove()
+{
+	if( m_bClientSide )
 	{
-		data.mForce = data.mForce + data.mExternalForce;
-
-		data.mExternalForce = g_vecZero;
-		data.mApplyExternalForce = false;
+		MESSAGE_BEGIN( MSG_ALL, gmsgRope );
+			WRITE_BYTE( ROPE_MSG_REMOVE );
+			WRITE_SHORT( entindex() );
+		MESSAGE_END();
 	}
 
-	if( DotProduct( m_Gravity, data.mVelocity ) >= 0 )
-	{
-		data.mForce = data.mForce + data.mVelocity * -0.04;
-	}
-	else
-	{
-		data.mForce = data.mForce - data.mVelocity;
-	}
+	CBaseDelay::UpdateOnRemove();
 }
 
-void CRope::ComputeSpringForce( RopeSampleData& first, RopeSampleData& second )
+void CRope::SendRope( CBaseEntity* pClient )
 {
-	Vector vecDist = first.mPosition - second.mPosition;
-
-	const double flDistance = vecDist.Length();
-
-	const double flForce = ( flDistance - first.restLength ) * HOOK_CONSTANT;
+	if( !m_bClientSide || m_iSegments <= 0 )
+		return;
 
-	const double flNewRelativeDist = DotProduct( first.mVelocity - second.mVelocity, vecDist ) * SPRING_DAMPING;
+	const int msgType = pClient ? MSG_ONE : MSG_ALL;
+	edict_t* pClientEdict = pClient ? pClient->edict() : NULL;
+
+	// The clients build the samples along the gravity from the anchor, like InitRope does
+	MESSAGE_BEGIN( msgType, gmsgRope, NULL, pClientEdict );
+		WRITE_BYTE( ROPE_MSG_CREATE );
+		WRITE_SHORT( entindex() );
+		WRITE_BYTE( m_iSegments );
+		WRITE_VECTOR( m_Sim.position[ 0 ] );
+		WRITE_SHORT( MODEL_INDEX( STRING( GetBodyModel() ) ) );
+		WRITE_SHORT( MODEL_INDEX( STRING( GetEndingModel() ) ) );
+		WRITE_COORD( GetSegmentLength( 0 ) );
+		WRITE_COORD( GetSegmentLength( m_iSegments - 1 ) );
+	MESSAGE_END();
+}
 
-	vecDist = vecDist.Normalize();
+void CRope::SendAttachedObject( CBaseEntity* pClient )
+{
+	if( !m_bClientSide )
+		return;
 
-	const double flSpringFactor = -( flNewRelativeDist / flDistance + flForce );
+	const int msgType = pClient ? MSG_ONE : MSG_ALL;
+	edict_t* pClientEdict = pClient ? pClient->edict() : NULL;
 
-	const Vector vecForce = flSpringFactor * vecDist;
+	CBaseEntity* pObject = mObjectAttached ? (CBaseEntity*)m_hAttachedObject : NULL;
 
-	first.mForce = first.mForce + vecForce;
+	MESSAGE_BEGIN( msgType, gmsgRope, NULL, pClientEdict );
+		WRITE_BYTE( ROPE_MSG_ATTACH );
+		WRITE_SHORT( entindex() );
+		WRITE_SHORT( pObject ? pObject->entindex() : 0 );
+		WRITE_BYTE( mAttachedObjectsSegment );
+	MESSAGE_END();
 
-	second.mForce = second.mForce - vecForce;
+	if( !pClient )
+		m_iSentAttachedSegment = pObject ? mAttachedObjectsSegment : -1;
 }
 
-void CRope::RK4Integrate( const float flDeltaTime )
+void CRope::InitializeRopeSim()
 {
-	const float flDeltas[ MAX_LIST_SEGMENTS - 1 ] =
-	{
-		flDeltaTime * 0.5f,
-		flDeltaTime * 0.5f,
-		flDeltaTime * 0.5f,
-		flDeltaTime
-	};
+	int uiIndex;
 
-	{
-		RopeSampleData* pTemp1 = g_pTempList[ 0 ];
-		RopeSampleData* pTemp2 = g_pTempList[ 1 ];
+	m_Sim.Init( m_NumSamples, m_Sim.gravity );
 
-		for( int uiIndex = 0; uiIndex < m_NumSamples; ++uiIndex, ++pTemp1, ++pTemp2 )
-		{
-			RopeSampleData& data = m_Samples[ uiIndex ]->GetSourceData();
-
-			pTemp2->mForce = data.mMassReciprocal * data.mForce * flDeltas[ 0 ];
-			pTemp2->mVelocity = data.mVelocity * flDeltas[ 0 ];
-			pTemp2->restLength = data.restLength;
+	for( int uiSeg = 0; uiSeg < m_iSegments; ++uiSeg )
+	{
+		CRopeSegment* pSegment = seg[ uiSeg ];
 
-			pTemp1->mMassReciprocal = data.mMassReciprocal;
-			pTemp1->mVelocity = data.mVelocity + pTemp2->mForce;
-			pTemp1->mPosition = data.mPosition + pTemp2->mVelocity;
-			pTemp1->restLength = data.restLength;
-		}
+		m_Sim.position[ uiSeg ] = pSegment->pev->origin;
+		m_Sim.massReciprocal[ uiSeg ] = 1;
 
-		ComputeForces( g_pTempList[ 0 ] );
+		Vector vecOrigin, vecAngles;
+		pSegment->GetAttachment( 0, vecOrigin, vecAngles );
+		m_Sim.restLength[ uiSeg ] = ( pSegment->pev->origin - vecOrigin ).Length();
 	}
 
-	for( int uiStep = 2; uiStep < MAX_LIST_SEGMENTS - 1; ++uiStep )
-	{
-		RopeSampleData* pTemp1 = g_pTempList[ 0 ];
-		RopeSampleData* pTemp2 = g_pTempList[ uiStep ];
+	//Zero out the anchored segment's mass so it stays in place.
+	m_Sim.massReciprocal[ 0 ] = 0;
 
-		for( int uiIndex = 0; uiIndex < m_NumSamples; ++uiIndex, ++pTemp1, ++pTemp2 )
-		{
-			RopeSampleData& data = m_Samples[ uiIndex ]->GetSourceData();
+	CRopeSegment* pSegment = seg[ m_iSegments - 1 ];
 
-			pTemp2->mForce = data.mMassReciprocal * pTemp1->mForce * flDeltas[ uiStep - 1 ];
-			pTemp2->mVelocity = pTemp1->mVelocity * flDeltas[ uiStep - 1 ];
-			pTemp2->restLength = data.restLength;
+	const Vector vecGravity = m_Sim.gravity.Normalize();
 
-			pTemp1->mMassReciprocal = data.mMassReciprocal;
-			pTemp1->mVelocity = data.mVelocity + pTemp2->mForce;
-			pTemp1->mPosition = data.mPosition + pTemp2->mVelocity;
-			pTemp1->restLength = data.restLength;
-		}
+	const Vector vecOrigin = vecGravity * GetSegmentLength( m_iSegments - 1 ) + pSegment->pev->origin;
 
-		ComputeForces( g_pTempList[ 0 ] );
-	}
+	m_Sim.position[ m_NumSamples - 1 ] = vecOrigin;
+	m_Sim.massReciprocal[ m_NumSamples - 1 ] = 0.2;
 
-	{
-		RopeSampleData* pTemp1 = g_pTempList[ 0 ];
-		RopeSampleData* pTemp2 = g_pTempList[ 4 ];
+	m_LastEndPos = vecOrigin;
 
-		for( int uiIndex = 0; uiIndex < m_NumSamples; ++uiIndex, ++pTemp1, ++pTemp2 )
-		{
-			RopeSampleData& data = m_Samples[ uiIndex ]->GetSourceData();
+	int uiNumSegs = ROPE_IGNORE_SAMPLES;
 
-			pTemp2->mForce = data.mMassReciprocal * pTemp1->mForce * flDeltas[ 3 ];
+	if( m_iSegments <= ROPE_IGNORE_SAMPLES )
+		uiNumSegs = m_iSegments;
 
-			pTemp2->mVelocity = pTemp1->mVelocity * flDeltas[ 3 ];
-		}
+	for( uiIndex = 0; uiIndex < uiNumSegs; ++uiIndex )
+	{
+		seg[ uiIndex ]->SetCanBeGrabbed( false );
 	}
+}
 
-	RopeSampleData* pTemp1 = g_pTempList[ 1 ];
-	RopeSampleData* pTemp2 = g_pTempList[ 2 ];
-	RopeSampleData* pTemp3 = g_pTempList[ 3 ];
-	RopeSampleData* pTemp4 = g_pTempList[ 4 ];
-
-	for( int uiIndex = 0; uiIndex < m_NumSamples; ++uiIndex, ++pTemp1, ++pTemp2, ++pTemp3, ++pTemp4 )
+void CRope::RunSimOnSamples()
+{
+	if( m_InitialDeltaTime )
 	{
-		RopeSampleData& pSource = m_Samples[ uiIndex ]->GetSourceData();
-		RopeSampleData& pTarget = m_Samples[ uiIndex ]->GetTargetData();
-
-		const Vector vecPosChange = 1.0f / 6.0f * ( pTemp1->mVelocity + ( pTemp2->mVelocity + pTemp3->mVelocity ) * 2 + pTemp4->mVelocity );
-
-		const Vector vecVelChange = 1.0f / 6.0f * ( pTemp1->mForce + ( pTemp2->mForce + pTemp3->mForce ) * 2 + pTemp4->mForce );
+		m_InitialDeltaTime = false;
+		mLastTime = gpGlobals->time;
+		return;
+	}
 
-		pTarget.mPosition = pSource.mPosition + ( vecPosChange );//* flDeltaTime );
+	m_Sim.Advance( gpGlobals->time - mLastTime );
 
-		pTarget.mVelocity = pSource.mVelocity + ( vecVelChange );//* flDeltaTime );
-	}
+	mLastTime = gpGlobals->time;
 }
 
 //TODO move to common header - Solokiller
@@ -719,18 +574,15 @@ void TruncateEpsilon( Vector& vec )
 	vec = vec1 / 10;
 }
 
-void CRope::TraceModels( CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSegs )
+void CRope::TraceModels()
 {
 	if( m_iSegments > 1 )
 	{
 		Vector vecAngles;
 
-		GetAlignmentAngles(
-			m_Samples[ 0 ]->GetData().mPosition,
-			m_Samples[ 1 ]->GetData().mPosition,
-			vecAngles );
+		GetAlignmentAngles( m_Sim.position[ 0 ], m_Sim.position[ 1 ], vecAngles );
 
-		( *ppPrimarySegs )->pev->angles = vecAngles;
+		seg[ 0 ]->pev->angles = vecAngles;
 	}
 
 	TraceResult tr;
@@ -739,9 +591,9 @@ void CRope::TraceModels( CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSe
 	{
 		for( unsigned int uiSeg = 1; uiSeg < m_iSegments; ++uiSeg )
 		{
-			CRopeSample* pSample = m_Samples[ uiSeg ];
+			const Vector vecPrevOrigin = seg[ uiSeg ]->pev->origin;
 
-			Vector vecDist = pSample->GetData().mPosition - ppHiddenSegs[ uiSeg ]->pev->origin;
+			Vector vecDist = m_Sim.position[ uiSeg ] - vecPrevOrigin;
 
 			vecDist = vecDist.Normalize();
 
@@ -750,9 +602,9 @@ void CRope::TraceModels( CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSe
 
 			const Vector vecTraceDist = vecDist * flTraceDist;
 
-			const Vector vecEnd = pSample->GetData().mPosition + vecTraceDist;
+			const Vector vecEnd = m_Sim.position[ uiSeg ] + vecTraceDist;
 
-			UTIL_TraceLine( ppHiddenSegs[ uiSeg ]->pev->origin, vecEnd, ignore_monsters, edict(), &tr );
+			UTIL_TraceLine( vecPrevOrigin, vecEnd, ignore_monsters, edict(), &tr );
 
 			if( tr.flFraction == 1.0 && tr.fAllSolid )
 			{
@@ -765,25 +617,21 @@ void CRope::TraceModels( CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSe
 
 				TruncateEpsilon( vecOrigin );
 
-				ppPrimarySegs[ uiSeg ]->SetAbsOrigin( vecOrigin );
+				seg[ uiSeg ]->SetAbsOrigin( vecOrigin );
 
 				Vector vecNormal = tr.vecPlaneNormal.Normalize() * 20000.0;
 
-				RopeSampleData& data = ppPrimarySegs[ uiSeg ]->GetSample()->GetData();
-
-				data.mApplyExternalForce = true;
+				m_Sim.SetExternalForce( uiSeg, vecNormal );
 
-				data.mExternalForce = vecNormal;
-
-				data.mVelocity = g_vecZero;
+				m_Sim.velocity[ uiSeg ] = g_vecZero;
 			}
 			else
 			{
-				Vector vecOrigin = pSample->GetData().mPosition;
+				Vector vecOrigin = m_Sim.position[ uiSeg ];
 
 				TruncateEpsilon( vecOrigin );
 
-				ppPrimarySegs[ uiSeg ]->SetAbsOrigin( vecOrigin );
+				seg[ uiSeg ]->SetAbsOrigin( vecOrigin );
 			}
 		}
 	}
@@ -791,33 +639,27 @@ void CRope::TraceModels( CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSe
 	{
 		for( unsigned int uiSeg = 1; uiSeg < m_iSegments; ++uiSeg )
 		{
-			UTIL_TraceLine(
-				ppHiddenSegs[ uiSeg ]->pev->origin,
-				m_Samples[ uiSeg ]->GetData().mPosition,
-				ignore_monsters, edict(), &tr );
+			UTIL_TraceLine( seg[ uiSeg ]->pev->origin, m_Sim.position[ uiSeg ], ignore_monsters, edict(), &tr );
 
 			if( tr.flFraction == 1.0 )
 			{
-				Vector vecOrigin = m_Samples[ uiSeg ]->GetData().mPosition;
+				Vector vecOrigin = m_Sim.position[ uiSeg ];
 
 				TruncateEpsilon( vecOrigin );
 
-				ppPrimarySegs[ uiSeg ]->SetAbsOrigin( vecOrigin );
+				seg[ uiSeg ]->SetAbsOrigin( vecOrigin );
 			}
 			else
 			{
-				CBaseEntity* pEnt = (CBaseEntity*)GET_PRIVATE( tr.pHit );
 				const Vector vecNormal = tr.vecPlaneNormal.Normalize();
 
 				Vector vecOrigin = tr.vecEndPos + vecNormal * 10.0;
 
 				TruncateEpsilon( vecOrigin );
 
-				ppPrimarySegs[ uiSeg ]->SetAbsOrigin( vecOrigin );
-
-				ppPrimarySegs[ uiSeg ]->GetSample()->GetData().mApplyExternalForce = true;
+				seg[ uiSeg ]->SetAbsOrigin( vecOrigin );
 
-				ppPrimarySegs[ uiSeg ]->GetSample()->GetData().mExternalForce = vecNormal * 40000.0;
+				m_Sim.SetExternalForce( uiSeg, vecNormal * 40000.0 );
 			}
 		}
 	}
@@ -826,8 +668,8 @@ void CRope::TraceModels( CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSe
 
 	for( int uiSeg = 1; uiSeg < m_iSegments; ++uiSeg )
 	{
-		CRopeSegment *pSegment = ppPrimarySegs[ uiSeg - 1 ];
-		CRopeSegment *pSegment2 = ppPrimarySegs[ uiSeg ];
+		CRopeSegment *pSegment = seg[ uiSeg - 1 ];
+		CRopeSegment *pSegment2 = seg[ uiSeg ];
 
 		GetAlignmentAngles( pSegment->pev->origin, pSegment2->pev->origin, vecAngles );
 
@@ -836,24 +678,22 @@ void CRope::TraceModels( CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSe
 
 	if( m_iSegments > 1 )
 	{
-		CRopeSample *pSample = m_Samples[ m_NumSamples - 1 ];
+		const int iLastSample = m_NumSamples - 1;
 
-		UTIL_TraceLine( m_LastEndPos, pSample->GetData().mPosition, ignore_monsters, edict(), &tr );
+		UTIL_TraceLine( m_LastEndPos, m_Sim.position[ iLastSample ], ignore_monsters, edict(), &tr );
 
 		if( tr.flFraction == 1.0 )
 		{
-			m_LastEndPos = pSample->GetData().mPosition;
+			m_LastEndPos = m_Sim.position[ iLastSample ];
 		}
 		else
 		{
 			m_LastEndPos = tr.vecEndPos;
 
-			pSample->GetData().mApplyExternalForce = true;
-
-			pSample->GetData().mExternalForce = tr.vecPlaneNormal.Normalize() * 40000.0;
+			m_Sim.SetExternalForce( iLastSample, tr.vecPlaneNormal.Normalize() * 40000.0 );
 		}
 
-		CRopeSegment *pSegment = ppPrimarySegs[ m_NumSamples - 2 ];
+		CRopeSegment *pSegment = seg[ m_NumSamples - 2 ];
 
 		GetAlignmentAngles( pSegment->pev->origin, m_LastEndPos, vecAngles );
 
@@ -861,48 +701,12 @@ void CRope::TraceModels( CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSe
 	}
 }
 
-void CRope::SetRopeSegments( const int uiNumSegments,
-							 CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSegs )
-{
-	if( uiNumSegments > 0 )
-	{
-		TraceModels( ppPrimarySegs, ppHiddenSegs );
-
-		ppPrimarySegs[ 0 ]->pev->solid = SOLID_TRIGGER;
-		ppPrimarySegs[ 0 ]->pev->effects = 0;
-
-		ppHiddenSegs[ 0 ]->pev->solid = SOLID_NOT;
-		ppHiddenSegs[ 0 ]->pev->effects = EF_NODRAW;
-
-		for( int uiIndex = 1; uiIndex < uiNumSegments; ++uiIndex )
-		{
-			CRopeSegment* pPrim = ppPrimarySegs[ uiIndex ];
-			CRopeSegment* pHidden = ppHiddenSegs[ uiIndex ];
-
-			pPrim->pev->solid = SOLID_TRIGGER;
-			pPrim->pev->effects = 0;
-
-			pHidden->pev->solid = SOLID_NOT;
-			pHidden->pev->effects = EF_NODRAW;
-
-			Vector vecOrigin = pPrim->pev->origin;
-
-			//vecOrigin.x += 10.0;
-			//vecOrigin.y += 10.0;
-
-			pHidden->SetAbsOrigin( vecOrigin );
-		}
-	}
-}
-
 bool CRope::MoveUp( const float flDeltaTime )
 {
 	if( mAttachedObjectsSegment > 4 )
 	{
 		float flDistance = flDeltaTime * 128.0;
 
-		Vector vecOrigin, vecAngles;
-
 		while( true )
 		{
 			float flOldDist = flDistance;
@@ -925,11 +729,7 @@ bool CRope::MoveUp( const float flDeltaTime )
 
 				if( mAttachedObjectsSegment < m_iSegments )
 				{
-					CRopeSegment *pSegment = seg[ mAttachedObjectsSegment ];
-
-					pSegment->GetAttachment( 0, vecOrigin, vecAngles );
-
-					flNewOffset = ( pSegment->pev->origin - vecOrigin ).Length();
+					flNewOffset = GetSegmentLength( mAttachedObjectsSegment );
 				}
 
 				mAttachedObjectsOffset = flNewOffset;
@@ -951,10 +751,6 @@ bool CRope::MoveDown( const float flDeltaTime )
 
 	float flDistance = flDeltaTime * 128.0;
 
-	Vector vecOrigin, vecAngles;
-
-	CRopeSegment* pSegment;
-
 	bool bOnRope = true;
 
 	bool bDoIteration = true;
@@ -972,11 +768,7 @@ bool CRope::MoveDown( const float flDeltaTime )
 			{
 				if( mAttachedObjectsSegment < m_iSegments )
 				{
-					pSegment = seg[ mAttachedObjectsSegment ];
-
-					pSegment->GetAttachment( 0, vecOrigin, vecAngles );
-
-					flSegLength = ( pSegment->pev->origin - vecOrigin ).Length();
+					flSegLength = GetSegmentLength( mAttachedObjectsSegment );
 				}
 
 				const float flOffset = flSegLength - mAttachedObjectsOffset;
@@ -1013,7 +805,7 @@ Vector CRope::GetAttachedObjectsVelocity() const
 	if( !mObjectAttached )
 		return g_vecZero;
 
-	return seg[ mAttachedObjectsSegment ]->GetSample()->GetData().mVelocity;
+	return m_Sim.velocity[ mAttachedObjectsSegment ];
 }
 
 void CRope::ApplyForceFromPlayer( const Vector& vecForce )
@@ -1035,23 +827,25 @@ void CRope::ApplyForceToSegment( const Vector& vecForce, const int uiSegment )
 {
 	if( uiSegment < m_iSegments )
 	{
-		seg[ uiSegment ]->ApplyExternalForce( vecForce );
+		ApplyForceToSample( vecForce, uiSegment );
 	}
 	else if( uiSegment == m_iSegments )
 	{
 		//Apply force to the last sample.
-
-		RopeSampleData& data = m_Samples[ uiSegment - 1 ]->GetData();
-
-		data.mExternalForce = data.mExternalForce + vecForce;
-
-		data.mApplyExternalForce = true;
+		ApplyForceToSample( vecForce, uiSegment - 1 );
 	}
 }
 
-void CRope::AttachObjectToSegment( CRopeSegment* pSegment )
+void CRope::ApplyForceToSample( const Vector& vecForce, const int uiSample )
+{
+	if( uiSample >= 0 && uiSample < m_NumSamples )
+		m_Sim.AddExternalForce( uiSample, vecForce );
+}
+
+void CRope::AttachObjectToSegment( CRopeSegment* pSegment, CBaseEntity* pObject )
 {
 	mObjectAttached = true;
+	m_hAttachedObject = pObject;
 
 	detachTime = 0;
 	detachDelay = 2.0f;
@@ -1059,13 +853,25 @@ void CRope::AttachObjectToSegment( CRopeSegment* pSegment )
 	SetAttachedObjectsSegment( pSegment );
 
 	mAttachedObjectsOffset = 0;
+
+	if( m_bClientSide )
+	{
+		SendAttachedObject( NULL );
+
+		// Back to the full rate for the attached object
+		pev->flags |= FL_ALWAYSTHINK;
+		pev->nextthink = gpGlobals->time;
+	}
 }
 
 void CRope::DetachObject(float delay)
 {
 	mObjectAttached = false;
+	m_hAttachedObject = NULL;
 	detachTime = gpGlobals->time;
 	detachDelay = delay;
+
+	SendAttachedObject( NULL );
 }
 
 bool CRope::IsAcceptingAttachment() const
@@ -1082,9 +888,7 @@ bool CRope::ShouldCreak() const
 {
 	if( mObjectAttached && m_bMakeSound )
 	{
-		CRopeSample* pSample = seg[ mAttachedObjectsSegment ]->GetSample();
-
-		if( pSample->GetData().mVelocity.Length() > 20.0 )
+		if( m_Sim.velocity[ mAttachedObjectsSegment ].Length() > 20.0 )
 			return RANDOM_LONG( 1, 5 ) == 1;
 	}
 
@@ -1098,15 +902,10 @@ void CRope::Creak()
 
 float CRope::GetSegmentLength( int uiSegmentIndex ) const
 {
+	// Rest lengths are measured from the segment models when the rope is built
 	if( uiSegmentIndex < m_iSegments )
 	{
-		Vector vecOrigin, vecAngles;
-
-		CRopeSegment *pSegment = seg[ uiSegmentIndex ];
-
-		pSegment->GetAttachment( 0, vecOrigin, vecAngles );
-
-		return ( pSegment->pev->origin - vecOrigin ).Length();
+		return m_Sim.restLength[ uiSegmentIndex ];
 	}
 
 	return 0;
@@ -1116,15 +915,9 @@ float CRope::GetRopeLength() const
 {
 	float flLength = 0;
 
-	Vector vecOrigin, vecAngles;
-
 	for( int uiIndex = 0; uiIndex < m_iSegments; ++uiIndex )
 	{
-		CRopeSegment *pSegment = seg[ uiIndex ];
-
-		pSegment->GetAttachment( 0, vecOrigin, vecAngles );
-
-		flLength += ( pSegment->pev->origin - vecOrigin ).Length();
+		flLength += m_Sim.restLength[ uiIndex ];
 	}
 
 	return flLength;
@@ -1132,7 +925,7 @@ float CRope::GetRopeLength() const
 
 Vector CRope::GetRopeOrigin() const
 {
-	return m_Samples[ 0 ]->GetData().mPosition;
+	return m_Sim.position[ 0 ];
 }
 
 bool CRope::IsValidSegmentIndex( const int uiSegment ) const
@@ -1145,7 +938,7 @@ Vector CRope::GetSegmentOrigin( const int uiSegment ) const
 	if( !IsValidSegmentIndex( uiSegment ) )
 		return g_vecZero;
 
-	return m_Samples[ uiSegment ]->GetData().mPosition;
+	return m_Sim.position[ uiSegment ];
 }
 
 Vector CRope::GetSegmentAttachmentPoint( const int uiSegment ) const
@@ -1155,7 +948,7 @@ Vector CRope::GetSegmentAttachmentPoint( const int uiSegment ) const
 
 	Vector vecOrigin, vecAngles;
 
-	CRopeSegment *pSegment = m_bToggle ? altseg[ uiSegment ] : seg[ uiSegment ];
+	CRopeSegment *pSegment = seg[ uiSegment ];
 
 	pSegment->GetAttachment( 0, vecOrigin, vecAngles );
 
@@ -1166,7 +959,7 @@ void CRope::SetAttachedObjectsSegment( CRopeSegment* pSegment )
 {
 	for( int uiIndex = 0; uiIndex < m_iSegments; ++uiIndex )
 	{
-		if( seg[ uiIndex ] == pSegment || altseg[ uiIndex ] == pSegment )
+		if( seg[ uiIndex ] == pSegment )
 		{
 			mAttachedObjectsSegment = uiIndex;
 			break;
@@ -1181,8 +974,8 @@ Vector CRope::GetSegmentDirFromOrigin( const int uiSegmentIndex ) const
 
 	//There is one more sample than there are segments, so this is fine.
 	const Vector vecResult =
-		m_Samples[ uiSegmentIndex + 1 ]->GetData().mPosition -
-		m_Samples[ uiSegmentIndex ]->GetData().mPosition;
+		m_Sim.position[ uiSegmentIndex + 1 ] -
+		m_Sim.position[ uiSegmentIndex ];
 
 	return vecResult.Normalize();
 }
@@ -1195,7 +988,7 @@ Vector CRope::GetAttachedObjectsPosition() const
 	Vector vecResult;
 
 	if( mAttachedObjectsSegment < m_iSegments )
-		vecResult = m_Samples[ mAttachedObjectsSegment ]->GetData().mPosition;
+		vecResult = m_Sim.position[ mAttachedObjectsSegment ];
 
 	vecResult = vecResult +
 		( mAttachedObjectsOffset * GetSegmentDirFromOrigin( mAttachedObjectsSegment ) );
@@ -1205,51 +998,10 @@ Vector CRope::GetAttachedObjectsPosition() const
 
 
 
-// Global Savedata for player
-TYPEDESCRIPTION	CRopeSample::m_SaveData[] =
-{
-	DEFINE_FIELD( CRopeSample, data.mPosition, FIELD_VECTOR ),
-	DEFINE_FIELD( CRopeSample, data.mVelocity, FIELD_VECTOR ),
-	DEFINE_FIELD( CRopeSample, data.mForce, FIELD_VECTOR ),
-	DEFINE_FIELD( CRopeSample, data.mExternalForce, FIELD_VECTOR ),
-	DEFINE_FIELD( CRopeSample, data.mApplyExternalForce, FIELD_BOOLEAN ),
-	DEFINE_FIELD( CRopeSample, data.mMassReciprocal, FIELD_FLOAT ),
-	DEFINE_FIELD( CRopeSample, data.restLength, FIELD_FLOAT ),
-	DEFINE_FIELD( CRopeSample, data2.mPosition, FIELD_VECTOR ),
-	DEFINE_FIELD( CRopeSample, data2.mVelocity, FIELD_VECTOR ),
-	DEFINE_FIELD( CRopeSample, data2.mForce, FIELD_VECTOR ),
-	DEFINE_FIELD( CRopeSample, data2.mExternalForce, FIELD_VECTOR ),
-	DEFINE_FIELD( CRopeSample, data2.mApplyExternalForce, FIELD_BOOLEAN ),
-	DEFINE_FIELD( CRopeSample, data2.mMassReciprocal, FIELD_FLOAT ),
-	DEFINE_FIELD( CRopeSample, data2.restLength, FIELD_FLOAT ),
-	DEFINE_FIELD( CRopeSample, swapped, FIELD_BOOLEAN ),
-};
-
-IMPLEMENT_SAVERESTORE(CRopeSample, CBaseEntity)
-
-LINK_ENTITY_TO_CLASS( rope_sample, CRopeSample )
-
-void CRopeSample::Spawn()
-{
-	pev->classname = MAKE_STRING( "rope_sample" );
-	pev->effects |= EF_NODRAW;
-}
-
-CRopeSample* CRopeSample::CreateSample()
-{
-	CRopeSample* pSample = GetClassPtr<CRopeSample>( NULL );
-
-	pSample->Spawn();
-
-	return pSample;
-}
-
-
 TYPEDESCRIPTION	CRopeSegment::m_SaveData[] =
 {
-	DEFINE_FIELD( CRopeSegment, m_Sample, FIELD_CLASSPTR ),
+	DEFINE_FIELD( CRopeSegment, m_iSample, FIELD_INTEGER ),
 	DEFINE_FIELD( CRopeSegment, mModelName, FIELD_STRING ),
-	DEFINE_FIELD( CRopeSegment, mDefaultMass, FIELD_FLOAT ),
 	DEFINE_FIELD( CRopeSegment, mCauseDamage, FIELD_BOOLEAN ),
 	DEFINE_FIELD( CRopeSegment, mCanBeGrabbed, FIELD_BOOLEAN ),
 	DEFINE_FIELD( CRopeSegment, mMasterRope, FIELD_CLASSPTR ),
@@ -1277,7 +1029,6 @@ void CRopeSegment::Spawn()
 
 	pev->movetype = MOVETYPE_NOCLIP;
 	pev->solid = SOLID_TRIGGER;
-	pev->effects = EF_NODRAW;
 	SetAbsOrigin( pev->origin );
 
 	UTIL_SetSize( pev, Vector( -30, -30, -30 ), Vector( 30, 30, 30 ) );
@@ -1309,22 +1060,18 @@ void CRopeSegment::Touch( CBaseEntity* pOther )
 		{
 			if( mCanBeGrabbed )
 			{
-				RopeSampleData& data = m_Sample->GetData();
-
-				//pPlayer->SetClosestOriginOnRope(data->mPosition);
+				//pPlayer->SetClosestOriginOnRope(GetMasterRope()->GetSegmentOrigin(m_iSample));
 
 				pPlayer->SetOnRopeState( true );
 				pPlayer->SetRope( GetMasterRope() );
-				GetMasterRope()->AttachObjectToSegment( this );
+				GetMasterRope()->AttachObjectToSegment( this, pPlayer );
 
 				const Vector& vecVelocity = pOther->pev->velocity;
 
 				if( vecVelocity.Length() > 0.5 )
 				{
 					//Apply some external force to move the rope. - Solokiller
-					data.mApplyExternalForce = true;
-
-					data.mExternalForce = data.mExternalForce + vecVelocity * 750;
+					ApplyExternalForce( vecVelocity * 750 );
 				}
 
 				if( GetMasterRope()->IsSoundAllowed() )
@@ -1356,7 +1103,7 @@ void CRopeSegment::Touch( CBaseEntity* pOther )
 	}
 }
 
-CRopeSegment* CRopeSegment::CreateSegment( CRopeSample* pSample, string_t iszModelName, CRope* rope )
+CRopeSegment* CRopeSegment::CreateSegment( int iSample, string_t iszModelName, CRope* rope )
 {
 	CRopeSegment* pSegment = GetClassPtr<CRopeSegment>( NULL );
 
@@ -1364,11 +1111,10 @@ CRopeSegment* CRopeSegment::CreateSegment( CRopeSample* pSample, string_t iszMod
 
 	pSegment->Spawn();
 
-	pSegment->m_Sample = pSample;
+	pSegment->m_iSample = iSample;
 
 	pSegment->mCauseDamage = false;
 	pSegment->mCanBeGrabbed = true;
-	pSegment->mDefaultMass = pSample->GetData().mMassReciprocal;
 	pSegment->SetMasterRope(rope);
 
 	return pSegment;
@@ -1376,9 +1122,7 @@ CRopeSegment* CRopeSegment::CreateSegment( CRopeSample* pSample, string_t iszMod
 
 void CRopeSegment::ApplyExternalForce( const Vector& vecForce )
 {
-	m_Sample->GetData().mApplyExternalForce = true;
-
-	m_Sample->GetData().mExternalForce = m_Sample->GetData().mExternalForce + vecForce;
+	mMasterRope->ApplyForceToSample( vecForce, m_iSample );
 }
 
 void CRopeSegment::SetCauseDamageOnTouch( const bool bCauseDamage )
@@ -1577,14 +1321,12 @@ void CElectrifiedWire::InitElectrifiedRope()
 		for( int uiIndex = 0; uiIndex < m_uiNumUninsulatedSegments; ++uiIndex )
 		{
 			GetSegments()[ uiIndex ]->SetCauseDamageOnTouch( m_bIsActive );
-			GetAltSegments()[ uiIndex ]->SetCauseDamageOnTouch( m_bIsActive );
 		}
 	}
 
 	if( m_iTipSparkFrequency > 0 )
 	{
 		GetSegments()[ GetNumSegments() - 1 ]->SetCauseDamageOnTouch( m_bIsActive );
-		GetAltSegments()[ GetNumSegments() - 1 ]->SetCauseDamageOnTouch( m_bIsActive );
 	}
 
 	m_flLastSparkTime = gpGlobals->time;
@@ -1641,14 +1383,12 @@ void CElectrifiedWire::Use( CBaseEntity* pActivator, CBaseEntity* pCaller, USE_T
 		for( int uiIndex = 0; uiIndex < m_uiNumUninsulatedSegments; ++uiIndex )
 		{
 			GetSegments()[ m_uiUninsulatedSegments[ uiIndex ] ]->SetCauseDamageOnTouch( m_bIsActive );
-			GetAltSegments()[ m_uiUninsulatedSegments[ uiIndex ] ]->SetCauseDamageOnTouch( m_bIsActive );
 		}
 	}
 
 	if( m_iTipSparkFrequency > 0 )
 	{
 		GetSegments()[ GetNumSegments() - 1 ]->SetCauseDamageOnTouch( m_bIsActive );
-		GetAltSegments()[ GetNumSegments() - 1 ]->SetCauseDamageOnTouch( m_bIsActive );
 	}
 }
 
@@ -1701,24 +1441,23 @@ void CElectrifiedWire::DoLightning()
 	if( uiIndex >= 10 )
 		return;
 
-	CRopeSegment* pSegment1;
-	CRopeSegment* pSegment2;
-
-	if( GetToggleValue() )
-	{
-		pSegment1 = GetAltSegments()[ uiSegment1 ];
-		pSegment2 = GetAltSegments()[ uiSegment2 ];
-	}
-	else
-	{
-		pSegment1 = GetSegments()[ uiSegment1 ];
-		pSegment2 = GetSegments()[ uiSegment2 ];
-	}
+	CRopeSegment* pSegment1 = GetSegments()[ uiSegment1 ];
+	CRopeSegment* pSegment2 = GetSegments()[ uiSegment2 ];
 
 	MESSAGE_BEGIN( MSG_BROADCAST, SVC_TEMPENTITY );
-		WRITE_BYTE( TE_BEAMENTS );
-		WRITE_SHORT( pSegment1->entindex() );
-		WRITE_SHORT( pSegment2->entindex() );
+		if( IsClientSide() )
+		{
+			// Segments of client-side ropes aren't sent to the clients
+			WRITE_BYTE( TE_BEAMPOINTS );
+			WRITE_VECTOR( pSegment1->pev->origin );
+			WRITE_VECTOR( pSegment2->pev->origin );
+		}
+		else
+		{
+			WRITE_BYTE( TE_BEAMENTS );
+			WRITE_SHORT( pSegment1->entindex() );
+			WRITE_SHORT( pSegment2->entindex() );
+		}
 		WRITE_SHORT( m_iLightningSprite );
 		WRITE_BYTE( 0 );
 		WRITE_BYTE( 0 );
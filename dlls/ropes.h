@@ -16,18 +16,17 @@
 #define ROPES_H
 
 class CRopeSegment;
-class CRopeSample;
-
-struct RopeSampleData;
 
 #include "cbase.h"
+#include "rope_solver.h"
 
 #define MAX_SEGMENTS 63
-#define MAX_SAMPLES  64
+#define MAX_SAMPLES  ROPE_MAX_SAMPLES
 
 /**
 *	A rope with a number of segments.
 *	Uses an RK4 integrator with dampened springs to simulate rope physics.
+*	The samples are only simulated, the segments are the entities players see and grab.
 */
 class CRope : public CBaseDelay
 {
@@ -44,6 +43,10 @@ public:
 
 	void InitRope();
 	void EXPORT RopeThink();
+	void EXPORT RestoreRopeThink();
+
+	void SendMessages( CBaseEntity* pClient );
+	void UpdateOnRemove();
 
 	virtual int		Save( CSave &save );
 	virtual int		Restore( CRestore &restore );
@@ -59,52 +62,11 @@ public:
 	*/
 	void RunSimOnSamples();
 
-	/**
-	*	Computes forces on the given sample list.
-	*	@param pSystem List of sample data. m_NumSamples Elements large.
-	*/
-	void ComputeForces( RopeSampleData* pSystem );
-
-	/**
-	*	Computes forces on the given sample list.
-	*	@param pSystem List of samples. m_NumSamples Elements large.
-	*/
-	void ComputeForces( CRopeSample** ppSystem );
-
-	/**
-	*	Computes forces for the given sample data.
-	*	@param data Sample data.
-	*/
-	void ComputeSampleForce( RopeSampleData& data );
-
-	/**
-	*	Computes spring force for the given sample datas.
-	*	@param first First sample.
-	*	@param second Second sample.
-	*	@param spring Spring.
-	*/
-	void ComputeSpringForce(RopeSampleData& first, RopeSampleData& second);
-
-	/**
-	*	Runs RK4 integration.
-	*	@param flDeltaTime Delta between previous and current time.
-	*	@param ppSampleSource Previous sample state.
-	*	@param ppSampleTarget Next sample state.
-	*/
-	void RK4Integrate(const float flDeltaTime);
-
 	/**
 	*	Traces model positions and angles and corrects them.
-	*	@param ppPrimarySegs Visible segments.
-	*	@param ppHiddenSegs hidden segments.
-	*/
-	void TraceModels( CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSegs );
-
-	/**
-	*	Traces model positions and angles, makes visible segments visible and hidden segments hidden.
+	*	The segments are still at the positions of the previous frame, they are moved to their samples.
 	*/
-	void SetRopeSegments( const int uiNumSegments,
-						  CRopeSegment** ppPrimarySegs, CRopeSegment** ppHiddenSegs );
+	void TraceModels();
 
 	/**
 	*	Moves the attached object up.
@@ -141,7 +103,7 @@ public:
 	/**
 	*	Attached an object to the given segment.
 	*/
-	void AttachObjectToSegment( CRopeSegment* pSegment );
+	void AttachObjectToSegment( CRopeSegment* pSegment, CBaseEntity* pObject );
 
 	/**
 	*	Detaches an attached object.
@@ -153,6 +115,13 @@ public:
 	*/
 	bool IsObjectAttached() const { return mObjectAttached; }
 
+	/**
+	*	@return Whether the rope is simulated and drawn by the clients.
+	*	The server only networks the anchor, the parameters and the attached player's segment,
+	*	its own copy of the rope runs at a low rate unless an object is attached.
+	*/
+	bool IsClientSide() const { return m_bClientSide; }
+
 	/**
 	*	@return Whether this rope allows attachments.
 	*/
@@ -168,16 +137,6 @@ public:
 	*/
 	CRopeSegment** GetSegments() { return seg; }
 
-	/**
-	*	@return The alternative segments.
-	*/
-	CRopeSegment** GetAltSegments() { return altseg; }
-
-	/**
-	*	@return The toggle value.
-	*/
-	bool GetToggleValue() const { return m_bToggle; }
-
 	/**
 	*	@return Whether this rope is allowed to make sounds.
 	*/
@@ -226,6 +185,11 @@ public:
 	*/
 	Vector GetRopeOrigin() const;
 
+	/**
+	*	Adds an external force to the given sample, applied on the next simulation step.
+	*/
+	void ApplyForceToSample( const Vector& vecForce, const int uiSample );
+
 	/**
 	*	@return Whether the given segment index is valid.
 	*/
@@ -258,6 +222,16 @@ public:
 	*/
 	Vector GetAttachedObjectsPosition() const;
 
+	/**
+	*	Describes the rope to the given client, or to all clients if NULL.
+	*/
+	void SendRope( CBaseEntity* pClient );
+
+	/**
+	*	Tells the clients who is attached to which segment.
+	*/
+	void SendAttachedObject( CBaseEntity* pClient );
+
 	static const NamedSoundScript grabSoundScript;
 	static const NamedSoundScript creakSoundScript;
 
@@ -265,18 +239,14 @@ private:
 	int m_iSegments;
 
 	CRopeSegment* seg[ MAX_SEGMENTS ];
-	CRopeSegment* altseg[ MAX_SEGMENTS ];
-
-	bool m_bToggle;
 
 	bool m_InitialDeltaTime;
 
 	float mLastTime;
 
 	Vector m_LastEndPos;
-	Vector m_Gravity;
 
-	CRopeSample* m_Samples[ MAX_SAMPLES ];
+	RopeSolver m_Sim;
 
 	int m_NumSamples;
 
@@ -294,6 +264,10 @@ private:
 
 	bool m_bMakeSound;
 
+	bool m_bClientSide;
+	EHANDLE m_hAttachedObject;
+	int m_iSentAttachedSegment;
+
 protected:
 	bool m_activated;
 };
@@ -106,6 +106,7 @@ private:
 	int		BufferCheckZString( const char *string );
 
 	void	BufferReadHeader( HEADER *pheader );
+	void	ReadFieldData( void *pBaseData, TYPEDESCRIPTION *pTest, void *pData );
 
 	int		m_global;		// Restoring a global entity?
 	bool	m_precache;
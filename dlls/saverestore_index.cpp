@@ -0,0 +1,186 @@
+#include "extdll.h"
+#include "util.h"
+#include "saverestore_index.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+
+SaveRestoreIndex g_SaveRestoreIndex;
+SaveRestoreStats g_SaveRestoreStats;
+
+unsigned int SaveRestoreIndex::HashFieldName(const char *pszName)
+{
+	// FNV-1a of the lower case name, field names are matched with stricmp
+	unsigned int hash = 2166136261u;
+	for (const unsigned char* p = (const unsigned char*)pszName; *p; ++p)
+	{
+		unsigned char c = *p;
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		hash = (hash ^ c) * 16777619u;
+	}
+	return hash;
+}
+
+void SaveRestoreIndex::FieldTable::Build(const TYPEDESCRIPTION *pFields, int fieldCount)
+{
+	_fields = pFields;
+	_fieldCount = fieldCount;
+
+	unsigned int slotCount = 8;
+	while (slotCount < (unsigned int)fieldCount * 2)
+		slotCount <<= 1;
+	_mask = slotCount - 1;
+	_slots.assign(slotCount, -1);
+
+	for (int i = 0; i < fieldCount; ++i)
+	{
+		if (!pFields[i].fieldName)
+			continue;
+		// Keep the first of the duplicate names, like the linear search does
+		if (Find(pFields[i].fieldName) >= 0)
+			continue;
+		unsigned int slot = HashFieldName(pFields[i].fieldName) & _mask;
+		while (_slots[slot] >= 0)
+			slot = (slot + 1) & _mask;
+		_slots[slot] = i;
+	}
+}
+
+bool SaveRestoreIndex::FieldTable::Matches(const TYPEDESCRIPTION *pFields, int fieldCount) const
+{
+	return _fields == pFields && _fieldCount == fieldCount;
+}
+
+int SaveRestoreIndex::FieldTable::Find(const char *pszName) const
+{
+	if (_slots.empty())
+		return -1;
+	unsigned int slot = HashFieldName(pszName) & _mask;
+	while (_slots[slot] >= 0)
+	{
+		const int i = _slots[slot];
+		if (!stricmp(_fields[i].fieldName, pszName))
+			return i;
+		slot = (slot + 1) & _mask;
+	}
+	return -1;
+}
+
+const SaveRestoreIndex::FieldTable& SaveRestoreIndex::GetFieldTable(const TYPEDESCRIPTION *pFields, int fieldCount)
+{
+	FieldTable& table = _fieldTables[pFields];
+	if (!table.Matches(pFields, fieldCount))
+		table.Build(pFields, fieldCount);
+	return table;
+}
+
+unsigned int SaveRestoreIndex::TokenSlot(const char *pszToken)
+{
+	const std::uintptr_t value = (std::uintptr_t)pszToken;
+	return (unsigned int)((value >> 3) ^ (value >> 15)) & (TOKEN_CACHE_SIZE - 1);
+}
+
+int SaveRestoreIndex::LookupToken(const SAVERESTOREDATA *pSaveData, const char *pszToken) const
+{
+	const TokenEntry& entry = _tokens[TokenSlot(pszToken)];
+	if (entry.name != pszToken || entry.token < 0 || entry.token >= pSaveData->tokenCount)
+		return -1;
+
+	// The token table belongs to the engine and may have been reset since
+	const char* pszStored = pSaveData->pTokens[entry.token];
+	if (!pszStored || (pszStored != pszToken && strcmp(pszStored, pszToken) != 0))
+		return -1;
+	return entry.token;
+}
+
+void SaveRestoreIndex::StoreToken(const char *pszToken, int token)
+{
+	TokenEntry& entry = _tokens[TokenSlot(pszToken)];
+	entry.name = pszToken;
+	entry.token = token;
+}
+
+double SaveRestoreStats::Clock()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SaveRestoreStats::Counters& SaveRestoreStats::GetCounters(const char *pname)
+{
+	Counters& counters = _counters[pname];
+	if (counters.name.empty())
+		counters.name = pname ? pname : "";
+	return counters;
+}
+
+void SaveRestoreStats::CountSave(const char *pname, int fieldCount, double seconds)
+{
+	Counters& counters = GetCounters(pname);
+	counters.saves++;
+	counters.savedFields += fieldCount;
+	counters.saveTime += seconds;
+}
+
+void SaveRestoreStats::CountRestore(const char *pname, int fieldCount, double seconds)
+{
+	Counters& counters = GetCounters(pname);
+	counters.restores++;
+	counters.restoredFields += fieldCount;
+	counters.restoreTime += seconds;
+}
+
+void SaveRestoreStats::Report()
+{
+	// The same name may come from different string literals
+	std::map<std::string, Counters> merged;
+	for (std::unordered_map<const char*, Counters>::const_iterator it = _counters.begin(); it != _counters.end(); ++it)
+	{
+		const Counters& counters = it->second;
+		Counters& total = merged[counters.name];
+		total.name = counters.name;
+		total.saves += counters.saves;
+		total.savedFields += counters.savedFields;
+		total.saveTime += counters.saveTime;
+		total.restores += counters.restores;
+		total.restoredFields += counters.restoredFields;
+		total.restoreTime += counters.restoreTime;
+	}
+
+	std::vector<Counters> sorted;
+	for (std::map<std::string, Counters>::const_iterator it = merged.begin(); it != merged.end(); ++it)
+		sorted.push_back(it->second);
+	std::sort(sorted.begin(), sorted.end(), [](const Counters& a, const Counters& b) {
+		return a.saveTime + a.restoreTime > b.saveTime + b.restoreTime;
+	});
+
+	double saveTime = 0.0;
+	double restoreTime = 0.0;
+	ALERT(at_console, "%-32s %8s %8s %10s %8s %8s %10s\n", "Name", "Saves", "Fields", "Save ms", "Restores", "Fields", "Restore ms");
+	for (size_t i = 0; i < sorted.size(); ++i)
+	{
+		const Counters& counters = sorted[i];
+		ALERT(at_console, "%-32s %8u %8u %10.3f %8u %8u %10.3f\n", counters.name.c_str(),
+			  counters.saves, counters.savedFields, counters.saveTime * 1000.0,
+			  counters.restores, counters.restoredFields, counters.restoreTime * 1000.0);
+		saveTime += counters.saveTime;
+		restoreTime += counters.restoreTime;
+	}
+	ALERT(at_console, "Total: save %.3f ms, restore %.3f ms\n", saveTime * 1000.0, restoreTime * 1000.0);
+	if (sorted.empty())
+		ALERT(at_console, "Set sv_saverestore_stats 1 to collect the timings\n");
+}
+
+void SaveRestoreStats::ResetCounters()
+{
+	_counters.clear();
+}
+
+void ReportSaveRestoreStats()
+{
+	g_SaveRestoreStats.Report();
+	if (CMD_ARGC() > 1 && FStrEq(CMD_ARGV(1), "reset"))
+		g_SaveRestoreStats.ResetCounters();
+}
@@ -0,0 +1,94 @@
+#pragma once
+#ifndef SAVERESTORE_INDEX_H
+#define SAVERESTORE_INDEX_H
+
+#include "extdll.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Lookup tables that speed up CSave and CRestore.
+// Field tables get a case insensitive hash of their field names, built the first time the table is restored.
+// Token table positions of the field names are remembered by the name pointer, so saving doesn't rehash
+// and probe the token table for every field of every entity.
+// Cached results are always checked against the actual data, a stale entry only costs a regular lookup.
+class SaveRestoreIndex
+{
+public:
+	enum {
+		TOKEN_CACHE_SIZE = 4096,
+	};
+
+	class FieldTable
+	{
+	public:
+		FieldTable(): _fields(NULL), _fieldCount(0), _mask(0) {}
+		void Build(const TYPEDESCRIPTION* pFields, int fieldCount);
+		bool Matches(const TYPEDESCRIPTION* pFields, int fieldCount) const;
+		// Index of the field named pszName or -1
+		int Find(const char* pszName) const;
+	private:
+		const TYPEDESCRIPTION* _fields;
+		int _fieldCount;
+		unsigned int _mask;
+		std::vector<int> _slots;
+	};
+
+	const FieldTable& GetFieldTable(const TYPEDESCRIPTION* pFields, int fieldCount);
+
+	int LookupToken(const SAVERESTOREDATA* pSaveData, const char* pszToken) const;
+	void StoreToken(const char* pszToken, int token);
+
+	static unsigned int HashFieldName(const char* pszName);
+
+private:
+	struct TokenEntry
+	{
+		TokenEntry(): name(NULL), token(-1) {}
+		const char* name;
+		int token;
+	};
+
+	static unsigned int TokenSlot(const char* pszToken);
+
+	std::unordered_map<const TYPEDESCRIPTION*, FieldTable> _fieldTables;
+	TokenEntry _tokens[TOKEN_CACHE_SIZE];
+};
+
+extern SaveRestoreIndex g_SaveRestoreIndex;
+
+// Time spent saving and restoring each field set (usually a class), enabled by sv_saverestore_stats
+class SaveRestoreStats
+{
+public:
+	static double Clock();
+	void CountSave(const char* pname, int fieldCount, double seconds);
+	void CountRestore(const char* pname, int fieldCount, double seconds);
+
+	void Report();
+	void ResetCounters();
+private:
+	struct Counters
+	{
+		Counters(): saves(0), savedFields(0), saveTime(0.0), restores(0), restoredFields(0), restoreTime(0.0) {}
+		std::string name;
+		unsigned int saves;
+		unsigned int savedFields;
+		double saveTime;
+		unsigned int restores;
+		unsigned int restoredFields;
+		double restoreTime;
+	};
+
+	Counters& GetCounters(const char* pname);
+
+	// By the name pointer, the names are normally string literals
+	std::unordered_map<const char*, Counters> _counters;
+};
+
+extern SaveRestoreStats g_SaveRestoreStats;
+
+void ReportSaveRestoreStats();
+
+#endif
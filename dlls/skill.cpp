@@ -18,9 +18,80 @@
 #include	"extdll.h"
 #include	"util.h"
 #include	"skill.h"
+#include	"name_symbols.h"
 
 skilldata_t gSkillData;
 
+SkillCvarRegistry g_SkillCvars;
+
+void SkillCvarRegistry::Register( const char *name, cvar_t *easy, cvar_t *medium, cvar_t *hard )
+{
+	const int symbol = g_NameSymbols.Intern( name );
+	if( symbol == NameSymbolTable::INVALID_SYMBOL )
+		return;
+	if( symbol >= (int)_bySymbol.size() )
+		_bySymbol.resize( symbol + 1, -1 );
+
+	SkillCvars entry;
+	entry.levels[0] = easy;
+	entry.levels[1] = medium;
+	entry.levels[2] = hard;
+	entry.watched = NULL;
+	entry.watchedValue = 0.0f;
+
+	_bySymbol[symbol] = (int)_cvars.size();
+	_cvars.push_back( entry );
+}
+
+SkillCvarRegistry::SkillCvars* SkillCvarRegistry::FindEntry( const char *name )
+{
+	const int symbol = g_NameSymbols.Find( name );
+	if( symbol == NameSymbolTable::INVALID_SYMBOL || symbol >= (int)_bySymbol.size() || _bySymbol[symbol] < 0 )
+		return NULL;
+	return &_cvars[_bySymbol[symbol]];
+}
+
+bool SkillCvarRegistry::Read( const char *name, float &value )
+{
+	SkillCvars* entry = FindEntry( name );
+	if( !entry || gSkillData.iSkillLevel < SKILL_EASY || gSkillData.iSkillLevel > SKILL_HARD )
+		return false;
+
+	cvar_t* cvar = entry->levels[gSkillData.iSkillLevel - 1];
+	if( !entry->watched )
+		_watched.push_back( (int)( entry - &_cvars[0] ) );
+	entry->watched = cvar;
+	entry->watchedValue = cvar->value;
+
+	value = cvar->value;
+	return true;
+}
+
+void SkillCvarRegistry::BeginRefresh()
+{
+	for( size_t i = 0; i < _watched.size(); i++ )
+		_cvars[_watched[i]].watched = NULL;
+	_watched.clear();
+	_nextCheck = 0;
+}
+
+bool SkillCvarRegistry::CheckForChanges()
+{
+	if( _watched.empty() )
+		return false;
+
+	const size_t count = Q_min( (size_t)CHECKS_PER_FRAME, _watched.size() );
+	for( size_t i = 0; i < count; i++ )
+	{
+		if( _nextCheck >= _watched.size() )
+			_nextCheck = 0;
+		const SkillCvars& entry = _cvars[_watched[_nextCheck++]];
+		if( entry.watched->value != entry.watchedValue )
+			return true;
+	}
+	return false;
+}
+
 //=========================================================
 // take the name of a cvar, tack a digit for the skill level
 // on, and return the value.of that Cvar 
@@ -30,9 +101,11 @@ static float GetSkillCvar(const char *pName , const char *fallback, bool allowZe
 	float flValue;
 	char szBuffer[64];
 
-	sprintf( szBuffer, "%s%d",pName, gSkillData.iSkillLevel );
-
-	flValue = CVAR_GET_FLOAT( szBuffer );
+	if( !g_SkillCvars.Read( pName, flValue ) )
+	{
+		sprintf( szBuffer, "%s%d",pName, gSkillData.iSkillLevel );
+		flValue = CVAR_GET_FLOAT( szBuffer );
+	}
 
 	if( flValue <= 0 && !allowZero)
 	{
@@ -41,7 +114,7 @@ static float GetSkillCvar(const char *pName , const char *fallback, bool allowZe
 		else if (fallbackValue)
 			flValue = fallbackValue;
 		if (flValue <= 0)
-			ALERT( at_console, "\n\n** GetSkillCVar Got a zero for %s **\n\n", szBuffer );
+			ALERT( at_console, "\n\n** GetSkillCVar Got a zero for %s%d **\n\n", pName, gSkillData.iSkillLevel );
 	}
 
 	return flValue;
@@ -22,6 +22,8 @@
 #include "mod_features.h"
 #include "util.h"
 
+#include <vector>
+
 struct skilldata_t
 {
 	int iSkillLevel; // game skill level
@@ -335,6 +337,41 @@ float GetSkillCvar( const char *pName, const char* fallback = 0 );
 float GetSkillCvar( const char *pName, float fallback );
 float GetSkillCvarZeroable( const char* pName );
 
+// Skill cvars declared by the game, looked up by name without going through the engine.
+// The values read by the last RefreshSkillData are watched a few per frame, so edits to them take effect without a map change.
+class SkillCvarRegistry
+{
+public:
+	enum {
+		CHECKS_PER_FRAME = 32
+	};
+
+	void Register( const char* name, cvar_t* easy, cvar_t* medium, cvar_t* hard );
+	// Reads the cvar of the name for the current skill level and starts watching it. False if it's not registered.
+	bool Read( const char* name, float& value );
+
+	void BeginRefresh();
+	// Whether any of the watched cvars changed since the last refresh
+	bool CheckForChanges();
+
+private:
+	struct SkillCvars
+	{
+		cvar_t* levels[3];
+		cvar_t* watched;
+		float watchedValue;
+	};
+
+	SkillCvars* FindEntry( const char* name );
+
+	std::vector<int> _bySymbol;
+	std::vector<SkillCvars> _cvars;
+	std::vector<int> _watched;
+	size_t _nextCheck = 0;
+};
+
+extern SkillCvarRegistry g_SkillCvars;
+
 extern DLL_GLOBAL int		g_iSkillLevel;
 
 #define SKILL_EASY		1
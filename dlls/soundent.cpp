@@ -19,10 +19,159 @@
 #include	"monsters.h"
 #include	"soundent.h"
 
+#include	<algorithm>
+#include	<vector>
+
 LINK_ENTITY_TO_CLASS( soundent, CSoundEnt )
 
 CSoundEnt *pSoundEnt;
 
+//=========================================================
+// Sound pool storage. Sounds are allocated in blocks so the
+// pointers returned by SoundPointerForIndex stay valid when
+// the pool grows. Blocks are kept between levels.
+//=========================================================
+static std::vector<CSound*> g_SoundBlocks;
+
+static inline CSound &SoundAt( int iSound )
+{
+	return g_SoundBlocks[iSound / MAX_WORLD_SOUNDS][iSound % MAX_WORLD_SOUNDS];
+}
+
+//=========================================================
+// CSoundBuckets - active (non-reserved) sounds bucketed by
+// type bit and by spatial cell, so listeners only visit
+// sounds they care about that are close enough.
+//=========================================================
+#define SOUND_CELL_SIZE		512
+#define SOUND_CELL_BUCKETS	256
+#define SOUND_MAX_QUERY_CELLS	64
+#define SOUND_TYPE_BUCKETS	8 // one per each sound type bit, the last one is for all other bits
+
+class CSoundBuckets
+{
+public:
+	void Clear( void )
+	{
+		for( int t = 0; t < SOUND_TYPE_BUCKETS; t++ )
+		{
+			m_byType[t].clear();
+			for( int i = 0; i < SOUND_CELL_BUCKETS; i++ )
+				m_cells[t][i].clear();
+		}
+		m_iMaxVolume = 0;
+		m_fMaxVolumeDirty = false;
+	}
+
+	void Add( int iSound, const CSound &sound )
+	{
+		const int bucket = CellBucket( CellCoord( sound.m_vecOrigin.x ), CellCoord( sound.m_vecOrigin.y ) );
+		for( int t = 0; t < SOUND_TYPE_BUCKETS; t++ )
+		{
+			if( sound.m_iType & TypeBits( t ) )
+			{
+				m_byType[t].push_back( iSound );
+				m_cells[t][bucket].push_back( iSound );
+			}
+		}
+		if( sound.m_iVolume > m_iMaxVolume )
+			m_iMaxVolume = sound.m_iVolume;
+	}
+
+	void Remove( int iSound, const CSound &sound )
+	{
+		const int bucket = CellBucket( CellCoord( sound.m_vecOrigin.x ), CellCoord( sound.m_vecOrigin.y ) );
+		for( int t = 0; t < SOUND_TYPE_BUCKETS; t++ )
+		{
+			if( sound.m_iType & TypeBits( t ) )
+			{
+				Erase( m_byType[t], iSound );
+				Erase( m_cells[t][bucket], iSound );
+			}
+		}
+		if( sound.m_iVolume >= m_iMaxVolume )
+			m_fMaxVolumeDirty = true;
+	}
+
+	int MaxVolume( void )
+	{
+		if( m_fMaxVolumeDirty )
+		{
+			m_iMaxVolume = 0;
+			for( int t = 0; t < SOUND_TYPE_BUCKETS; t++ )
+			{
+				for( size_t i = 0; i < m_byType[t].size(); i++ )
+					m_iMaxVolume = Q_max( m_iMaxVolume, SoundAt( m_byType[t][i] ).m_iVolume );
+			}
+			m_fMaxVolumeDirty = false;
+		}
+		return m_iMaxVolume;
+	}
+
+	void Gather( int iTypeMask, const Vector &vecOrigin, float flRadius, std::vector<int> &candidates )
+	{
+		const int minX = CellCoord( vecOrigin.x - flRadius );
+		const int minY = CellCoord( vecOrigin.y - flRadius );
+		const int maxX = CellCoord( vecOrigin.x + flRadius );
+		const int maxY = CellCoord( vecOrigin.y + flRadius );
+		const bool fWide = ( maxX - minX + 1 ) * ( maxY - minY + 1 ) > SOUND_MAX_QUERY_CELLS;
+
+		for( int t = 0; t < SOUND_TYPE_BUCKETS; t++ )
+		{
+			if( !( iTypeMask & TypeBits( t ) ) || m_byType[t].empty() )
+				continue;
+
+			if( fWide )
+			{
+				candidates.insert( candidates.end(), m_byType[t].begin(), m_byType[t].end() );
+				continue;
+			}
+
+			for( int x = minX; x <= maxX; x++ )
+			{
+				for( int y = minY; y <= maxY; y++ )
+				{
+					const std::vector<int> &cell = m_cells[t][CellBucket( x, y )];
+					candidates.insert( candidates.end(), cell.begin(), cell.end() );
+				}
+			}
+		}
+	}
+
+private:
+	static int TypeBits( int t )
+	{
+		return t < SOUND_TYPE_BUCKETS - 1 ? ( 1 << t ) : ~( ( 1 << ( SOUND_TYPE_BUCKETS - 1 ) ) - 1 );
+	}
+
+	static int CellCoord( float coord )
+	{
+		return (int)floor( coord / SOUND_CELL_SIZE );
+	}
+
+	static int CellBucket( int x, int y )
+	{
+		return ( (unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u ) & ( SOUND_CELL_BUCKETS - 1 );
+	}
+
+	static void Erase( std::vector<int> &sounds, int iSound )
+	{
+		std::vector<int>::iterator it = std::find( sounds.begin(), sounds.end(), iSound );
+		if( it != sounds.end() )
+		{
+			*it = sounds.back();
+			sounds.pop_back();
+		}
+	}
+
+	std::vector<int> m_byType[SOUND_TYPE_BUCKETS];
+	std::vector<int> m_cells[SOUND_TYPE_BUCKETS][SOUND_CELL_BUCKETS];
+	int m_iMaxVolume;
+	bool m_fMaxVolumeDirty;
+};
+
+static CSoundBuckets g_SoundBuckets;
+
 //=========================================================
 // CSound - Clear - zeros all fields for a sound
 //=========================================================
@@ -34,6 +183,7 @@ void CSound::Clear( void )
 	m_flExpireTime = 0;
 	m_iNext = SOUNDLIST_EMPTY;
 	m_iNextAudible = 0;
+	m_iSerial = 0;
 }
 
 //=========================================================
@@ -102,9 +252,9 @@ void CSoundEnt::Think( void )
 
 	while( iSound != SOUNDLIST_EMPTY )
 	{
-		if( m_SoundPool[ iSound ].m_flExpireTime <= gpGlobals->time && m_SoundPool[ iSound ].m_flExpireTime != SOUND_NEVER_EXPIRE )
+		if( SoundAt( iSound ).m_flExpireTime <= gpGlobals->time && SoundAt( iSound ).m_flExpireTime != SOUND_NEVER_EXPIRE )
 		{
-			int iNext = m_SoundPool[ iSound ].m_iNext;
+			int iNext = SoundAt( iSound ).m_iNext;
 
 			// move this sound back into the free list
 			FreeSound( iSound, iPreviousSound );
@@ -114,13 +264,13 @@ void CSoundEnt::Think( void )
 		else
 		{
 			iPreviousSound = iSound;
-			iSound = m_SoundPool[ iSound ].m_iNext;
+			iSound = SoundAt( iSound ).m_iNext;
 		}
 	}
 
 	if( m_fShowReport )
 	{
-		ALERT( at_aiconsole, "Soundlist: %d / %d  (%d)\n", ISoundsInList( SOUNDLISTTYPE_ACTIVE ),ISoundsInList( SOUNDLISTTYPE_FREE ), ISoundsInList( SOUNDLISTTYPE_ACTIVE ) - m_cLastActiveSounds );
+		ALERT( at_aiconsole, "Soundlist: %d / %d  (%d), pool size: %d\n", ISoundsInList( SOUNDLISTTYPE_ACTIVE ),ISoundsInList( SOUNDLISTTYPE_FREE ), ISoundsInList( SOUNDLISTTYPE_ACTIVE ) - m_cLastActiveSounds, m_cPoolSize );
 		m_cLastActiveSounds = ISoundsInList( SOUNDLISTTYPE_ACTIVE );
 	}
 }
@@ -145,21 +295,23 @@ void CSoundEnt::FreeSound( int iSound, int iPrevious )
 		return;
 	}
 
+	if( iSound >= pSoundEnt->m_cReservedSounds )
+		g_SoundBuckets.Remove( iSound, SoundAt( iSound ) );
+
 	if( iPrevious != SOUNDLIST_EMPTY )
 	{
 		// iSound is not the head of the active list, so
 		// must fix the index for the Previous sound
-		//pSoundEnt->m_SoundPool[iPrevious].m_iNext = m_SoundPool[iSound].m_iNext;
-		pSoundEnt->m_SoundPool[iPrevious].m_iNext = pSoundEnt->m_SoundPool[iSound].m_iNext;
+		SoundAt( iPrevious ).m_iNext = SoundAt( iSound ).m_iNext;
 	}
 	else 
 	{
 		// the sound we're freeing IS the head of the active list.
-		pSoundEnt->m_iActiveSound = pSoundEnt->m_SoundPool[iSound].m_iNext;
+		pSoundEnt->m_iActiveSound = SoundAt( iSound ).m_iNext;
 	}
 
 	// make iSound the head of the Free list.
-	pSoundEnt->m_SoundPool[iSound].m_iNext = pSoundEnt->m_iFreeSound;
+	SoundAt( iSound ).m_iNext = pSoundEnt->m_iFreeSound;
 	pSoundEnt->m_iFreeSound = iSound;
 }
 
@@ -171,6 +323,9 @@ int CSoundEnt::IAllocSound( void )
 {
 	int iNewSound;
 
+	if( m_iFreeSound == SOUNDLIST_EMPTY )
+		GrowPool();
+
 	if( m_iFreeSound == SOUNDLIST_EMPTY )
 	{
 		// no free sound!
@@ -183,15 +338,45 @@ int CSoundEnt::IAllocSound( void )
 
 	iNewSound = m_iFreeSound;// copy the index of the next free sound
 
-	m_iFreeSound = m_SoundPool[m_iFreeSound].m_iNext;// move the index down into the free list. 
+	m_iFreeSound = SoundAt( m_iFreeSound ).m_iNext;// move the index down into the free list. 
 
-	m_SoundPool[iNewSound].m_iNext = m_iActiveSound;// point the new sound at the top of the active list.
+	SoundAt( iNewSound ).m_iNext = m_iActiveSound;// point the new sound at the top of the active list.
+	SoundAt( iNewSound ).m_iSerial = m_iNextSerial++;
 
 	m_iActiveSound = iNewSound;// now make the new sound the top of the active list. You're done.
 
 	return iNewSound;
 }
 
+//=========================================================
+// GrowPool - adds another block of sounds to the free list
+// if the pool hasn't reached MAX_WORLD_SOUNDS_LIMIT yet.
+//=========================================================
+void CSoundEnt::GrowPool( void )
+{
+	if( m_cPoolSize + MAX_WORLD_SOUNDS > MAX_WORLD_SOUNDS_LIMIT )
+		return;
+
+	const int iBlock = m_cPoolSize / MAX_WORLD_SOUNDS;
+	if( iBlock >= (int)g_SoundBlocks.size() )
+		g_SoundBlocks.push_back( new CSound[MAX_WORLD_SOUNDS] );
+
+	const int iFirst = m_cPoolSize;
+	m_cPoolSize += MAX_WORLD_SOUNDS;
+
+	for( int i = iFirst; i < m_cPoolSize; i++ )
+	{
+		SoundAt( i ).Clear();
+		SoundAt( i ).m_iNext = i + 1;
+	}
+
+	SoundAt( m_cPoolSize - 1 ).m_iNext = m_iFreeSound;
+	m_iFreeSound = iFirst;
+
+	if( iFirst > 0 )
+		ALERT( at_aiconsole, "Sound pool grown to %d sounds\n", m_cPoolSize );
+}
+
 //=========================================================
 // InsertSound - Allocates a free sound and fills it with 
 // sound info.
@@ -214,10 +399,13 @@ void CSoundEnt::InsertSound( int iType, const Vector &vecOrigin, int iVolume, fl
 		return;
 	}
 
-	pSoundEnt->m_SoundPool[iThisSound].m_vecOrigin = vecOrigin;
-	pSoundEnt->m_SoundPool[iThisSound].m_iType = iType;
-	pSoundEnt->m_SoundPool[iThisSound].m_iVolume = iVolume;
-	pSoundEnt->m_SoundPool[iThisSound].m_flExpireTime = gpGlobals->time + flDuration;
+	CSound &sound = SoundAt( iThisSound );
+	sound.m_vecOrigin = vecOrigin;
+	sound.m_iType = iType;
+	sound.m_iVolume = iVolume;
+	sound.m_flExpireTime = gpGlobals->time + flDuration;
+
+	g_SoundBuckets.Add( iThisSound, sound );
 }
 
 //=========================================================
@@ -230,17 +418,16 @@ void CSoundEnt::Initialize( void )
 	int iSound;
 
 	m_cLastActiveSounds = 0;
-	m_iFreeSound = 0;
+	m_iFreeSound = SOUNDLIST_EMPTY;
 	m_iActiveSound = SOUNDLIST_EMPTY;
+	m_cPoolSize = 0;
+	m_cReservedSounds = 0;
+	m_iNextSerial = 0;
 
-	for( i = 0; i < MAX_WORLD_SOUNDS; i++ )
-	{
-		// clear all sounds, and link them into the free sound list.
-		m_SoundPool[i].Clear();
-		m_SoundPool[i].m_iNext = i + 1;
-	}
+	g_SoundBuckets.Clear();
 
-	m_SoundPool[i - 1].m_iNext = SOUNDLIST_EMPTY;// terminate the list here.
+	// clear the first block of sounds, and link them into the free sound list.
+	GrowPool();
 
 	// now reserve enough sounds for each client
 	for( i = 0; i < gpGlobals->maxClients; i++ )
@@ -253,7 +440,8 @@ void CSoundEnt::Initialize( void )
 			return;
 		}
 
-		pSoundEnt->m_SoundPool[iSound].m_flExpireTime = SOUND_NEVER_EXPIRE;
+		SoundAt( iSound ).m_flExpireTime = SOUND_NEVER_EXPIRE;
+		m_cReservedSounds++;
 	}
 
 	if( CVAR_GET_FLOAT( "displaysoundlist" ) == 1 )
@@ -299,7 +487,7 @@ int CSoundEnt::ISoundsInList( int iListType )
 	{
 		i++;
 
-		iThisSound = m_SoundPool[iThisSound].m_iNext;
+		iThisSound = SoundAt( iThisSound ).m_iNext;
 	}
 
 	return i;
@@ -342,7 +530,7 @@ CSound *CSoundEnt::SoundPointerForIndex( int iIndex )
 		return NULL;
 	}
 
-	if( iIndex > ( MAX_WORLD_SOUNDS - 1 ) )
+	if( iIndex > ( pSoundEnt->m_cPoolSize - 1 ) )
 	{
 		ALERT( at_console, "SoundPointerForIndex() - Index too large!\n" );
 		return NULL;
@@ -354,7 +542,49 @@ CSound *CSoundEnt::SoundPointerForIndex( int iIndex )
 		return NULL;
 	}
 
-	return &pSoundEnt->m_SoundPool[iIndex];
+	return &SoundAt( iIndex );
+}
+
+//=========================================================
+// SoundsInRange - collects sounds a listener may hear.
+// Client reserved sounds change every frame, so they are
+// always tested. Other sounds come from the buckets for the
+// requested types within the largest audible radius.
+//=========================================================
+int CSoundEnt::SoundsInRange( int iTypeMask, const Vector &vecOrigin, float flVolumeScale, int *pList, int listMax )
+{
+	static std::vector<int> candidates;
+
+	if( !pSoundEnt )
+	{
+		return 0;
+	}
+
+	candidates.clear();
+
+	for( int i = 0; i < pSoundEnt->m_cReservedSounds; i++ )
+	{
+		if( SoundAt( i ).m_iType & iTypeMask )
+			candidates.push_back( i );
+	}
+
+	const float flRadius = g_SoundBuckets.MaxVolume() * flVolumeScale;
+	if( flRadius >= 0 )
+		g_SoundBuckets.Gather( iTypeMask, vecOrigin, flRadius, candidates );
+
+	// keep the order of the active list: newer sounds first.
+	// Sounds with several type bits may come more than once.
+	std::sort( candidates.begin(), candidates.end(), []( int a, int b ) {
+		return SoundAt( a ).m_iSerial > SoundAt( b ).m_iSerial;
+	});
+	candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+
+	int count = 0;
+	for( size_t i = 0; i < candidates.size() && count < listMax; i++ )
+	{
+		pList[count++] = candidates[i];
+	}
+	return count;
 }
 
 //=========================================================
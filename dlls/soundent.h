@@ -23,7 +23,8 @@
 
 #include "soundent_bits.h"
 
-#define	MAX_WORLD_SOUNDS	64 // maximum number of sounds handled by the world at one time.
+#define	MAX_WORLD_SOUNDS	64 // number of sounds the pool starts with. The pool grows by this amount when it's full.
+#define	MAX_WORLD_SOUNDS_LIMIT	1024 // maximum number of sounds handled by the world at one time.
 
 #define SOUNDLIST_EMPTY	-1
 
@@ -47,6 +48,7 @@ public:
 	float	m_flExpireTime;	// when the sound should be purged from the list
 	int		m_iNext;		// index of next sound in this list ( Active or Free )
 	int		m_iNextAudible;	// temporary link that monsters use to build a list of audible sounds
+	int		m_iSerial;		// allocation order, newer sounds come first in the active list
 
 	bool FIsSound( void );
 	bool FIsScent( void );
@@ -71,6 +73,9 @@ public:
 	static int		FreeList( void );// return the head of the free list
 	static CSound*	SoundPointerForIndex( int iIndex );// return a pointer for this index in the sound list
 	static int		ClientSoundIndex ( edict_t *pClient );
+	// fill the list with active sounds that match the type mask and can be heard at vecOrigin with the given volume scale.
+	// The order is the same as in the active list. Distance to each returned sound still must be checked by the caller.
+	static int		SoundsInRange ( int iTypeMask, const Vector &vecOrigin, float flVolumeScale, int *pList, int listMax );
 
 	bool	IsEmpty( void ) { return m_iActiveSound == SOUNDLIST_EMPTY; }
 	int		ISoundsInList ( int iListType );
@@ -83,6 +88,11 @@ public:
 	bool	m_fShowReport; // if true, dump information about free/active sounds.
 
 private:
-	CSound		m_SoundPool[ MAX_WORLD_SOUNDS ];
+	void	GrowPool( void );
+
+	// sounds themselves are stored outside of the entity, in blocks of MAX_WORLD_SOUNDS
+	int		m_cPoolSize;
+	int		m_cReservedSounds; // sounds reserved for clients are at the start of the pool
+	int		m_iNextSerial;
 };
 #endif // SOUNDENT_H
@@ -241,25 +241,43 @@ void SoundScriptSystem::AddSoundScriptFromJsonValue(const char *name, Value &val
 	}
 	soundScriptMeta.pitchSet = UpdatePropertyFromJson(soundScript.pitch, value, "pitch");
 
-	_soundScripts[name] = std::make_pair(soundScript, soundScriptMeta);
+	SoundScriptEntry& entry = _soundScripts[name];
+	entry = std::make_pair(soundScript, soundScriptMeta);
+	IndexSoundScript(name, entry);
+}
+
+void SoundScriptSystem::IndexSoundScript(const std::string& name, SoundScriptEntry& entry)
+{
+	const int symbol = g_NameSymbols.Intern(name.c_str());
+	if (symbol == NameSymbolTable::INVALID_SYMBOL)
+		return;
+	if (symbol >= (int)_soundScriptsBySymbol.size())
+		_soundScriptsBySymbol.resize(symbol + 1, nullptr);
+	_soundScriptsBySymbol[symbol] = &entry;
+}
+
+SoundScriptSystem::SoundScriptEntry* SoundScriptSystem::FindSoundScriptEntry(const char *name)
+{
+	const int symbol = g_NameSymbols.Find(name);
+	if (symbol >= 0 && symbol < (int)_soundScriptsBySymbol.size())
+		return _soundScriptsBySymbol[symbol];
+	return nullptr;
 }
 
 void SoundScriptSystem::EnsureSoundScriptExists(const std::string& name)
 {
-	auto it = _soundScripts.find(name);
-	if (it == _soundScripts.end())
-		_soundScripts[name] = std::make_pair(SoundScript(), SoundScriptMeta());
+	if (!FindSoundScriptEntry(name.c_str()))
+	{
+		SoundScriptEntry& entry = _soundScripts[name];
+		entry = std::make_pair(SoundScript(), SoundScriptMeta());
+		IndexSoundScript(name, entry);
+	}
 }
 
 const SoundScript* SoundScriptSystem::GetSoundScript(const char *name)
 {
-	if (!name || *name == '\0')
-		return nullptr;
-	_temp = name; // reuse the same std::string for search to avoid reallocation
-	auto it = _soundScripts.find(_temp);
-	if (it != _soundScripts.end())
-		return &it->second.first;
-	return nullptr;
+	SoundScriptEntry* entry = FindSoundScriptEntry(name);
+	return entry ? &entry->first : nullptr;
 }
 
 static void MarkSoundScriptAllDefined(SoundScriptMeta& meta)
@@ -299,12 +317,11 @@ void SoundScriptSystem::EnsureExistingScriptDefined(SoundScript& existing, Sound
 
 const SoundScript* SoundScriptSystem::ProvideDefaultSoundScript(const char *name, const SoundScript &soundScript)
 {
-	_temp = name;
-	auto it = _soundScripts.find(_temp);
-	if (it != _soundScripts.end())
+	SoundScriptEntry* entry = FindSoundScriptEntry(name);
+	if (entry)
 	{
-		SoundScript& existing = it->second.first;
-		SoundScriptMeta& meta = it->second.second;
+		SoundScript& existing = entry->first;
+		SoundScriptMeta& meta = entry->second;
 		EnsureExistingScriptDefined(existing, meta, soundScript);
 		return &existing;
 	}
@@ -312,9 +329,10 @@ const SoundScript* SoundScriptSystem::ProvideDefaultSoundScript(const char *name
 	{
 		SoundScriptMeta meta;
 		MarkSoundScriptAllDefined(meta);
-		auto inserted = _soundScripts.insert(std::make_pair(_temp, std::make_pair(soundScript, meta)));
+		auto inserted = _soundScripts.insert(std::make_pair(std::string(name), std::make_pair(soundScript, meta)));
 		if (inserted.second)
 		{
+			IndexSoundScript(inserted.first->first, inserted.first->second);
 			return &inserted.first->second.first;
 		}
 		return nullptr;
@@ -323,12 +341,11 @@ const SoundScript* SoundScriptSystem::ProvideDefaultSoundScript(const char *name
 
 const SoundScript* SoundScriptSystem::ProvideDefaultSoundScript(const char *derivative, const char *base, const SoundScript &soundScript, const SoundScriptParamOverride paramOverride)
 {
-	_temp = derivative;
-	auto it = _soundScripts.find(_temp);
-	if (it != _soundScripts.end())
+	SoundScriptEntry* entry = FindSoundScriptEntry(derivative);
+	if (entry)
 	{
-		SoundScript& existing = it->second.first;
-		SoundScriptMeta& meta = it->second.second;
+		SoundScript& existing = entry->first;
+		SoundScriptMeta& meta = entry->second;
 
 		if (!meta.defaultSet)
 		{
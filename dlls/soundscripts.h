@@ -14,8 +14,10 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 #include "fixed_vector.h"
 #include "icase_compare.h"
+#include "name_symbols.h"
 
 constexpr size_t MAX_RANDOM_SOUNDS = 10;
 
@@ -48,6 +50,14 @@ struct NamedSoundScript : public SoundScript
 	operator const char* () const {
 		return name;
 	}
+	// Resolved on the first use, the name never changes
+	int Symbol() const {
+		if (symbol == NameSymbolTable::INVALID_SYMBOL)
+			symbol = g_NameSymbols.Intern(name);
+		return symbol;
+	}
+private:
+	mutable int symbol = NameSymbolTable::INVALID_SYMBOL;
 };
 
 struct SoundScriptParamOverride
@@ -100,6 +110,9 @@ public:
 	void AddSoundScriptFromJsonValue(const char* name, rapidjson::Value& value);
 	void EnsureSoundScriptExists(const std::string& name);
 	const SoundScript* GetSoundScript(const char* name);
+	const SoundScript* GetSoundScript(int symbol) const {
+		return symbol >= 0 && symbol < (int)_soundScriptsBySymbol.size() && _soundScriptsBySymbol[symbol] ? &_soundScriptsBySymbol[symbol]->first : nullptr;
+	}
 	const SoundScript* ProvideDefaultSoundScript(const char* name, const SoundScript& soundScript);
 	const SoundScript* ProvideDefaultSoundScript(const char* derivative, const char* base, const SoundScript& soundScript, const SoundScriptParamOverride paramOverride = SoundScriptParamOverride());
 	void DumpSoundScripts() const;
@@ -110,12 +123,15 @@ protected:
 private:
 	void DumpSoundScriptImpl(const char* name, const SoundScript& soundScript, const SoundScriptMeta& meta) const;
 	void EnsureExistingScriptDefined(SoundScript& existing, SoundScriptMeta& meta, const SoundScript& soundScript);
+	typedef std::pair<SoundScript, SoundScriptMeta> SoundScriptEntry;
+	void IndexSoundScript(const std::string& name, SoundScriptEntry& entry);
+	SoundScriptEntry* FindSoundScriptEntry(const char* name);
 
 	static constexpr const char* notDefinedYet = "waiting for default";
 
-	std::map<std::string, std::pair<SoundScript, SoundScriptMeta>, CaseInsensitiveCompare> _soundScripts;
+	std::map<std::string, SoundScriptEntry, CaseInsensitiveCompare> _soundScripts;
+	std::vector<SoundScriptEntry*> _soundScriptsBySymbol; // map nodes never move
 	std::set<std::string> _waveStringSet;
-	std::string _temp;
 };
 
 extern SoundScriptSystem g_SoundScriptSystem;
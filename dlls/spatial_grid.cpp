@@ -0,0 +1,340 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid g_SpatialGrid;
+
+int SpatialGrid::CellCoord(float coord)
+{
+	return (int)floorf(coord / CELL_SIZE);
+}
+
+unsigned int SpatialGrid::BucketIndex(int x, int y)
+{
+	return ((unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u) & (BUCKET_COUNT - 1);
+}
+
+SpatialGrid::CellRange SpatialGrid::RangeFromBounds(const Vector &mins, const Vector &maxs)
+{
+	CellRange range;
+	range.minX = CellCoord(mins.x);
+	range.minY = CellCoord(mins.y);
+	range.maxX = CellCoord(maxs.x);
+	range.maxY = CellCoord(maxs.y);
+	return range;
+}
+
+SpatialGrid::CellRange SpatialGrid::RangeFromEdict(const edict_t *pent)
+{
+	// Origin is used by the sphere test, so make sure it's covered too
+	const entvars_t& vars = pent->v;
+	const Vector mins(Q_min(vars.absmin.x, vars.origin.x), Q_min(vars.absmin.y, vars.origin.y), 0.0f);
+	const Vector maxs(Q_max(vars.absmax.x, vars.origin.x), Q_max(vars.absmax.y, vars.origin.y), 0.0f);
+	return RangeFromBounds(mins, maxs);
+}
+
+SpatialGrid::EdictRecord* SpatialGrid::GetRecord(edict_t *pent)
+{
+	const int index = ENTINDEX(pent);
+	if (index <= 0)
+		return nullptr;
+	if ((size_t)index >= _records.size())
+		_records.resize(std::max(index + 1, gpGlobals->maxEntities));
+	return &_records[index];
+}
+
+void SpatialGrid::EraseFrom(std::vector<edict_t *> &edicts, edict_t *pent)
+{
+	std::vector<edict_t*>::iterator it = std::find(edicts.begin(), edicts.end(), pent);
+	if (it != edicts.end())
+	{
+		*it = edicts.back();
+		edicts.pop_back();
+	}
+}
+
+void SpatialGrid::Unlink(edict_t *pent, EdictRecord &record)
+{
+	if (!record.tracked)
+		return;
+
+	if (record.oversized)
+	{
+		EraseFrom(_oversized, pent);
+	}
+	else
+	{
+		for (int x = record.range.minX; x <= record.range.maxX; ++x)
+		{
+			for (int y = record.range.minY; y <= record.range.maxY; ++y)
+			{
+				EraseFrom(_buckets[BucketIndex(x, y)], pent);
+			}
+		}
+	}
+	EraseFrom(_tracked, pent);
+	record.tracked = false;
+	record.oversized = false;
+}
+
+void SpatialGrid::Insert(edict_t *pent, EdictRecord &record, const CellRange &range)
+{
+	record.range = range;
+	record.tracked = true;
+	record.oversized = range.CellCount() > MAX_ENTITY_CELLS;
+
+	if (record.oversized)
+	{
+		_oversized.push_back(pent);
+	}
+	else
+	{
+		for (int x = range.minX; x <= range.maxX; ++x)
+		{
+			for (int y = range.minY; y <= range.maxY; ++y)
+			{
+				std::vector<edict_t*>& bucket = _buckets[BucketIndex(x, y)];
+				// Hash collisions may map several cells of the same entity to one bucket
+				if (std::find(bucket.begin(), bucket.end(), pent) == bucket.end())
+					bucket.push_back(pent);
+			}
+		}
+	}
+	_tracked.push_back(pent);
+}
+
+void SpatialGrid::Update(edict_t *pent)
+{
+	if (!pent)
+		return;
+
+	const bool shouldTrack = !pent->free && (pent->v.flags & TRACKED_FLAGS) != 0;
+	EdictRecord* record;
+	if (shouldTrack)
+	{
+		record = GetRecord(pent);
+	}
+	else
+	{
+		// Don't allocate records for entities we're not interested in
+		const int index = ENTINDEX(pent);
+		record = (index > 0 && (size_t)index < _records.size()) ? &_records[index] : nullptr;
+	}
+	if (!record)
+		return;
+
+	if (!shouldTrack)
+	{
+		Unlink(pent, *record);
+		return;
+	}
+
+	const CellRange range = RangeFromEdict(pent);
+
+	if (record->tracked && record->range == range)
+		return;
+
+	Unlink(pent, *record);
+	Insert(pent, *record, range);
+}
+
+void SpatialGrid::UpdateAll()
+{
+	edict_t* pWorld = INDEXENT(0);
+	if (!pWorld)
+		return;
+
+	for (int i = 1; i < gpGlobals->maxEntities; ++i)
+	{
+		Update(pWorld + i);
+	}
+}
+
+void SpatialGrid::Remove(edict_t *pent)
+{
+	if (!pent)
+		return;
+	const int index = ENTINDEX(pent);
+	if (index > 0 && (size_t)index < _records.size())
+		Unlink(pent, _records[index]);
+}
+
+void SpatialGrid::Clear()
+{
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+		_buckets[i].clear();
+	_oversized.clear();
+	_tracked.clear();
+	_records.clear();
+}
+
+void SpatialGrid::UpdateMoved()
+{
+	_moved.clear();
+	for (size_t i = 0; i < _tracked.size(); ++i)
+	{
+		edict_t* pent = _tracked[i];
+		if (pent->free || !(pent->v.flags & TRACKED_FLAGS) || !(RangeFromEdict(pent) == GetRecord(pent)->range))
+			_moved.push_back(pent);
+	}
+
+	// Update reorders _tracked, so it's done after the scan
+	for (size_t i = 0; i < _moved.size(); ++i)
+	{
+		Update(_moved[i]);
+	}
+}
+
+void SpatialGrid::GatherCandidates(const Vector &mins, const Vector &maxs)
+{
+	UpdateMoved();
+
+	_candidates.clear();
+
+	const CellRange range = RangeFromBounds(mins, maxs);
+	if (range.CellCount() > MAX_QUERY_CELLS || range.CellCount() <= 0)
+	{
+		_candidates = _tracked;
+	}
+	else
+	{
+		for (int x = range.minX; x <= range.maxX; ++x)
+		{
+			for (int y = range.minY; y <= range.maxY; ++y)
+			{
+				const std::vector<edict_t*>& bucket = _buckets[BucketIndex(x, y)];
+				_candidates.insert(_candidates.end(), bucket.begin(), bucket.end());
+			}
+		}
+		_candidates.insert(_candidates.end(), _oversized.begin(), _oversized.end());
+	}
+
+	// Keep the edict order of the linear scan
+	std::sort(_candidates.begin(), _candidates.end());
+	_candidates.erase(std::unique(_candidates.begin(), _candidates.end()), _candidates.end());
+}
+
+int SpatialGrid::EntitiesInBox(CBaseEntity **pList, int listMax, const Vector &mins, const Vector &maxs, int flagMask)
+{
+	_queries++;
+	GatherCandidates(mins, maxs);
+
+	int count = 0;
+	for (size_t i = 0; i < _candidates.size() && count < listMax; ++i)
+	{
+		edict_t* pEdict = _candidates[i];
+		_candidatesTested++;
+
+		if( pEdict->free )
+			continue;
+
+		if( !( pEdict->v.flags & flagMask ) )
+			continue;
+
+		if( mins.x > pEdict->v.absmax.x ||
+			mins.y > pEdict->v.absmax.y ||
+			mins.z > pEdict->v.absmax.z ||
+			maxs.x < pEdict->v.absmin.x ||
+			maxs.y < pEdict->v.absmin.y ||
+			maxs.z < pEdict->v.absmin.z )
+			continue;
+
+		CBaseEntity* pEntity = CBaseEntity::Instance( pEdict );
+		if( !pEntity )
+			continue;
+
+		pList[count] = pEntity;
+		count++;
+	}
+
+	_returned += count;
+	return count;
+}
+
+int SpatialGrid::MonstersInSphere(CBaseEntity **pList, int listMax, const Vector &center, float radius)
+{
+	_queries++;
+	const Vector extent(radius, radius, radius);
+	GatherCandidates(center - extent, center + extent);
+
+	const float radiusSquared = radius * radius;
+	int count = 0;
+	for (size_t i = 0; i < _candidates.size() && count < listMax; ++i)
+	{
+		edict_t* pEdict = _candidates[i];
+		_candidatesTested++;
+
+		if( pEdict->free )
+			continue;
+
+		if( !( pEdict->v.flags & ( FL_CLIENT | FL_MONSTER ) ) )
+			continue;
+
+		// Same as in the linear version: origin for X & Y, center of the box for Z
+		float delta = center.x - pEdict->v.origin.x;
+		float distance = delta * delta;
+		if( distance > radiusSquared )
+			continue;
+
+		delta = center.y - pEdict->v.origin.y;
+		distance += delta * delta;
+		if( distance > radiusSquared )
+			continue;
+
+		delta = center.z - ( pEdict->v.absmin.z + pEdict->v.absmax.z ) * 0.5f;
+		distance += delta * delta;
+		if( distance > radiusSquared )
+			continue;
+
+		CBaseEntity* pEntity = CBaseEntity::Instance( pEdict );
+		if( !pEntity )
+			continue;
+
+		pList[count] = pEntity;
+		count++;
+	}
+
+	_returned += count;
+	return count;
+}
+
+void SpatialGrid::CountLinearQuery(int tested, int returned)
+{
+	_linearQueries++;
+	_candidatesTested += tested;
+	_returned += returned;
+}
+
+void SpatialGrid::Report()
+{
+	size_t usedBuckets = 0;
+	size_t largestBucket = 0;
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+	{
+		if (!_buckets[i].empty())
+		{
+			usedBuckets++;
+			largestBucket = Q_max(largestBucket, _buckets[i].size());
+		}
+	}
+	ALERT(at_console, "Tracked entities: %u (%u oversized)\n", (unsigned)_tracked.size(), (unsigned)_oversized.size());
+	ALERT(at_console, "Used buckets: %u / %d. Largest bucket: %u\n", (unsigned)usedBuckets, BUCKET_COUNT, (unsigned)largestBucket);
+	ALERT(at_console, "Grid queries: %u. Linear queries: %u\n", _queries, _linearQueries);
+	ALERT(at_console, "Candidates tested: %u. Returned: %u\n", _candidatesTested, _returned);
+}
+
+void SpatialGrid::ResetCounters()
+{
+	_queries = _linearQueries = _candidatesTested = _returned = 0;
+}
+
+void ReportSpatialGrid()
+{
+	g_SpatialGrid.Report();
+	if (CMD_ARGC() > 1 && FStrEq(CMD_ARGV(1), "reset"))
+		g_SpatialGrid.ResetCounters();
+}
@@ -0,0 +1,90 @@
+#pragma once
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "extdll.h"
+
+#include <vector>
+
+class CBaseEntity;
+
+// Uniform 2D grid over the XY plane holding monsters and clients.
+// Used by UTIL_EntitiesInBox and UTIL_MonstersInSphere instead of walking all edicts.
+// Entries are refreshed incrementally each frame and when the origin is set via UTIL_SetOrigin.
+// Entities that moved some other way (engine physics, WALK_MOVE, origin writes) are rebucketed before each query.
+// Results are returned in the increasing edict index order, same as the linear scan.
+class SpatialGrid
+{
+public:
+	enum {
+		CELL_SIZE = 256,
+		BUCKET_COUNT = 4096,
+		// Entities spanning more cells than this are kept in a separate list
+		MAX_ENTITY_CELLS = 16,
+		// Queries spanning more cells than this just test all tracked entities
+		MAX_QUERY_CELLS = 64,
+		TRACKED_FLAGS = FL_CLIENT | FL_MONSTER,
+	};
+
+	void Update(edict_t* pent);
+	void UpdateAll();
+	void Remove(edict_t* pent);
+	void Clear();
+
+	int EntitiesInBox(CBaseEntity **pList, int listMax, const Vector &mins, const Vector &maxs, int flagMask);
+	int MonstersInSphere(CBaseEntity **pList, int listMax, const Vector &center, float radius);
+
+	void CountLinearQuery(int tested, int returned);
+	void Report();
+	void ResetCounters();
+private:
+	struct CellRange
+	{
+		int minX, minY, maxX, maxY;
+		bool operator==(const CellRange& other) const {
+			return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+		}
+		int CellCount() const {
+			return (maxX - minX + 1) * (maxY - minY + 1);
+		}
+	};
+
+	struct EdictRecord
+	{
+		EdictRecord(): tracked(false), oversized(false) {}
+		CellRange range;
+		bool tracked;
+		bool oversized;
+	};
+
+	static int CellCoord(float coord);
+	static unsigned int BucketIndex(int x, int y);
+	static CellRange RangeFromBounds(const Vector& mins, const Vector& maxs);
+	static CellRange RangeFromEdict(const edict_t* pent);
+
+	EdictRecord* GetRecord(edict_t* pent);
+	void Insert(edict_t* pent, EdictRecord& record, const CellRange& range);
+	void Unlink(edict_t* pent, EdictRecord& record);
+	static void EraseFrom(std::vector<edict_t*>& edicts, edict_t* pent);
+
+	void UpdateMoved();
+	void GatherCandidates(const Vector& mins, const Vector& maxs);
+
+	std::vector<edict_t*> _buckets[BUCKET_COUNT];
+	std::vector<edict_t*> _oversized;
+	std::vector<edict_t*> _tracked;
+	std::vector<edict_t*> _candidates;
+	std::vector<edict_t*> _moved;
+	std::vector<EdictRecord> _records;
+
+	unsigned int _queries = 0;
+	unsigned int _linearQueries = 0;
+	unsigned int _candidatesTested = 0;
+	unsigned int _returned = 0;
+};
+
+extern SpatialGrid g_SpatialGrid;
+
+void ReportSpatialGrid();
+
+#endif
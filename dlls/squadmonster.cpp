@@ -147,6 +147,22 @@ void CSquadMonster::OnDying()
 	CBaseMonster::OnDying();
 }
 
+void CSquadMonster::ResetMonsterState()
+{
+	// The squad was left on dying, the monster will look for a new one in StartMonster
+	m_hSquadLeader = NULL;
+	for( int i = 0; i < MAX_SQUAD_MEMBERS - 1; i++ )
+	{
+		m_hSquadMember[i] = NULL;
+	}
+	m_afSquadSlots = 0;
+	m_iMySlot = bits_NO_SLOT;
+	m_flLastEnemySightTime = 0.0f;
+	m_fEnemyEluded = false;
+
+	CBaseMonster::ResetMonsterState();
+}
+
 // These functions are still awaiting conversion to CSquadMonster 
 
 
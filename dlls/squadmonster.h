@@ -79,6 +79,7 @@ public:
 	void VacateSlot( void );
 	void ScheduleChange( void );
 	void OnDying();
+	void ResetMonsterState( void );
 	bool OccupySlot( int iDesiredSlot );
 	bool NoFriendlyFire( void );
 
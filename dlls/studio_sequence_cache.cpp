@@ -0,0 +1,167 @@
+#include "extdll.h"
+#include "util.h"
+#include "animation.h"
+#include "monsterevent.h"
+#include "name_symbols.h"
+#include "studio_sequence_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+StudioSequenceCache g_StudioSequenceCache;
+
+void StudioSequenceCache::ModelSequences::Build(const studiohdr_t *pstudiohdr)
+{
+	_studiohdr = pstudiohdr;
+	_length = pstudiohdr->length;
+	_numseq = pstudiohdr->numseq;
+	_seqindex = pstudiohdr->seqindex;
+
+	const mstudioseqdesc_t *pseqdesc = (const mstudioseqdesc_t *)( (const byte *)pstudiohdr + pstudiohdr->seqindex );
+
+	_activities.clear();
+	for( int i = 0; i < _numseq; i++ )
+	{
+		ActivitySequences& activitySequences = _activities[pseqdesc[i].activity];
+		const int weightSum = activitySequences.weightSums.empty() ? 0 : activitySequences.weightSums.back();
+		activitySequences.sequences.push_back(i);
+		activitySequences.weightSums.push_back(weightSum + pseqdesc[i].actweight);
+
+		const int heaviest = activitySequences.heaviest;
+		if( pseqdesc[i].actweight > ( heaviest >= 0 ? pseqdesc[heaviest].actweight : 0 ) )
+			activitySequences.heaviest = i;
+	}
+
+	unsigned int slotCount = 8;
+	while( slotCount < (unsigned int)_numseq * 2 )
+		slotCount <<= 1;
+	_labelMask = slotCount - 1;
+	_labelSlots.assign(slotCount, -1);
+	for( int i = 0; i < _numseq; i++ )
+	{
+		// Keep the first of the sequences with the same label, like the linear search does
+		if( LookupSequence(pseqdesc[i].label) >= 0 )
+			continue;
+		unsigned int slot = NameSymbolTable::HashName(pseqdesc[i].label) & _labelMask;
+		while( _labelSlots[slot] >= 0 )
+			slot = ( slot + 1 ) & _labelMask;
+		_labelSlots[slot] = i;
+	}
+
+	_numtransitions = pstudiohdr->numtransitions;
+	_transitions.assign(_numtransitions * _numtransitions, 0);
+	for( int i = 0; i < _numseq; i++ )
+	{
+		const int entryNode = pseqdesc[i].entrynode;
+		const int exitNode = pseqdesc[i].exitnode;
+		if( entryNode > 0 && entryNode <= _numtransitions && exitNode > 0 && exitNode <= _numtransitions )
+		{
+			// The first sequence in the order of the original search wins
+			int& forward = _transitions[( entryNode - 1 ) * _numtransitions + ( exitNode - 1 )];
+			if( forward == 0 )
+				forward = i + 1;
+			if( pseqdesc[i].nodeflags )
+			{
+				int& backward = _transitions[( exitNode - 1 ) * _numtransitions + ( entryNode - 1 )];
+				if( backward == 0 )
+					backward = -( i + 1 );
+			}
+		}
+	}
+
+	_serverEvents.assign(_numseq, std::vector<ServerEvent>());
+	for( int i = 0; i < _numseq; i++ )
+	{
+		const mstudioevent_t *pevent = (const mstudioevent_t *)( (const byte *)pstudiohdr + pseqdesc[i].eventindex );
+		std::vector<ServerEvent>& events = _serverEvents[i];
+		for( int j = 0; j < pseqdesc[i].numevents; j++ )
+		{
+			// Don't send client-side events to the server AI
+			if( pevent[j].event >= EVENT_CLIENT )
+				continue;
+			ServerEvent serverEvent;
+			serverEvent.frame = pevent[j].frame;
+			serverEvent.index = j;
+			events.push_back(serverEvent);
+		}
+		std::stable_sort(events.begin(), events.end(), [](const ServerEvent& a, const ServerEvent& b) {
+			return a.frame < b.frame;
+		});
+	}
+}
+
+bool StudioSequenceCache::ModelSequences::Matches(const studiohdr_t *pstudiohdr) const
+{
+	return _studiohdr == pstudiohdr && _length == pstudiohdr->length && _numseq == pstudiohdr->numseq &&
+		_seqindex == pstudiohdr->seqindex && _numtransitions == pstudiohdr->numtransitions;
+}
+
+int StudioSequenceCache::ModelSequences::LookupActivity(int activity) const
+{
+	auto it = _activities.find(activity);
+	if( it == _activities.end() )
+		return ACTIVITY_NOT_AVAILABLE;
+
+	const ActivitySequences& activitySequences = it->second;
+	const int weightTotal = activitySequences.weightSums.back();
+	if( weightTotal <= 0 )
+		return activitySequences.sequences.back();
+
+	// Sequence i is chosen with the chance of its weight out of the total
+	const int choice = RANDOM_LONG( 0, weightTotal - 1 );
+	const int position = std::upper_bound(activitySequences.weightSums.begin(), activitySequences.weightSums.end(), choice) - activitySequences.weightSums.begin();
+	return activitySequences.sequences[position];
+}
+
+int StudioSequenceCache::ModelSequences::LookupActivityHeaviest(int activity) const
+{
+	auto it = _activities.find(activity);
+	if( it == _activities.end() )
+		return ACTIVITY_NOT_AVAILABLE;
+	return it->second.heaviest >= 0 ? it->second.heaviest : ACTIVITY_NOT_AVAILABLE;
+}
+
+int StudioSequenceCache::ModelSequences::LookupSequence(const char *label) const
+{
+	if( _labelSlots.empty() )
+		return -1;
+	const mstudioseqdesc_t *pseqdesc = (const mstudioseqdesc_t *)( (const byte *)_studiohdr + _seqindex );
+	unsigned int slot = NameSymbolTable::HashName(label) & _labelMask;
+	while( _labelSlots[slot] >= 0 )
+	{
+		const int i = _labelSlots[slot];
+		if( stricmp( pseqdesc[i].label, label ) == 0 )
+			return i;
+		slot = ( slot + 1 ) & _labelMask;
+	}
+	return -1;
+}
+
+bool StudioSequenceCache::ModelSequences::FindTransition(int endNode, int internNode, int &sequence, int &dir) const
+{
+	if( endNode <= 0 || endNode > _numtransitions || internNode <= 0 || internNode > _numtransitions )
+		return false;
+	const int transition = _transitions[( endNode - 1 ) * _numtransitions + ( internNode - 1 )];
+	if( transition == 0 )
+		return false;
+	sequence = ( transition > 0 ? transition : -transition ) - 1;
+	dir = transition > 0 ? 1 : -1;
+	return true;
+}
+
+const StudioSequenceCache::ModelSequences* StudioSequenceCache::GetModelSequences(void *pmodel)
+{
+	const studiohdr_t *pstudiohdr = (const studiohdr_t *)pmodel;
+	if( !pstudiohdr )
+		return NULL;
+
+	ModelSequences& modelSequences = _models[pstudiohdr];
+	if( !modelSequences.Matches(pstudiohdr) )
+		modelSequences.Build(pstudiohdr);
+	return &modelSequences;
+}
+
+void StudioSequenceCache::Clear()
+{
+	_models.clear();
+}
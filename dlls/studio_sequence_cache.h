@@ -0,0 +1,74 @@
+#pragma once
+#ifndef STUDIO_SEQUENCE_CACHE_H
+#define STUDIO_SEQUENCE_CACHE_H
+
+#include "studio.h"
+
+#include <unordered_map>
+#include <vector>
+
+// Lookup tables for the sequences of a studio model, built the first time the model is used by animation code.
+// Keyed by the model data pointer and checked against the header, as the engine may reload the model elsewhere.
+class StudioSequenceCache
+{
+public:
+	struct ServerEvent
+	{
+		int frame;
+		int index; // Index in the sequence event array
+	};
+
+	class ModelSequences
+	{
+	public:
+		void Build(const studiohdr_t* pstudiohdr);
+		bool Matches(const studiohdr_t* pstudiohdr) const;
+
+		// Random sequence of the activity chosen by the sequence weights or ACTIVITY_NOT_AVAILABLE
+		int LookupActivity(int activity) const;
+		int LookupActivityHeaviest(int activity) const;
+		// Sequence with the label (case insensitive) or -1
+		int LookupSequence(const char* label) const;
+		// Sequence going from endNode to internNode, false if there's none
+		bool FindTransition(int endNode, int internNode, int& sequence, int& dir) const;
+		// Events of the sequence not meant for the client, sorted by frame
+		const std::vector<ServerEvent>& SequenceServerEvents(int sequence) const {
+			return _serverEvents[sequence];
+		}
+
+	private:
+		struct ActivitySequences
+		{
+			std::vector<int> sequences;
+			std::vector<int> weightSums; // Running total of the weights, for the weighted choice
+			int heaviest = -1;
+		};
+
+		const studiohdr_t* _studiohdr = nullptr;
+		int _length = 0;
+		int _numseq = 0;
+		int _seqindex = 0;
+
+		std::unordered_map<int, ActivitySequences> _activities;
+
+		std::vector<int> _labelSlots;
+		unsigned int _labelMask = 0;
+
+		// By (endNode - 1) * _numtransitions + (internNode - 1), sequence + 1 going forward, -(sequence + 1) going backward, 0 if none
+		std::vector<int> _transitions;
+		int _numtransitions = 0;
+
+		std::vector<std::vector<ServerEvent> > _serverEvents;
+	};
+
+	// Tables for the studio model, built if needed. NULL if pmodel is NULL.
+	const ModelSequences* GetModelSequences(void* pmodel);
+	void Clear();
+
+private:
+	std::unordered_map<const studiohdr_t*, ModelSequences> _models;
+};
+
+extern StudioSequenceCache g_StudioSequenceCache;
+
+#endif
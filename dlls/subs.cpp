@@ -26,6 +26,7 @@
 #include "saverestore.h"
 #include "nodes.h"
 #include "doors.h"
+#include "localmove_cache.h"
 
 extern bool FEntIsVisible( entvars_t *pev, entvars_t *pevTarget );
 
@@ -130,6 +131,13 @@ void CBaseEntity::UpdateOnRemove( void )
 // Convenient way to delay removing oneself
 void CBaseEntity::SUB_Remove( void )
 {
+	if( !FNullEnt( pev->owner ) )
+	{
+		CBaseEntity *pOwner = CBaseEntity::Instance( pev->owner );
+		if( pOwner && pOwner->RecycleChild( this ) )
+			return;
+	}
+
 	UpdateOnRemove();
 	if( pev->health > 0 )
 	{
@@ -157,19 +165,17 @@ TYPEDESCRIPTION	CBaseDelay::m_SaveData[] =
 
 IMPLEMENT_SAVERESTORE( CBaseDelay, CBaseEntity )
 
+TYPEDESCRIPTION CBaseDelay::m_KeyValueData[] =
+{
+	DEFINE_KEYVALUE( CBaseDelay, m_flDelay, FIELD_FLOAT, "delay" ),
+	DEFINE_KEYVALUE( CBaseDelay, m_iszKillTarget, FIELD_STRING, "killtarget" ),
+};
+
+IMPLEMENT_KEYVALUES( CBaseDelay )
+
 void CBaseDelay::KeyValue( KeyValueData *pkvd )
 {
-	if( FStrEq( pkvd->szKeyName, "delay" ) )
-	{
-		m_flDelay = atof( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "killtarget" ) )
-	{
-		m_iszKillTarget = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else
+	if( !m_KeyValueTable.Apply( this, pkvd ) )
 	{
 		CBaseEntity::KeyValue( pkvd );
 	}
@@ -375,29 +381,19 @@ TYPEDESCRIPTION	CBaseToggle::m_SaveData[] =
 
 IMPLEMENT_SAVERESTORE( CBaseToggle, CBaseAnimating )
 
+TYPEDESCRIPTION CBaseToggle::m_KeyValueData[] =
+{
+	DEFINE_KEYVALUE( CBaseToggle, m_flLip, FIELD_FLOAT, "lip" ),
+	DEFINE_KEYVALUE( CBaseToggle, m_flWait, FIELD_FLOAT, "wait" ),
+	DEFINE_KEYVALUE( CBaseToggle, m_sMaster, FIELD_STRING, "master" ),
+	DEFINE_KEYVALUE( CBaseToggle, m_flMoveDistance, FIELD_FLOAT, "distance" ),
+};
+
+IMPLEMENT_KEYVALUES( CBaseToggle )
+
 void CBaseToggle::KeyValue( KeyValueData *pkvd )
 {
-	if( FStrEq(pkvd->szKeyName, "lip" ) )
-	{
-		m_flLip = atof( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "wait" ) )
-	{
-		m_flWait = atof( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "master" ) )
-	{
-		m_sMaster = ALLOC_STRING( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else if( FStrEq( pkvd->szKeyName, "distance" ) )
-	{
-		m_flMoveDistance = atof( pkvd->szValue );
-		pkvd->fHandled = true;
-	}
-	else
+	if( !m_KeyValueTable.Apply( this, pkvd ) )
 		CBaseDelay::KeyValue( pkvd );
 }
 
@@ -423,6 +419,9 @@ void CBaseToggle::LinearMove( Vector vecDest, float flSpeed )
 		return;
 	}
 
+	// Local move results around the moving brush are stale now
+	g_LocalMoveCache.Invalidate();
+
 	// set destdelta to the vector needed to move
 	Vector vecDestDelta = vecDest - pev->origin;
 
@@ -455,6 +454,7 @@ void CBaseToggle::LinearMoveDone( void )
 	UTIL_SetOrigin( pev, m_vecFinalDest );
 	pev->velocity = g_vecZero;
 	pev->nextthink = -1;
+	g_LocalMoveCache.Invalidate();
 	if( m_pfnCallWhenMoveDone )
 		( this->*m_pfnCallWhenMoveDone )();
 }
@@ -487,6 +487,8 @@ void CBaseToggle::AngularMove( Vector vecDestAngle, float flSpeed )
 		return;
 	}
 
+	g_LocalMoveCache.Invalidate();
+
 	// set destdelta to the vector needed to move
 	Vector vecDestDelta = vecDestAngle - pev->angles;
 
@@ -511,6 +513,7 @@ void CBaseToggle::AngularMoveDone( void )
 	pev->angles = m_vecFinalAngle;
 	pev->avelocity = g_vecZero;
 	pev->nextthink = -1;
+	g_LocalMoveCache.Invalidate();
 	if( m_pfnCallWhenMoveDone )
 		( this->*m_pfnCallWhenMoveDone )();
 }
@@ -1761,6 +1761,13 @@ bool CTalkMonster::EmitSoundScriptTalk(const char* name)
 	return EmitSoundScript(name, paramOverride);
 }
 
+bool CTalkMonster::EmitSoundScriptTalk(const NamedSoundScript& soundScript)
+{
+	SoundScriptParamOverride paramOverride;
+	paramOverride.OverridePitchRelative(GetVoicePitch());
+	return EmitSoundScript(soundScript, paramOverride);
+}
+
 void CTalkMonster::RegisterTalkMonster(const char *className, bool canFollow, short followerCategory)
 {
 	int i;
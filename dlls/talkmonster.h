@@ -143,6 +143,7 @@ public:
 	void			OnDying();
 	void			StartMonster( void );
 	int				IRelationship ( CBaseEntity *pTarget );
+	bool			IRelationshipMayOverrideNone() { return true; }
 	bool			IsFriendWithPlayerBeforeProvoked();
 	virtual bool	CanPlaySentence( bool fDisregardState ) override;
 	virtual bool PlaySentence( const char *pszSentence, float duration, float volume, float attenuation, bool subtitle = false );
@@ -185,6 +186,7 @@ public:
 	virtual const char* SentenceGroup(int group);
 	virtual void PlayPainSound() {}
 	bool EmitSoundScriptTalk(const char* name);
+	bool EmitSoundScriptTalk(const NamedSoundScript& soundScript);
 
 	// Following related
 	virtual void	StartFollowing( CBaseEntity *pLeader, bool saySentence = true );
@@ -2112,14 +2112,14 @@ edict_t *CChangeLevel::FindLandmark( const char *pLandmarkName )
 {
 	edict_t	*pentLandmark;
 
-	pentLandmark = FIND_ENTITY_BY_STRING( NULL, "targetname", pLandmarkName );
+	pentLandmark = FIND_ENTITY_BY_TARGETNAME( NULL, pLandmarkName );
 	while( !FNullEnt( pentLandmark ) )
 	{
 		// Found the landmark
 		if( FClassnameIs( pentLandmark, "info_landmark" ) )
 			return pentLandmark;
 		else
-			pentLandmark = FIND_ENTITY_BY_STRING( pentLandmark, "targetname", pLandmarkName );
+			pentLandmark = FIND_ENTITY_BY_TARGETNAME( pentLandmark, pLandmarkName );
 	}
 	ALERT( at_error, "Can't find landmark %s\n", pLandmarkName );
 	return NULL;
@@ -2307,7 +2307,7 @@ int CChangeLevel::ChangeList( LEVELLIST *pLevelList, int maxList )
 	count = 0;
 
 	// Find all of the possible level changes on this BSP
-	pentChangelevel = FIND_ENTITY_BY_STRING( NULL, "classname", "trigger_changelevel" );
+	pentChangelevel = FIND_ENTITY_BY_CLASSNAME( NULL, "trigger_changelevel" );
 	if( FNullEnt( pentChangelevel ) )
 		return 0;
 	while( !FNullEnt( pentChangelevel ) )
@@ -2330,7 +2330,7 @@ int CChangeLevel::ChangeList( LEVELLIST *pLevelList, int maxList )
 				}
 			}
 		}
-		pentChangelevel = FIND_ENTITY_BY_STRING( pentChangelevel, "classname", "trigger_changelevel" );
+		pentChangelevel = FIND_ENTITY_BY_CLASSNAME( pentChangelevel, "trigger_changelevel" );
 	}
 
 	if( gpGlobals->pSaveData && ( (SAVERESTOREDATA *)gpGlobals->pSaveData)->pTable )
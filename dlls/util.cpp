@@ -31,6 +31,9 @@
 #include "global_models.h"
 #include "gamerules.h"
 #include "string_utils.h"
+#include "game.h"
+#include "spatial_grid.h"
+#include "saverestore_index.h"
 
 #include <map>
 #include <set>
@@ -442,6 +445,9 @@ TYPEDESCRIPTION	gEntvarsDescription[] =
 
 #define ENTVARS_COUNT		( sizeof(gEntvarsDescription) / sizeof(gEntvarsDescription[0]) )
 
+// Every keyvalue of every entity in the map is looked up here first, entvars keys are case-insensitive
+static KeyValueTable g_entvarsKeyValueTable( gEntvarsDescription, ENTVARS_COUNT, false );
+
 #if	DEBUG
 edict_t *DBG_EntOfVars( const entvars_t *pev )
 {
@@ -488,9 +494,14 @@ void UTIL_MoveToOrigin( edict_t *pent, const Vector &vecGoal, float flDist, int
 
 int UTIL_EntitiesInBox( CBaseEntity **pList, int listMax, const Vector &mins, const Vector &maxs, int flagMask )
 {
+	// The grid holds only monsters and clients
+	if( sv_spatial_grid.value && flagMask && !( flagMask & ~SpatialGrid::TRACKED_FLAGS ) )
+		return g_SpatialGrid.EntitiesInBox( pList, listMax, mins, maxs, flagMask );
+
 	edict_t *pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
 	CBaseEntity *pEntity;
 	int count;
+	int tested = 0;
 
 	count = 0;
 
@@ -502,6 +513,8 @@ int UTIL_EntitiesInBox( CBaseEntity **pList, int listMax, const Vector &mins, co
 		if( pEdict->free )	// Not in use
 			continue;
 
+		tested++;
+
 		if( flagMask && !( pEdict->v.flags & flagMask ) )	// Does it meet the criteria?
 			continue;
 
@@ -521,18 +534,23 @@ int UTIL_EntitiesInBox( CBaseEntity **pList, int listMax, const Vector &mins, co
 		count++;
 
 		if( count >= listMax )
-			return count;
+			break;
 	}
 
+	g_SpatialGrid.CountLinearQuery( tested, count );
 	return count;
 }
 
 int UTIL_MonstersInSphere( CBaseEntity **pList, int listMax, const Vector &center, float radius )
 {
+	if( sv_spatial_grid.value )
+		return g_SpatialGrid.MonstersInSphere( pList, listMax, center, radius );
+
 	edict_t *pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
 	CBaseEntity *pEntity;
 	int		count;
 	float		distance, delta;
+	int tested = 0;
 
 	count = 0;
 	float radiusSquared = radius * radius;
@@ -545,6 +563,8 @@ int UTIL_MonstersInSphere( CBaseEntity **pList, int listMax, const Vector &cente
 		if( pEdict->free )	// Not in use
 			continue;
 
+		tested++;
+
 		if( !( pEdict->v.flags & ( FL_CLIENT | FL_MONSTER ) ) )	// Not a client/monster ?
 			continue;
 
@@ -581,9 +601,10 @@ int UTIL_MonstersInSphere( CBaseEntity **pList, int listMax, const Vector &cente
 		count++;
 
 		if( count >= listMax )
-			return count;
+			break;
 	}
 
+	g_SpatialGrid.CountLinearQuery( tested, count );
 	return count;
 }
 
@@ -603,6 +624,16 @@ CBaseEntity *UTIL_FindEntityInSphere( CBaseEntity *pStartEntity, const Vector &v
 	return NULL;
 }
 
+edict_t *UTIL_FindEdictByClassname( edict_t *entStart, const char *pszName )
+{
+	return g_EntityNameIndex.Find( entStart, EntityNameIndex::KEY_CLASSNAME, pszName );
+}
+
+edict_t *UTIL_FindEdictByTargetname( edict_t *entStart, const char *pszName )
+{
+	return g_EntityNameIndex.Find( entStart, EntityNameIndex::KEY_TARGETNAME, pszName );
+}
+
 CBaseEntity *UTIL_FindEntityByString( CBaseEntity *pStartEntity, const char *szKeyword, const char *szValue )
 {
 	edict_t	*pentEntity;
@@ -612,7 +643,12 @@ CBaseEntity *UTIL_FindEntityByString( CBaseEntity *pStartEntity, const char *szK
 	else
 		pentEntity = NULL;
 
-	pentEntity = FIND_ENTITY_BY_STRING( pentEntity, szKeyword, szValue );
+	if( FStrEq( szKeyword, "targetname" ) )
+		pentEntity = UTIL_FindEdictByTargetname( pentEntity, szValue );
+	else if( FStrEq( szKeyword, "classname" ) )
+		pentEntity = UTIL_FindEdictByClassname( pentEntity, szValue );
+	else
+		pentEntity = FIND_ENTITY_BY_STRING( pentEntity, szKeyword, szValue );
 
 	if( !FNullEnt( pentEntity ) )
 		return CBaseEntity::Instance( pentEntity );
@@ -621,12 +657,20 @@ CBaseEntity *UTIL_FindEntityByString( CBaseEntity *pStartEntity, const char *szK
 
 CBaseEntity *UTIL_FindEntityByClassname( CBaseEntity *pStartEntity, const char *szName )
 {
-	return UTIL_FindEntityByString( pStartEntity, "classname", szName );
+	edict_t *pentEntity = UTIL_FindEdictByClassname( pStartEntity ? pStartEntity->edict() : NULL, szName );
+
+	if( !FNullEnt( pentEntity ) )
+		return CBaseEntity::Instance( pentEntity );
+	return NULL;
 }
 
 CBaseEntity *UTIL_FindEntityByTargetname( CBaseEntity *pStartEntity, const char *szName )
 {
-	return UTIL_FindEntityByString( pStartEntity, "targetname", szName );
+	edict_t *pentEntity = UTIL_FindEdictByTargetname( pStartEntity ? pStartEntity->edict() : NULL, szName );
+
+	if( !FNullEnt( pentEntity ) )
+		return CBaseEntity::Instance( pentEntity );
+	return NULL;
 }
 
 CBaseEntity *UTIL_FindEntityByTargetname( CBaseEntity *pStartEntity, const char *szName, CBaseEntity *pActivator )
@@ -1134,7 +1178,10 @@ void UTIL_SetOrigin( entvars_t *pev, const Vector &vecOrigin )
 {
 	edict_t *ent = ENT( pev );
 	if( ent )
+	{
 		SET_ORIGIN( ent, vecOrigin );
+		g_SpatialGrid.Update( ent );
+	}
 }
 
 void UTIL_ParticleEffect( const Vector &vecOrigin, const Vector &vecDirection, ULONG ulColor, ULONG ulCount )
@@ -1663,6 +1710,7 @@ void UTIL_Remove( CBaseEntity *pEntity )
 	pEntity->UpdateOnRemove();
 	pEntity->pev->flags |= FL_KILLME;
 	pEntity->pev->targetname = 0;
+	g_EntityNameIndex.Update( pEntity->edict() );
 }
 
 bool UTIL_IsValidEntity( edict_t *pent )
@@ -1947,6 +1995,10 @@ unsigned int CSaveRestoreBuffer::HashString( const char *pszToken )
 
 unsigned short CSaveRestoreBuffer::TokenHash( const char *pszToken )
 {
+	const int cachedToken = g_SaveRestoreIndex.LookupToken( m_pdata, pszToken );
+	if( cachedToken >= 0 )
+		return cachedToken;
+
 	unsigned short hash = (unsigned short)( HashString( pszToken ) % (unsigned)m_pdata->tokenCount );
 #if _DEBUG
 	static int tokensparsed = 0;
@@ -1971,6 +2023,7 @@ unsigned short CSaveRestoreBuffer::TokenHash( const char *pszToken )
 		if( !m_pdata->pTokens[index] || strcmp( pszToken, m_pdata->pTokens[index] ) == 0 )
 		{
 			m_pdata->pTokens[index] = (char *)pszToken;
+			g_SaveRestoreIndex.StoreToken( pszToken, index );
 			return index;
 		}
 	}
@@ -2107,86 +2160,53 @@ void CSave::WriteFunction( const char *pname, void **data, int count )
 		ALERT( at_error, "Invalid function pointer in entity!\n" );
 }
 
-void EntvarsKeyvalue( entvars_t *pev, KeyValueData *pkvd )
+const TYPEDESCRIPTION* FindEntvarsKeyvalueField( const char* keyName )
 {
-	int i;
-	TYPEDESCRIPTION *pField;
+	return g_entvarsKeyValueTable.Find( keyName );
+}
 
-	for( i = 0; i < (int)ENTVARS_COUNT; i++ )
+void EntvarsKeyvalue( entvars_t *pev, KeyValueData *pkvd )
+{
+	const TYPEDESCRIPTION *pField = g_entvarsKeyValueTable.Find( pkvd->szKeyName );
+	if( pField )
 	{
-		pField = &gEntvarsDescription[i];
-
-		if( !stricmp( pField->fieldName, pkvd->szKeyName ) )
-		{
-			switch( pField->fieldType )
-			{
-			case FIELD_MODELNAME:
-			case FIELD_SOUNDNAME:
-			case FIELD_STRING:
-				( *(string_t *)( (char *)pev + pField->fieldOffset ) ) = ALLOC_STRING( pkvd->szValue );
-				break;
-			case FIELD_TIME:
-			case FIELD_FLOAT:
-				( *(float *)( (char *)pev + pField->fieldOffset ) ) = atof( pkvd->szValue );
-				break;
-			case FIELD_INTEGER:
-				( *(int *)( (char *)pev + pField->fieldOffset ) ) = atoi( pkvd->szValue );
-				break;
-			case FIELD_POSITION_VECTOR:
-			case FIELD_VECTOR:
-				UTIL_StringToVector( (float *)( (char *)pev + pField->fieldOffset ), pkvd->szValue );
-				break;
-			default:
-			case FIELD_EVARS:
-			case FIELD_CLASSPTR:
-			case FIELD_EDICT:
-			case FIELD_ENTITY:
-			case FIELD_POINTER:
-				ALERT( at_error, "Bad field in entity!!\n" );
-				break;
-			}
-			pkvd->fHandled = true;
-			return;
-		}
+		KeyValueTable::SetField( pev, pField, pkvd->szValue );
+		pkvd->fHandled = true;
 	}
 }
 
 int ReadEntvarKeyvalue(entvars_t* pev, const char* keyName, int* offset, float* outFloat, int* outInteger, Vector* outVector, string_t* outString)
 {
-	for( int i = 0; i < (int)ENTVARS_COUNT; i++ )
-	{
-		TYPEDESCRIPTION *pField = &gEntvarsDescription[i];
-		if( stricmp( pField->fieldName, keyName ) == 0 )
-		{
-			switch( pField->fieldType )
-			{
-			case FIELD_MODELNAME:
-			case FIELD_SOUNDNAME:
-			case FIELD_STRING:
-				if (outString)
-					*outString = ( *(string_t *)( (char *)pev + pField->fieldOffset ) );
-				break;
-			case FIELD_TIME:
-			case FIELD_FLOAT:
-				if (outFloat)
-					*outFloat = ( *(float *)( (char *)pev + pField->fieldOffset ) );
-				break;
-			case FIELD_INTEGER:
-				if (outInteger)
-					*outInteger = ( *(int *)( (char *)pev + pField->fieldOffset ) );
-				break;
-			case FIELD_POSITION_VECTOR:
-			case FIELD_VECTOR:
-				if (outVector)
-					*outVector = Vector((float *)( (char *)pev + pField->fieldOffset ));
-				break;
-			}
-			if (offset)
-				*offset = pField->fieldOffset;
-			return pField->fieldType;
-		}
-	}
-	return -1;
+	const TYPEDESCRIPTION *pField = g_entvarsKeyValueTable.Find( keyName );
+	if( !pField )
+		return -1;
+
+	switch( pField->fieldType )
+	{
+	case FIELD_MODELNAME:
+	case FIELD_SOUNDNAME:
+	case FIELD_STRING:
+		if (outString)
+			*outString = ( *(string_t *)( (char *)pev + pField->fieldOffset ) );
+		break;
+	case FIELD_TIME:
+	case FIELD_FLOAT:
+		if (outFloat)
+			*outFloat = ( *(float *)( (char *)pev + pField->fieldOffset ) );
+		break;
+	case FIELD_INTEGER:
+		if (outInteger)
+			*outInteger = ( *(int *)( (char *)pev + pField->fieldOffset ) );
+		break;
+	case FIELD_POSITION_VECTOR:
+	case FIELD_VECTOR:
+		if (outVector)
+			*outVector = Vector((float *)( (char *)pev + pField->fieldOffset ));
+		break;
+	}
+	if (offset)
+		*offset = pField->fieldOffset;
+	return pField->fieldType;
 }
 
 int CSave::WriteEntVars( const char *pname, entvars_t *pev )
@@ -2196,35 +2216,35 @@ int CSave::WriteEntVars( const char *pname, entvars_t *pev )
 
 int CSave::WriteFields( const char *pname, void *pBaseData, TYPEDESCRIPTION *pFields, int fieldCount )
 {
-	int i, j, actualCount, emptyCount;
+	int i, j, actualCount;
 	TYPEDESCRIPTION	*pTest;
 	int entityArray[MAX_ENTITYARRAY];
 	byte boolArray[MAX_ENTITYARRAY];
+	const double startTime = sv_saverestore_stats.value ? SaveRestoreStats::Clock() : 0.0;
 
-	// Precalculate the number of empty fields
-	emptyCount = 0;
-	for( i = 0; i < fieldCount; i++ )
+	// Empty fields will not be written. The actual number of fields to be written is not known yet,
+	// write a placeholder and fill it in when all fields are written.
+	actualCount = 0;
+	char *pCountData = NULL;
+	if( m_pdata )
 	{
-		void *pOutputData;
-		pOutputData = ( (char *)pBaseData + pFields[i].fieldOffset );
-		if( DataEmpty( (const char *)pOutputData, pFields[i].fieldSize * gSizes[pFields[i].fieldType] ) )
-			emptyCount++;
+		const int sizeBefore = m_pdata->size;
+		WriteInt( pname, &actualCount, 1 );
+		if( m_pdata->size == sizeBefore + (int)( sizeof(short) * 2 + sizeof(int) ) )
+			pCountData = m_pdata->pCurrentData - sizeof(int);
 	}
 
-	// Empty fields will not be written, write out the actual number of fields to be written
-	actualCount = fieldCount - emptyCount;
-	WriteInt( pname, &actualCount, 1 );
-
 	for( i = 0; i < fieldCount; i++ )
 	{
 		void *pOutputData;
 		pTest = &pFields[i];
 		pOutputData = ( (char *)pBaseData + pTest->fieldOffset );
 
-		// UNDONE: Must we do this twice?
 		if( DataEmpty( (const char *)pOutputData, pTest->fieldSize * gSizes[pTest->fieldType] ) )
 			continue;
 
+		actualCount++;
+
 		switch( pTest->fieldType )
 		{
 		case FIELD_FLOAT:
@@ -2309,6 +2329,12 @@ int CSave::WriteFields( const char *pname, void *pBaseData, TYPEDESCRIPTION *pFi
 		}
 	}
 
+	if( pCountData )
+		memcpy( pCountData, &actualCount, sizeof(int) );
+
+	if( sv_saverestore_stats.value )
+		g_SaveRestoreStats.CountSave( pname, actualCount, SaveRestoreStats::Clock() - startTime );
+
 	return 1;
 }
 
@@ -2369,8 +2395,25 @@ void CSave::BufferData( const char *pdata, int size )
 // --------------------------------------------------------------
 int CRestore::ReadField( void *pBaseData, TYPEDESCRIPTION *pFields, int fieldCount, int startField, int size, char *pName, void *pData )
 {
-	int i, j, stringCount, fieldNumber, entityIndex;
+	int i, fieldNumber;
 	TYPEDESCRIPTION *pTest;
+
+	for( i = 0; i < fieldCount; i++ )
+	{
+		fieldNumber = ( i + startField ) % fieldCount;
+		pTest = &pFields[fieldNumber];
+		if( pTest->fieldName && !stricmp( pTest->fieldName, pName ) )
+		{
+			ReadFieldData( pBaseData, pTest, pData );
+			return fieldNumber;
+		}
+	}
+	return -1;
+}
+
+void CRestore::ReadFieldData( void *pBaseData, TYPEDESCRIPTION *pTest, void *pData )
+{
+	int j, stringCount, entityIndex;
 	float time, timeData;
 	Vector position;
 	edict_t	*pent;
@@ -2386,173 +2429,157 @@ int CRestore::ReadField( void *pBaseData, TYPEDESCRIPTION *pFields, int fieldCou
 			position = m_pdata->vecLandmarkOffset;
 	}
 
-	for( i = 0; i < fieldCount; i++ )
+	if( !m_global || !(pTest->flags & FTYPEDESC_GLOBAL ) )
 	{
-		fieldNumber = ( i + startField ) % fieldCount;
-		pTest = &pFields[fieldNumber];
-		if( pTest->fieldName && !stricmp( pTest->fieldName, pName ) )
+		for( j = 0; j < pTest->fieldSize; j++ )
 		{
-			if( !m_global || !(pTest->flags & FTYPEDESC_GLOBAL ) )
+			void *pOutputData = ( (char *)pBaseData + pTest->fieldOffset + ( j * gSizes[pTest->fieldType] ) );
+			void *pInputData = (char *)pData + j * gInputSizes[pTest->fieldType];
+
+			switch( pTest->fieldType )
 			{
-				for( j = 0; j < pTest->fieldSize; j++ )
+			case FIELD_TIME:
+			#if __VFP_FP__
+				memcpy( &timeData, pInputData, 4 );
+				// Re-base time variables
+				timeData += time;
+				memcpy( pOutputData, &timeData, 4 );
+			#else
+				timeData = *(float *)pInputData;
+				// Re-base time variables
+				timeData += time;
+				*( (float *)pOutputData ) = timeData;
+			#endif
+				break;
+			case FIELD_FLOAT:
+				memcpy( pOutputData, pInputData, 4 );
+				break;
+			case FIELD_MODELNAME:
+			case FIELD_SOUNDNAME:
+			case FIELD_STRING:
+				// Skip over j strings
+				pString = (char *)pData;
+				for( stringCount = 0; stringCount < j; stringCount++ )
+				{
+					while( *pString )
+						pString++;
+					pString++;
+				}
+				pInputData = pString;
+				if( ( (char *)pInputData )[0] == '\0' )
+					*( (string_t *)pOutputData ) = 0;
+				else
 				{
-					void *pOutputData = ( (char *)pBaseData + pTest->fieldOffset + ( j * gSizes[pTest->fieldType] ) );
-					void *pInputData = (char *)pData + j * gInputSizes[pTest->fieldType];
+					string_t string;
 
-					switch( pTest->fieldType )
-					{
-					case FIELD_TIME:
-					#if __VFP_FP__
-						memcpy( &timeData, pInputData, 4 );
-						// Re-base time variables
-						timeData += time;
-						memcpy( pOutputData, &timeData, 4 );
-					#else
-						timeData = *(float *)pInputData;
-						// Re-base time variables
-						timeData += time;
-						*( (float *)pOutputData ) = timeData;
-					#endif
-						break;
-					case FIELD_FLOAT:
-						memcpy( pOutputData, pInputData, 4 );
-						break;
-					case FIELD_MODELNAME:
-					case FIELD_SOUNDNAME:
-					case FIELD_STRING:
-						// Skip over j strings
-						pString = (char *)pData;
-						for( stringCount = 0; stringCount < j; stringCount++ )
-						{
-							while( *pString )
-								pString++;
-							pString++;
-						}
-						pInputData = pString;
-						if( ( (char *)pInputData )[0] == '\0' )
-							*( (string_t *)pOutputData ) = 0;
-						else
-						{
-							string_t string;
-
-							string = ALLOC_STRING( (char *)pInputData );
-
-							*( (string_t *)pOutputData ) = string;
-
-							if( !FStringNull( string ) && m_precache )
-							{
-								if( pTest->fieldType == FIELD_MODELNAME )
-									PRECACHE_MODEL( STRING( string ) );
-								else if( pTest->fieldType == FIELD_SOUNDNAME )
-									PRECACHE_SOUND( STRING( string ) );
-							}
-						}
-						break;
-					case FIELD_EVARS:
-						entityIndex = *( int *)pInputData;
-						pent = EntityFromIndex( entityIndex );
-						if( pent )
-							*( (entvars_t **)pOutputData ) = VARS( pent );
-						else
-							*( (entvars_t **)pOutputData ) = NULL;
-						break;
-					case FIELD_CLASSPTR:
-						entityIndex = *( int *)pInputData;
-						pent = EntityFromIndex( entityIndex );
-						if( pent )
-							*( (CBaseEntity **)pOutputData ) = CBaseEntity::Instance( pent );
-						else
-							*( (CBaseEntity **)pOutputData ) = NULL;
-						break;
-					case FIELD_EDICT:
-						entityIndex = *(int *)pInputData;
-						pent = EntityFromIndex( entityIndex );
-						*( (edict_t **)pOutputData ) = pent;
-						break;
-					case FIELD_EHANDLE:
-						// Input and Output sizes are different!
-						pInputData = (char*)pData + j * gInputSizes[pTest->fieldType];
-						entityIndex = *(int *)pInputData;
-						pent = EntityFromIndex( entityIndex );
-						if( pent )
-							*( (EHANDLE *)pOutputData ) = CBaseEntity::Instance( pent );
-						else
-							*( (EHANDLE *)pOutputData ) = NULL;
-						break;
-					case FIELD_ENTITY:
-						entityIndex = *(int *)pInputData;
-						pent = EntityFromIndex( entityIndex );
-						if( pent )
-							*( (EOFFSET *)pOutputData ) = OFFSET( pent );
-						else
-							*( (EOFFSET *)pOutputData ) = 0;
-						break;
-					case FIELD_VECTOR:
-						#if __VFP_FP__
-						memcpy( pOutputData, pInputData, sizeof( Vector ) );
-						#else
-						( (float *)pOutputData )[0] = ( (float *)pInputData )[0];
-						( (float *)pOutputData )[1] = ( (float *)pInputData )[1];
-						( (float *)pOutputData )[2] = ( (float *)pInputData )[2];
-						#endif
-						break;
-					case FIELD_POSITION_VECTOR:
-						#if  __VFP_FP__
-						{
-							Vector tmp;
-							memcpy( &tmp, pInputData, sizeof( Vector ) );
-							tmp = tmp + position;
-							memcpy( pOutputData, &tmp, sizeof( Vector ) );
-						}
-						#else
-						( (float *)pOutputData )[0] = ( (float *)pInputData )[0] + position.x;
-						( (float *)pOutputData )[1] = ( (float *)pInputData )[1] + position.y;
-						( (float *)pOutputData )[2] = ( (float *)pInputData )[2] + position.z;
-						#endif
-						break;
-					case FIELD_BOOLEAN:
+					string = ALLOC_STRING( (char *)pInputData );
+
+					*( (string_t *)pOutputData ) = string;
+
+					if( !FStringNull( string ) && m_precache )
 					{
-						pOutputData = (char*)pOutputData + j * (sizeof(bool) - gSizes[pTest->fieldType]);
-						const bool value = *((byte*)pInputData) != 0;
-						*((bool*)pOutputData) = value;
-					}
-						break;
-					case FIELD_INTEGER:
-						*( (int *)pOutputData ) = *(int *)pInputData;
-						break;
-					case FIELD_SHORT:
-						*( (short *)pOutputData ) = *(short *)pInputData;
-						break;
-					case FIELD_CHARACTER:
-						*( (char *)pOutputData ) = *(char *)pInputData;
-						break;
-					case FIELD_POINTER:
-						*( (void**)pOutputData ) = *(void **)pInputData;
-						break;
-					case FIELD_FUNCTION:
-						if( ( (char *)pInputData )[0] == '\0' )
-							*( (void**)pOutputData ) = 0;
-						else
-							*( (void**)pOutputData ) = (void*)FUNCTION_FROM_NAME( (char *)pInputData );
-						break;
-					case FIELD_INT64:
-						*((std::uint64_t*)pOutputData) = *(std::uint64_t*)pInputData;
-						break;
-					default:
-						ALERT( at_error, "Bad field type\n" );
+						if( pTest->fieldType == FIELD_MODELNAME )
+							PRECACHE_MODEL( STRING( string ) );
+						else if( pTest->fieldType == FIELD_SOUNDNAME )
+							PRECACHE_SOUND( STRING( string ) );
 					}
 				}
-			}
-#if 0
-			else
+				break;
+			case FIELD_EVARS:
+				entityIndex = *( int *)pInputData;
+				pent = EntityFromIndex( entityIndex );
+				if( pent )
+					*( (entvars_t **)pOutputData ) = VARS( pent );
+				else
+					*( (entvars_t **)pOutputData ) = NULL;
+				break;
+			case FIELD_CLASSPTR:
+				entityIndex = *( int *)pInputData;
+				pent = EntityFromIndex( entityIndex );
+				if( pent )
+					*( (CBaseEntity **)pOutputData ) = CBaseEntity::Instance( pent );
+				else
+					*( (CBaseEntity **)pOutputData ) = NULL;
+				break;
+			case FIELD_EDICT:
+				entityIndex = *(int *)pInputData;
+				pent = EntityFromIndex( entityIndex );
+				*( (edict_t **)pOutputData ) = pent;
+				break;
+			case FIELD_EHANDLE:
+				// Input and Output sizes are different!
+				pInputData = (char*)pData + j * gInputSizes[pTest->fieldType];
+				entityIndex = *(int *)pInputData;
+				pent = EntityFromIndex( entityIndex );
+				if( pent )
+					*( (EHANDLE *)pOutputData ) = CBaseEntity::Instance( pent );
+				else
+					*( (EHANDLE *)pOutputData ) = NULL;
+				break;
+			case FIELD_ENTITY:
+				entityIndex = *(int *)pInputData;
+				pent = EntityFromIndex( entityIndex );
+				if( pent )
+					*( (EOFFSET *)pOutputData ) = OFFSET( pent );
+				else
+					*( (EOFFSET *)pOutputData ) = 0;
+				break;
+			case FIELD_VECTOR:
+				#if __VFP_FP__
+				memcpy( pOutputData, pInputData, sizeof( Vector ) );
+				#else
+				( (float *)pOutputData )[0] = ( (float *)pInputData )[0];
+				( (float *)pOutputData )[1] = ( (float *)pInputData )[1];
+				( (float *)pOutputData )[2] = ( (float *)pInputData )[2];
+				#endif
+				break;
+			case FIELD_POSITION_VECTOR:
+				#if  __VFP_FP__
+				{
+					Vector tmp;
+					memcpy( &tmp, pInputData, sizeof( Vector ) );
+					tmp = tmp + position;
+					memcpy( pOutputData, &tmp, sizeof( Vector ) );
+				}
+				#else
+				( (float *)pOutputData )[0] = ( (float *)pInputData )[0] + position.x;
+				( (float *)pOutputData )[1] = ( (float *)pInputData )[1] + position.y;
+				( (float *)pOutputData )[2] = ( (float *)pInputData )[2] + position.z;
+				#endif
+				break;
+			case FIELD_BOOLEAN:
 			{
-				ALERT( at_console, "Skipping global field %s\n", pName );
+				pOutputData = (char*)pOutputData + j * (sizeof(bool) - gSizes[pTest->fieldType]);
+				const bool value = *((byte*)pInputData) != 0;
+				*((bool*)pOutputData) = value;
+			}
+				break;
+			case FIELD_INTEGER:
+				*( (int *)pOutputData ) = *(int *)pInputData;
+				break;
+			case FIELD_SHORT:
+				*( (short *)pOutputData ) = *(short *)pInputData;
+				break;
+			case FIELD_CHARACTER:
+				*( (char *)pOutputData ) = *(char *)pInputData;
+				break;
+			case FIELD_POINTER:
+				*( (void**)pOutputData ) = *(void **)pInputData;
+				break;
+			case FIELD_FUNCTION:
+				if( ( (char *)pInputData )[0] == '\0' )
+					*( (void**)pOutputData ) = 0;
+				else
+					*( (void**)pOutputData ) = (void*)FUNCTION_FROM_NAME( (char *)pInputData );
+				break;
+			case FIELD_INT64:
+				*((std::uint64_t*)pOutputData) = *(std::uint64_t*)pInputData;
+				break;
+			default:
+				ALERT( at_error, "Bad field type\n" );
 			}
-#endif
-			return fieldNumber;
 		}
 	}
-	return -1;
 }
 
 int CRestore::ReadEntVars( const char *pname, entvars_t *pev )
@@ -2584,6 +2611,9 @@ int CRestore::ReadFields( const char *pname, void *pBaseData, TYPEDESCRIPTION *p
 
 	lastField = 0;								// Make searches faster, most data is read/written in the same order
 
+	const double startTime = sv_saverestore_stats.value ? SaveRestoreStats::Clock() : 0.0;
+	const SaveRestoreIndex::FieldTable &fieldTable = g_SaveRestoreIndex.GetFieldTable( pFields, fieldCount );
+
 	// Clear out base data
 	for( i = 0; i < fieldCount; i++ )
 	{
@@ -2595,10 +2625,26 @@ int CRestore::ReadFields( const char *pname, void *pBaseData, TYPEDESCRIPTION *p
 	for( i = 0; i < fileCount; i++ )
 	{
 		BufferReadHeader( &header );
-		lastField = ReadField( pBaseData, pFields, fieldCount, lastField, header.size, m_pdata->pTokens[header.token], header.pData );
-		lastField++;
+
+		// Try the field after the last one first, then the hash of the names
+		const char *pName = m_pdata->pTokens[header.token];
+		int fieldNumber = -1;
+		if( pName )
+		{
+			if( lastField < fieldCount && pFields[lastField].fieldName && !stricmp( pFields[lastField].fieldName, pName ) )
+				fieldNumber = lastField;
+			else
+				fieldNumber = fieldTable.Find( pName );
+		}
+
+		if( fieldNumber >= 0 )
+			ReadFieldData( pBaseData, &pFields[fieldNumber], header.pData );
+		lastField = fieldNumber + 1;
 	}
-	
+
+	if( sv_saverestore_stats.value )
+		g_SaveRestoreStats.CountRestore( pname, fileCount, SaveRestoreStats::Clock() - startTime );
+
 	return 1;
 }
 
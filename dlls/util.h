@@ -66,14 +66,18 @@ extern void WRITE_COLOR(const Vector& color);
 extern void WRITE_VECTOR(const Vector& vecSrc);
 extern void WRITE_CIRCLE(const Vector& vecSrc, float radius);
 
+// These use the game-side name index instead of the engine's linear search
+extern edict_t *UTIL_FindEdictByClassname(edict_t *entStart, const char *pszName);
+extern edict_t *UTIL_FindEdictByTargetname(edict_t *entStart, const char *pszName);
+
 inline edict_t *FIND_ENTITY_BY_CLASSNAME(edict_t *entStart, const char *pszName) 
 {
-	return FIND_ENTITY_BY_STRING(entStart, "classname", pszName);
+	return UTIL_FindEdictByClassname(entStart, pszName);
 }
 
 inline edict_t *FIND_ENTITY_BY_TARGETNAME(edict_t *entStart, const char *pszName) 
 {
-	return FIND_ENTITY_BY_STRING(entStart, "targetname", pszName);
+	return UTIL_FindEdictByTargetname(entStart, pszName);
 }
 
 // for doing a reverse lookup. Say you have a door, and want to find its button.
@@ -392,6 +396,8 @@ extern float UTIL_DotPoints ( const Vector &vecSrc, const Vector &vecCheck, cons
 extern void UTIL_StripToken( const char *pKey, char *pDest, int nLen );// for redundant keynames
 
 extern void EntvarsKeyvalue( entvars_t *pev, KeyValueData *pkvd );
+// Returns the entvars field of the keyvalue key or NULL. Lets the same key be applied many times without a lookup.
+extern const TYPEDESCRIPTION* FindEntvarsKeyvalueField( const char* keyName );
 extern int ReadEntvarKeyvalue(entvars_t* pev, const char* keyName, int* offset, float* outFloat, int* outInteger, Vector* outVector, string_t* outString);
 
 // Misc functions
@@ -0,0 +1,96 @@
+#include "extdll.h"
+#include "util.h"
+#include "visibility_cache.h"
+
+VisibilityCache g_VisibilityCache;
+
+unsigned int VisibilityCache::Slot(int a, int b)
+{
+	// The same slot for both directions of the pair
+	const unsigned int lo = (unsigned int)(a < b ? a : b);
+	const unsigned int hi = (unsigned int)(a < b ? b : a);
+	return ((lo * 2654435761u) ^ (hi * 40503u)) & (CACHE_SIZE - 1);
+}
+
+bool VisibilityCache::CanBeSymmetric(const edict_t *pent)
+{
+	// Traces ignore monsters, so swapping the ignored entity doesn't matter for them.
+	// Brush entities can block the trace of the other side.
+	return (pent->v.flags & (FL_MONSTER | FL_CLIENT)) != 0 && pent->v.solid != SOLID_BSP;
+}
+
+void VisibilityCache::NewFrame()
+{
+	_frame++;
+	if (_frame == 0)
+	{
+		// Wrapped around, make sure nothing old is considered valid
+		for (int i = 0; i < CACHE_SIZE; ++i)
+			_entries[i].frame = 0;
+		_frame = 1;
+	}
+}
+
+bool VisibilityCache::Lookup(edict_t *pentLooker, edict_t *pentTarget, const Vector &vecStart, const Vector &vecEnd, bool &visible)
+{
+	const int looker = ENTINDEX(pentLooker);
+	const int target = ENTINDEX(pentTarget);
+	const Entry& entry = _entries[Slot(looker, target)];
+
+	if (entry.frame == _frame)
+	{
+		if (entry.looker == looker && entry.target == target && entry.start == vecStart && entry.end == vecEnd)
+		{
+			_hits++;
+			visible = entry.visible;
+			return true;
+		}
+		if (entry.symmetric && entry.looker == target && entry.target == looker &&
+				entry.start == vecEnd && entry.end == vecStart &&
+				CanBeSymmetric(pentLooker) && CanBeSymmetric(pentTarget))
+		{
+			_hits++;
+			_symmetricHits++;
+			visible = entry.visible;
+			return true;
+		}
+	}
+	_misses++;
+	return false;
+}
+
+void VisibilityCache::Store(edict_t *pentLooker, edict_t *pentTarget, const Vector &vecStart, const Vector &vecEnd, bool visible)
+{
+	const int looker = ENTINDEX(pentLooker);
+	const int target = ENTINDEX(pentTarget);
+	Entry& entry = _entries[Slot(looker, target)];
+
+	entry.frame = _frame;
+	entry.looker = looker;
+	entry.target = target;
+	entry.start = vecStart;
+	entry.end = vecEnd;
+	entry.symmetric = CanBeSymmetric(pentLooker) && CanBeSymmetric(pentTarget);
+	entry.visible = visible;
+}
+
+void VisibilityCache::Report()
+{
+	const unsigned int total = _hits + _misses;
+	ALERT(at_console, "Visibility cache: %u hits (%u symmetric), %u misses", _hits, _symmetricHits, _misses);
+	if (total)
+		ALERT(at_console, ", hit rate %.1f%%", _hits * 100.0f / total);
+	ALERT(at_console, "\n");
+}
+
+void VisibilityCache::ResetCounters()
+{
+	_hits = _symmetricHits = _misses = 0;
+}
+
+void ReportVisibilityCache()
+{
+	g_VisibilityCache.Report();
+	if (CMD_ARGC() > 1 && FStrEq(CMD_ARGV(1), "reset"))
+		g_VisibilityCache.ResetCounters();
+}
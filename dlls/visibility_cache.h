@@ -0,0 +1,52 @@
+#pragma once
+#ifndef VISIBILITY_CACHE_H
+#define VISIBILITY_CACHE_H
+
+#include "extdll.h"
+
+// Frame-scoped cache of line of sight traces done by CBaseEntity::FVisible.
+// Entries are keyed by the looker/target edict pair and are valid only during the frame they were made in
+// and only for the exactly same trace endpoints.
+// For monsters and clients the result is shared between A->B and B->A traces when their eye positions match.
+class VisibilityCache
+{
+public:
+	enum {
+		CACHE_SIZE = 4096,
+	};
+
+	void NewFrame();
+	bool Lookup(edict_t* pentLooker, edict_t* pentTarget, const Vector& vecStart, const Vector& vecEnd, bool& visible);
+	void Store(edict_t* pentLooker, edict_t* pentTarget, const Vector& vecStart, const Vector& vecEnd, bool visible);
+
+	void Report();
+	void ResetCounters();
+private:
+	struct Entry
+	{
+		Entry(): frame(0), looker(0), target(0), symmetric(false), visible(false) {}
+		unsigned int frame;
+		int looker;
+		int target;
+		Vector start;
+		Vector end;
+		bool symmetric;
+		bool visible;
+	};
+
+	static unsigned int Slot(int a, int b);
+	static bool CanBeSymmetric(const edict_t* pent);
+
+	Entry _entries[CACHE_SIZE];
+	unsigned int _frame = 1;
+
+	unsigned int _hits = 0;
+	unsigned int _symmetricHits = 0;
+	unsigned int _misses = 0;
+};
+
+extern VisibilityCache g_VisibilityCache;
+
+void ReportVisibilityCache();
+
+#endif
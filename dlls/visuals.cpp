@@ -310,34 +310,50 @@ void VisualSystem::AddVisualFromJsonValue(const char *name, Value &value)
 		visual.SetDecay(decay);
 	}
 
-	_visuals[name] = visual;
+	Visual& entry = _visuals[name];
+	entry = visual;
+	IndexVisual(name, entry);
+}
+
+void VisualSystem::IndexVisual(const std::string& name, Visual& visual)
+{
+	const int symbol = g_NameSymbols.Intern(name.c_str());
+	if (symbol == NameSymbolTable::INVALID_SYMBOL)
+		return;
+	if (symbol >= (int)_visualsBySymbol.size())
+		_visualsBySymbol.resize(symbol + 1, nullptr);
+	_visualsBySymbol[symbol] = &visual;
+}
+
+Visual* VisualSystem::FindVisual(const char *name)
+{
+	const int symbol = g_NameSymbols.Find(name);
+	if (symbol >= 0 && symbol < (int)_visualsBySymbol.size())
+		return _visualsBySymbol[symbol];
+	return nullptr;
 }
 
 void VisualSystem::EnsureVisualExists(const std::string& name)
 {
-	auto it = _visuals.find(name);
-	if (it == _visuals.end())
-		_visuals[name] = Visual();
+	if (!FindVisual(name.c_str()))
+	{
+		Visual& entry = _visuals[name];
+		entry = Visual();
+		IndexVisual(name, entry);
+	}
 }
 
 const Visual* VisualSystem::GetVisual(const char *name)
 {
-	if (!name || *name == '\0')
-		return nullptr;
-	_temp = name; // reuse the same std::string for search to avoid reallocation
-	auto it = _visuals.find(_temp);
-	if (it != _visuals.end())
-		return &it->second;
-	return nullptr;
+	return FindVisual(name);
 }
 
 const Visual* VisualSystem::ProvideDefaultVisual(const char *name, const Visual &visual, bool doPrecache)
 {
-	_temp = name;
-	auto it = _visuals.find(_temp);
-	if (it != _visuals.end())
+	Visual* found = FindVisual(name);
+	if (found)
 	{
-		Visual& existing = it->second;
+		Visual& existing = *found;
 		existing.CompleteFrom(visual);
 
 		if (doPrecache)
@@ -347,10 +363,11 @@ const Visual* VisualSystem::ProvideDefaultVisual(const char *name, const Visual
 	}
 	else
 	{
-		auto inserted = _visuals.insert(std::make_pair(_temp, visual));
+		auto inserted = _visuals.insert(std::make_pair(std::string(name), visual));
 		if (inserted.second)
 		{
 			Visual* insertedVisual = &inserted.first->second;
+			IndexVisual(inserted.first->first, *insertedVisual);
 			if (doPrecache)
 				insertedVisual->DoPrecache();
 			return insertedVisual;
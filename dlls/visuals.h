@@ -10,7 +10,9 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 #include "icase_compare.h"
+#include "name_symbols.h"
 
 struct BeamVisualParams
 {
@@ -156,7 +158,15 @@ struct NamedVisual : public Visual
 	operator const char* () const {
 		return name;
 	}
+	// Resolved on the first use, the name never changes
+	int Symbol() const {
+		if (symbol == NameSymbolTable::INVALID_SYMBOL)
+			symbol = g_NameSymbols.Intern(name);
+		return symbol;
+	}
 	const NamedVisual* mixin = nullptr;
+private:
+	mutable int symbol = NameSymbolTable::INVALID_SYMBOL;
 };
 
 struct BuildVisual
@@ -275,6 +285,9 @@ public:
 	void AddVisualFromJsonValue(const char* name, rapidjson::Value& value);
 	void EnsureVisualExists(const std::string& name);
 	const Visual* GetVisual(const char* name);
+	const Visual* GetVisual(int symbol) const {
+		return symbol >= 0 && symbol < (int)_visualsBySymbol.size() ? _visualsBySymbol[symbol] : nullptr;
+	}
 	const Visual* ProvideDefaultVisual(const char* name, const Visual& visual, bool doPrecache);
 	const Visual* ProvideDefaultVisual(const char* name, const Visual& visual, const char* mixinName, const Visual& mixinVisual);
 	void DumpVisuals() const;
@@ -284,10 +297,12 @@ protected:
 	bool ReadFromDocument(rapidjson::Document& document, const char* fileName);
 private:
 	void DumpVisualImpl(const char* name, const Visual& visual) const;
+	void IndexVisual(const std::string& name, Visual& visual);
+	Visual* FindVisual(const char* name);
 
 	std::map<std::string, Visual, CaseInsensitiveCompare> _visuals;
+	std::vector<Visual*> _visualsBySymbol; // map nodes never move
 	std::set<std::string> _modelStringSet;
-	std::string _temp;
 };
 
 extern VisualSystem g_VisualSystem;
@@ -37,6 +37,10 @@
 #include "savetitles.h"
 #include "string_utils.h"
 #include "common_soundscripts.h"
+#include "studio_sequence_cache.h"
+#include "localmove_cache.h"
+#include "fullpack_cache.h"
+#include "pm_shared.h"
 
 extern CSoundEnt *pSoundEnt;
 
@@ -527,6 +531,11 @@ int CWorld::wallPuffsIndices[] = {0,0,0,0};
 void CWorld::Precache( void )
 {
 	g_pLastSpawn = NULL;
+	// Model data from the previous map may be gone
+	g_StudioSequenceCache.Clear();
+	g_LocalMoveCache.Invalidate();
+	g_FullPackCache.Clear();
+	PM_ClearGroundTextureCache();
 #if 1
 	CVAR_SET_STRING( "sv_gravity", "800" ); // 67ft/sec
 	CVAR_SET_STRING( "sv_stepsize", "18" );
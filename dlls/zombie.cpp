@@ -50,6 +50,9 @@ public:
 
 	float m_flNextFlinch;
 
+	void ResetMonsterState( void ) override;
+	bool CanBePooled( void ) override { return true; }
+
 	void PainSound( void ) override;
 	void AlertSound( void ) override;
 	void IdleSound( void ) override;
@@ -242,6 +245,12 @@ void CZombie::Spawn()
 	ZombieSpawnHelper("models/zombie.mdl", gSkillData.zombieHealth);
 }
 
+void CZombie::ResetMonsterState()
+{
+	m_flNextFlinch = 0.0f;
+	CBaseMonster::ResetMonsterState();
+}
+
 //=========================================================
 // Precache - precaches all resources this monster needs
 //=========================================================
@@ -12,6 +12,10 @@
 #include "rapidjson/schema.h"
 #include "rapidjson/error/en.h"
 
+#include <cstdint>
+#include <map>
+#include <memory>
+
 using namespace rapidjson;
 
 constexpr const char definitions[] = R"(
@@ -281,39 +285,72 @@ private:
 	const SchemaDocument* _schema;
 };
 
-bool ReadJsonDocumentWithSchema(Document &document, const char *pMemFile, int fileSize, const char *schemaText, const char* fileName)
+struct CompiledSchema
 {
-	if (!fileName)
-		fileName = "";
+	Document schemaDocument;
+	std::unique_ptr<SchemaDocument> schema;
+};
 
-	Document definitionsSchemaDocument;
-	definitionsSchemaDocument.Parse<kParseTrailingCommasFlag | kParseCommentsFlag>(definitions);
-	ParseResult parseResult = definitionsSchemaDocument;
-	if (!parseResult) {
-		ReportParseErrors(fileName, parseResult, pMemFile);
-		return false;
-	}
-	SchemaDocument definitionsSchema(definitionsSchemaDocument);
+// Schemas are compiled once per process and reused by every config that uses them.
+// Schema texts are static strings, so they are looked up by address.
+static std::unique_ptr<CompiledSchema> g_definitionsSchema;
+static std::unique_ptr<DefinitionsProvider> g_definitionsProvider;
+static std::map<const char*, std::unique_ptr<CompiledSchema> > g_compiledSchemas;
 
-	Document schemaDocument;
+static bool ParseSchemaText(Document& schemaDocument, const char* schemaText, const char* fileName)
+{
 	schemaDocument.Parse<kParseTrailingCommasFlag | kParseCommentsFlag>(schemaText);
-	parseResult = schemaDocument;
+	ParseResult parseResult = schemaDocument;
 	if (!parseResult) {
-		ReportParseErrors(fileName, parseResult, pMemFile);
+		ReportParseErrors(fileName, parseResult, schemaText);
 		return false;
 	}
+	return true;
+}
+
+static const CompiledSchema* GetCompiledSchema(const char* schemaText, const char* fileName)
+{
+	if (!g_definitionsProvider)
+	{
+		std::unique_ptr<CompiledSchema> definitionsSchema(new CompiledSchema);
+		if (!ParseSchemaText(definitionsSchema->schemaDocument, definitions, fileName))
+			return nullptr;
+		definitionsSchema->schema.reset(new SchemaDocument(definitionsSchema->schemaDocument));
+		g_definitionsProvider.reset(new DefinitionsProvider(definitionsSchema->schema.get()));
+		g_definitionsSchema = std::move(definitionsSchema);
+	}
+
+	auto it = g_compiledSchemas.find(schemaText);
+	if (it != g_compiledSchemas.end())
+		return it->second.get();
 
-	DefinitionsProvider provider(&definitionsSchema);
-	SchemaDocument schema(schemaDocument, 0, 0, &provider);
+	std::unique_ptr<CompiledSchema> compiledSchema(new CompiledSchema);
+	if (!ParseSchemaText(compiledSchema->schemaDocument, schemaText, fileName))
+		return nullptr;
+	compiledSchema->schema.reset(new SchemaDocument(compiledSchema->schemaDocument, 0, 0, g_definitionsProvider.get()));
+
+	const CompiledSchema* result = compiledSchema.get();
+	g_compiledSchemas[schemaText] = std::move(compiledSchema);
+	return result;
+}
+
+bool ReadJsonDocumentWithSchema(Document &document, const char *pMemFile, int fileSize, const char *schemaText, const char* fileName)
+{
+	if (!fileName)
+		fileName = "";
+
+	const CompiledSchema* compiledSchema = GetCompiledSchema(schemaText, fileName);
+	if (!compiledSchema)
+		return false;
 
 	document.Parse<kParseTrailingCommasFlag | kParseCommentsFlag>(pMemFile, fileSize);
-	parseResult = document;
+	ParseResult parseResult = document;
 	if (!parseResult) {
 		ReportParseErrors(fileName, parseResult, pMemFile);
 		return false;
 	}
 
-	SchemaValidator validator(schema);
+	SchemaValidator validator(*compiledSchema->schema);
 	if (!document.Accept(validator))
 	{
 		Pointer schemaPointer = validator.GetInvalidSchemaPointer();
@@ -334,7 +371,7 @@ bool ReadJsonDocumentWithSchema(Document &document, const char *pMemFile, int fi
 
 		StringBuffer schemaPartBuffer;
 		Pointer schemaKeywordPointer = schemaPointer.Append(validator.GetInvalidSchemaKeyword());
-		Value* schemaPartValue = GetValueByPointer(schemaDocument, schemaKeywordPointer);
+		const Value* schemaPartValue = GetValueByPointer(compiledSchema->schemaDocument, schemaKeywordPointer);
 		if (schemaPartValue)
 		{
 			Writer<StringBuffer> writer(schemaPartBuffer);
@@ -356,6 +393,30 @@ bool ReadJsonDocumentWithSchema(Document &document, const char *pMemFile, int fi
 	return true;
 }
 
+// Documents that were parsed and validated, by file name.
+// Reading a file again with the same contents and schema only copies the document.
+struct ValidatedDocument
+{
+	const char* schemaText;
+	std::uint64_t contentHash;
+	int fileSize;
+	Document document;
+};
+
+static std::map<std::string, std::unique_ptr<ValidatedDocument> > g_validatedDocuments;
+
+static std::uint64_t HashFileContents(const char* pMemFile, int fileSize)
+{
+	// FNV-1a
+	std::uint64_t hash = 14695981039346656037ULL;
+	for (int i = 0; i < fileSize; ++i)
+	{
+		hash ^= (unsigned char)pMemFile[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
 bool ReadJsonDocumentWithSchemaFromFile(Document &document, const char *fileName, const char *schemaText)
 {
 	int fileSize;
@@ -364,10 +425,39 @@ bool ReadJsonDocumentWithSchemaFromFile(Document &document, const char *fileName
 	if (!pMemFile)
 		return false;
 
+	const std::uint64_t contentHash = HashFileContents(pMemFile, fileSize);
+
+	auto it = g_validatedDocuments.find(fileName);
+	if (it != g_validatedDocuments.end())
+	{
+		const ValidatedDocument& validated = *it->second;
+		if (validated.schemaText == schemaText && validated.contentHash == contentHash && validated.fileSize == fileSize)
+		{
+			FreeFileContents(pMemFile);
+			LOG("Reusing unchanged %s\n", fileName);
+			document.CopyFrom(validated.document, document.GetAllocator());
+			return true;
+		}
+	}
+
 	LOG("Parsing %s\n", fileName);
 
 	const bool success = ReadJsonDocumentWithSchema(document, pMemFile, fileSize, schemaText, fileName);
 	FreeFileContents(pMemFile);
+
+	if (success)
+	{
+		std::unique_ptr<ValidatedDocument> validated(new ValidatedDocument);
+		validated->schemaText = schemaText;
+		validated->contentHash = contentHash;
+		validated->fileSize = fileSize;
+		validated->document.CopyFrom(document, validated->document.GetAllocator());
+		g_validatedDocuments[fileName] = std::move(validated);
+	}
+	else
+	{
+		g_validatedDocuments.erase(fileName);
+	}
 	return success;
 }
 
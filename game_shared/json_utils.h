@@ -8,7 +8,9 @@
 #include "rapidjson/document.h"
 #include "template_property_types.h"
 
+// Schemas are compiled on first use and kept for the lifetime of the process, schemaText must be a static string.
 bool ReadJsonDocumentWithSchema(rapidjson::Document& document, const char* pMemFile, int fileSize, const char* schemaText, const char* fileName);
+// A file read again with unchanged contents is copied from the last validated document instead of being parsed and validated
 bool ReadJsonDocumentWithSchemaFromFile(rapidjson::Document& document, const char* fileName, const char* schemaText);
 
 bool UpdatePropertyFromJson(std::string& str, rapidjson::Value& jsonValue, const char* key);
@@ -0,0 +1,14 @@
+#pragma once
+#ifndef ROPE_MSG_H
+#define ROPE_MSG_H
+
+// Type of the Rope message, followed by the entity index of the rope.
+// Ropes are only described this way when the server runs them in the client-side mode (sv_client_ropes)
+#define ROPE_MSG_CREATE 0 // anchor, number of segments, model indices and rest lengths of the body and the ending segments
+#define ROPE_MSG_REMOVE 1 // the rope index 0 removes all the ropes
+#define ROPE_MSG_ATTACH 2 // index of the attached player (0 when nobody is attached) and the attached segment
+
+// Direction of the rope gravity, the rope is built hanging along it
+#define ROPE_GRAVITY_FORCE Vector( 0, 0, -50 )
+
+#endif
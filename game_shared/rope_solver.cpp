@@ -0,0 +1,171 @@
+#include "rope_solver.h"
+
+#define ROPE_HOOK_CONSTANT	2500.0f
+#define ROPE_SPRING_DAMPING	0.1f
+
+// Real time consumed by each step, one step per rope frame
+#define ROPE_STEP_TIME	0.01f
+// Think times are rounded to the frame time, don't lose a step to that
+#define ROPE_STEP_TIME_EPSILON	0.0001f
+// Don't try to catch up after hitches and level loads
+#define ROPE_MAX_CATCHUP_STEPS	16
+
+// Simulated time of the integration in each step
+#define ROPE_STEP_DELTA	0.025f
+// The integration is followed by a force-free drift along the new velocities.
+// The spring constants are tuned for it: the original solver alternated between two sample buffers,
+// and the second one never had any mass, so every other integration only moved the samples along.
+#define ROPE_DRIFT_DELTA	( ROPE_STEP_DELTA * 7.0f / 12.0f )
+
+// Scratch space of the RK4 integration, shared by all ropes
+static Vector g_ropeForce[ROPE_MAX_SAMPLES];
+static Vector g_ropeEvalPosition[ROPE_MAX_SAMPLES];
+static Vector g_ropeEvalVelocity[ROPE_MAX_SAMPLES];
+static Vector g_ropeEvalForce[ROPE_MAX_SAMPLES];
+static Vector g_ropePositionChange[4][ROPE_MAX_SAMPLES];
+static Vector g_ropeVelocityChange[4][ROPE_MAX_SAMPLES];
+
+void RopeSolver::Init(int sampleCount, const Vector &gravityForce)
+{
+	numSamples = sampleCount;
+	if (numSamples > ROPE_MAX_SAMPLES)
+		numSamples = ROPE_MAX_SAMPLES;
+	gravity = gravityForce;
+	accumulatedTime = 0.0f;
+
+	for (int i = 0; i < ROPE_MAX_SAMPLES; ++i)
+	{
+		position[i] = velocity[i] = externalForce[i] = Vector(0, 0, 0);
+		massReciprocal[i] = 1.0f;
+		restLength[i] = 0.0f;
+		applyExternalForce[i] = false;
+	}
+}
+
+static void ComputeForces(const RopeSolver& rope, const Vector* position, const Vector* velocity, Vector* force)
+{
+	const int numSamples = rope.numSamples;
+	for (int i = 0; i < numSamples; ++i)
+	{
+		Vector sampleForce = Vector(0, 0, 0);
+		if (rope.massReciprocal[i] != 0.0f)
+			sampleForce = rope.gravity / rope.massReciprocal[i];
+
+		if (DotProduct(rope.gravity, velocity[i]) >= 0)
+			sampleForce = sampleForce + velocity[i] * -0.04f;
+		else
+			sampleForce = sampleForce - velocity[i];
+		force[i] = sampleForce;
+	}
+
+	for (int i = 0; i < numSamples - 1; ++i)
+	{
+		Vector vecDist = position[i] - position[i + 1];
+
+		const double flDistance = vecDist.Length();
+		if (flDistance == 0.0)
+			continue;
+
+		const double flForce = ( flDistance - rope.restLength[i] ) * ROPE_HOOK_CONSTANT;
+		const double flNewRelativeDist = DotProduct( velocity[i] - velocity[i + 1], vecDist ) * ROPE_SPRING_DAMPING;
+
+		vecDist = vecDist.Normalize();
+
+		const double flSpringFactor = -( flNewRelativeDist / flDistance + flForce );
+		const Vector vecForce = (float)flSpringFactor * vecDist;
+
+		force[i] = force[i] + vecForce;
+		force[i + 1] = force[i + 1] - vecForce;
+	}
+}
+
+void RopeSolver::Step()
+{
+	ComputeForces(*this, position, velocity, g_ropeForce);
+	for (int i = 0; i < numSamples; ++i)
+	{
+		if (applyExternalForce[i])
+		{
+			g_ropeForce[i] = g_ropeForce[i] + externalForce[i];
+			externalForce[i] = Vector(0, 0, 0);
+			applyExternalForce[i] = false;
+		}
+	}
+
+	const float deltas[4] = {
+		ROPE_STEP_DELTA * 0.5f,
+		ROPE_STEP_DELTA * 0.5f,
+		ROPE_STEP_DELTA * 0.5f,
+		ROPE_STEP_DELTA
+	};
+
+	const Vector* force = g_ropeForce;
+	const Vector* evalVelocity = velocity;
+	for (int stage = 0; stage < 4; ++stage)
+	{
+		Vector* positionChange = g_ropePositionChange[stage];
+		Vector* velocityChange = g_ropeVelocityChange[stage];
+		const float delta = deltas[stage];
+
+		for (int i = 0; i < numSamples; ++i)
+		{
+			velocityChange[i] = massReciprocal[i] * force[i] * delta;
+			positionChange[i] = evalVelocity[i] * delta;
+		}
+
+		if (stage == 3)
+			break;
+
+		for (int i = 0; i < numSamples; ++i)
+		{
+			g_ropeEvalVelocity[i] = velocity[i] + velocityChange[i];
+			g_ropeEvalPosition[i] = position[i] + positionChange[i];
+		}
+		ComputeForces(*this, g_ropeEvalPosition, g_ropeEvalVelocity, g_ropeEvalForce);
+		force = g_ropeEvalForce;
+		evalVelocity = g_ropeEvalVelocity;
+	}
+
+	for (int i = 0; i < numSamples; ++i)
+	{
+		const Vector vecPosChange = 1.0f / 6.0f * ( g_ropePositionChange[0][i] + ( g_ropePositionChange[1][i] + g_ropePositionChange[2][i] ) * 2 + g_ropePositionChange[3][i] );
+		const Vector vecVelChange = 1.0f / 6.0f * ( g_ropeVelocityChange[0][i] + ( g_ropeVelocityChange[1][i] + g_ropeVelocityChange[2][i] ) * 2 + g_ropeVelocityChange[3][i] );
+
+		velocity[i] = velocity[i] + vecVelChange;
+		position[i] = position[i] + vecPosChange + velocity[i] * ROPE_DRIFT_DELTA;
+	}
+}
+
+int RopeSolver::Advance(float seconds)
+{
+	if (seconds > 0.0f)
+		accumulatedTime += seconds;
+
+	int steps = 0;
+	while (accumulatedTime + ROPE_STEP_TIME_EPSILON >= ROPE_STEP_TIME)
+	{
+		if (steps == ROPE_MAX_CATCHUP_STEPS)
+		{
+			accumulatedTime = 0.0f;
+			break;
+		}
+		Step();
+		accumulatedTime -= ROPE_STEP_TIME;
+		++steps;
+	}
+	if (accumulatedTime < 0.0f)
+		accumulatedTime = 0.0f;
+	return steps;
+}
+
+void RopeSolver::AddExternalForce(int sample, const Vector &force)
+{
+	externalForce[sample] = externalForce[sample] + force;
+	applyExternalForce[sample] = true;
+}
+
+void RopeSolver::SetExternalForce(int sample, const Vector &force)
+{
+	externalForce[sample] = force;
+	applyExternalForce[sample] = true;
+}
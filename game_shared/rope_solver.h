@@ -0,0 +1,37 @@
+#pragma once
+#ifndef ROPE_SOLVER_H
+#define ROPE_SOLVER_H
+
+#include "vector.h"
+
+#define ROPE_MAX_SAMPLES 64
+
+// Spring and RK4 simulation of the samples (joints) of a rope. There's one spring between each pair of neighbour samples.
+// The state is kept in plain arrays, one per attribute, and is public so the owner can save and restore it.
+// Time is consumed in fixed steps, so the result doesn't depend on how often the owner advances the simulation.
+struct RopeSolver
+{
+	void Init(int sampleCount, const Vector& gravityForce);
+
+	// Consumes the given seconds in whole steps, the remainder is kept for the next call. Returns the number of steps done.
+	int Advance(float seconds);
+	void Step();
+
+	// External forces are applied on the next step
+	void AddExternalForce(int sample, const Vector& force);
+	void SetExternalForce(int sample, const Vector& force);
+
+	int numSamples;
+	Vector gravity;
+	float accumulatedTime;
+
+	Vector position[ROPE_MAX_SAMPLES];
+	Vector velocity[ROPE_MAX_SAMPLES];
+	Vector externalForce[ROPE_MAX_SAMPLES];
+	float massReciprocal[ROPE_MAX_SAMPLES];
+	// Rest length of the spring between the sample and the next one
+	float restLength[ROPE_MAX_SAMPLES];
+	bool applyExternalForce[ROPE_MAX_SAMPLES];
+};
+
+#endif
@@ -3,5 +3,16 @@
 #define SPRITEHINT_FLAGS_H
 
 #define OBJECTHINT_FLAG_CLOSEST (1<<0)
+#define OBJECTHINT_FLAG_REMOVE (1<<1) // remove the hint, or all the scan hints when the entity index is 0
+
+// Fields following the flags and the entity index of a hint that was added or changed
+#define OBJECTHINT_FIELD_SPRITE (1<<0)
+#define OBJECTHINT_FIELD_COLOR (1<<1)
+#define OBJECTHINT_FIELD_SCALE (1<<2)
+#define OBJECTHINT_FIELD_CENTER (1<<3)
+#define OBJECTHINT_FIELD_SIZE (1<<4)
+#define OBJECTHINT_FIELD_ALL (OBJECTHINT_FIELD_SPRITE|OBJECTHINT_FIELD_COLOR|OBJECTHINT_FIELD_SCALE|OBJECTHINT_FIELD_CENTER|OBJECTHINT_FIELD_SIZE)
+
+#define OBJECTHINT_MAX_SPRITES 255
 
 #endif
@@ -102,6 +102,33 @@ struct MatTexture
 // Texture names
 static fixed_vector<MatTexture, CTEXTURESMAX> gTextures;
 
+// Open addressing table of indices into gTextures, filled once the names are sorted
+#define CTEXTUREHASHSLOTS	( CTEXTURESMAX * 2 )
+static short gTextureHash[CTEXTUREHASHSLOTS];
+
+// Texture found under each player by the last trace. While the player stands on the same entity
+// within the same small cell the trace is skipped, which is every frame when standing still.
+#define TEXTURE_CACHE_CELL	4.0f
+
+struct GroundTextureCache
+{
+	bool valid;
+	int onground;
+	const struct model_s* model;
+	char physentName[32];
+	Vector physentAngles;
+	int cell[3];
+	char textureName[CBTEXTURENAMEMAX];
+	char textureType;
+};
+
+static GroundTextureCache gGroundTextureCache[MAX_CLIENTS];
+
+void PM_ClearGroundTextureCache( void )
+{
+	memset( gGroundTextureCache, 0, sizeof( gGroundTextureCache ) );
+}
+
 bool g_onladder = true;
 
 static void PM_InitTrace( trace_t *trace, const Vector& end )
@@ -128,6 +155,15 @@ std::set<char> PM_GetPossibleMaterials()
 	return materials;
 }
 
+static unsigned int PM_HashTextureName( const char *name )
+{
+	// FNV-1a over the lower case name
+	unsigned int hash = 2166136261u;
+	for( ; *name; name++ )
+		hash = ( hash ^ (unsigned char)tolower( *name ) ) * 16777619u;
+	return hash;
+}
+
 struct MatTextureComparator
 {
 	bool operator()(const MatTexture& lhs, const char* rhs)
@@ -207,6 +243,19 @@ void PM_InitTextureTypes( void )
 
 	std::sort(gTextures.begin(), gTextures.end(), MatTextureComparator());
 
+	for( i = 0; i < CTEXTUREHASHSLOTS; i++ )
+		gTextureHash[i] = -1;
+	for( i = 0; i < (int)gTextures.size(); i++ )
+	{
+		// Keep the first of the duplicates, like the binary search does
+		if( i > 0 && stricmp( gTextures[i - 1].name.c_str(), gTextures[i].name.c_str() ) == 0 )
+			continue;
+		unsigned int slot = PM_HashTextureName( gTextures[i].name.c_str() ) & ( CTEXTUREHASHSLOTS - 1 );
+		while( gTextureHash[slot] >= 0 )
+			slot = ( slot + 1 ) & ( CTEXTUREHASHSLOTS - 1 );
+		gTextureHash[slot] = i;
+	}
+
 	bTextureTypeInit = true;
 }
 
@@ -214,10 +263,16 @@ char PM_FindTextureType( const char *name )
 {
 	assert( pm_shared_initialized );
 
-	auto result = std::equal_range(gTextures.begin(), gTextures.end(), name, MatTextureComparator());
-	if (result.first != result.second)
+	if( !gTextures.empty() )
 	{
-		return result.first->type;
+		unsigned int slot = PM_HashTextureName( name ) & ( CTEXTUREHASHSLOTS - 1 );
+		while( gTextureHash[slot] >= 0 )
+		{
+			const MatTexture& texture = gTextures[gTextureHash[slot]];
+			if( stricmp( texture.name.c_str(), name ) == 0 )
+				return texture.type;
+			slot = ( slot + 1 ) & ( CTEXTUREHASHSLOTS - 1 );
+		}
 	}
 	return g_MaterialRegistry.DefaultMaterial();
 }
@@ -283,11 +338,59 @@ PM_CatagorizeTextureType
 Determine texture info for the texture we are standing on.
 ====================
 */
+static GroundTextureCache* PM_GroundTextureCacheLookup( int cell[3], bool& hit )
+{
+	hit = false;
+	if( pmove->player_index < 0 || pmove->player_index >= MAX_CLIENTS )
+		return NULL;
+	if( pmove->onground < 0 || pmove->onground >= pmove->numphysent )
+		return NULL;
+
+	const physent_t* pe = &pmove->physents[pmove->onground];
+	// Cells are relative to the ground entity so riding a moving platform keeps hitting the cache.
+	// A rotating one moves the textures under the player, so angles still have to match.
+	for( int i = 0; i < 3; i++ )
+		cell[i] = (int)floor( ( pmove->origin[i] - pe->origin[i] ) / TEXTURE_CACHE_CELL );
+
+	GroundTextureCache* cache = &gGroundTextureCache[pmove->player_index];
+	hit = cache->valid && cache->onground == pmove->onground && cache->model == pe->model &&
+		cache->physentAngles == pe->angles &&
+		cache->cell[0] == cell[0] && cache->cell[1] == cell[1] && cache->cell[2] == cell[2] &&
+		strncmp( cache->physentName, pe->name, sizeof( cache->physentName ) ) == 0;
+	return cache;
+}
+
+static void PM_GroundTextureCacheStore( GroundTextureCache* cache, const int cell[3] )
+{
+	const physent_t* pe = &pmove->physents[pmove->onground];
+	cache->valid = true;
+	cache->onground = pmove->onground;
+	cache->model = pe->model;
+	strncpy( cache->physentName, pe->name, sizeof( cache->physentName ) );
+	cache->physentAngles = pe->angles;
+	cache->cell[0] = cell[0];
+	cache->cell[1] = cell[1];
+	cache->cell[2] = cell[2];
+	strncpy( cache->textureName, pmove->sztexturename, sizeof( cache->textureName ) );
+	cache->textureName[sizeof( cache->textureName ) - 1] = '\0';
+	cache->textureType = pmove->chtexturetype;
+}
+
 void PM_CatagorizeTextureType( void )
 {
 	Vector start, end;
 	const char *pTextureName;
 
+	int cell[3];
+	bool hit;
+	GroundTextureCache* cache = PM_GroundTextureCacheLookup( cell, hit );
+	if( hit )
+	{
+		strcpy( pmove->sztexturename, cache->textureName );
+		pmove->chtexturetype = cache->textureType;
+		return;
+	}
+
 	VectorCopy( pmove->origin, start );
 	VectorCopy( pmove->origin, end );
 
@@ -299,13 +402,16 @@ void PM_CatagorizeTextureType( void )
 	pmove->chtexturetype = g_MaterialRegistry.DefaultMaterial();
 
 	pTextureName = pmove->PM_TraceTexture( pmove->onground, start, end );
-	if( !pTextureName )
-		return;
+	if( pTextureName )
+	{
+		GetStrippedTextureName(pmove->sztexturename, pTextureName);
 
-	GetStrippedTextureName(pmove->sztexturename, pTextureName);
+		// get texture type
+		pmove->chtexturetype = PM_FindTextureType( pmove->sztexturename );
+	}
 
-	// get texture type
-	pmove->chtexturetype = PM_FindTextureType( pmove->sztexturename );	
+	if( cache )
+		PM_GroundTextureCacheStore( cache, cell );
 }
 
 void PM_UpdateStepSound( void )
@@ -3105,6 +3211,7 @@ void PM_Init( struct playermove_s *ppmove )
 
 	PM_CreateStuckTable();
 	PM_InitTextureTypes();
+	PM_ClearGroundTextureCache();
 
 	pm_shared_initialized = true;
 }
@@ -19,6 +19,8 @@
 #include <set>
 
 void PM_Init( struct playermove_s *ppmove );
+// Forget the ground textures of the previous map, call on map change
+void PM_ClearGroundTextureCache( void );
 void PM_Move( struct playermove_s *ppmove, int server );
 char PM_FindTextureType( const char* name );
 std::set<char> PM_GetPossibleMaterials();
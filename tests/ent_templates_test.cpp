@@ -82,6 +82,11 @@ TEST(EntityTemplates, Parse)
 		EXPECT_STREQ(femaleCiv->GetSoundScriptNameOverride("Civilian.Die"), "Female.Die");
 		EXPECT_TRUE(femaleCiv->GetSoundScriptNameOverride("Nonexistent") == nullptr);
 
+		const int painOverride = femaleCiv->GetSoundScriptSymbolOverride(g_NameSymbols.Intern("Civilian.Pain"));
+		EXPECT_EQ(ss.GetSoundScript(painOverride), painSoundScript);
+		EXPECT_EQ(femaleCiv->GetSoundScriptSymbolOverride(g_NameSymbols.Intern("Nonexistent")), NameSymbolTable::INVALID_SYMBOL);
+		EXPECT_EQ(es.GetTemplate(g_NameSymbols.Find("FEMALE_CIV")), femaleCiv);
+
 		EXPECT_EQ(femaleCiv->PrecachedSoundsBegin(), femaleCiv->PrecachedSoundsEnd());
 		EXPECT_EQ(femaleCiv->PrecachedSoundScriptsBegin(), femaleCiv->PrecachedSoundScriptsEnd());
 
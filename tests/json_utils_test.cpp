@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "json_utils.h"
+
+const char numberSchema[] = R"(
+{
+	"type": "object",
+	"properties": {
+		"number": {
+			"type": "integer",
+			"minimum": 0
+		},
+		"color": {
+			"$ref": "definitions.json#/color"
+		}
+	},
+	"additionalProperties": false
+}
+)";
+
+TEST(JsonUtils, SchemaReused) {
+	const char valid[] = R"({"number": 4, "color": "255 0 0"})";
+	const char invalid[] = R"({"number": -4})";
+
+	for (int i = 0; i < 2; ++i)
+	{
+		rapidjson::Document document;
+		ASSERT_TRUE(ReadJsonDocumentWithSchema(document, valid, sizeof(valid) - 1, numberSchema, ""));
+		EXPECT_EQ(document["number"].GetInt(), 4);
+
+		rapidjson::Document invalidDocument;
+		EXPECT_FALSE(ReadJsonDocumentWithSchema(invalidDocument, invalid, sizeof(invalid) - 1, numberSchema, ""));
+	}
+}
+
+static void WriteTestFile(const char* fileName, const char* contents)
+{
+	FILE* f = fopen(fileName, "w");
+	ASSERT_NE(f, nullptr);
+	fputs(contents, f);
+	fclose(f);
+}
+
+TEST(JsonUtils, ChangedFileRevalidated) {
+	const char fileName[] = "json_utils_test.json";
+
+	WriteTestFile(fileName, R"({"number": 4})");
+	for (int i = 0; i < 2; ++i)
+	{
+		rapidjson::Document document;
+		ASSERT_TRUE(ReadJsonDocumentWithSchemaFromFile(document, fileName, numberSchema));
+		EXPECT_EQ(document["number"].GetInt(), 4);
+	}
+
+	WriteTestFile(fileName, R"({"number": 5})");
+	{
+		rapidjson::Document document;
+		ASSERT_TRUE(ReadJsonDocumentWithSchemaFromFile(document, fileName, numberSchema));
+		EXPECT_EQ(document["number"].GetInt(), 5);
+	}
+
+	WriteTestFile(fileName, R"({"number": -5})");
+	{
+		rapidjson::Document document;
+		EXPECT_FALSE(ReadJsonDocumentWithSchemaFromFile(document, fileName, numberSchema));
+	}
+
+	remove(fileName);
+}
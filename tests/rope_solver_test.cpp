@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "rope_solver.h"
+
+static void MakeHangingRope(RopeSolver& rope, int numSamples, float segmentLength)
+{
+	rope.Init(numSamples, Vector(0, 0, -50));
+	for (int i = 0; i < numSamples; ++i)
+	{
+		rope.position[i] = Vector(0, 0, -segmentLength * i);
+		rope.restLength[i] = segmentLength;
+	}
+	rope.massReciprocal[0] = 0;
+	rope.massReciprocal[numSamples - 1] = 0.2f;
+}
+
+TEST(RopeSolver, FixedSteps) {
+	RopeSolver rope;
+	MakeHangingRope(rope, 8, 16.0f);
+
+	EXPECT_EQ(rope.Advance(0.005f), 0);
+	EXPECT_EQ(rope.Advance(0.005f), 1);
+	EXPECT_EQ(rope.Advance(0.035f), 3);
+	EXPECT_EQ(rope.Advance(0.005f), 1);
+	// Hitches don't have to be caught up with
+	EXPECT_LT(rope.Advance(10.0f), 100);
+}
+
+TEST(RopeSolver, Deterministic) {
+	RopeSolver rope1;
+	RopeSolver rope2;
+	MakeHangingRope(rope1, 16, 16.0f);
+	MakeHangingRope(rope2, 16, 16.0f);
+
+	rope1.AddExternalForce(15, Vector(20000, 0, 0));
+	rope2.AddExternalForce(15, Vector(20000, 0, 0));
+
+	for (int i = 0; i < 10; ++i)
+		rope1.Advance(0.01f);
+	rope2.Advance(0.05f);
+	rope2.Advance(0.05f);
+
+	for (int i = 0; i < 16; ++i)
+	{
+		EXPECT_FLOAT_EQ(rope1.position[i].x, rope2.position[i].x);
+		EXPECT_FLOAT_EQ(rope1.position[i].z, rope2.position[i].z);
+	}
+}
+
+TEST(RopeSolver, AnchorStays) {
+	RopeSolver rope;
+	MakeHangingRope(rope, 8, 16.0f);
+	rope.AddExternalForce(7, Vector(0, 20000, 0));
+
+	for (int i = 0; i < 100; ++i)
+		rope.Step();
+
+	EXPECT_EQ(rope.position[0].x, 0.0f);
+	EXPECT_EQ(rope.position[0].y, 0.0f);
+	EXPECT_EQ(rope.position[0].z, 0.0f);
+	EXPECT_NE(rope.position[7].y, 0.0f);
+	EXPECT_LT(rope.position[7].z, rope.position[1].z);
+}
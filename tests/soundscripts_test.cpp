@@ -67,3 +67,26 @@ TEST(SoundScripts, Parse) {
 		EXPECT_EQ(bullsquidGrowl->attenuation, 1.1f);
 	}
 }
+
+TEST(SoundScripts, Symbols) {
+	SoundScriptSystem s;
+	ASSERT_TRUE(s.ReadFromContents(soundScripts, ""));
+
+	const int civilianPain = g_NameSymbols.Find("civilian.pain");
+	ASSERT_NE(civilianPain, NameSymbolTable::INVALID_SYMBOL);
+	EXPECT_EQ(civilianPain, g_NameSymbols.Intern("CIVILIAN.PAIN"));
+	EXPECT_EQ(s.GetSoundScript(civilianPain), s.GetSoundScript("Civilian.Pain"));
+
+	const NamedSoundScript growl(CHAN_WEAPON, {"bullsquid/growl.wav"}, "Bullsquid.Growl");
+	EXPECT_EQ(s.GetSoundScript(growl.Symbol()), s.GetSoundScript("Bullsquid.Growl"));
+	EXPECT_EQ(s.GetSoundScript(growl.Symbol())->waves.size(), 2);
+
+	const NamedSoundScript fallback(CHAN_BODY, {"common/null.wav"}, "Civilian.Fallback");
+	EXPECT_TRUE(s.GetSoundScript(fallback.Symbol()) == nullptr);
+	const SoundScript* provided = s.ProvideDefaultSoundScript(fallback.name, fallback);
+	ASSERT_TRUE(provided != nullptr);
+	EXPECT_EQ(s.GetSoundScript(fallback.Symbol()), provided);
+
+	EXPECT_TRUE(s.GetSoundScript(NameSymbolTable::INVALID_SYMBOL) == nullptr);
+	EXPECT_TRUE(s.GetSoundScript(g_NameSymbols.Count()) == nullptr);
+}